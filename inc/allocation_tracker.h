@@ -0,0 +1,61 @@
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+// When TRACK_HEAP_ALLOCATIONS is defined (which the Debug configurations do), the global operator new and operator delete are replaced in allocation_tracker.cpp
+// so that every heap allocation made through them is counted
+// Otherwise the default ones are used, nothing is counted, and the totals are always 0
+// Note that allocations made directly with malloc (e.g. by GLFW, Assimp, stb_image and ImGui) are not counted
+unsigned long long getTotalNumOfHeapAllocations();
+unsigned long long getTotalNumOfBytesAllocatedOnHeap();
+bool               isHeapAllocationTrackingEnabled();
+
+class AllocationTracker
+{
+public:
+
+   explicit AllocationTracker(unsigned int numOfWarmUpFrames);
+   ~AllocationTracker() = default;
+
+   AllocationTracker(const AllocationTracker&) = delete;
+   AllocationTracker& operator=(const AllocationTracker&) = delete;
+
+   AllocationTracker(AllocationTracker&&) = delete;
+   AllocationTracker& operator=(AllocationTracker&&) = delete;
+
+   void               beginFrame();
+   void               endFrame();
+
+   bool               isInSteadyState() const;
+
+   // Starts counting the warm-up frames again (e.g. while resources are loading, since loading them allocates)
+   void               restartWarmUp();
+
+   unsigned long long getNumOfAllocationsInLastFrame() const;
+   unsigned long long getNumOfBytesAllocatedInLastFrame() const;
+
+   unsigned long long getNumOfSteadyStateFrames() const;
+   unsigned long long getNumOfSteadyStateAllocations() const;
+   unsigned long long getMaxNumOfAllocationsInSteadyStateFrame() const;
+
+   // When enabled, debug builds assert if a frame allocates after the warm-up frames
+   void               setAssertOnSteadyStateAllocations(bool assertOnSteadyStateAllocations);
+
+private:
+
+   unsigned int       mNumOfWarmUpFrames;
+   unsigned long long mNumOfFrames;
+
+   unsigned long long mNumOfAllocationsAtBeginningOfFrame;
+   unsigned long long mNumOfBytesAllocatedAtBeginningOfFrame;
+
+   unsigned long long mNumOfAllocationsInLastFrame;
+   unsigned long long mNumOfBytesAllocatedInLastFrame;
+
+   unsigned long long mNumOfSteadyStateFrames;
+   unsigned long long mNumOfSteadyStateAllocations;
+   unsigned long long mMaxNumOfAllocationsInSteadyStateFrame;
+
+   bool               mAssertOnSteadyStateAllocations;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef BAKED_MODEL_H
+#define BAKED_MODEL_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+#include "mesh.h"
+
+// A baked model stores the meshes of a model in the format in which they are uploaded to a geometry arena,
+// so that loading it doesn't require Assimp, the mesh optimizer or any conversion
+// The file is made out of a header, a mesh table, a material table, the strings of the materials and the vertex and index blobs of the meshes
+// It's written with the byte order of the machine that bakes it, which is assumed to be the one that loads it
+
+// A baked model is only valid for the model file, the import flags and the vertex format that it was baked with
+struct BakedModelKey
+{
+   std::uint64_t sourceHash; // FNV-1a hash of the contents of the model file and of the MTL files that it references
+   unsigned int  importFlags;
+   VertexFormat  vertexFormat;
+};
+
+// Textures are referenced by their filenames, which are relative to the directory of the model
+// The filename of a texture type that the material doesn't use is empty
+struct MaterialDescription
+{
+   MaterialDescription(const std::array<std::string, static_cast<unsigned int>(MaterialTextureTypes::count)>& textureFilenames,
+                       const MaterialConstants&                                                               constants)
+      : textureFilenames(textureFilenames)
+      , constants(constants)
+   {
+
+   }
+
+   std::array<std::string, static_cast<unsigned int>(MaterialTextureTypes::count)> textureFilenames;
+   MaterialConstants                                                               constants;
+};
+
+// Vertex and index data of a mesh in the format of a geometry arena, which is owned by an ImportedModel or a BakedModel
+struct MeshDataView
+{
+   const void*  vertexData;
+   const void*  indexData;
+   unsigned int numOfVertices;
+   unsigned int numOfIndices;
+   unsigned int indexSizeInBytes;
+   unsigned int materialIndex;
+};
+
+// Mesh that was imported with Assimp and processed into the format of a geometry arena, but that was not uploaded yet
+struct ImportedMesh
+{
+   std::vector<unsigned char> vertexData;
+   std::vector<unsigned char> indexData;
+   unsigned int               numOfVertices;
+   unsigned int               numOfIndices;
+   unsigned int               indexSizeInBytes;
+   unsigned int               materialIndex;
+};
+
+// Model that was imported with Assimp, which is what a baked model is written from
+struct ImportedModel
+{
+   std::vector<MeshDataView> getMeshViews() const;
+
+   PositionQuantization             positionQuantization;
+   std::vector<ImportedMesh>        meshes;
+   std::vector<MaterialDescription> materials;
+};
+
+class BakedModel
+{
+public:
+
+   BakedModel() = default;
+   ~BakedModel() = default;
+
+   BakedModel(const BakedModel&) = delete;
+   BakedModel& operator=(const BakedModel&) = delete;
+
+   BakedModel(BakedModel&&) = default;
+   BakedModel& operator=(BakedModel&&) = default;
+
+   // Maps the file and checks that it was baked with the given key, and that all its tables and blobs lie within it
+   // Returns false without printing anything if the file doesn't exist or if it was baked with a different key, since that just means that it must be baked again
+   bool                             open(const std::string& bakedModelFilePath, const BakedModelKey& key);
+
+   PositionQuantization             getPositionQuantization() const;
+
+   // The views point to the mapped file, so they are only valid while the baked model is open
+   std::vector<MeshDataView>        getMeshViews() const;
+   std::vector<MaterialDescription> getMaterials() const;
+
+private:
+
+   MappedFile mFile;
+};
+
+bool writeBakedModel(const std::string& bakedModelFilePath, const BakedModelKey& key, const ImportedModel& importedModel);
+
+// Calculates the FNV-1a hash of the contents of a file, which is read through a mapping
+bool calculateFileHash(const std::string& filePath, std::uint64_t& hash);
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef BAKED_TEXTURE_H
+#define BAKED_TEXTURE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+#include "texture_compression.h"
+
+// A baked texture stores the mip chain of a texture compressed into a format that the GPU samples from directly (see texture_compression.h),
+// so that loading it doesn't require decoding the image, generating its mips or compressing them, and so that it takes less VRAM
+// The file is made out of a header, a mip level table and the blocks of the levels, starting with the base level
+// It's written with the byte order of the machine that bakes it, which is assumed to be the one that loads it
+
+// A baked texture is only valid for the image file and the color space that it was baked with
+// The compressed format isn't part of the key, since it's chosen from the image, so it's known once the file is open without having to read the image
+struct BakedTextureKey
+{
+   std::uint64_t     sourceHash; // FNV-1a hash of the contents of the image file
+   TextureColorSpace colorSpace;
+};
+
+class BakedTexture
+{
+public:
+
+   BakedTexture() = default;
+   ~BakedTexture() = default;
+
+   BakedTexture(const BakedTexture&) = delete;
+   BakedTexture& operator=(const BakedTexture&) = delete;
+
+   BakedTexture(BakedTexture&&) = default;
+   BakedTexture& operator=(BakedTexture&&) = default;
+
+   // Maps the file and checks that it was baked with the given key, and that its mip levels have the right sizes and lie within it
+   // Returns false without printing anything if the file doesn't exist or if it was baked with a different key, since that just means that it must be baked again
+   bool                                open(const std::string& bakedTextureFilePath, const BakedTextureKey& key);
+
+   bool                                isOpen() const;
+
+   CompressedTextureFormat             getFormat() const;
+   int                                 getWidth() const;
+   int                                 getHeight() const;
+
+   // Number of components of the image that the texture was baked from
+   int                                 getNumOfSourceComponents() const;
+
+   // The views point to the mapped file, so they are only valid while the baked texture is open
+   std::vector<CompressedMipLevelView> getMipLevels() const;
+
+private:
+
+   MappedFile mFile;
+};
+
+bool writeBakedTexture(const std::string&                     bakedTextureFilePath,
+                       const BakedTextureKey&                 key,
+                       CompressedTextureFormat                format,
+                       int                                    numOfSourceComponents,
+                       const std::vector<CompressedMipLevel>& mipLevels);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <string>
+#include <vector>
+
+// Benchmarks that run without a window or an OpenGL context
+// They are launched from the command line (see main.cpp) and print their results to the console
+
+void runObjectPoolBenchmark();
+void runInstanceTransformBenchmark();
+void runQTangentBenchmark();
+void runMeshOptimizerBenchmark(const char* modelFilePath);
+void runModelCacheBenchmark(const char* modelFilePath);
+void runObjParserBenchmark(const char* modelFilePath);
+
+// Imports each model with both Assimp and the OBJ parser, in both vertex formats, and checks that their meshes and materials match byte for byte
+// Returns false if any of them doesn't, which is what has to pass before USE_NATIVE_OBJ_PARSER can be defined by default
+bool verifyObjParser(const std::vector<std::string>& modelFilePaths);
+
+// Measures how a cold load of a model and its textures scales with the number of threads, without an OpenGL context
+void runLoadScalingBenchmark(const char* modelFilePath);
+
+// Without a model file, a model with hundreds of meshes is generated
+void runMeshProcessingBenchmark(const char* modelFilePath = nullptr);
+
+// Stress-tests a resource manager from many threads, checks that concurrent requests for the same resource only load it once,
+// and measures how well LRU eviction keeps a budgeted cache within its budget
+void runResourceCacheBenchmark();
+
+// Compares the lookups of resources by std::string keys with their lookups by StringIDs
+void runStringIDBenchmark();
+
+// Compresses the mip chain of a texture with each block-compressed format, verifies the blocks by decompressing them and reading them back from a baked texture,
+// and compares their sizes, their quality and the time it takes to load them with the time it takes to decode the image
+void runTextureCompressionBenchmark(const char* texFilePath);
+
+#endif
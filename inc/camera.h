@@ -53,6 +53,8 @@ public:
    bool      isFree() const;
    void      setFree(bool free);
 
+   bool      isDirty() const;
+
 private:
 
    void      updateCoordinateFrame();
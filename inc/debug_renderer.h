@@ -0,0 +1,91 @@
+#ifndef DEBUG_RENDERER_H
+#define DEBUG_RENDERER_H
+
+#include <glm/glm.hpp>
+
+#include <array>
+
+#include "linear_allocator.h"
+#include "shader.h"
+#include "quat.h"
+
+// Lines with the same style are rendered with a single draw call
+enum class DebugLineStyle : unsigned int
+{
+   thin  = 0, // 1 pixel wide
+   thick = 1, // 5 pixels wide
+   count = 2
+};
+
+// Immediate mode renderer for debug geometry
+// Shapes are added every frame, appended to the CPU side vertex list of their style, and uploaded to a single dynamic vertex buffer when the renderer is flushed
+// The vertex lists are allocated from a per-frame allocator, so begin must be called every frame before any shapes are added
+// This lets us visualize thousands of orientation frames with one upload and one draw call per style
+class DebugRenderer
+{
+public:
+
+   DebugRenderer();
+   ~DebugRenderer();
+
+   DebugRenderer(const DebugRenderer&) = delete;
+   DebugRenderer& operator=(const DebugRenderer&) = delete;
+
+   DebugRenderer(DebugRenderer&& rhs) noexcept;
+   DebugRenderer& operator=(DebugRenderer&& rhs) noexcept;
+
+   // Shapes that are added before begin is called for the first time, or after the allocator runs out of memory, are dropped
+   void         begin(LinearAllocator& frameAllocator);
+
+   void         addLine(const glm::vec3& startPoint, const glm::vec3& endPoint, const glm::vec3& color, DebugLineStyle style = DebugLineStyle::thin);
+
+   // Adds the X, Y and Z axes of a coordinate system that is rotated by the given rotation
+   void         addAxes(const glm::vec3& position,
+                        const quat&      rotation,
+                        float            length,
+                        DebugLineStyle   style  = DebugLineStyle::thin,
+                        const glm::vec3& xColor = glm::vec3(1.0f, 0.0f, 0.0f),
+                        const glm::vec3& yColor = glm::vec3(0.0f, 1.0f, 0.0f),
+                        const glm::vec3& zColor = glm::vec3(0.0f, 0.0f, 1.0f));
+
+   // Adds an arc that starts at center + startVector and sweeps angleInRad around the normal (counterclockwise when looking down the normal)
+   // The component of startVector that is parallel to the normal is ignored, and the radius of the arc is the length of what remains
+   void         addArc(const glm::vec3& center,
+                       const glm::vec3& normal,
+                       const glm::vec3& startVector,
+                       float            angleInRad,
+                       const glm::vec3& color,
+                       DebugLineStyle   style          = DebugLineStyle::thin,
+                       unsigned int     numOfSegments  = 32);
+
+   // Adds the axes of the given rotation, together with its axis of rotation (white) and an arc that shows its angle of rotation (yellow)
+   void         addOrientationFrame(const glm::vec3& position, const quat& rotation, float size, DebugLineStyle style = DebugLineStyle::thin);
+
+   // Uploads the lines that were added since the last flush, renders them and clears them
+   void         flush(const Shader& shader);
+
+   unsigned int getNumOfLinesInLastFlush() const;
+   unsigned int getNumOfDrawCallsInLastFlush() const;
+
+private:
+
+   struct DebugVertex
+   {
+      glm::vec3 position;
+      glm::vec3 color;
+   };
+
+   void         configureVAO();
+
+   // The vertices of each style are kept in a separate list, so that they end up contiguous in the vertex buffer
+   std::array<FrameVector<DebugVertex>, static_cast<unsigned int>(DebugLineStyle::count)> mVertices;
+
+   unsigned int mVAO;
+   unsigned int mVBO;
+   unsigned int mCapacityOfVBOInBytes;
+
+   unsigned int mNumOfLinesInLastFlush;
+   unsigned int mNumOfDrawCallsInLastFlush;
+};
+
+#endif
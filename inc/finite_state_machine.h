@@ -5,6 +5,7 @@
 #include <memory>
 
 #include "state.h"
+#include "string_id.h"
 
 class FiniteStateMachine
 {
@@ -19,26 +20,27 @@ public:
    FiniteStateMachine(FiniteStateMachine&&) = delete;
    FiniteStateMachine& operator=(FiniteStateMachine&&) = delete;
 
-   void                   initialize(std::unordered_map<std::string, std::shared_ptr<State>>&& states,
-                                     const std::string&                                        initialStateID);
+   void                   initialize(std::unordered_map<StringID, std::shared_ptr<State>>&& states,
+                                     StringID                                               initialStateID);
    void                   processInputInCurrentState(float deltaTime) const;
    void                   updateCurrentState(float deltaTime) const;
    void                   renderCurrentState() const;
-   void                   changeState(const std::string& newStateID);
+   bool                   currentStateNeedsRedraw() const;
+   void                   changeState(StringID newStateID);
 
    std::shared_ptr<State> getPreviousState();
 
-   std::string            getPreviousStateID() const;
-   std::string            getCurrentStateID() const;
+   StringID               getPreviousStateID() const;
+   StringID               getCurrentStateID() const;
 
 private:
 
-   std::unordered_map<std::string, std::shared_ptr<State>> mStates;
+   std::unordered_map<StringID, std::shared_ptr<State>> mStates;
 
-   std::shared_ptr<State>                                  mCurrentState;
+   std::shared_ptr<State>                               mCurrentState;
 
-   std::string                                             mPreviousStateID;
-   std::string                                             mCurrentStateID;
+   StringID                                             mPreviousStateID;
+   StringID                                             mCurrentStateID;
 };
 
 #endif
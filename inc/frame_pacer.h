@@ -0,0 +1,49 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+class FramePacer
+{
+public:
+
+   FramePacer();
+   ~FramePacer() = default;
+
+   FramePacer(const FramePacer&) = delete;
+   FramePacer& operator=(const FramePacer&) = delete;
+
+   FramePacer(FramePacer&&) = delete;
+   FramePacer& operator=(FramePacer&&) = delete;
+
+   void   waitForNextFrame();
+
+   int    getTargetFrameRate() const;
+   void   setTargetFrameRate(int targetFrameRate);
+
+   bool   isLateLatchEnabled() const;
+   void   setLateLatch(bool lateLatch);
+
+   // Input to present latency
+   void   recordInputLatency(double latencyInSec);
+   double getLastInputLatencyInMs() const;
+   double getAverageInputLatencyInMs() const;
+   double getMaxInputLatencyInMs() const;
+   void   resetInputLatencyStats();
+
+private:
+
+   int    mTargetFrameRate;
+   double mTargetFrameDurationInSec;
+   double mNextFrameDeadlineInSec;
+
+   // OS sleeps are not precise, so we stop sleeping this amount of time before the deadline and spin for the rest
+   double mSpinThresholdInSec;
+
+   bool   mLateLatch;
+
+   double mLastInputLatencyInSec;
+   double mAverageInputLatencyInSec;
+   double mMaxInputLatencyInSec;
+   bool   mHasInputLatencySamples;
+};
+
+#endif
@@ -3,10 +3,23 @@
 
 #include "model.h"
 #include "game_object_3D.h"
+#include "object_pool.h"
 #include "camera.h"
 #include "window.h"
 #include "state.h"
 #include "finite_state_machine.h"
+#include "frame_pacer.h"
+#include "uniform_buffer.h"
+#include "uniform_blocks.h"
+#include "material_buffer.h"
+#include "texture_cache.h"
+#include "geometry_arena.h"
+#include "allocation_tracker.h"
+#include "linear_allocator.h"
+#include "thread_pool.h"
+#include "gl_upload_queue.h"
+
+class PlayState;
 
 class Game
 {
@@ -24,20 +37,56 @@ public:
    bool  initialize(const std::string& title);
    void  executeGameLoop();
 
+   void  setOnDemandRendering(bool onDemandRendering);
+   void  setTargetFrameRate(int targetFrameRate);
+   void  setSwapInterval(int swapInterval);
+   void  setLateLatch(bool lateLatch);
+   void  setNumOfBenchmarkFrames(unsigned int numOfBenchmarkFrames);
+   void  setNumOfStressTestTeapots(unsigned int numOfStressTestTeapots);
+   void  setModelMemoryBudget(const ResourceFootprint& budget);
+
 private:
 
+   bool  needsToRender();
+
    std::shared_ptr<FiniteStateMachine>     mFSM;
+   std::shared_ptr<PlayState>              mPlayState;
 
    std::shared_ptr<Window>                 mWindow;
 
    std::shared_ptr<Camera>                 mCamera;
 
+   std::shared_ptr<FramePacer>             mFramePacer;
+
+   std::shared_ptr<UniformBuffer>          mCameraUniformBuffer;
+   std::shared_ptr<UniformBuffer>          mLightsUniformBuffer;
+   std::shared_ptr<MaterialBuffer>         mMaterialBuffer;
+   std::shared_ptr<TextureCache>           mTextureCache;
+   std::shared_ptr<GeometryArena>          mGeometryArena;
+
+   // The thread pool is declared after the upload queue so that it's destroyed first, since its tasks push to the upload queue
+   std::shared_ptr<GLUploadQueue>          mGLUploadQueue;
+   std::shared_ptr<ThreadPool>             mThreadPool;
+
    ResourceManager<Model>                  mModelManager;
-   ResourceManager<Texture>                mTextureManager;
    ResourceManager<Shader>                 mShaderManager;
 
-   std::shared_ptr<GameObject3D>           mTable;
-   std::shared_ptr<GameObject3D>           mTeapot;
+   std::shared_ptr<ObjectPool<GameObject3D>> mGameObject3DPool;
+
+   Handle<GameObject3D>                    mTable;
+   Handle<GameObject3D>                    mTeapot;
+
+   // On-demand rendering
+   bool                                    mOnDemandRendering;
+   unsigned int                            mNumOfFramesToRenderAfterEvents;
+   unsigned long long                      mNumOfRenderedFrames;
+   unsigned long long                      mNumOfSkippedFrames;
+
+   // Memory
+   AllocationTracker                       mAllocationTracker;
+   std::shared_ptr<LinearAllocator>        mFrameAllocator;
+
+   unsigned int                            mNumOfBenchmarkFrames;
 };
 
 #endif
@@ -7,16 +7,18 @@
 
 #include "model.h"
 #include "quat.h"
+#include "resource_manager.h"
 
 class GameObject3D
 {
 public:
 
-   GameObject3D(const std::shared_ptr<Model>& model,
-                const glm::vec3&              position,
-                float                         angleOfRotInDeg,
-                const glm::vec3&              axisOfRot,
-                float                         scalingFactor);
+   // The model can still be loading (see ResourceManager::loadResourceAsync), in which case the game object isn't rendered until it's ready
+   GameObject3D(const ResourceHandle<Model>& model,
+                const glm::vec3&             position,
+                float                        angleOfRotInDeg,
+                const glm::vec3&             axisOfRot,
+                float                        scalingFactor);
    ~GameObject3D() = default;
 
    GameObject3D(const GameObject3D&) = default;
@@ -27,11 +29,18 @@ public:
 
    void      render(const Shader& shader) const;
 
+   // Returns a nullptr while the model is loading
+   const std::shared_ptr<Model>& getModel() const;
+   const ResourceHandle<Model>&  getModelHandle() const;
+   bool                          isModelReady() const;
+   InstanceTransform             getInstanceTransform() const;
+
    glm::vec3 getPosition() const;
    void      setPosition(const glm::vec3& position);
 
    float     getScalingFactor() const;
 
+   quat      getRotation() const;
    void      setRotation(const quat& rotation);
 
    void      translate(const glm::vec3& translation);
@@ -39,18 +48,18 @@ public:
    void      rotateByMultiplyingCurrentRotationFromTheRight(const quat& rotation);
    void      scale(float scalingFactor);
 
-private:
+   bool      isDirty() const;
 
-   void      calculateModelMatrix() const;
+private:
 
-   std::shared_ptr<Model> mModel;
+   ResourceHandle<Model>  mModel;
 
    glm::vec3              mPosition;
    quat                   mRotation;
    float                  mScalingFactor;
 
-   mutable glm::mat4      mModelMatrix;
-   mutable bool           mCalculateModelMatrix;
+   // Set when the transform changes, and cleared when the transform is sent to the GPU
+   mutable bool           mIsDirty;
 };
 
 #endif
@@ -0,0 +1,133 @@
+#ifndef GEOMETRY_ARENA_H
+#define GEOMETRY_ARENA_H
+
+#include <vector>
+
+#include "mesh.h"
+#include "offset_allocator.h"
+
+// The geometry arena stores the vertices and indices of all the meshes in a single vertex buffer and a single index buffer,
+// which are sub-allocated with offset allocators and described by a single VAO
+// Meshes are ranges of those buffers, so rendering a different mesh never requires a VAO switch, and consecutive draws can be submitted together as a list of commands
+// When an allocation doesn't fit, the arena is compacted, and if that's not enough it's grown
+// All the vertices of an arena share its vertex format, but its meshes can mix 16-bit and 32-bit indices
+class GeometryArena
+{
+public:
+
+   GeometryArena(VertexFormat vertexFormat, unsigned int initialNumOfVertices, unsigned int initialNumOfIndices);
+   ~GeometryArena();
+
+   GeometryArena(const GeometryArena&) = delete;
+   GeometryArena& operator=(const GeometryArena&) = delete;
+
+   // Meshes keep pointers to the arena, so it can't be moved
+   GeometryArena(GeometryArena&&) = delete;
+   GeometryArena& operator=(GeometryArena&&) = delete;
+
+   // Convert the data to the format of the arena, copy it into the arena and return the IDs of its allocations
+   unsigned int                allocateVertices(const std::vector<Vertex>& vertices, const PositionQuantization& positionQuantization);
+   unsigned int                allocateIndices(const std::vector<unsigned int>& indices, unsigned int numOfVertices);
+
+   // Copy data that is already in the format of the arena (see encodeVertices and encodeIndices) into the arena and return the IDs of its allocations
+   // The data is uploaded straight from the given memory, which can be a mapped file
+   unsigned int                allocateEncodedVertices(const void* vertexData, unsigned int numOfVertices);
+   unsigned int                allocateEncodedIndices(const void* indexData, unsigned int numOfIndices, unsigned int indexSizeInBytes);
+
+   // Convert data to the format of an arena with the given vertex format, which doesn't need an OpenGL context
+   // The size of the encoded indices depends on the number of vertices that they address, and it's returned through indexSizeInBytes
+   static std::vector<unsigned char> encodeVertices(VertexFormat vertexFormat, const std::vector<Vertex>& vertices, const PositionQuantization& positionQuantization);
+   static std::vector<unsigned char> encodeIndices(VertexFormat                     vertexFormat,
+                                                   const std::vector<unsigned int>& indices,
+                                                   unsigned int                     numOfVertices,
+                                                   unsigned int&                    indexSizeInBytes);
+
+   void                        freeVertices(unsigned int vertexAllocationID);
+   void                        freeIndices(unsigned int indexAllocationID);
+
+   // Moves all the allocations to the beginning of the buffers
+   // Draw commands must be rebuilt afterwards, since they store offsets
+   void                        compact();
+
+   DrawElementsIndirectCommand getDrawCommand(unsigned int vertexAllocationID,
+                                              unsigned int indexAllocationID,
+                                              unsigned int numOfInstances,
+                                              unsigned int baseInstance) const;
+
+   unsigned int                getIndexType(unsigned int indexAllocationID) const; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+
+   // Bytes taken by an allocation in the buffers, including its padding
+   unsigned int                getVertexAllocationSizeInBytes(unsigned int vertexAllocationID) const;
+   unsigned int                getIndexAllocationSizeInBytes(unsigned int indexAllocationID) const;
+
+   void                        bindVertexArray() const;
+
+   // The instance transforms of all the commands of a frame are uploaded at once, and each command selects its own with its base instance
+   void                        uploadInstanceTransforms(const InstanceTransform* instanceTransforms, unsigned int numOfInstances);
+
+   // Executes a list of draw commands that use the geometry of the arena
+   // Like glMultiDrawElementsIndirect, all the commands of a list must use the same index type
+   // Returns the number of draw calls that were issued, which is one per command, since OpenGL 3.3 can only emulate the multi-draw
+   unsigned int                multiDrawElementsIndirect(unsigned int indexType, const DrawElementsIndirectCommand* commands, unsigned int numOfCommands) const;
+
+   VertexFormat                getVertexFormat() const;
+
+   unsigned int                getVertexCapacity() const;
+   unsigned int                getNumOfFreeVertices() const;
+   unsigned int                getIndexCapacityInBytes() const;
+   unsigned int                getNumOfFreeIndexBytes() const;
+
+   // Bytes taken by the vertices and indices of the allocations, and bytes they would take on top of that with the standard vertex format
+   unsigned int                getNumOfBytesInUse() const;
+   unsigned int                getNumOfBytesSavedByVertexFormat() const;
+
+private:
+
+   // Only the first dataSizeInBytes bytes of the allocation are uploaded, so that data whose size is not a multiple of the size of the elements doesn't need to be padded
+   unsigned int                allocate(OffsetAllocator& allocator,
+                                        unsigned int     bufferID,
+                                        unsigned int     elementSizeInBytes,
+                                        unsigned int     numOfElements,
+                                        const void*      data,
+                                        unsigned int     dataSizeInBytes);
+
+   // Compacts the allocator, grows it if the compaction didn't free a big enough block, and moves the contents of the buffer accordingly
+   void                        makeRoom(OffsetAllocator& allocator, unsigned int bufferID, unsigned int elementSizeInBytes, unsigned int numOfElements);
+   void                        relocate(unsigned int                              bufferID,
+                                        unsigned int                              elementSizeInBytes,
+                                        unsigned int                              oldCapacity,
+                                        unsigned int                              newCapacity,
+                                        const std::vector<OffsetAllocator::Move>& moves);
+
+   void                        setBaseInstance(unsigned int baseInstance) const;
+
+   void                        configureVAO();
+
+   struct IndexAllocation
+   {
+      unsigned int numOfIndices;
+      unsigned int indexSizeInBytes;
+   };
+
+   VertexFormat                 mVertexFormat;
+   unsigned int                 mVertexSizeInBytes;
+
+   // The vertex allocator counts vertices, and the index allocator counts 16-bit units so that both index types can share the index buffer
+   OffsetAllocator              mVertexAllocator;
+   OffsetAllocator              mIndexAllocator;
+   std::vector<IndexAllocation> mIndexAllocations; // Indexed by the IDs of the index allocations
+
+   unsigned int                 mVAO;
+   unsigned int                 mVBO;
+   unsigned int                 mEBO;
+   unsigned int                 mInstanceVBO;
+   unsigned int                 mInstanceCapacity;
+
+   // Base instance that the instance attributes of the VAO currently point to
+   mutable unsigned int         mCurrBaseInstance;
+
+   unsigned int                 mNumOfBytesInUse;
+   unsigned int                 mNumOfBytesSavedByVertexFormat;
+};
+
+#endif
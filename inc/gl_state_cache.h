@@ -0,0 +1,76 @@
+#ifndef GL_STATE_CACHE_H
+#define GL_STATE_CACHE_H
+
+#include <glad/glad.h>
+
+#include <array>
+
+// The GL state cache remembers the state that was last set through it, and it filters the calls that would set the same state again
+// Since the OpenGL context is global, so is the cache. All the rendering classes must go through it, otherwise the cache would be out of date
+// The cache is invalidated at the beginning of every frame, which keeps it correct even if a library (e.g. ImGui) changes the state behind its back
+class GLStateCache
+{
+public:
+
+   static GLStateCache& get();
+
+   GLStateCache(const GLStateCache&) = delete;
+   GLStateCache& operator=(const GLStateCache&) = delete;
+
+   GLStateCache(GLStateCache&&) = delete;
+   GLStateCache& operator=(GLStateCache&&) = delete;
+
+   // Forgets all the cached state and starts counting the calls of a new frame
+   void         beginFrame();
+   void         invalidate();
+
+   void         useProgram(unsigned int programID);
+   void         bindVertexArray(unsigned int vaoID);
+
+   // Only GL_ARRAY_BUFFER and GL_UNIFORM_BUFFER are cached, since GL_ELEMENT_ARRAY_BUFFER is part of the state of the VAO
+   void         bindBuffer(GLenum target, unsigned int bufferID);
+   void         bindBufferBase(GLenum target, unsigned int index, unsigned int bufferID);
+
+   void         activeTexture(unsigned int texUnit);
+   void         bindTexture2D(unsigned int texUnit, unsigned int texID);
+
+   void         enable(GLenum capability);
+   void         disable(GLenum capability);
+
+   void         lineWidth(float width);
+
+   // Deleting an object that is bound changes the bindings behind the back of the cache, so objects must be deleted through it
+   void         deleteProgram(unsigned int programID);
+   void         deleteVertexArray(unsigned int vaoID);
+   void         deleteBuffer(unsigned int bufferID);
+   void         deleteTexture(unsigned int texID);
+
+   unsigned int getNumOfCallsIssuedInLastFrame() const;
+   unsigned int getNumOfCallsSkippedInLastFrame() const;
+
+private:
+
+   GLStateCache();
+   ~GLStateCache() = default;
+
+   bool         setCapability(GLenum capability, bool enabled);
+
+   static const unsigned int                  maxNumOfTexUnits = 32;
+   static const unsigned int                  unknown          = 0xFFFFFFFF; // Value of the state that is not known to the cache
+
+   unsigned int                               mProgramID;
+   unsigned int                               mVAOID;
+   unsigned int                               mArrayBufferID;
+   unsigned int                               mUniformBufferID;
+   unsigned int                               mActiveTexUnit;
+   std::array<unsigned int, maxNumOfTexUnits> mTexture2DIDs;
+   std::array<int, 4>                         mCapabilities; // GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND and GL_MULTISAMPLE (1 = Enabled, 0 = Disabled, -1 = Unknown)
+   float                                      mLineWidth;
+
+   unsigned int                               mNumOfCallsIssued;
+   unsigned int                               mNumOfCallsSkipped;
+   unsigned int                               mNumOfCallsIssuedInLastFrame;
+   unsigned int                               mNumOfCallsSkippedInLastFrame;
+};
+
+#endif
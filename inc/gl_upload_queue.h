@@ -0,0 +1,38 @@
+#ifndef GL_UPLOAD_QUEUE_H
+#define GL_UPLOAD_QUEUE_H
+
+#include <deque>
+#include <functional>
+#include <mutex>
+
+// Queue of the steps of asynchronous loads that create OpenGL objects, which can only run on the thread that has the context
+// Any thread can push uploads, and the context thread processes them once per frame within a time budget, so that a burst of loads doesn't cause a long frame
+class GLUploadQueue
+{
+public:
+
+   GLUploadQueue();
+   ~GLUploadQueue() = default;
+
+   GLUploadQueue(const GLUploadQueue&) = delete;
+   GLUploadQueue& operator=(const GLUploadQueue&) = delete;
+
+   GLUploadQueue(GLUploadQueue&&) = delete;
+   GLUploadQueue& operator=(GLUploadQueue&&) = delete;
+
+   void         push(std::function<void()> upload);
+
+   // Must be called on the context thread
+   // Runs uploads in the order in which they were pushed until the budget is exceeded, and returns how many of them it ran
+   // At least one upload is run per call, so that uploads that take longer than the budget are not postponed forever
+   unsigned int processUploads(double budgetInSec);
+
+   unsigned int getNumOfPendingUploads() const;
+
+private:
+
+   std::deque<std::function<void()>> mUploads;
+   mutable std::mutex                mMutex;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef INSTANCED_RENDERER_H
+#define INSTANCED_RENDERER_H
+
+#include <vector>
+
+#include "game_object_3D.h"
+#include "render_queue.h"
+
+// Groups the game objects that share a Model so that each of its meshes can be rendered once for all of them with instancing
+// The groups are cleared but not freed at the beginning of every frame, so after the first few frames submitting objects doesn't allocate
+class InstancedRenderer
+{
+public:
+
+   InstancedRenderer();
+   ~InstancedRenderer() = default;
+
+   InstancedRenderer(const InstancedRenderer&) = delete;
+   InstancedRenderer& operator=(const InstancedRenderer&) = delete;
+
+   InstancedRenderer(InstancedRenderer&&) = default;
+   InstancedRenderer& operator=(InstancedRenderer&&) = default;
+
+   void         begin();
+   void         submit(const GameObject3D& gameObject);
+
+   // Submits one instanced packet per mesh of each group to the render queue
+   void         flush(RenderQueue& renderQueue, RenderPass pass, const Shader& shader) const;
+
+private:
+
+   struct InstanceGroup
+   {
+      const Model*                   model;
+      std::vector<InstanceTransform> instanceTransforms;
+      unsigned int                   numOfInstances;
+   };
+
+   std::vector<InstanceGroup> mGroups;
+};
+
+#endif
@@ -0,0 +1,233 @@
+#ifndef LINEAR_ALLOCATOR_H
+#define LINEAR_ALLOCATOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// A linear allocator hands out memory by bumping an offset inside a block that is allocated once
+// Individual allocations cannot be freed. Instead, the whole block is reset at once (e.g. at the beginning of every frame)
+// This makes it a good fit for transient render data, which only needs to live for a single frame
+class LinearAllocator
+{
+public:
+
+   explicit LinearAllocator(std::size_t capacityInBytes);
+   ~LinearAllocator() = default;
+
+   LinearAllocator(const LinearAllocator&) = delete;
+   LinearAllocator& operator=(const LinearAllocator&) = delete;
+
+   LinearAllocator(LinearAllocator&&) = default;
+   LinearAllocator& operator=(LinearAllocator&&) = default;
+
+   void*       allocate(std::size_t sizeInBytes, std::size_t alignment);
+
+   template<typename T>
+   T*          allocateArray(std::size_t count);
+
+   void        reset();
+
+   std::size_t getCapacityInBytes() const;
+   std::size_t getUsedBytes() const;
+   std::size_t getPeakUsedBytes() const;
+
+private:
+
+   std::unique_ptr<unsigned char[]> mBlock;
+   std::size_t                      mCapacityInBytes;
+   std::size_t                      mOffset;
+   std::size_t                      mPeakOffset;
+   bool                             mOutOfMemoryReported;
+};
+
+template<typename T>
+T* LinearAllocator::allocateArray(std::size_t count)
+{
+   // Destructors are never called on memory that comes from a linear allocator
+   static_assert(std::is_trivially_destructible<T>::value, "LinearAllocator can only allocate trivially destructible types");
+
+   void* memory = allocate(sizeof(T) * count, alignof(T));
+   if (!memory)
+   {
+      return nullptr;
+   }
+
+   T* array = static_cast<T*>(memory);
+   for (std::size_t i = 0; i < count; ++i)
+   {
+      new (&array[i]) T();
+   }
+
+   return array;
+}
+
+// Growable array whose elements are allocated from a linear allocator, for per-frame lists whose size isn't known in advance
+// Growing it allocates a larger array and copies the elements into it, and the old array is only reclaimed when the allocator is reset
+// reset must be called after every reset of the allocator. It reserves the largest size that the array reached since the previous reset,
+// so that the array only grows in the frames in which it holds more elements than before
+// If the allocator runs out of memory, the elements that don't fit are dropped (the allocator reports it)
+template<typename T>
+class FrameVector
+{
+public:
+
+   FrameVector();
+   ~FrameVector() = default;
+
+   FrameVector(const FrameVector&) = delete;
+   FrameVector& operator=(const FrameVector&) = delete;
+
+   FrameVector(FrameVector&&) = default;
+   FrameVector& operator=(FrameVector&&) = default;
+
+   void        reset(LinearAllocator& allocator);
+
+   // The elements are cleared, but the array is kept until the allocator is reset
+   void        clear();
+
+   bool        push_back(const T& element);
+   bool        append(const T* elements, std::size_t count);
+
+   // The new elements are left uninitialized, so they must be written before they are read
+   bool        resize(std::size_t size);
+
+   void        swap(FrameVector& rhs);
+
+   T*          data()                             { return mData; }
+   const T*    data() const                       { return mData; }
+   std::size_t size() const                       { return mSize; }
+   bool        empty() const                      { return mSize == 0; }
+   T&          operator[](std::size_t index)       { return mData[index]; }
+   const T&    operator[](std::size_t index) const { return mData[index]; }
+
+   T*          begin()                            { return mData; }
+   const T*    begin() const                      { return mData; }
+   T*          end()                              { return mData + mSize; }
+   const T*    end() const                        { return mData + mSize; }
+
+private:
+
+   bool        reserve(std::size_t capacity);
+
+   // The elements are copied with memcpy and never destroyed
+   static_assert(std::is_trivially_copyable<T>::value, "FrameVector can only store trivially copyable types");
+
+   LinearAllocator* mAllocator;
+   T*               mData;
+   std::size_t      mSize;
+   std::size_t      mCapacity;
+   std::size_t      mPeakSize;
+};
+
+template<typename T>
+FrameVector<T>::FrameVector()
+   : mAllocator(nullptr)
+   , mData(nullptr)
+   , mSize(0)
+   , mCapacity(0)
+   , mPeakSize(0)
+{
+
+}
+
+template<typename T>
+void FrameVector<T>::reset(LinearAllocator& allocator)
+{
+   // The previous array belonged to the previous frame, so it's gone
+   std::size_t capacity = std::max(mPeakSize, mSize);
+
+   mAllocator = &allocator;
+   mData      = nullptr;
+   mSize      = 0;
+   mCapacity  = 0;
+   mPeakSize  = 0;
+
+   reserve(capacity);
+}
+
+template<typename T>
+void FrameVector<T>::clear()
+{
+   mPeakSize = std::max(mPeakSize, mSize);
+   mSize     = 0;
+}
+
+template<typename T>
+bool FrameVector<T>::push_back(const T& element)
+{
+   return append(&element, 1);
+}
+
+template<typename T>
+bool FrameVector<T>::append(const T* elements, std::size_t count)
+{
+   if (!resize(mSize + count))
+   {
+      return false;
+   }
+
+   if (count != 0)
+   {
+      std::memcpy(mData + mSize - count, elements, sizeof(T) * count);
+   }
+
+   return true;
+}
+
+template<typename T>
+bool FrameVector<T>::resize(std::size_t size)
+{
+   if (size > mCapacity && !reserve(std::max(size, std::max<std::size_t>(mCapacity * 2, 16))))
+   {
+      return false;
+   }
+
+   mSize = size;
+   return true;
+}
+
+template<typename T>
+void FrameVector<T>::swap(FrameVector& rhs)
+{
+   std::swap(mAllocator, rhs.mAllocator);
+   std::swap(mData,      rhs.mData);
+   std::swap(mSize,      rhs.mSize);
+   std::swap(mCapacity,  rhs.mCapacity);
+   std::swap(mPeakSize,  rhs.mPeakSize);
+}
+
+template<typename T>
+bool FrameVector<T>::reserve(std::size_t capacity)
+{
+   if (capacity <= mCapacity)
+   {
+      return true;
+   }
+
+   if (!mAllocator)
+   {
+      return false;
+   }
+
+   T* data = static_cast<T*>(mAllocator->allocate(sizeof(T) * capacity, alignof(T)));
+   if (!data)
+   {
+      return false;
+   }
+
+   if (mSize != 0)
+   {
+      std::memcpy(data, mData, sizeof(T) * mSize);
+   }
+
+   mData     = data;
+   mCapacity = capacity;
+   return true;
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file
+// The OS loads the pages of the file when they are first accessed, and they are shared with its file cache, so reading a mapped file doesn't copy it into a buffer first
+class MappedFile
+{
+public:
+
+   MappedFile();
+   ~MappedFile();
+
+   MappedFile(const MappedFile&) = delete;
+   MappedFile& operator=(const MappedFile&) = delete;
+
+   MappedFile(MappedFile&& rhs) noexcept;
+   MappedFile& operator=(MappedFile&& rhs) noexcept;
+
+   // Returns false without printing anything if the file can't be opened (e.g. because it doesn't exist),
+   // so that callers can treat a missing file as a cache miss
+   bool                 open(const std::string& filePath);
+   void                 close();
+
+   bool                 isOpen() const;
+   const unsigned char* getData() const;
+   std::size_t          getSize() const;
+
+private:
+
+   const unsigned char* mData;
+   std::size_t          mSize;
+};
+
+#endif
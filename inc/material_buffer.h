@@ -0,0 +1,48 @@
+#ifndef MATERIAL_BUFFER_H
+#define MATERIAL_BUFFER_H
+
+#include <bitset>
+#include <vector>
+
+#include "mesh.h"
+#include "uniform_buffer.h"
+#include "uniform_blocks.h"
+
+// A material buffer stores the constants of all the materials of all the models in a single uniform buffer
+// Materials are added once when the models are loaded, and each draw selects its material by setting a single index
+// Each slot of the buffer counts its references, and it can be reused by another material once they have all been released
+class MaterialBuffer
+{
+public:
+
+   MaterialBuffer();
+   ~MaterialBuffer() = default;
+
+   MaterialBuffer(const MaterialBuffer&) = delete;
+   MaterialBuffer& operator=(const MaterialBuffer&) = delete;
+
+   MaterialBuffer(MaterialBuffer&&) = default;
+   MaterialBuffer& operator=(MaterialBuffer&&) = default;
+
+   // Adds a reference to the slot of the material and returns its index, which must be released with releaseMaterial once it's no longer used
+   // Identical materials share the same slot
+   // Returns false if every slot is referenced by another material
+   bool         addMaterial(const MaterialConstants&                                            materialConstants,
+                            std::bitset<static_cast<unsigned int>(MaterialTextureTypes::count)> materialTextureAvailabilities,
+                            unsigned int&                                                       materialIndex);
+
+   // Adds another reference to the slot of a material that is already referenced
+   void         retainMaterial(unsigned int materialIndex);
+   void         releaseMaterial(unsigned int materialIndex);
+
+   // Number of slots that are referenced
+   unsigned int getNumOfMaterials() const;
+
+private:
+
+   UniformBuffer                mUniformBuffer;
+   std::vector<MaterialUniform> mMaterials;
+   std::vector<unsigned int>    mNumOfReferences;
+};
+
+#endif
@@ -2,21 +2,27 @@
 #define MESH_H
 
 #include <assimp/scene.h>
+#include <glm/gtc/packing.hpp>
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <bitset>
 
 #include "shader.h"
 #include "texture.h"
+#include "quat.h"
+
+class GeometryArena;
+class MaterialBuffer;
 
 struct Vertex
 {
    Vertex(const glm::vec3& position,
-          const glm::vec3& normal,
+          const quat&      tangentFrame,
           const glm::vec2& texCoords)
       : position(position)
-      , normal(normal)
+      , tangentFrame(tangentFrame)
       , texCoords(texCoords)
    {
 
@@ -29,7 +35,7 @@ struct Vertex
 
    Vertex(Vertex&& rhs) noexcept
       : position(std::exchange(rhs.position, glm::vec3(0.0f)))
-      , normal(std::exchange(rhs.normal, glm::vec3(0.0f)))
+      , tangentFrame(std::exchange(rhs.tangentFrame, quat()))
       , texCoords(std::exchange(rhs.texCoords, glm::vec2(0.0f)))
    {
 
@@ -37,17 +43,126 @@ struct Vertex
 
    Vertex& operator=(Vertex&& rhs) noexcept
    {
-      position  = std::exchange(rhs.position, glm::vec3(0.0f));
-      normal    = std::exchange(rhs.normal, glm::vec3(0.0f));
-      texCoords = std::exchange(rhs.texCoords, glm::vec2(0.0f));
+      position     = std::exchange(rhs.position, glm::vec3(0.0f));
+      tangentFrame = std::exchange(rhs.tangentFrame, quat());
+      texCoords    = std::exchange(rhs.texCoords, glm::vec2(0.0f));
       return *this;
    }
 
    glm::vec3 position;
-   glm::vec3 normal;
+   quat      tangentFrame; // QTangent (see qtangent.h), which takes 16 bytes instead of the 36 of a tangent, a bitangent and a normal
    glm::vec2 texCoords;
 };
 
+// Bounding cube that the positions of a model are quantized to when its meshes are stored with the compact vertex format
+// The default cube leaves the positions untouched, which is what the standard vertex format uses
+struct PositionQuantization
+{
+   PositionQuantization()
+      : center(0.0f)
+      , halfExtent(1.0f)
+   {
+
+   }
+
+   PositionQuantization(const glm::vec3& center, float halfExtent)
+      : center(center)
+      , halfExtent(halfExtent)
+   {
+
+   }
+
+   ~PositionQuantization() = default;
+
+   PositionQuantization(const PositionQuantization&) = default;
+   PositionQuantization& operator=(const PositionQuantization&) = default;
+
+   PositionQuantization(PositionQuantization&&) = default;
+   PositionQuantization& operator=(PositionQuantization&&) = default;
+
+   glm::vec3 center;
+   float     halfExtent; // Half the length of the sides of the cube
+};
+
+enum class VertexFormat : unsigned int
+{
+   standard = 0, // Vertex (36 bytes) and 32-bit indices
+   compact  = 1, // CompactVertex (20 bytes) and 16-bit indices for the meshes that have at most 65536 vertices
+   count    = 2
+};
+
+// Compact version of Vertex, which is what the vertices of the meshes are converted to when they are stored with the compact vertex format
+// The positions are quantized to the bounding cube of their model, whose dequantization is folded into the instance transforms (see Model::applyPositionQuantization),
+// so the vertex shader reads both formats without knowing which one it's reading
+struct CompactVertex
+{
+   CompactVertex(const Vertex& vertex, const PositionQuantization& positionQuantization)
+      : position(toSnorm16(glm::vec4((vertex.position - positionQuantization.center) / positionQuantization.halfExtent, 0.0f)))
+      , tangentFrame(toSnorm16(glm::vec4(vertex.tangentFrame.x, vertex.tangentFrame.y, vertex.tangentFrame.z, vertex.tangentFrame.w)))
+      , texCoords(glm::packHalf2x16(vertex.texCoords))
+   {
+
+   }
+
+   ~CompactVertex() = default;
+
+   CompactVertex(const CompactVertex&) = default;
+   CompactVertex& operator=(const CompactVertex&) = default;
+
+   CompactVertex(CompactVertex&&) = default;
+   CompactVertex& operator=(CompactVertex&&) = default;
+
+   glm::i16vec4  position;     // 4 x 16-bit snorm, xyz = Position in the bounding cube of the model, w = Padding
+   glm::i16vec4  tangentFrame; // 4 x 16-bit snorm, QTangent (see qtangent.h)
+   std::uint32_t texCoords;    // 2 x half float
+
+private:
+
+   static glm::i16vec4 toSnorm16(const glm::vec4& v)
+   {
+      return glm::i16vec4(glm::round(glm::clamp(v, -1.0f, 1.0f) * 32767.0f));
+   }
+};
+
+static_assert(sizeof(CompactVertex) == 20, "CompactVertex must be tightly packed, since it's uploaded as is to the vertex buffers");
+
+// Per instance transform, which is expanded into a model matrix in the vertex shader
+// It takes half the space of a mat4 (32 bytes instead of 64), and it doesn't need to be built on the CPU
+struct InstanceTransform
+{
+   InstanceTransform(const glm::vec3& position,
+                     float            scalingFactor,
+                     const quat&      rotation)
+      : positionAndScale(position, scalingFactor)
+      , rotation(rotation)
+   {
+
+   }
+
+   ~InstanceTransform() = default;
+
+   InstanceTransform(const InstanceTransform&) = default;
+   InstanceTransform& operator=(const InstanceTransform&) = default;
+
+   InstanceTransform(InstanceTransform&&) = default;
+   InstanceTransform& operator=(InstanceTransform&&) = default;
+
+   glm::vec4 positionAndScale; // xyz = Position, w = Uniform scaling factor
+   quat      rotation;
+};
+
+static_assert(sizeof(InstanceTransform) == 32, "InstanceTransform must be tightly packed, since it's uploaded as is to the instance buffers");
+
+// Has the same layout as the commands that glMultiDrawElementsIndirect reads, so that a list of them could be uploaded as is to a GL_DRAW_INDIRECT_BUFFER
+struct DrawElementsIndirectCommand
+{
+   unsigned int count;         // Number of indices
+   unsigned int instanceCount;
+   unsigned int firstIndex;    // Offset of the first index in the index buffer, in indices
+   int          baseVertex;    // Offset that is added to each index, in vertices
+   unsigned int baseInstance;  // Offset of the first instance in the instance buffer, in instances
+};
+
 struct MaterialTexture
 {
    MaterialTexture(const std::shared_ptr<Texture>& texture, const std::string& uniformName)
@@ -130,10 +245,12 @@ struct Material
 {
    Material(const std::vector<MaterialTexture>&                                 materialTextures,
             std::bitset<static_cast<unsigned int>(MaterialTextureTypes::count)> materialTextureAvailabilities,
-            const MaterialConstants&                                            materialConstants)
+            const MaterialConstants&                                            materialConstants,
+            unsigned int                                                        materialIndex)
       : textures(materialTextures)
       , textureAvailabilities(materialTextureAvailabilities)
       , constants(materialConstants)
+      , index(materialIndex)
    {
 
    }
@@ -147,6 +264,7 @@ struct Material
       : textures(std::move(rhs.textures))
       , textureAvailabilities(std::exchange(rhs.textureAvailabilities, std::bitset<static_cast<unsigned int>(MaterialTextureTypes::count)>())) // TODO: Investigate what happens when you move a std::bitset
       , constants(std::move(rhs.constants))
+      , index(std::exchange(rhs.index, 0))
    {
 
    }
@@ -156,21 +274,27 @@ struct Material
       textures              = std::move(rhs.textures);
       textureAvailabilities = std::exchange(rhs.textureAvailabilities, std::bitset<static_cast<unsigned int>(MaterialTextureTypes::count)>()); // TODO: Investigate what happens when you move a std::bitset
       constants             = std::move(rhs.constants);
+      index                 = std::exchange(rhs.index, 0);
       return *this;
    }
 
    std::vector<MaterialTexture>                                        textures;
    std::bitset<static_cast<unsigned int>(MaterialTextureTypes::count)> textureAvailabilities;
    MaterialConstants                                                   constants;
+   unsigned int                                                        index; // Index of the material in the MaterialBuffer
 };
 
 class Mesh
 {
 public:
 
-   Mesh(const std::vector<Vertex>&       vertices,
-        const std::vector<unsigned int>& indices,
-        const Material&                  material);
+   // The vertices and indices must already be allocated in the geometry arena, and the mesh takes ownership of their allocations
+   // The material must already be in the material buffer, and the mesh holds a reference to its slot until it's destroyed
+   Mesh(const std::shared_ptr<GeometryArena>&  geometryArena,
+        unsigned int                           vertexAllocationID,
+        unsigned int                           indexAllocationID,
+        const std::shared_ptr<MaterialBuffer>& materialBuffer,
+        const Material&                        material);
    ~Mesh();
 
    Mesh(const Mesh&) = delete;
@@ -179,21 +303,48 @@ public:
    Mesh(Mesh&& rhs) noexcept;
    Mesh& operator=(Mesh&& rhs) noexcept;
 
-   void render(const Shader& shader) const;
+   // Renders the given number of instances, whose transforms must have been uploaded to the geometry arena starting at the given base instance
+   void                        render(const Shader& shader, unsigned int numOfInstances, unsigned int baseInstance = 0) const;
+
+   // The functions below split render() into its state changes and its draw command, so that a RenderQueue can skip the redundant state changes
+   // and submit the commands of consecutive meshes together
+   void                        bindMaterial(const Shader& shader) const;
+   DrawElementsIndirectCommand getDrawCommand(unsigned int numOfInstances, unsigned int baseInstance) const;
+
+   bool                        hasSameMaterialAs(const Mesh& other) const;
+
+   GeometryArena&              getGeometryArena() const;
+   unsigned int                getGeometryID() const;
+   unsigned int                getIndexType() const; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+   unsigned int                getMaterialIndex() const;
+
+   // The textures of the material are not included, since they are shared and managed by the model
+   ResourceFootprint           getFootprint() const;
 
 private:
 
-   void configureVAO(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+   void                        bindMaterialTextures(const Shader& shader) const;
 
-   void bindMaterialTextures(const Shader& shader) const;
-   void setMaterialTextureAvailabilities(const Shader& shader) const;
-   void setMaterialConstants(const Shader& shader) const;
+   void                        resolveMaterialUniformHandles(const Shader& shader) const;
 
-   unsigned int mNumIndices;
-   Material     mMaterial;
-   unsigned int mVAO;
-   unsigned int mVBO;
-   unsigned int mEBO;
+   // The handles of the material uniforms are resolved the first time the mesh is rendered with a shader,
+   // so that rendering it again with the same shader doesn't do any string work
+   struct MaterialUniformHandles
+   {
+      unsigned int                    shaderProgID;
+      std::vector<UniformHandle<int>> textureSamplers;
+      UniformHandle<int>              materialIndex;
+   };
+
+   // The vertices and indices of the mesh live in the geometry arena, which is shared by all the meshes
+   std::shared_ptr<GeometryArena>  mGeometryArena;
+   unsigned int                    mVertexAllocationID;
+   unsigned int                    mIndexAllocationID;
+
+   // The constants of the material live in the material buffer, which is shared by all the meshes too
+   std::shared_ptr<MaterialBuffer> mMaterialBuffer;
+   Material                        mMaterial;
+   mutable MaterialUniformHandles  mMaterialUniformHandles;
 };
 
 #endif
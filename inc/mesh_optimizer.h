@@ -0,0 +1,63 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <array>
+#include <vector>
+
+#include "mesh.h"
+
+// The mesh optimizer reorders the vertices and indices of a triangle mesh so that the GPU does less work to render it
+// It only works on the CPU copies of the data, so it doesn't need an OpenGL context
+
+// Results of simulating a FIFO post-transform vertex cache on an index buffer
+struct VertexCacheStatistics
+{
+   float acmr; // Average cache miss ratio, which is the number of transformed vertices per triangle (3 is the worst, ~0.5 is the best for large regular meshes)
+   float atvr; // Average transformed vertex ratio, which is the number of transformed vertices per vertex (1 is the best)
+};
+
+enum class MeshOptimizationStage : unsigned int
+{
+   welding     = 0, // Merges the vertices that are identical
+   vertexCache = 1, // Reorders the triangles so that their vertices are reused while they are in the post-transform cache
+   overdraw    = 2, // Reorders clusters of triangles so that the ones that face outwards are drawn first, without undoing the previous stage
+   vertexFetch = 3, // Reorders the vertices in the order in which they are first used, and drops the ones that are not used
+   count       = 4
+};
+
+struct MeshOptimizationStageReport
+{
+   unsigned int          numOfVerticesBefore;
+   unsigned int          numOfVerticesAfter;
+   VertexCacheStatistics before;
+   VertexCacheStatistics after;
+   double                timeInMs;
+};
+
+struct MeshOptimizationReport
+{
+   std::array<MeshOptimizationStageReport, static_cast<unsigned int>(MeshOptimizationStage::count)> stages;
+};
+
+// Size of the FIFO cache that the statistics are calculated with, which is a conservative estimate of the caches of current GPUs
+const unsigned int vertexCacheSizeForStatistics = 16;
+
+VertexCacheStatistics analyzeVertexCache(const std::vector<unsigned int>& indices, unsigned int numOfVertices, unsigned int cacheSize = vertexCacheSizeForStatistics);
+
+void                  weldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+// Tom Forsyth's linear-speed vertex cache optimization, which scores the vertices by their position in a simulated LRU cache and by their number of remaining triangles
+void                  optimizeVertexCache(std::vector<unsigned int>& indices, unsigned int numOfVertices);
+
+// Sander et al.'s overdraw optimization, which splits the triangles into clusters where the vertex cache is (or could be) flushed,
+// and sorts the clusters so that the ones that face away from the center of the mesh are drawn first
+// The threshold is how much worse than the ACMR of the input the ACMR of the output is allowed to get (e.g. 1.05 allows it to get 5% worse)
+void                  optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, float threshold = 1.05f);
+
+void                  optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+// Runs all the stages in the order in which they are declared in MeshOptimizationStage
+// If a report is given, the statistics and the time of each stage are written to it
+void                  optimizeMesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, MeshOptimizationReport* report = nullptr);
+
+#endif
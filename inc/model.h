@@ -3,26 +3,42 @@
 
 #include "shader.h"
 #include "mesh.h"
-#include "resource_manager.h"
+#include "resource_footprint.h"
 
 class Model
 {
 public:
 
-   Model(std::vector<Mesh>&& meshes, ResourceManager<Texture>&& texManager);
+   // The position quantization is the one that the vertices of the meshes were stored with
+   // The textures of the materials of the meshes are shared with the other models through the texture cache (see TextureCache)
+   Model(std::vector<Mesh>&& meshes, const PositionQuantization& positionQuantization);
+   ~Model() = default;
 
    Model(const Model&) = delete;
    Model& operator=(const Model&) = delete;
 
-   Model(Model&& rhs) = default;
-   Model& operator=(Model&& rhs) = default;
+   Model(Model&& rhs) noexcept;
+   Model& operator=(Model&& rhs) noexcept;
 
-   void render(const Shader& shader) const;
+   void              render(const Shader& shader, const InstanceTransform* instanceTransforms, unsigned int numOfInstances) const;
+
+   // Folds the dequantization of the positions of the meshes into the given instance transform, which must be done before it's uploaded
+   void              applyPositionQuantization(InstanceTransform& instanceTransform) const;
+
+   unsigned int      getNumOfMeshes() const;
+   const Mesh&       getMesh(unsigned int index) const;
+
+   // Includes the meshes of the model, but not its textures, which are shared and accounted for by the texture cache
+   ResourceFootprint getFootprint() const;
 
 private:
 
-   std::vector<Mesh>        mMeshes;
-   ResourceManager<Texture> mTexManager;
+   std::vector<Mesh>                      mMeshes;
+   PositionQuantization                   mPositionQuantization;
+
+   // The instance transforms that render() applies the position quantization to
+   // It's cleared but not freed, so after the first few frames rendering doesn't allocate
+   mutable std::vector<InstanceTransform> mQuantizedInstanceTransforms;
 };
 
 #endif
@@ -1,10 +1,29 @@
 #ifndef MODEL_LOADER_H
 #define MODEL_LOADER_H
 
+#include <array>
+#include <functional>
 #include <unordered_map>
 
 #include "model.h"
-#include "resource_manager.h"
+#include "baked_model.h"
+#include "geometry_arena.h"
+#include "material_buffer.h"
+#include "mesh_optimizer.h"
+#include "string_id.h"
+#include "texture_cache.h"
+#include "texture_loader.h"
+
+// Texture of a model that was either found in the texture cache or decoded on a worker thread, and that is waiting for the model to be uploaded
+// The decoded texture can be shared with the models that were loaded at the same time (see TextureCache::decodeTexture)
+// A texture that could neither be found nor decoded has neither a cached texture nor a decoded texture
+struct PreparedTexture
+{
+   StringID                              key;
+   std::shared_ptr<Texture>              cachedTexture;
+   std::shared_ptr<const DecodedTexture> decodedTexture;
+   double                                decodeTimeInSec;
+};
 
 class ModelLoader
 {
@@ -19,23 +38,95 @@ public:
    ModelLoader(ModelLoader&&) = default;
    ModelLoader& operator=(ModelLoader&&) = default;
 
-   std::shared_ptr<Model>    loadResource(const std::string& modelFilePath) const;
+   // The constants of the materials of the model are added to the given material buffer, its textures to the given texture cache, and its vertices and indices to the given geometry arena
+   // The meshes of the model give their materials and their vertices and indices back when they are destroyed (e.g. when the model is evicted)
+   // The textures that are already in the texture cache are neither decoded nor uploaded again
+   // The vertices are converted to the vertex format of the geometry arena
+   // The first time a model is loaded, it's baked next to the model file (see baked_model.h), and the next times the baked model is loaded instead,
+   // for as long as the model file, the import flags and the vertex format stay the same
+   // Importing a model is spread over worker threads, and only the upload of the meshes and the textures runs on the calling thread, which must have the OpenGL context
+   std::shared_ptr<Model>    loadResource(const std::string&                     modelFilePath,
+                                          const std::shared_ptr<MaterialBuffer>& materialBuffer,
+                                          TextureCache&                          textureCache,
+                                          const std::shared_ptr<GeometryArena>&  geometryArena) const;
 
-private:
+   // Imports or maps the model and decodes its textures without an OpenGL context, and returns the function that uploads them (see ResourceManager::loadResourceAsync)
+   std::function<std::shared_ptr<Model>()> prepareResource(const std::string&                     modelFilePath,
+                                                           const std::shared_ptr<MaterialBuffer>& materialBuffer,
+                                                           TextureCache&                          textureCache,
+                                                           const std::shared_ptr<GeometryArena>&  geometryArena) const;
 
-   void                      processNodeHierarchyRecursively(const aiNode*             node,
-                                                             const aiScene*            scene,
-                                                             const std::string&        modelDir,
-                                                             ResourceManager<Texture>& texManager,
-                                                             std::vector<Mesh>&        meshes) const;
+   // Imports a model and processes it into the format of a geometry arena with the given vertex format, which doesn't need an OpenGL context
+   // Models are imported with Assimp, unless USE_NATIVE_OBJ_PARSER is defined, in which case OBJ files are imported with the OBJ parser (see obj_parser.h),
+   // and only the other files, as well as the OBJ files that the OBJ parser doesn't support, are imported with Assimp
+   // The OBJ parser is experimental: it stays opt-in, and Assimp stays the default, until --verify-obj-parser has confirmed that it matches Assimp byte for byte on the models of the game
+   // The meshes and the materials are processed in parallel on up to numOfThreads threads (see parallel_for.h), and a numOfThreads of 0 uses one thread per hardware thread
+   // If reports are given, they are resized to the number of meshes, and the optimization of each mesh is reported to the report with its index (see optimizeMesh)
+   bool                      importModel(const std::string&                   modelFilePath,
+                                         VertexFormat                         vertexFormat,
+                                         ImportedModel&                       importedModel,
+                                         unsigned int                         numOfThreads            = 0,
+                                         std::vector<MeshOptimizationReport>* meshOptimizationReports = nullptr) const;
 
+   // Both importers produce the same meshes and materials, and they can be called directly to compare them (e.g. by the benchmarks)
+   bool                      importModelWithAssimp(const std::string&                   modelFilePath,
+                                                   VertexFormat                         vertexFormat,
+                                                   ImportedModel&                       importedModel,
+                                                   unsigned int                         numOfThreads            = 0,
+                                                   std::vector<MeshOptimizationReport>* meshOptimizationReports = nullptr) const;
+   bool                      importObjModel(const std::string&                   modelFilePath,
+                                            VertexFormat                         vertexFormat,
+                                            ImportedModel&                       importedModel,
+                                            unsigned int                         numOfThreads            = 0,
+                                            std::vector<MeshOptimizationReport>* meshOptimizationReports = nullptr) const;
+
+   // Returns false if the model file can't be read
+   bool                      calculateBakedModelKey(const std::string& modelFilePath, VertexFormat vertexFormat, BakedModelKey& key) const;
+   std::string               getBakedModelFilePath(const std::string& modelFilePath) const;
+
+   // The vertices and indices of a mesh can be processed without an OpenGL context (e.g. by the benchmarks)
    std::vector<Vertex>       processVertices(const aiMesh* mesh) const;
 
    std::vector<unsigned int> processIndices(const aiMesh* mesh) const;
 
-   Material                  processMaterial(const aiMaterial*         material,
-                                             const std::string&        modelDir,
-                                             ResourceManager<Texture>& texManager) const;
+private:
+
+   // Prepared textures of a model by color space and filename, since an image that is used in both color spaces becomes two different textures
+   using PreparedTextures = std::array<std::unordered_map<std::string, PreparedTexture>, static_cast<unsigned int>(TextureColorSpace::count)>;
+
+   // Uploads the vertices and indices of the meshes to the geometry arena, and loads the textures and constants of the materials that they use
+   // Returns nullptr if the material buffer doesn't have enough free slots for the materials
+   std::shared_ptr<Model>    createModel(const std::vector<MeshDataView>&        meshViews,
+                                         const std::vector<MaterialDescription>& materialDescriptions,
+                                         const PositionQuantization&             positionQuantization,
+                                         const PreparedTextures&                 preparedTextures,
+                                         const std::shared_ptr<MaterialBuffer>&  materialBuffer,
+                                         TextureCache&                           textureCache,
+                                         const std::shared_ptr<GeometryArena>&   geometryArena) const;
+
+   // Collects the meshes of the nodes in depth-first order, which is the order in which they are stored in the model
+   void                      flattenNodeHierarchyRecursively(const aiNode*               node,
+                                                             const aiScene*              scene,
+                                                             std::vector<const aiMesh*>& meshes) const;
+
+   // Welds and reorders the vertices and the triangles of a mesh, and converts them to the given vertex format
+   ImportedMesh              processMesh(std::vector<Vertex>&        vertices,
+                                         std::vector<unsigned int>&  indices,
+                                         unsigned int                materialIndex,
+                                         VertexFormat                vertexFormat,
+                                         const PositionQuantization& positionQuantization,
+                                         MeshOptimizationReport*     meshOptimizationReport) const;
+
+   // Calculates the bounding cube of all the meshes of the scene, which is what the positions are quantized to with the compact vertex format
+   PositionQuantization      calculatePositionQuantization(const aiScene* scene) const;
+   PositionQuantization      calculatePositionQuantization(const glm::vec3& minPos, const glm::vec3& maxPos) const;
+
+   MaterialDescription       processMaterial(const aiMaterial* material) const;
+
+   // Loads the textures of the material, which still has to be added to the material buffer
+   Material                  createMaterial(const MaterialDescription& materialDescription,
+                                            const PreparedTextures&    preparedTextures,
+                                            TextureCache&              textureCache) const;
 };
 
 #endif
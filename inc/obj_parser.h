@@ -0,0 +1,40 @@
+#ifndef OBJ_PARSER_H
+#define OBJ_PARSER_H
+
+#include <string>
+#include <vector>
+
+#include "baked_model.h"
+#include "mesh.h"
+
+// The OBJ parser reads the OBJ and MTL files of a model without Assimp, and produces the meshes and materials that Assimp produces
+// when it imports them with the flags of ModelLoader (aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace)
+// The OBJ file is memory-mapped and split into chunks of whole lines that are parsed in parallel, and the chunks are merged in order afterwards
+// The triangulation and the tangents of the meshes are then calculated in parallel too
+// It's experimental, and ModelLoader only uses it when USE_NATIVE_OBJ_PARSER is defined (see ModelLoader::importModel)
+
+// The vertices are the corners of the faces, like the ones that ModelLoader::processVertices creates, so they still need to be welded
+struct ObjMesh
+{
+   std::vector<Vertex>       vertices;
+   std::vector<unsigned int> indices;
+   unsigned int              materialIndex;
+};
+
+// Like in Assimp, the first material is the default one, and the rest are the ones of the MTL files in the order in which they are defined
+struct ObjModel
+{
+   std::vector<ObjMesh>             meshes;
+   std::vector<MaterialDescription> materials;
+};
+
+// Returns false if the file can't be read, or if it uses a feature that the parser doesn't handle like Assimp does (e.g. polygons with more than 4 vertices),
+// in which case the model should be imported with Assimp instead
+// A numOfThreads of 0 uses one thread per hardware thread
+bool parseObjModel(const std::string& modelFilePath, ObjModel& objModel, unsigned int numOfThreads = 0);
+
+// Appends the paths of the MTL files that the OBJ file references, resolved like parseObjModel resolves them, in the order in which they are referenced
+// Returns false if the OBJ file can't be read
+bool findObjMaterialLibraries(const std::string& modelFilePath, std::vector<std::string>& mtlFilePaths);
+
+#endif
@@ -0,0 +1,255 @@
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <climits>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// A handle identifies an object that lives in an ObjectPool
+// The generation is incremented every time a slot is reused, which lets the pool detect handles that refer to destroyed objects
+template<typename T>
+struct Handle
+{
+   Handle()
+      : index(UINT_MAX)
+      , generation(0)
+   {
+
+   }
+
+   Handle(unsigned int index, unsigned int generation)
+      : index(index)
+      , generation(generation)
+   {
+
+   }
+
+   ~Handle() = default;
+
+   Handle(const Handle&) = default;
+   Handle& operator=(const Handle&) = default;
+
+   Handle(Handle&&) = default;
+   Handle& operator=(Handle&&) = default;
+
+   bool operator==(const Handle& rhs) const { return (index == rhs.index) && (generation == rhs.generation); }
+   bool operator!=(const Handle& rhs) const { return !(*this == rhs); }
+
+   unsigned int index;
+   unsigned int generation;
+};
+
+// An object pool stores objects of the same type in blocks of slots that are allocated once and never moved
+// Destroyed objects leave their slots in a free list so that the next object that is created can reuse them without touching the heap
+// Debug lines are not pooled, since they are not objects that live across frames (see DebugRenderer)
+template<typename T>
+class ObjectPool
+{
+public:
+
+   explicit ObjectPool(unsigned int numOfSlotsPerBlock = 1024);
+   ~ObjectPool();
+
+   ObjectPool(const ObjectPool&) = delete;
+   ObjectPool& operator=(const ObjectPool&) = delete;
+
+   ObjectPool(ObjectPool&&) = delete;
+   ObjectPool& operator=(ObjectPool&&) = delete;
+
+   template<typename... Args>
+   Handle<T>    create(Args&&... args);
+
+   void         destroy(Handle<T> handle);
+   void         destroyAll();
+
+   T*           get(Handle<T> handle) const;
+
+   bool         contains(Handle<T> handle) const;
+
+   template<typename TFunction>
+   void         forEach(TFunction&& function) const;
+
+   unsigned int getNumOfLiveObjects() const;
+   unsigned int getCapacity() const;
+
+private:
+
+   struct Slot
+   {
+      alignas(T) unsigned char storage[sizeof(T)];
+      unsigned int             generation;
+      unsigned int             nextFreeSlot;
+      bool                     isAlive;
+   };
+
+   Slot&        getSlot(unsigned int index) const;
+   T*           getObject(Slot& slot) const;
+   void         addBlock();
+
+   std::vector<std::unique_ptr<Slot[]>> mBlocks;
+   unsigned int                         mNumOfSlotsPerBlock;
+   unsigned int                         mNumOfSlots;
+   unsigned int                         mFirstFreeSlot;
+   unsigned int                         mNumOfLiveObjects;
+};
+
+template<typename T>
+ObjectPool<T>::ObjectPool(unsigned int numOfSlotsPerBlock)
+   : mBlocks()
+   , mNumOfSlotsPerBlock(numOfSlotsPerBlock != 0 ? numOfSlotsPerBlock : 1)
+   , mNumOfSlots(0)
+   , mFirstFreeSlot(UINT_MAX)
+   , mNumOfLiveObjects(0)
+{
+
+}
+
+template<typename T>
+ObjectPool<T>::~ObjectPool()
+{
+   destroyAll();
+}
+
+template<typename T>
+template<typename... Args>
+Handle<T> ObjectPool<T>::create(Args&&... args)
+{
+   if (mFirstFreeSlot == UINT_MAX)
+   {
+      addBlock();
+   }
+
+   unsigned int index = mFirstFreeSlot;
+   Slot&        slot  = getSlot(index);
+
+   new (slot.storage) T(std::forward<Args>(args)...);
+
+   mFirstFreeSlot = slot.nextFreeSlot;
+   slot.isAlive   = true;
+   ++mNumOfLiveObjects;
+
+   return Handle<T>(index, slot.generation);
+}
+
+template<typename T>
+void ObjectPool<T>::destroy(Handle<T> handle)
+{
+   if (!contains(handle))
+   {
+      std::cout << "Error - ObjectPool::destroy - The following handle does not refer to a live object: " << handle.index << " (generation " << handle.generation << ")" << "\n";
+      return;
+   }
+
+   Slot& slot = getSlot(handle.index);
+
+   getObject(slot)->~T();
+
+   // Incrementing the generation invalidates all the handles that refer to this slot
+   // We skip 0 when the generation wraps around, since it's reserved for invalid handles
+   slot.isAlive = false;
+   if (++slot.generation == 0)
+   {
+      slot.generation = 1;
+   }
+
+   slot.nextFreeSlot = mFirstFreeSlot;
+   mFirstFreeSlot    = handle.index;
+   --mNumOfLiveObjects;
+}
+
+template<typename T>
+void ObjectPool<T>::destroyAll()
+{
+   for (unsigned int i = 0; i < mNumOfSlots; ++i)
+   {
+      Slot& slot = getSlot(i);
+      if (slot.isAlive)
+      {
+         destroy(Handle<T>(i, slot.generation));
+      }
+   }
+}
+
+template<typename T>
+T* ObjectPool<T>::get(Handle<T> handle) const
+{
+   if (!contains(handle))
+   {
+      return nullptr;
+   }
+
+   return getObject(getSlot(handle.index));
+}
+
+template<typename T>
+bool ObjectPool<T>::contains(Handle<T> handle) const
+{
+   if (handle.index >= mNumOfSlots)
+   {
+      return false;
+   }
+
+   const Slot& slot = getSlot(handle.index);
+   return slot.isAlive && (slot.generation == handle.generation);
+}
+
+template<typename T>
+template<typename TFunction>
+void ObjectPool<T>::forEach(TFunction&& function) const
+{
+   for (unsigned int i = 0; i < mNumOfSlots; ++i)
+   {
+      Slot& slot = getSlot(i);
+      if (slot.isAlive)
+      {
+         function(*getObject(slot));
+      }
+   }
+}
+
+template<typename T>
+unsigned int ObjectPool<T>::getNumOfLiveObjects() const
+{
+   return mNumOfLiveObjects;
+}
+
+template<typename T>
+unsigned int ObjectPool<T>::getCapacity() const
+{
+   return mNumOfSlots;
+}
+
+template<typename T>
+typename ObjectPool<T>::Slot& ObjectPool<T>::getSlot(unsigned int index) const
+{
+   return mBlocks[index / mNumOfSlotsPerBlock][index % mNumOfSlotsPerBlock];
+}
+
+template<typename T>
+T* ObjectPool<T>::getObject(Slot& slot) const
+{
+   return reinterpret_cast<T*>(slot.storage);
+}
+
+template<typename T>
+void ObjectPool<T>::addBlock()
+{
+   mBlocks.emplace_back(new Slot[mNumOfSlotsPerBlock]);
+
+   // Thread the slots of the new block into the free list in order, so that objects are created in increasing memory order
+   Slot* block = mBlocks.back().get();
+   for (unsigned int i = 0; i < mNumOfSlotsPerBlock; ++i)
+   {
+      block[i].generation   = 1;
+      block[i].nextFreeSlot = (i + 1 < mNumOfSlotsPerBlock) ? (mNumOfSlots + i + 1) : mFirstFreeSlot;
+      block[i].isAlive      = false;
+   }
+
+   mFirstFreeSlot = mNumOfSlots;
+   mNumOfSlots   += mNumOfSlotsPerBlock;
+}
+
+#endif
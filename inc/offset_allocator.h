@@ -0,0 +1,78 @@
+#ifndef OFFSET_ALLOCATOR_H
+#define OFFSET_ALLOCATOR_H
+
+#include <climits>
+#include <vector>
+
+// An offset allocator sub-allocates ranges of a buffer whose memory it doesn't own (e.g. a vertex buffer on the GPU)
+// It only deals with offsets and sizes, which are expressed in units of the caller's choosing (e.g. vertices or indices)
+// Allocations are identified by IDs instead of by their offsets, since compacting the buffer moves them
+class OffsetAllocator
+{
+public:
+
+   static const unsigned int invalidAllocation = UINT_MAX;
+
+   // Describes a range of units that needs to be copied when the allocator is compacted
+   struct Move
+   {
+      unsigned int srcOffset;
+      unsigned int dstOffset;
+      unsigned int size;
+   };
+
+   explicit OffsetAllocator(unsigned int capacity);
+   ~OffsetAllocator() = default;
+
+   OffsetAllocator(const OffsetAllocator&) = delete;
+   OffsetAllocator& operator=(const OffsetAllocator&) = delete;
+
+   OffsetAllocator(OffsetAllocator&&) = default;
+   OffsetAllocator& operator=(OffsetAllocator&&) = default;
+
+   // Returns invalidAllocation if there is no free block that is big enough
+   // In that case the caller can compact the allocator or grow it, and try again
+   unsigned int      allocate(unsigned int size);
+   void              free(unsigned int allocationID);
+
+   // Moves all the allocations to the beginning of the range without changing their order, so that all the free units form a single block at the end
+   // The returned moves are sorted by their source offsets, and their destinations are never greater than their sources
+   std::vector<Move> compact();
+
+   void              grow(unsigned int newCapacity);
+
+   unsigned int      getOffset(unsigned int allocationID) const;
+   unsigned int      getSize(unsigned int allocationID) const;
+
+   unsigned int      getCapacity() const;
+   unsigned int      getNumOfFreeUnits() const;
+   unsigned int      getSizeOfLargestFreeBlock() const;
+
+private:
+
+   struct Allocation
+   {
+      unsigned int offset;
+      unsigned int size;
+      bool         isAlive;
+   };
+
+   struct FreeBlock
+   {
+      unsigned int offset;
+      unsigned int size;
+   };
+
+   void              addFreeBlock(unsigned int offset, unsigned int size);
+
+   std::vector<Allocation>   mAllocations;
+   std::vector<unsigned int> mFreeAllocationIDs;
+
+   // Sorted by offset, and adjacent blocks are always merged
+   std::vector<FreeBlock>    mFreeBlocks;
+
+   unsigned int              mCapacity;
+   unsigned int              mNumOfFreeUnits;
+};
+
+#endif
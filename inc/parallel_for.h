@@ -0,0 +1,14 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <functional>
+
+// Returns the number of threads that a numOfThreads of 0 stands for, which is one per hardware thread
+unsigned int getDefaultNumOfThreads();
+
+// Runs the task once for each index from 0 to numOfTasks - 1 on up to numOfThreads threads, one of which is the calling thread, and returns once all the tasks are done
+// Each thread takes the next index that hasn't been taken yet, so tasks of different lengths are spread evenly between the threads
+// The tasks must not touch OpenGL, since only the calling thread can have the context
+void parallelFor(unsigned int numOfTasks, unsigned int numOfThreads, const std::function<void(unsigned int)>& task);
+
+#endif
@@ -4,19 +4,26 @@
 #include <array>
 
 #include "game.h"
-#include "line.h"
+#include "debug_renderer.h"
+#include "instanced_renderer.h"
+#include "render_queue.h"
 
 class PlayState : public State
 {
 public:
 
-   PlayState(const std::shared_ptr<FiniteStateMachine>&     finiteStateMachine,
-             const std::shared_ptr<Window>&                 window,
-             const std::shared_ptr<Camera>&                 camera,
-             const std::shared_ptr<Shader>&                 gameObject3DShader,
-             const std::shared_ptr<Shader>&                 lineShader,
-             const std::shared_ptr<GameObject3D>&           table,
-             const std::shared_ptr<GameObject3D>&           teapot);
+   PlayState(const std::shared_ptr<FiniteStateMachine>&       finiteStateMachine,
+             const std::shared_ptr<Window>&                   window,
+             const std::shared_ptr<Camera>&                   camera,
+             const std::shared_ptr<FramePacer>&               framePacer,
+             const std::shared_ptr<LinearAllocator>&          frameAllocator,
+             const std::shared_ptr<UniformBuffer>&            cameraUniformBuffer,
+             const std::shared_ptr<Shader>&                   gameObject3DShader,
+             const std::shared_ptr<Shader>&                   lineShader,
+             const std::shared_ptr<GeometryArena>&            geometryArena,
+             const std::shared_ptr<ObjectPool<GameObject3D>>& gameObject3DPool,
+             Handle<GameObject3D>                             table,
+             Handle<GameObject3D>                             teapot);
    ~PlayState() = default;
 
    PlayState(const PlayState&) = delete;
@@ -30,6 +37,14 @@ public:
    void update(float deltaTime) override;
    void render() override;
    void exit() override;
+   bool needsRedraw() const override;
+
+   void spawnStressTestTeapots(unsigned int numOfTeapots);
+   void destroyStressTestTeapots();
+
+   // Returns true if objects were spawned since the last call
+   // Spawning them grows the pools and the renderers, so the frames that follow allocate until they fit the new objects
+   bool haveObjectsBeenSpawned();
 
 private:
 
@@ -46,19 +61,32 @@ private:
 
    std::shared_ptr<Camera>                 mCamera;
 
+   std::shared_ptr<FramePacer>             mFramePacer;
+
+   // The render queue and the debug renderer allocate their per-frame arrays from it
+   std::shared_ptr<LinearAllocator>        mFrameAllocator;
+
+   std::shared_ptr<UniformBuffer>          mCameraUniformBuffer;
+
    std::shared_ptr<Shader>                 mGameObject3DShader;
    std::shared_ptr<Shader>                 mLineShader;
 
-   std::shared_ptr<GameObject3D>           mTable;
-   std::shared_ptr<GameObject3D>           mTeapot;
+   std::shared_ptr<GeometryArena>          mGeometryArena;
+
+   std::shared_ptr<ObjectPool<GameObject3D>> mGameObject3DPool;
+
+   Handle<GameObject3D>                    mTable;
+   Handle<GameObject3D>                    mTeapot;
 
-   Line                                    mWorldXAxis;
-   Line                                    mWorldYAxis;
-   Line                                    mWorldZAxis;
+   RenderQueue                             mRenderQueue;
+   DebugRenderer                           mDebugRenderer;
 
-   Line                                    mLocalXAxis;
-   Line                                    mLocalYAxis;
-   Line                                    mLocalZAxis;
+   // Stress test
+   InstancedRenderer                       mInstancedRenderer;
+   std::vector<Handle<GameObject3D>>       mStressTestTeapots;
+   bool                                    mUseInstancing;
+   bool                                    mShowOrientationFrames;
+   bool                                    mHaveObjectsBeenSpawned;
 };
 
 #endif
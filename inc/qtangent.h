@@ -0,0 +1,19 @@
+#ifndef QTANGENT_H
+#define QTANGENT_H
+
+#include <glm/glm.hpp>
+
+#include "quat.h"
+
+// A QTangent stores a tangent frame (tangent, bitangent and normal) as the unit quaternion that rotates the X, Y and Z axes onto it
+// Since a quaternion can only represent rotations, frames whose bitangent is reflected (e.g. because of mirrored UVs) are stored as the negated quaternion,
+// which represents the same rotation, and the reflection is recovered from the sign of w
+// That's why the encoded quaternions never have a w of 0, not even after being quantized to 16-bit snorms
+
+quat encodeQTangent(const glm::vec3& tangent, const glm::vec3& bitangent, const glm::vec3& normal);
+
+// CPU equivalent of the decoding functions of game_object_3D.vs
+// The returned frame is orthonormal, even if the encoded one wasn't
+void decodeQTangent(const quat& qTangent, glm::vec3& tangent, glm::vec3& bitangent, glm::vec3& normal);
+
+#endif
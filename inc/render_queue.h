@@ -0,0 +1,102 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include "game_object_3D.h"
+#include "geometry_arena.h"
+#include "linear_allocator.h"
+
+// Passes are rendered in the order in which they are declared
+enum class RenderPass : unsigned int
+{
+   opaque            = 0,
+   opaqueDoubleSided = 1, // Rendered with face culling disabled
+   count             = 2
+};
+
+// States submit draw packets to a render queue instead of rendering directly
+// Each packet has a 64-bit sort key, and the packets are radix sorted by their keys before they are executed,
+// so that packets that share a pass, a shader, a material and a mesh end up next to each other and their state changes only need to be issued once
+// The draw commands of consecutive packets that share their state are submitted together with a single multi-draw call
+//
+// Sort key layout (from the most to the least significant bits):
+// | Pass (4) | Shader (8) | Material (12) | Mesh (16) | Depth (24) |
+class RenderQueue
+{
+public:
+
+   RenderQueue();
+   ~RenderQueue() = default;
+
+   RenderQueue(const RenderQueue&) = delete;
+   RenderQueue& operator=(const RenderQueue&) = delete;
+
+   RenderQueue(RenderQueue&&) = default;
+   RenderQueue& operator=(RenderQueue&&) = default;
+
+   // Clears the packets of the previous frame
+   // The packets, their sort entries, their instance transforms and the draw commands are allocated from the given per-frame allocator,
+   // so they are only valid until it's reset
+   // The depth of each packet is its distance to the camera, which is quantized in the [0, maxDepth] range
+   void         begin(const glm::vec3& cameraPos, float maxDepth, LinearAllocator& frameAllocator);
+
+   void         submit(RenderPass pass, const Shader& shader, const GameObject3D& gameObject);
+   void         submit(RenderPass pass, const Shader& shader, const Model& model, const InstanceTransform* instanceTransforms, unsigned int numOfInstances);
+
+   // Sorts and executes the packets
+   void         render();
+
+   // Each batch submits the draw commands of consecutive packets that share their state with a single multi-draw,
+   // which the geometry arena emulates with one draw call per command (see GeometryArena::multiDrawElementsIndirect)
+   unsigned int getNumOfBatchesInLastRender() const;
+   unsigned int getNumOfDrawCallsInLastRender() const;
+   unsigned int getNumOfStateChangesInLastRender() const;
+   unsigned int getNumOfStateChangesAvoidedInLastRender() const;
+
+private:
+
+   struct DrawPacket
+   {
+      RenderPass    pass;
+      const Shader* shader;
+      const Model*  model;
+      unsigned int  meshIndex;
+      unsigned int  firstInstance; // Index of the first instance transform of the packet in mInstanceTransforms
+      unsigned int  numOfInstances;
+   };
+
+   struct SortEntry
+   {
+      unsigned long long key;
+      unsigned int       packetIndex;
+   };
+
+   void               addPacket(const DrawPacket& packet, unsigned int materialID, unsigned int meshID, float depth);
+
+   void               radixSort();
+
+   // Walks the packets in the given order, and returns the number of state changes that are needed to execute them
+   // The GL calls are only issued if issueCalls is true, which lets us count the state changes of the unsorted order without rendering it
+   unsigned int       executePackets(const FrameVector<SortEntry>& order, bool issueCalls);
+
+   // Submits the draw commands that were recorded since the last submission
+   void               submitDrawCommands(GeometryArena* geometryArena, unsigned int indexType);
+
+   FrameVector<DrawPacket>                  mPackets;
+   FrameVector<SortEntry>                   mSortEntries;
+   FrameVector<SortEntry>                   mSortScratch;
+   FrameVector<InstanceTransform>           mInstanceTransforms;
+
+   // Command buffer that is built on the CPU while the packets are executed
+   FrameVector<DrawElementsIndirectCommand> mDrawCommands;
+   unsigned int                             mNumOfSubmittedDrawCommands;
+
+   glm::vec3                                mCameraPos;
+   float                                    mMaxDepth;
+
+   unsigned int                             mNumOfBatchesInLastRender;
+   unsigned int                             mNumOfDrawCallsInLastRender;
+   unsigned int                             mNumOfStateChangesInLastRender;
+   unsigned int                             mNumOfStateChangesAvoidedInLastRender;
+};
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef RESOURCE_FOOTPRINT_H
+#define RESOURCE_FOOTPRINT_H
+
+#include <cstddef>
+
+// Memory that a resource takes in RAM and in VRAM
+// Every type of resource that is managed by a ResourceManager must report it through a getFootprint() const function,
+// which the manager calls once when the resource is ready to account for it in its budget
+struct ResourceFootprint
+{
+   ResourceFootprint& operator+=(const ResourceFootprint& rhs)
+   {
+      cpuMemoryInBytes += rhs.cpuMemoryInBytes;
+      gpuMemoryInBytes += rhs.gpuMemoryInBytes;
+      return *this;
+   }
+
+   std::size_t cpuMemoryInBytes;
+   std::size_t gpuMemoryInBytes;
+};
+
+#endif
@@ -1,67 +1,390 @@
 #ifndef RESOURCE_MANAGER_H
 #define RESOURCE_MANAGER_H
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <tuple>
 #include <unordered_map>
 #include <iostream>
 
+#include "gl_upload_queue.h"
+#include "resource_footprint.h"
+#include "string_id.h"
+#include "thread_pool.h"
+
+enum class ResourceStatus : unsigned int
+{
+   loading = 0,
+   ready   = 1,
+   failed  = 2,
+   count   = 3
+};
+
+// Handle to a resource that may still be loading
+// Copies of a handle share the same resource, which they all see once it's ready
+template<typename TResource>
+class ResourceHandle
+{
+public:
+
+   // A default-constructed handle refers to a resource that failed to load
+   ResourceHandle() = default;
+   ResourceHandle(const std::shared_ptr<TResource>& resource);
+   ~ResourceHandle() = default;
+
+   ResourceHandle(const ResourceHandle&) = default;
+   ResourceHandle& operator=(const ResourceHandle&) = default;
+
+   ResourceHandle(ResourceHandle&&) = default;
+   ResourceHandle& operator=(ResourceHandle&&) = default;
+
+   ResourceStatus                    getStatus() const;
+   bool                              isReady() const;
+
+   // Returns a nullptr until the resource is ready
+   const std::shared_ptr<TResource>& get() const;
+
+   // Blocks until the resource is ready or fails to load
+   // The second step of an asynchronous load runs on the context thread, so the context thread must not wait for an asynchronous load
+   void                              wait() const;
+
+private:
+
+   template<typename> friend class ResourceManager;
+
+   struct SharedState
+   {
+      std::atomic<ResourceStatus> status;
+      std::shared_ptr<TResource>  resource;
+      bool                        isAsync;
+
+      // Used by the resource manager to approximate LRU eviction with the CLOCK algorithm
+      // The footprint is only set when the resource is accounted for, and it's protected by the lock of the shard of the resource
+      std::atomic<bool>           isReferenced;
+      ResourceFootprint           footprint;
+
+      // Only used to wake up the threads that wait for the load to finish
+      std::mutex                  mutex;
+      std::condition_variable     loadFinished;
+   };
+
+   // Creates a handle to a resource that is about to be loaded
+   static ResourceHandle             createLoadingHandle(bool isAsync);
+
+   // Must be called once by the thread that loads the resource, with a nullptr if the load failed
+   void                              finishLoading(const std::shared_ptr<TResource>& resource) const;
+
+   std::shared_ptr<SharedState> mState;
+};
+
+template<typename TResource>
+ResourceHandle<TResource>::ResourceHandle(const std::shared_ptr<TResource>& resource)
+   : mState(std::make_shared<SharedState>())
+{
+   mState->status   = resource ? ResourceStatus::ready : ResourceStatus::failed;
+   mState->resource     = resource;
+   mState->isAsync      = false;
+   mState->isReferenced = false;
+   mState->footprint    = ResourceFootprint{0, 0};
+}
+
+template<typename TResource>
+ResourceStatus ResourceHandle<TResource>::getStatus() const
+{
+   return mState ? mState->status.load(std::memory_order_acquire) : ResourceStatus::failed;
+}
+
+template<typename TResource>
+bool ResourceHandle<TResource>::isReady() const
+{
+   return getStatus() == ResourceStatus::ready;
+}
+
+template<typename TResource>
+const std::shared_ptr<TResource>& ResourceHandle<TResource>::get() const
+{
+   // The resource is written before the status is released, so it can be read without a lock once the status says that it's ready
+   static const std::shared_ptr<TResource> noResource;
+   return isReady() ? mState->resource : noResource;
+}
+
+template<typename TResource>
+void ResourceHandle<TResource>::wait() const
+{
+   if (getStatus() != ResourceStatus::loading)
+   {
+      return;
+   }
+
+   std::unique_lock<std::mutex> lock(mState->mutex);
+   mState->loadFinished.wait(lock, [this]() { return mState->status.load(std::memory_order_acquire) != ResourceStatus::loading; });
+}
+
+template<typename TResource>
+ResourceHandle<TResource> ResourceHandle<TResource>::createLoadingHandle(bool isAsync)
+{
+   ResourceHandle handle;
+   handle.mState               = std::make_shared<SharedState>();
+   handle.mState->status       = ResourceStatus::loading;
+   handle.mState->isAsync      = isAsync;
+   handle.mState->isReferenced = true;
+   handle.mState->footprint    = ResourceFootprint{0, 0};
+   return handle;
+}
+
+template<typename TResource>
+void ResourceHandle<TResource>::finishLoading(const std::shared_ptr<TResource>& resource) const
+{
+   {
+      std::lock_guard<std::mutex> lock(mState->mutex);
+      mState->resource = resource;
+      mState->status.store(resource ? ResourceStatus::ready : ResourceStatus::failed, std::memory_order_release);
+   }
+
+   mState->loadFinished.notify_all();
+}
+
+// Counters of the lookups of a resource manager since it was created
+struct ResourceCacheStatistics
+{
+   unsigned long long numOfHits;           // Lookups that found a resource that was done loading
+   unsigned long long numOfMisses;         // Lookups that didn't find the resource, which start a load if they come from loadResource or loadResourceAsync
+   unsigned long long numOfInFlightHits;   // Lookups that found a resource that was still loading, and that reused its load instead of starting another one
+   unsigned long long numOfContendedLocks; // Lookups that had to wait for another thread to release the lock of a shard
+   unsigned long long numOfEvictions;      // Resources that were evicted to stay within the memory budget
+};
+
+// The resources are identified by StringIDs, so looking them up only hashes and compares integers
+// The resources are split into shards by the hash of their IDs, and each shard has its own lock, so threads that look up different resources rarely wait for each other
+// Concurrent requests for the same ID are de-duplicated: the first one loads the resource, and the others wait for it (or share its handle, if they are asynchronous)
+// The manager keeps track of the memory taken by the resources that are ready, and it can evict the least recently used ones when it exceeds its budget
 template<typename TResource>
 class ResourceManager
 {
 public:
 
-   ResourceManager() = default;
+   ResourceManager();
    ~ResourceManager() = default;
 
    ResourceManager(const ResourceManager&) = delete;
    ResourceManager& operator=(const ResourceManager&) = delete;
 
+   // A moved-from resource manager can only be destroyed or assigned to
    ResourceManager(ResourceManager&&) = default;
    ResourceManager& operator=(ResourceManager&&) = default;
 
+   // Can be called from any thread, as long as the loader can run on it
+   // If another thread is already loading the resource synchronously, this waits for it and returns its result
+   // If the resource is being loaded asynchronously, this returns a nullptr until it's ready, since waiting for it on the context thread would never end
+   template<typename TResourceLoader, typename... Args>
+   std::shared_ptr<TResource> loadResource(StringID resourceID, Args&&... args);
+
+   // Same as loadResource, but it doesn't warn if the resource is already managed, since it's meant for resources that may have been evicted and that need to be loaded again
+   template<typename TResourceLoader, typename... Args>
+   std::shared_ptr<TResource> getOrLoadResource(StringID resourceID, Args&&... args);
+
+   // Loads the resource in two steps, where the first one runs on a worker thread of the thread pool and the second one runs on the context thread when the upload queue is processed
+   // The loader must implement prepareResource, which runs the first step (e.g. reading and decoding files) and returns a function that runs the second step (e.g. creating the OpenGL objects),
+   // or an empty function if the resource can't be loaded
+   // Like with std::thread, the arguments are copied, so std::ref must be used for the ones that are passed by reference, which must stay alive until the resource is ready
+   // The resource is managed from the start, and its handle reports that it's loading until the second step is done
    template<typename TResourceLoader, typename... Args>
-   std::shared_ptr<TResource> loadResource(const std::string& resourceID, Args&&... args);
+   ResourceHandle<TResource>  loadResourceAsync(StringID resourceID, ThreadPool& threadPool, GLUploadQueue& uploadQueue, Args&&... args);
 
    template<typename TResourceLoader, typename... Args>
    std::shared_ptr<TResource> loadUnmanagedResource(Args&&... args) const;
 
-   std::shared_ptr<TResource> getResource(const std::string& resourceID) const;
+   // Returns a nullptr if the resource is still loading
+   std::shared_ptr<TResource> getResource(StringID resourceID) const;
+   ResourceHandle<TResource>  getResourceHandle(StringID resourceID) const;
+
+   // Same as getResource, but it doesn't print an error if the resource is not managed, since it's meant for caches that check whether a resource was already loaded
+   std::shared_ptr<TResource> findResource(StringID resourceID) const;
+
+   bool                       containsResource(StringID resourceID) const noexcept;
 
-   bool                       containsResource(const std::string& resourceID) const noexcept;
+   // Number of resources whose asynchronous loads haven't finished yet
+   unsigned int               getNumOfLoadingResources() const noexcept;
 
-   void                       stopManagingResource(const std::string& resourceID) noexcept;
+   void                       stopManagingResource(StringID resourceID) noexcept;
    void                       stopManagingAllResources() noexcept;
 
+   // The budget is not enforced while resources are loaded, since the resources must be destroyed on the thread that can destroy them (the context thread for OpenGL resources)
+   // Instead, enforceMemoryBudget evicts resources until the resident footprint fits in the budget again, or until all the resources that can be evicted are gone
+   // Only the resources that are not used outside of the manager can be evicted, since the ones that have live handles or shared_ptrs are pinned by them
+   // By default the budget is unlimited
+   void                       setMemoryBudget(const ResourceFootprint& budget) noexcept;
+   ResourceFootprint          getMemoryBudget() const noexcept;
+   void                       enforceMemoryBudget() noexcept;
+
+   // Memory taken by the managed resources that are ready
+   ResourceFootprint          getResidentFootprint() const noexcept;
+
+   ResourceCacheStatistics    getStatistics() const noexcept;
+
 private:
 
-   std::unordered_map<std::string, std::shared_ptr<TResource>> mResources;
+   // Must match the number of high bits of the hashes that pick a shard (see getShard)
+   static const unsigned int numOfShards = 16;
+
+   template<typename TResourceLoader, typename... Args>
+   std::shared_ptr<TResource> requestResource(StringID resourceID, bool warnIfManaged, Args&&... args);
+
+   using ResourceMap = std::unordered_map<StringID, ResourceHandle<TResource>>;
+
+   struct Shard
+   {
+      std::mutex  mutex;
+      ResourceMap resources;
+
+      // Resource where the clock hand stopped the last time it swept the shard, so that the next sweep continues from it instead of starting over
+      // The sweep starts from the beginning if that resource stopped being managed
+      StringID    clockHandResourceID;
+      bool        hasClockHandResourceID = false;
+   };
+
+   // The shards and the counters can't be moved, so they are allocated once and owned through a pointer, which keeps the resource manager movable
+   // The asynchronous loads share it too, so that they can account for their resources even if they finish after the manager was moved
+   struct Cache
+   {
+      Shard&                         getShard(StringID resourceID);
+
+      // Locks the shard, and counts it if another thread was holding its lock
+      std::unique_lock<std::mutex>   lockShard(Shard& shard);
+
+      void                           countHit(const ResourceHandle<TResource>& handle);
+
+      // Looks up the resource, and inserts a loading handle for it if it isn't managed yet, in which case the caller must load it
+      ResourceHandle<TResource>      findOrInsertLoadingHandle(StringID resourceID, bool isAsync, bool& mustLoad);
+
+      // Accounts for the resource if it's still managed, and wakes up the requests that are waiting for it
+      // A resource that failed to load synchronously stops being managed, so that it can be requested again
+      void                           finishLoading(StringID resourceID, const ResourceHandle<TResource>& handle, const std::shared_ptr<TResource>& resource);
+
+      // The lock of the shard must be held
+      typename ResourceMap::iterator eraseResource(Shard& shard, typename ResourceMap::iterator it);
+
+      bool                           isOverBudget() const;
+      bool                           canEvict(const ResourceHandle<TResource>& handle) const;
+      void                           evictResources();
+
+      std::array<Shard, numOfShards>  shards;
+
+      std::atomic<std::size_t>        residentCPUMemoryInBytes{0};
+      std::atomic<std::size_t>        residentGPUMemoryInBytes{0};
+      std::atomic<std::size_t>        cpuMemoryBudgetInBytes{std::numeric_limits<std::size_t>::max()};
+      std::atomic<std::size_t>        gpuMemoryBudgetInBytes{std::numeric_limits<std::size_t>::max()};
+
+      // Only one thread evicts at a time, and the clock hand is the shard where the next eviction starts (see Shard::clockHandResourceID for where it starts within the shard)
+      std::mutex                      evictionMutex;
+      unsigned int                    clockHand = 0;
+
+      std::atomic<unsigned long long> numOfHits{0};
+      std::atomic<unsigned long long> numOfMisses{0};
+      std::atomic<unsigned long long> numOfInFlightHits{0};
+      std::atomic<unsigned long long> numOfContendedLocks{0};
+      std::atomic<unsigned long long> numOfEvictions{0};
+   };
+
+   std::shared_ptr<Cache> mCache;
 };
 
+template<typename TResource>
+ResourceManager<TResource>::ResourceManager()
+   : mCache(std::make_shared<Cache>())
+{
+
+}
+
 template<typename TResource>
 template<typename TResourceLoader, typename... Args>
-std::shared_ptr<TResource> ResourceManager<TResource>::loadResource(const std::string& resourceID, Args&&... args)
+std::shared_ptr<TResource> ResourceManager<TResource>::loadResource(StringID resourceID, Args&&... args)
 {
-   std::shared_ptr<TResource> resource{};
+   return requestResource<TResourceLoader>(resourceID, true, std::forward<Args>(args)...);
+}
 
-   auto it = mResources.find(resourceID);
-   if (it == mResources.cend())
-   {
-      resource = TResourceLoader{}.loadResource(std::forward<Args>(args)...);
+template<typename TResource>
+template<typename TResourceLoader, typename... Args>
+std::shared_ptr<TResource> ResourceManager<TResource>::getOrLoadResource(StringID resourceID, Args&&... args)
+{
+   return requestResource<TResourceLoader>(resourceID, false, std::forward<Args>(args)...);
+}
+
+template<typename TResource>
+template<typename TResourceLoader, typename... Args>
+std::shared_ptr<TResource> ResourceManager<TResource>::requestResource(StringID resourceID, bool warnIfManaged, Args&&... args)
+{
+   bool                      mustLoad = false;
+   ResourceHandle<TResource> handle   = mCache->findOrInsertLoadingHandle(resourceID, false, mustLoad);
 
-      // We only store the resource if it is not a nullptr
-      // We expect the loaders to print an error message when they are unable to load a resource successfully, which is why we don't print anything here
-      if (resource)
+   if (!mustLoad)
+   {
+      if (warnIfManaged && handle.getStatus() == ResourceStatus::ready)
       {
-         mResources[resourceID] = resource;
+         std::cout << "Warning - ResourceManager::loadResource - A resource with the following ID already exists: " << resourceID.getString() << "\n";
       }
+      else if (!handle.mState->isAsync)
+      {
+         handle.wait();
+      }
+
+      return handle.get();
    }
-   else
+
+   // We only keep managing the resource if it is not a nullptr
+   // We expect the loaders to print an error message when they are unable to load a resource successfully, which is why we don't print anything here
+   std::shared_ptr<TResource> resource = TResourceLoader{}.loadResource(std::forward<Args>(args)...);
+
+   // The requests that were waiting for the resource are woken up even if it failed to load, and they return a nullptr
+   mCache->finishLoading(resourceID, handle, resource);
+   return resource;
+}
+
+template<typename TResource>
+template<typename TResourceLoader, typename... Args>
+ResourceHandle<TResource> ResourceManager<TResource>::loadResourceAsync(StringID resourceID, ThreadPool& threadPool, GLUploadQueue& uploadQueue, Args&&... args)
+{
+   bool                      mustLoad = false;
+   ResourceHandle<TResource> handle   = mCache->findOrInsertLoadingHandle(resourceID, true, mustLoad);
+
+   if (!mustLoad)
    {
-      std::cout << "Warning - ResourceManager::loadResource - A resource with the following ID already exists: " << resourceID << "\n";
-      resource = it->second;
+      if (handle.getStatus() == ResourceStatus::ready)
+      {
+         std::cout << "Warning - ResourceManager::loadResourceAsync - A resource with the following ID already exists: " << resourceID.getString() << "\n";
+      }
+
+      return handle;
    }
 
-   return resource;
+   // Unlike with loadResource, a resource that fails to load stays managed, since the failure is only known after its handle has been returned
+   // We expect the loaders to print an error message when they are unable to load a resource successfully, which is why we don't print anything here
+   auto argsTuple = std::make_tuple(std::forward<Args>(args)...);
+   threadPool.enqueue([cache = mCache, resourceID, handle, argsTuple, &uploadQueue]() mutable
+   {
+      std::function<std::shared_ptr<TResource>()> createResource = std::apply([](auto&... loaderArgs)
+      {
+         return TResourceLoader{}.prepareResource(loaderArgs...);
+      }, argsTuple);
+
+      if (!createResource)
+      {
+         cache->finishLoading(resourceID, handle, nullptr);
+         return;
+      }
+
+      uploadQueue.push([cache, resourceID, handle, createResource]()
+      {
+         cache->finishLoading(resourceID, handle, createResource());
+      });
+   });
+
+   return handle;
 }
 
 template<typename TResource>
@@ -73,44 +396,317 @@ std::shared_ptr<TResource> ResourceManager<TResource>::loadUnmanagedResource(Arg
 }
 
 template<typename TResource>
-std::shared_ptr<TResource> ResourceManager<TResource>::getResource(const std::string& resourceID) const
+std::shared_ptr<TResource> ResourceManager<TResource>::getResource(StringID resourceID) const
 {
-   auto it = mResources.find(resourceID);
-   if (it != mResources.end())
+   return getResourceHandle(resourceID).get();
+}
+
+template<typename TResource>
+ResourceHandle<TResource> ResourceManager<TResource>::getResourceHandle(StringID resourceID) const
+{
+   Shard&                       shard = mCache->getShard(resourceID);
+   std::unique_lock<std::mutex> lock  = mCache->lockShard(shard);
+
+   auto it = shard.resources.find(resourceID);
+   if (it != shard.resources.end())
    {
+      mCache->countHit(it->second);
       return it->second;
    }
    else
    {
-      std::cout << "Error - ResourceManager::getResource - A resource with the following ID does not exist: " << resourceID << "\n";
-      return nullptr;
+      lock.unlock();
+      mCache->numOfMisses.fetch_add(1, std::memory_order_relaxed);
+      std::cout << "Error - ResourceManager::getResourceHandle - A resource with the following ID does not exist: " << resourceID.getString() << "\n";
+      return ResourceHandle<TResource>();
    }
 }
 
 template<typename TResource>
-bool ResourceManager<TResource>::containsResource(const std::string& resourceID) const noexcept
+std::shared_ptr<TResource> ResourceManager<TResource>::findResource(StringID resourceID) const
 {
-   return (mResources.find(resourceID) != mResources.cend());
+   Shard&                       shard = mCache->getShard(resourceID);
+   std::unique_lock<std::mutex> lock  = mCache->lockShard(shard);
+
+   auto it = shard.resources.find(resourceID);
+   if (it != shard.resources.end())
+   {
+      mCache->countHit(it->second);
+      return it->second.get();
+   }
+
+   mCache->numOfMisses.fetch_add(1, std::memory_order_relaxed);
+   return nullptr;
+}
+
+template<typename TResource>
+bool ResourceManager<TResource>::containsResource(StringID resourceID) const noexcept
+{
+   Shard&                       shard = mCache->getShard(resourceID);
+   std::unique_lock<std::mutex> lock  = mCache->lockShard(shard);
+   return (shard.resources.find(resourceID) != shard.resources.cend());
 }
 
 template<typename TResource>
-void ResourceManager<TResource>::stopManagingResource(const std::string& resourceID) noexcept
+unsigned int ResourceManager<TResource>::getNumOfLoadingResources() const noexcept
 {
-   auto it = mResources.find(resourceID);
-   if (it != mResources.end())
+   unsigned int numOfLoadingResources = 0;
+   for (Shard& shard : mCache->shards)
    {
-      mResources.erase(it);
+      std::unique_lock<std::mutex> lock = mCache->lockShard(shard);
+      for (const auto& resource : shard.resources)
+      {
+         if (resource.second.getStatus() == ResourceStatus::loading)
+         {
+            ++numOfLoadingResources;
+         }
+      }
+   }
+
+   return numOfLoadingResources;
+}
+
+template<typename TResource>
+void ResourceManager<TResource>::stopManagingResource(StringID resourceID) noexcept
+{
+   Shard&                       shard = mCache->getShard(resourceID);
+   std::unique_lock<std::mutex> lock  = mCache->lockShard(shard);
+
+   auto it = shard.resources.find(resourceID);
+   if (it != shard.resources.end())
+   {
+      mCache->eraseResource(shard, it);
    }
    else
    {
-      std::cout << "Error - ResourceManager::stopManagingResource - A resource with the following ID does not exist: " << resourceID << "\n";
+      lock.unlock();
+      std::cout << "Error - ResourceManager::stopManagingResource - A resource with the following ID does not exist: " << resourceID.getString() << "\n";
    }
 }
 
 template<typename TResource>
 void ResourceManager<TResource>::stopManagingAllResources() noexcept
 {
-   mResources.clear();
+   for (Shard& shard : mCache->shards)
+   {
+      std::unique_lock<std::mutex> lock = mCache->lockShard(shard);
+      for (auto it = shard.resources.begin(); it != shard.resources.end();)
+      {
+         it = mCache->eraseResource(shard, it);
+      }
+   }
+}
+
+template<typename TResource>
+void ResourceManager<TResource>::setMemoryBudget(const ResourceFootprint& budget) noexcept
+{
+   mCache->cpuMemoryBudgetInBytes.store(budget.cpuMemoryInBytes, std::memory_order_relaxed);
+   mCache->gpuMemoryBudgetInBytes.store(budget.gpuMemoryInBytes, std::memory_order_relaxed);
+}
+
+template<typename TResource>
+ResourceFootprint ResourceManager<TResource>::getMemoryBudget() const noexcept
+{
+   return ResourceFootprint{mCache->cpuMemoryBudgetInBytes.load(std::memory_order_relaxed), mCache->gpuMemoryBudgetInBytes.load(std::memory_order_relaxed)};
+}
+
+template<typename TResource>
+void ResourceManager<TResource>::enforceMemoryBudget() noexcept
+{
+   mCache->evictResources();
+}
+
+template<typename TResource>
+ResourceFootprint ResourceManager<TResource>::getResidentFootprint() const noexcept
+{
+   return ResourceFootprint{mCache->residentCPUMemoryInBytes.load(std::memory_order_relaxed), mCache->residentGPUMemoryInBytes.load(std::memory_order_relaxed)};
+}
+
+template<typename TResource>
+ResourceCacheStatistics ResourceManager<TResource>::getStatistics() const noexcept
+{
+   return ResourceCacheStatistics{mCache->numOfHits.load(std::memory_order_relaxed),
+                                  mCache->numOfMisses.load(std::memory_order_relaxed),
+                                  mCache->numOfInFlightHits.load(std::memory_order_relaxed),
+                                  mCache->numOfContendedLocks.load(std::memory_order_relaxed),
+                                  mCache->numOfEvictions.load(std::memory_order_relaxed)};
+}
+
+template<typename TResource>
+typename ResourceManager<TResource>::Shard& ResourceManager<TResource>::Cache::getShard(StringID resourceID)
+{
+   // The maps of the shards use the low bits of the hashes to pick their buckets, so the shards use the high bits
+   return shards[resourceID.getHash() >> 60];
+}
+
+template<typename TResource>
+std::unique_lock<std::mutex> ResourceManager<TResource>::Cache::lockShard(Shard& shard)
+{
+   std::unique_lock<std::mutex> lock(shard.mutex, std::try_to_lock);
+   if (!lock.owns_lock())
+   {
+      numOfContendedLocks.fetch_add(1, std::memory_order_relaxed);
+      lock.lock();
+   }
+
+   return lock;
+}
+
+template<typename TResource>
+void ResourceManager<TResource>::Cache::countHit(const ResourceHandle<TResource>& handle)
+{
+   if (handle.getStatus() == ResourceStatus::loading)
+   {
+      numOfInFlightHits.fetch_add(1, std::memory_order_relaxed);
+   }
+   else
+   {
+      numOfHits.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   // Gives the resource a second chance the next time the clock hand reaches it
+   handle.mState->isReferenced.store(true, std::memory_order_relaxed);
+}
+
+template<typename TResource>
+ResourceHandle<TResource> ResourceManager<TResource>::Cache::findOrInsertLoadingHandle(StringID resourceID, bool isAsync, bool& mustLoad)
+{
+   Shard&                       shard = getShard(resourceID);
+   std::unique_lock<std::mutex> lock  = lockShard(shard);
+
+   auto it = shard.resources.find(resourceID);
+   if (it != shard.resources.end())
+   {
+      mustLoad = false;
+      countHit(it->second);
+      return it->second;
+   }
+
+   mustLoad = true;
+   numOfMisses.fetch_add(1, std::memory_order_relaxed);
+
+   ResourceHandle<TResource> handle = ResourceHandle<TResource>::createLoadingHandle(isAsync);
+   shard.resources.emplace(resourceID, handle);
+   return handle;
+}
+
+template<typename TResource>
+void ResourceManager<TResource>::Cache::finishLoading(StringID resourceID, const ResourceHandle<TResource>& handle, const std::shared_ptr<TResource>& resource)
+{
+   ResourceFootprint footprint = resource ? resource->getFootprint() : ResourceFootprint{0, 0};
+
+   {
+      Shard&                       shard = getShard(resourceID);
+      std::unique_lock<std::mutex> lock  = lockShard(shard);
+
+      // The resource could have stopped being managed while it was loading, and then loaded again by another request
+      auto it = shard.resources.find(resourceID);
+      if (it != shard.resources.end() && it->second.mState == handle.mState)
+      {
+         if (resource)
+         {
+            handle.mState->footprint = footprint;
+            residentCPUMemoryInBytes.fetch_add(footprint.cpuMemoryInBytes, std::memory_order_relaxed);
+            residentGPUMemoryInBytes.fetch_add(footprint.gpuMemoryInBytes, std::memory_order_relaxed);
+         }
+         else if (!handle.mState->isAsync)
+         {
+            shard.resources.erase(it);
+         }
+      }
+   }
+
+   handle.finishLoading(resource);
+}
+
+template<typename TResource>
+typename ResourceManager<TResource>::ResourceMap::iterator ResourceManager<TResource>::Cache::eraseResource(Shard& shard, typename ResourceMap::iterator it)
+{
+   // Resources that are still loading haven't been accounted for yet, and they won't be once they stop being managed
+   const ResourceFootprint& footprint = it->second.mState->footprint;
+   residentCPUMemoryInBytes.fetch_sub(footprint.cpuMemoryInBytes, std::memory_order_relaxed);
+   residentGPUMemoryInBytes.fetch_sub(footprint.gpuMemoryInBytes, std::memory_order_relaxed);
+   return shard.resources.erase(it);
+}
+
+template<typename TResource>
+bool ResourceManager<TResource>::Cache::isOverBudget() const
+{
+   return residentCPUMemoryInBytes.load(std::memory_order_relaxed) > cpuMemoryBudgetInBytes.load(std::memory_order_relaxed) ||
+          residentGPUMemoryInBytes.load(std::memory_order_relaxed) > gpuMemoryBudgetInBytes.load(std::memory_order_relaxed);
+}
+
+template<typename TResource>
+bool ResourceManager<TResource>::Cache::canEvict(const ResourceHandle<TResource>& handle) const
+{
+   // The handle in the map holds one reference to the state, and the state holds one reference to the resource
+   // Any other reference comes from a user, and new ones can only be made from the map while the lock of the shard is held
+   return handle.getStatus() == ResourceStatus::ready && handle.mState.use_count() == 1 && handle.mState->resource.use_count() == 1;
+}
+
+template<typename TResource>
+void ResourceManager<TResource>::Cache::evictResources()
+{
+   if (!isOverBudget())
+   {
+      return;
+   }
+
+   std::unique_lock<std::mutex> evictionLock(evictionMutex, std::try_to_lock);
+   if (!evictionLock.owns_lock())
+   {
+      // Another thread is already evicting resources
+      return;
+   }
+
+   // The clock hand sweeps the shards, and it evicts the resources that were not looked up since it last passed them
+   // A resource that was looked up gets a second chance, so two sweeps are enough to evict every resource that can be evicted
+   // An eviction that stops in the middle of a shard leaves the clock hand there, so the resources at the beginning of the shard don't get swept more often than the others
+   for (unsigned int i = 0; i < 2 * numOfShards && isOverBudget(); ++i)
+   {
+      Shard&                       shard = shards[clockHand];
+      std::unique_lock<std::mutex> lock  = lockShard(shard);
+
+      auto it = shard.hasClockHandResourceID ? shard.resources.find(shard.clockHandResourceID) : shard.resources.end();
+      if (it == shard.resources.end())
+      {
+         it = shard.resources.begin();
+      }
+
+      // Each resource is visited once per pass, which wraps around to the beginning of the shard
+      std::size_t numOfResourcesToVisit = shard.resources.size();
+      while (numOfResourcesToVisit > 0 && isOverBudget())
+      {
+         if (canEvict(it->second) && !it->second.mState->isReferenced.exchange(false, std::memory_order_relaxed))
+         {
+            it = eraseResource(shard, it);
+            numOfEvictions.fetch_add(1, std::memory_order_relaxed);
+         }
+         else
+         {
+            ++it;
+         }
+
+         if (it == shard.resources.end())
+         {
+            it = shard.resources.begin();
+         }
+
+         --numOfResourcesToVisit;
+      }
+
+      shard.hasClockHandResourceID = !shard.resources.empty();
+      if (shard.hasClockHandResourceID)
+      {
+         shard.clockHandResourceID = it->first;
+      }
+
+      // The clock hand only moves on to the next shard once it has swept this one
+      if (numOfResourcesToVisit == 0)
+      {
+         clockHand = (clockHand + 1) % numOfShards;
+      }
+   }
 }
 
 #endif
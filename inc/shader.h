@@ -5,6 +5,53 @@
 #include <glm/glm.hpp>
 
 #include <string>
+#include <vector>
+
+#include "resource_footprint.h"
+
+// Maps the C++ type of a uniform to the GLSL type that it's allowed to be bound to
+template<typename T>
+struct UniformType;
+
+template<> struct UniformType<bool>      { static const GLenum glType = GL_BOOL; };
+template<> struct UniformType<int>       { static const GLenum glType = GL_INT; };
+template<> struct UniformType<float>     { static const GLenum glType = GL_FLOAT; };
+template<> struct UniformType<glm::vec2> { static const GLenum glType = GL_FLOAT_VEC2; };
+template<> struct UniformType<glm::vec3> { static const GLenum glType = GL_FLOAT_VEC3; };
+template<> struct UniformType<glm::vec4> { static const GLenum glType = GL_FLOAT_VEC4; };
+template<> struct UniformType<glm::mat2> { static const GLenum glType = GL_FLOAT_MAT2; };
+template<> struct UniformType<glm::mat3> { static const GLenum glType = GL_FLOAT_MAT3; };
+template<> struct UniformType<glm::mat4> { static const GLenum glType = GL_FLOAT_MAT4; };
+
+// A uniform handle is resolved once (e.g. when a shader is loaded) and then used to set the uniform without any string work
+// Its type parameter guarantees at compile time that the uniform is always set with the type it was resolved with
+template<typename T>
+struct UniformHandle
+{
+   UniformHandle()
+      : location(-1)
+   {
+
+   }
+
+   explicit UniformHandle(int location)
+      : location(location)
+   {
+
+   }
+
+   ~UniformHandle() = default;
+
+   UniformHandle(const UniformHandle&) = default;
+   UniformHandle& operator=(const UniformHandle&) = default;
+
+   UniformHandle(UniformHandle&&) = default;
+   UniformHandle& operator=(UniformHandle&&) = default;
+
+   bool isValid() const { return location != -1; }
+
+   int location;
+};
 
 class Shader
 {
@@ -23,26 +70,71 @@ public:
 
    unsigned int getID() const;
 
-   void         setBool(const std::string& name, bool value) const;
-   void         setInt(const std::string& name, int value) const;
-   void         setFloat(const std::string& name, float value) const;
+   ResourceFootprint getFootprint() const;
+
+   void         bindUniformBlock(const char* blockName, unsigned int bindingPoint) const;
+
+   void         setBool(const char* name, bool value) const;
+   void         setInt(const char* name, int value) const;
+   void         setFloat(const char* name, float value) const;
 
-   void         setVec2(const std::string& name, const glm::vec2& value) const;
-   void         setVec2(const std::string& name, float x, float y) const;
-   void         setVec3(const std::string& name, const glm::vec3& value) const;
-   void         setVec3(const std::string& name, float x, float y, float z) const;
-   void         setVec4(const std::string& name, const glm::vec4& value) const;
-   void         setVec4(const std::string& name, float x, float y, float z, float w) const;
+   void         setVec2(const char* name, const glm::vec2& value) const;
+   void         setVec2(const char* name, float x, float y) const;
+   void         setVec3(const char* name, const glm::vec3& value) const;
+   void         setVec3(const char* name, float x, float y, float z) const;
+   void         setVec4(const char* name, const glm::vec4& value) const;
+   void         setVec4(const char* name, float x, float y, float z, float w) const;
 
-   void         setMat2(const std::string& name, const glm::mat2& value) const;
-   void         setMat3(const std::string& name, const glm::mat3& value) const;
-   void         setMat4(const std::string& name, const glm::mat4& value) const;
+   void         setMat2(const char* name, const glm::mat2& value) const;
+   void         setMat3(const char* name, const glm::mat3& value) const;
+   void         setMat4(const char* name, const glm::mat4& value) const;
+
+   template<typename T>
+   UniformHandle<T> getUniformHandle(const char* name) const;
+
+   void         setUniform(UniformHandle<bool> handle, bool value) const;
+   void         setUniform(UniformHandle<int> handle, int value) const;
+   void         setUniform(UniformHandle<float> handle, float value) const;
+   void         setUniform(UniformHandle<glm::vec2> handle, const glm::vec2& value) const;
+   void         setUniform(UniformHandle<glm::vec3> handle, const glm::vec3& value) const;
+   void         setUniform(UniformHandle<glm::vec4> handle, const glm::vec4& value) const;
+   void         setUniform(UniformHandle<glm::mat2> handle, const glm::mat2& value) const;
+   void         setUniform(UniformHandle<glm::mat3> handle, const glm::mat3& value) const;
+   void         setUniform(UniformHandle<glm::mat4> handle, const glm::mat4& value) const;
 
 private:
 
-   int          getUniformLocation(const std::string& name) const;
+   struct UniformInfo
+   {
+      std::string  name;
+      unsigned int hash;
+      int          location;
+      GLenum       type;
+   };
+
+   void               reflectActiveUniforms();
+   void               insertUniform(const std::string& name, int location, GLenum type);
+   const UniformInfo* findUniform(const char* name) const;
 
-   unsigned int mShaderProgID;
+   int                getUniformLocation(const char* name) const;
+   int                getUniformLocation(const char* name, GLenum type) const;
+
+   void               reportMissingUniform(const char* name) const;
+
+   unsigned int                     mShaderProgID;
+
+   // Open addressing hash table with linear probing that is filled when the shader is created
+   // Its size is always a power of 2, and empty slots have a location of -1
+   std::vector<UniformInfo>         mUniforms;
+
+   // Names of the uniforms that were requested but don't exist, so that each one is only reported once
+   mutable std::vector<std::string> mMissingUniforms;
 };
 
+template<typename T>
+UniformHandle<T> Shader::getUniformHandle(const char* name) const
+{
+   return UniformHandle<T>(getUniformLocation(name, UniformType<T>::glType));
+}
+
 #endif
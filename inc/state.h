@@ -19,6 +19,10 @@ public:
    virtual void update(float deltaTime) = 0;
    virtual void render() = 0;
    virtual void exit() = 0;
+
+   // Returns true when something in the state changed since the last frame (objects, camera, animations)
+   // Used by the on-demand rendering mode to decide if a frame can be skipped
+   virtual bool needsRedraw() const = 0;
 };
 
 #endif
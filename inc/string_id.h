@@ -0,0 +1,117 @@
+#ifndef STRING_ID_H
+#define STRING_ID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// 64-bit FNV-1a, which can be evaluated at compile time
+constexpr std::uint64_t hashString(const char* str, std::size_t length)
+{
+   std::uint64_t hash = 14695981039346656037ull;
+   for (std::size_t i = 0; i < length; ++i)
+   {
+      hash ^= static_cast<unsigned char>(str[i]);
+      hash *= 1099511628211ull;
+   }
+
+   return hash;
+}
+
+// Identifier that is made out of the hash of a string, so that comparing and hashing it is as cheap as comparing and hashing an integer
+// IDs that are known at compile time should be created with the _sid literal (e.g. "teapot"_sid), which hashes them at compile time,
+// while the ones that are only known at runtime are hashed once when they are converted (e.g. the filename of a texture)
+// In debug builds, each ID also keeps a pointer to its string, and the strings that are converted at runtime are interned in a reverse table,
+// which is used to print the IDs in error messages and to detect hash collisions
+class StringID
+{
+public:
+
+   // The empty ID is the hash of the empty string
+   constexpr StringID()
+      : mHash(hashString("", 0))
+#ifndef NDEBUG
+      , mDebugString("")
+#endif
+   {
+
+   }
+
+   StringID(const char* str);
+   StringID(const std::string& str);
+   ~StringID() = default;
+
+   StringID(const StringID&) = default;
+   StringID& operator=(const StringID&) = default;
+
+   StringID(StringID&&) = default;
+   StringID& operator=(StringID&&) = default;
+
+   // For IDs that are not made out of strings (e.g. the hash of the contents of a file), which are printed as hashes in debug builds too
+   static constexpr StringID fromHash(std::uint64_t hash)
+   {
+      return StringID(hash);
+   }
+
+   constexpr std::uint64_t getHash() const
+   {
+      return mHash;
+   }
+
+   // Returns the string that the ID was created from in debug builds, and its hash in hexadecimal in release builds or if it wasn't created from a string
+   std::string getString() const;
+
+   constexpr bool operator==(const StringID& rhs) const { return mHash == rhs.mHash; }
+   constexpr bool operator!=(const StringID& rhs) const { return mHash != rhs.mHash; }
+   constexpr bool operator<(const StringID& rhs) const { return mHash < rhs.mHash; }
+
+private:
+
+   friend constexpr StringID operator""_sid(const char* str, std::size_t length);
+
+   // The string must outlive the ID, which is the case for string literals
+   constexpr StringID(const char* str, std::size_t length)
+      : mHash(hashString(str, length))
+#ifndef NDEBUG
+      , mDebugString(str)
+#endif
+   {
+
+   }
+
+   constexpr explicit StringID(std::uint64_t hash)
+      : mHash(hash)
+#ifndef NDEBUG
+      , mDebugString(nullptr)
+#endif
+   {
+
+   }
+
+   std::uint64_t mHash;
+
+#ifndef NDEBUG
+   const char*   mDebugString; // Points to the string literal or to the interned string, so that the ID can also be inspected in the debugger
+#endif
+};
+
+constexpr StringID operator""_sid(const char* str, std::size_t length)
+{
+   return StringID(str, length);
+}
+
+// The hash is already well distributed, so it's used as is by the unordered containers
+namespace std
+{
+   template<>
+   struct hash<StringID>
+   {
+      std::size_t operator()(const StringID& stringID) const noexcept
+      {
+         return static_cast<std::size_t>(stringID.getHash());
+      }
+   };
+}
+
+#endif
@@ -3,11 +3,13 @@
 
 #include <glad/glad.h>
 
+#include "resource_footprint.h"
+
 class Texture
 {
 public:
 
-   explicit Texture(unsigned int texID);
+   Texture(unsigned int texID, std::size_t gpuMemoryInBytes);
    ~Texture();
 
    Texture(const Texture&) = delete;
@@ -16,11 +18,14 @@ public:
    Texture(Texture&& rhs) noexcept;
    Texture& operator=(Texture&& rhs) noexcept;
 
-   void bind() const;
+   void              bind(unsigned int texUnit) const;
+
+   ResourceFootprint getFootprint() const;
 
 private:
 
    unsigned int mTexID;
+   std::size_t  mGPUMemoryInBytes;
 };
 
 #endif
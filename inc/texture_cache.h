@@ -0,0 +1,110 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "resource_manager.h"
+#include "string_id.h"
+#include "texture.h"
+#include "texture_loader.h"
+
+struct TextureCacheStatistics
+{
+   unsigned long long numOfUploadedTextures;  // Textures that were decoded and uploaded
+   unsigned long long numOfSharedTextures;    // Requests that reused a texture that was already uploaded instead of uploading it again
+   unsigned long long numOfDecodedBytesSaved; // Pixels that didn't have to be decoded again, since the texture was found or was being decoded by another thread before decoding it
+   unsigned long long numOfVRAMBytesSaved;    // VRAM that the copies of the shared textures would have taken
+   double             timeSavedInSec;         // Time that decoding and uploading the shared textures took when they were loaded
+};
+
+// Cache of the textures of all the models, which identifies the textures by the hash of the contents of their files and by their sampler parameters,
+// so that identical images are decoded and uploaded once, even if they are referenced by different models or through different paths
+// Its textures are managed by a resource manager, which can be given a memory budget (the textures that are used by models are pinned by them)
+class TextureCache
+{
+public:
+
+   TextureCache();
+   ~TextureCache() = default;
+
+   // The loaders hold references to the cache, so it can't be copied or moved
+   TextureCache(const TextureCache&) = delete;
+   TextureCache& operator=(const TextureCache&) = delete;
+
+   TextureCache(TextureCache&&) = delete;
+   TextureCache& operator=(TextureCache&&) = delete;
+
+   // The source hash is the hash of the contents of the image file (see calculateFileHash), which is also what the baked texture is keyed by (see TextureLoader::decodeTexture),
+   // so the file only needs to be hashed once
+   // The same image in a different color space has different mips, so it's a different texture
+   StringID                  calculateKey(std::uint64_t     sourceHash,
+                                          TextureColorSpace colorSpace,
+                                          unsigned int      wrapS     = GL_REPEAT,
+                                          unsigned int      wrapT     = GL_REPEAT,
+                                          unsigned int      minFilter = GL_LINEAR_MIPMAP_LINEAR,
+                                          unsigned int      magFilter = GL_LINEAR,
+                                          bool              genMipmap = true) const;
+
+   // Returns the texture with the given key if it was already uploaded, so that it doesn't need to be decoded, or a nullptr otherwise
+   // Can be called from any thread
+   std::shared_ptr<Texture>  findTexture(StringID key);
+
+   // Decodes the texture with the given function, unless another thread is decoding it or decoded it and hasn't uploaded it yet, in which case that decoded texture is shared instead
+   // The decode time is set to the time that the decode took, even if it was shared
+   // Returns a nullptr if the texture could not be decoded
+   // Can be called from any thread, and the function is called without holding any locks
+   std::shared_ptr<const DecodedTexture> decodeTexture(StringID                                    key,
+                                                       const std::function<bool(DecodedTexture&)>& decode,
+                                                       double&                                     decodeTimeInSec);
+
+   // Uploads the decoded texture, unless a texture with the same key was uploaded since it was decoded, in which case that one is returned instead
+   // The decode time is the time it took to decode the texture, which is part of the time that the next requests for it save
+   // Must be called on the context thread, and with the sampler parameters that the key was calculated with
+   std::shared_ptr<Texture>  loadTexture(StringID              key,
+                                         const DecodedTexture& decodedTexture,
+                                         double                decodeTimeInSec,
+                                         unsigned int          wrapS     = GL_REPEAT,
+                                         unsigned int          wrapT     = GL_REPEAT,
+                                         unsigned int          minFilter = GL_LINEAR_MIPMAP_LINEAR,
+                                         unsigned int          magFilter = GL_LINEAR,
+                                         bool                  genMipmap = true);
+
+   ResourceManager<Texture>& getTextureManager();
+
+   TextureCacheStatistics    getStatistics() const;
+
+private:
+
+   // What loading a texture cost, which is what each later request for it saves
+   struct LoadCost
+   {
+      unsigned long long decodedSizeInBytes;
+      unsigned long long vramSizeInBytes;
+      double             decodeTimeInSec;
+      double             uploadTimeInSec;
+   };
+
+   // What the thread that decoded a texture shares with the threads that asked for it while it was decoding
+   // The decoded texture is only referenced weakly, so that it's freed once the model that decoded it is uploaded (or dropped)
+   struct DecodeResult
+   {
+      std::weak_ptr<const DecodedTexture> decodedTexture;
+      double                              decodeTimeInSec;
+   };
+
+   void recordSharedTexture(StringID key, bool isDecodeSaved);
+
+   ResourceManager<Texture>                                       mTextures;
+
+   mutable std::mutex                                             mMutex;
+   std::unordered_map<StringID, LoadCost>                         mLoadCosts;
+   std::unordered_map<StringID, std::shared_future<DecodeResult>> mDecodes;
+   TextureCacheStatistics                                         mStatistics;
+};
+
+#endif
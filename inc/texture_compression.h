@@ -0,0 +1,70 @@
+#ifndef TEXTURE_COMPRESSION_H
+#define TEXTURE_COMPRESSION_H
+
+#include <cstddef>
+#include <vector>
+
+// Block-compressed formats that GPUs sample from directly, without decompressing them first
+// Each format stores the texels in blocks of 4x4, and the blocks at the right and bottom edges of a level are padded with copies of its edge texels
+enum class CompressedTextureFormat : unsigned int
+{
+   bc1   = 0, // RGB in 8 bytes per block, for textures without alpha
+   bc3   = 1, // RGBA in 16 bytes per block, made out of an alpha block followed by a BC1 block
+   bc7   = 2, // RGBA in 16 bytes per block, with a higher quality than BC1 and BC3 (only mode 6 is encoded and decoded)
+   count = 3
+};
+
+// How the color components of a texture are encoded, which decides how its mips are filtered
+enum class TextureColorSpace : unsigned int
+{
+   srgb   = 0, // Colors that are authored by eye (e.g. diffuse, ambient and emissive maps)
+   linear = 1, // Data that is used as is by the shaders (e.g. specular maps)
+   count  = 2
+};
+
+// Level of a mip chain with 4 8-bit components per texel
+struct MipLevel
+{
+   int                        width;
+   int                        height;
+   std::vector<unsigned char> texels;
+};
+
+// Blocks of a compressed mip level, which are owned by a CompressedMipLevel or a BakedTexture
+struct CompressedMipLevelView
+{
+   const unsigned char* blocks;
+   std::size_t          sizeInBytes;
+   int                  width;
+   int                  height;
+};
+
+struct CompressedMipLevel
+{
+   CompressedMipLevelView     getView() const;
+
+   int                        width;
+   int                        height;
+   std::vector<unsigned char> blocks;
+};
+
+unsigned int            getBlockSizeInBytes(CompressedTextureFormat format);
+std::size_t             calculateCompressedSizeInBytes(CompressedTextureFormat format, int width, int height);
+
+// Textures with alpha are compressed with BC3, and the others with BC1, since both are supported by every desktop GPU
+CompressedTextureFormat chooseCompressedTextureFormat(int numComponents);
+
+// Converts the texels to RGBA and generates the whole mip chain down to 1x1
+// The colors of sRGB textures are averaged in linear space and encoded again, which keeps the mips from getting darker,
+// while the colors of linear textures, as well as the alpha, are averaged as is
+std::vector<MipLevel>   generateMipChain(const unsigned char* texels, int width, int height, int numComponents, TextureColorSpace colorSpace, unsigned int numOfThreads = 0);
+
+// The rows of blocks are compressed in parallel on up to numOfThreads threads (see parallel_for.h), and a numOfThreads of 0 uses one thread per hardware thread
+CompressedMipLevel      compressMipLevel(CompressedTextureFormat format, const MipLevel& mipLevel, unsigned int numOfThreads = 0);
+
+// Decompresses a level into RGBA texels without a GPU, so that the encoder can be verified on the CPU,
+// and so that the textures can still be uploaded if the GPU doesn't support their format
+// Returns false if a block can't be decoded (e.g. a BC7 block of a mode other than 6)
+bool                    decompressMipLevel(CompressedTextureFormat format, const CompressedMipLevelView& compressedMipLevel, MipLevel& mipLevel);
+
+#endif
@@ -1,11 +1,38 @@
 #ifndef TEXTURE_LOADER_H
 #define TEXTURE_LOADER_H
 
+#include <functional>
 #include <string>
 #include <memory>
 
+#include "baked_texture.h"
 #include "texture.h"
 
+// Texture that was prepared on the CPU, but that was not uploaded yet
+// It's either a baked texture, whose compressed mip chain is uploaded as is, or the pixels of an image that couldn't be baked
+struct DecodedTexture
+{
+   DecodedTexture()
+      : data(nullptr, stbiImageFree)
+      , width(0)
+      , height(0)
+      , numComponents(0)
+      , bakedTexture()
+   {
+
+   }
+
+   static void                                    stbiImageFree(void* data);
+
+   bool                                           isValid() const;
+
+   std::unique_ptr<unsigned char, void(*)(void*)> data;
+   int                                            width;
+   int                                            height;
+   int                                            numComponents; // Of the image, even if the texture was baked
+   BakedTexture                                   bakedTexture;
+};
+
 class TextureLoader
 {
 public:
@@ -19,24 +46,72 @@ public:
    TextureLoader(TextureLoader&&) = default;
    TextureLoader& operator=(TextureLoader&&) = default;
 
-   std::shared_ptr<Texture> loadResource(const std::string& texFilePath,
-                                         unsigned int       wrapS     = GL_REPEAT,
-                                         unsigned int       wrapT     = GL_REPEAT,
-                                         unsigned int       minFilter = GL_LINEAR_MIPMAP_LINEAR,
-                                         unsigned int       magFilter = GL_LINEAR,
-                                         bool               genMipmap = true) const;
+   std::shared_ptr<Texture>                  loadResource(const std::string& texFilePath,
+                                                          unsigned int       wrapS     = GL_REPEAT,
+                                                          unsigned int       wrapT     = GL_REPEAT,
+                                                          unsigned int       minFilter = GL_LINEAR_MIPMAP_LINEAR,
+                                                          unsigned int       magFilter = GL_LINEAR,
+                                                          bool               genMipmap = true) const;
+
+   // Uploads a texture that was already decoded (e.g. on a worker thread)
+   std::shared_ptr<Texture>                  loadResource(const DecodedTexture& decodedTexture,
+                                                          unsigned int          wrapS     = GL_REPEAT,
+                                                          unsigned int          wrapT     = GL_REPEAT,
+                                                          unsigned int          minFilter = GL_LINEAR_MIPMAP_LINEAR,
+                                                          unsigned int          magFilter = GL_LINEAR,
+                                                          bool                  genMipmap = true) const;
+
+   // Decodes the texture without an OpenGL context, and returns the function that uploads it (see ResourceManager::loadResourceAsync)
+   std::function<std::shared_ptr<Texture>()> prepareResource(const std::string& texFilePath,
+                                                             unsigned int       wrapS     = GL_REPEAT,
+                                                             unsigned int       wrapT     = GL_REPEAT,
+                                                             unsigned int       minFilter = GL_LINEAR_MIPMAP_LINEAR,
+                                                             unsigned int       magFilter = GL_LINEAR,
+                                                             bool               genMipmap = true) const;
+
+   // Returns false if the file can't be decoded, which doesn't need an OpenGL context
+   // The first time a texture is decoded, its mip chain is generated in the given color space, compressed and baked next to the image file (see baked_texture.h),
+   // and the next times the baked texture is mapped instead, for as long as the image file stays the same
+   // Baking runs on up to numOfThreads threads (see bakeTexture)
+   // The source hash is the hash of the contents of the image file (see calculateFileHash), which callers that also use it for something else (e.g. the texture cache) only calculate once
+   bool                                      decodeTexture(const std::string& texFilePath,
+                                                           std::uint64_t      sourceHash,
+                                                           TextureColorSpace  colorSpace,
+                                                           DecodedTexture&    decodedTexture,
+                                                           unsigned int       numOfThreads = 0) const;
+
+   // Hashes the image file and decodes it
+   bool                                      decodeTexture(const std::string& texFilePath, TextureColorSpace colorSpace, DecodedTexture& decodedTexture, unsigned int numOfThreads = 0) const;
+
+   // An image that is used in both color spaces is baked into a different file for each of them
+   std::string                               getBakedTextureFilePath(const std::string& texFilePath, TextureColorSpace colorSpace) const;
+
+   // Generates the mip chain of the pixels of a decoded texture in the color space of the key, compresses it and writes it to the given file, which doesn't need an OpenGL context
+   // The compressed format is chosen from the number of components of the image (see chooseCompressedTextureFormat)
+   // The mips and the blocks are processed in parallel on up to numOfThreads threads (see parallel_for.h), and a numOfThreads of 0 uses one thread per hardware thread
+   bool                                      bakeTexture(const std::string&     bakedTextureFilePath,
+                                                         const BakedTextureKey& key,
+                                                         const DecodedTexture&  decodedTexture,
+                                                         unsigned int           numOfThreads = 0) const;
 
 private:
 
-   unsigned int generateTexture(const std::unique_ptr<unsigned char, void(*)(void*)>& texData,
-                                int          width,
-                                int          height,
-                                int          numComponents,
-                                unsigned int wrapS,
-                                unsigned int wrapT,
-                                unsigned int minFilter,
-                                unsigned int magFilter,
-                                bool         genMipmap) const;
+   unsigned int generateTexture(const DecodedTexture& decodedTexture,
+                                unsigned int          wrapS,
+                                unsigned int          wrapT,
+                                unsigned int          minFilter,
+                                unsigned int          magFilter,
+                                bool                  genMipmap) const;
+
+   // Uploads the mip chain of a baked texture, or only its base level if the texture doesn't use mipmaps
+   // If the GPU doesn't support the compressed format, the levels are decompressed on the CPU and uploaded as RGBA
+   unsigned int generateCompressedTexture(const BakedTexture& bakedTexture,
+                                          unsigned int        wrapS,
+                                          unsigned int        wrapT,
+                                          unsigned int        minFilter,
+                                          unsigned int        magFilter,
+                                          bool                genMipmap,
+                                          std::size_t&        gpuMemoryInBytes) const;
 };
 
 #endif
@@ -0,0 +1,48 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs tasks on a fixed set of worker threads in the order in which they are enqueued
+// The tasks must not touch OpenGL, since the workers don't have the context (see GLUploadQueue)
+class ThreadPool
+{
+public:
+
+   // A numOfThreads of 0 uses one thread per hardware thread
+   explicit ThreadPool(unsigned int numOfThreads = 0);
+
+   // Waits for the tasks that are running, and discards the ones that haven't started yet
+   ~ThreadPool();
+
+   ThreadPool(const ThreadPool&) = delete;
+   ThreadPool& operator=(const ThreadPool&) = delete;
+
+   ThreadPool(ThreadPool&&) = delete;
+   ThreadPool& operator=(ThreadPool&&) = delete;
+
+   void         enqueue(std::function<void()> task);
+
+   unsigned int getNumOfThreads() const;
+
+   // Returns true if the calling thread is a worker of any thread pool
+   // Work that runs on a worker shouldn't start threads of its own (e.g. with parallelFor), since the other workers already keep the hardware threads busy
+   static bool  isWorkerThread();
+
+private:
+
+   void         runWorker();
+
+   std::vector<std::thread>          mWorkers;
+   std::deque<std::function<void()>> mTasks;
+   std::mutex                        mMutex;
+   std::condition_variable           mTaskAvailable;
+   bool                              mIsStopping;
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef UNIFORM_BLOCKS_H
+#define UNIFORM_BLOCKS_H
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+// The structs below mirror the std140 uniform blocks that are declared in the shaders, so they must be kept in sync with them
+// In std140, a vec3 occupies 16 bytes unless it's followed by a scalar, and arrays of structs are padded to multiples of 16 bytes
+
+enum class UniformBlockBindingPoints : unsigned int
+{
+   camera    = 0,
+   lights    = 1,
+   materials = 2
+};
+
+// layout (std140) uniform Camera
+struct CameraUniformBlock
+{
+   glm::mat4 projectionView;
+   glm::vec3 cameraPos;
+   float     padding;
+};
+
+static_assert(sizeof(CameraUniformBlock) == 80, "CameraUniformBlock must match the std140 layout of the Camera uniform block");
+
+#define MAX_NUMBER_OF_POINT_LIGHTS 4
+
+struct PointLightUniform
+{
+   glm::vec3 worldPos;
+   float     constantAtt;
+   glm::vec3 color;
+   float     linearAtt;
+   float     quadraticAtt;
+   float     padding[3];
+};
+
+static_assert(sizeof(PointLightUniform) == 48, "PointLightUniform must match the std140 layout of the PointLight struct");
+
+// layout (std140) uniform Lights
+struct LightsUniformBlock
+{
+   PointLightUniform pointLights[MAX_NUMBER_OF_POINT_LIGHTS];
+   int               numPointLightsInScene;
+   int               padding[3];
+};
+
+static_assert(offsetof(LightsUniformBlock, numPointLightsInScene) == 48 * MAX_NUMBER_OF_POINT_LIGHTS, "LightsUniformBlock must match the std140 layout of the Lights uniform block");
+
+#define MAX_NUMBER_OF_MATERIALS 128
+
+struct MaterialUniform
+{
+   glm::vec3 ambient;
+   int       ambientTexIsAvailable;
+   glm::vec3 emissive;
+   int       emissiveTexIsAvailable;
+   glm::vec3 diffuse;
+   int       diffuseTexIsAvailable;
+   glm::vec3 specular;
+   int       specularTexIsAvailable;
+   float     shininess;
+   float     padding[3];
+};
+
+static_assert(sizeof(MaterialUniform) == 80, "MaterialUniform must match the std140 layout of the Material struct");
+
+// layout (std140) uniform Materials
+struct MaterialsUniformBlock
+{
+   MaterialUniform materials[MAX_NUMBER_OF_MATERIALS];
+};
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#include <glad/glad.h>
+
+// A uniform buffer stores the contents of a uniform block, and it's bound to a binding point so that every shader
+// whose uniform block is bound to the same binding point (see Shader::bindUniformBlock) reads the same data
+class UniformBuffer
+{
+public:
+
+   UniformBuffer(unsigned int sizeInBytes, unsigned int bindingPoint);
+   ~UniformBuffer();
+
+   UniformBuffer(const UniformBuffer&) = delete;
+   UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+   UniformBuffer(UniformBuffer&& rhs) noexcept;
+   UniformBuffer& operator=(UniformBuffer&& rhs) noexcept;
+
+   void         update(const void* data, unsigned int sizeInBytes, unsigned int offsetInBytes = 0) const;
+
+   unsigned int getBindingPoint() const;
+
+private:
+
+   unsigned int mUBO;
+   unsigned int mSizeInBytes;
+   unsigned int mBindingPoint;
+};
+
+#endif
@@ -26,6 +26,18 @@ public:
    void         setShouldClose(bool shouldClose); // TODO: Could this be considered to be const?
    void         swapBuffers();                    // TODO: Could this be considered to be const?
    void         pollEvents();                     // TODO: Could this be considered to be const?
+   void         waitEvents(double timeoutInSec);  // TODO: Could this be considered to be const?
+   int          getSwapInterval() const;
+   void         setSwapInterval(int swapInterval);
+
+   // Events
+   bool         eventsReceived() const;
+   void         resetEventsReceived();
+
+   // Input latency
+   bool         hasUnpresentedInput() const;
+   double       getTimeOfOldestUnpresentedInput() const;
+   void         resetUnpresentedInput();
 
    // Window
    unsigned int getWidthOfWindowInPix() const;
@@ -34,6 +46,7 @@ public:
    unsigned int getHeightOfFramebufferInPix() const;
    bool         isFullScreen() const;
    void         setFullScreen(bool fullScreen);
+   void         setVisible(bool visible);
 
    // Keyboard
    bool         keyIsPressed(int key) const;
@@ -68,6 +81,9 @@ private:
    void         keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
    void         cursorPosCallback(GLFWwindow* window, double xPos, double yPos);
    void         scrollCallback(GLFWwindow* window, double xOffset, double yOffset);
+   void         mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+   void         charCallback(GLFWwindow* window, unsigned int codepoint);
+   void         recordInputTime();
 
    // Window
    GLFWwindow*                    mWindow;
@@ -77,6 +93,13 @@ private:
    int                            mHeightOfFramebufferInPix;
    std::string                    mTitle;
    bool                           mIsFullScreen;
+   int                            mSwapInterval;
+
+   // Events
+   bool                           mEventsReceived;
+
+   // Input latency
+   double                         mTimeOfOldestUnpresentedInput;
 
    // Keyboard
    std::bitset<GLFW_KEY_LAST + 1> mKeys;
@@ -7,65 +7,79 @@ in VertexData
    vec2 texCoords;
 } i;
 
+// The members are ordered so that each float fills the padding after a vec3 in std140
 struct PointLight
 {
    vec3  worldPos;
-   vec3  color;
    float constantAtt;
+   vec3  color;
    float linearAtt;
    float quadraticAtt;
 };
 
 #define MAX_NUMBER_OF_POINT_LIGHTS 4
-uniform PointLight pointLights[MAX_NUMBER_OF_POINT_LIGHTS];
-uniform int numPointLightsInScene;
 
-uniform vec3 cameraPos;
+layout (std140) uniform Lights
+{
+   PointLight pointLights[MAX_NUMBER_OF_POINT_LIGHTS];
+   int        numPointLightsInScene;
+};
+
+layout (std140) uniform Camera
+{
+   mat4 projectionView;
+   vec3 cameraPos;
+};
 
 uniform sampler2D ambientTex;
 uniform sampler2D emissiveTex;
 uniform sampler2D diffuseTex;
 uniform sampler2D specularTex;
 
-struct MaterialTextureAvailabilities
-{
-   int ambientTexIsAvailable;
-   int emissiveTexIsAvailable;
-   int diffuseTexIsAvailable;
-   int specularTexIsAvailable;
-};
-
-uniform MaterialTextureAvailabilities materialTextureAvailabilities;
-
-struct MaterialConstants
+// The constants of all the materials are uploaded once when the models are loaded, and each draw selects one of them by index
+// The members are ordered so that each int fills the padding after a vec3 in std140
+struct Material
 {
    vec3  ambient;
+   int   ambientTexIsAvailable;
    vec3  emissive;
+   int   emissiveTexIsAvailable;
    vec3  diffuse;
+   int   diffuseTexIsAvailable;
    vec3  specular;
+   int   specularTexIsAvailable;
    float shininess;
 };
 
-uniform MaterialConstants materialConstants;
+#define MAX_NUMBER_OF_MATERIALS 128
+
+layout (std140) uniform Materials
+{
+   Material materials[MAX_NUMBER_OF_MATERIALS];
+};
+
+uniform int materialIndex;
 
 out vec4 fragColor;
 
-vec3 calculateContributionOfPointLight(PointLight light, vec3 viewDir);
+vec3 calculateContributionOfPointLight(PointLight light, Material material, vec3 viewDir);
 
 void main()
 {
    vec3 viewDir = normalize(cameraPos - i.worldPos);
 
+   Material material = materials[materialIndex];
+
    vec3 color = vec3(0.0);
    for(int i = 0; i < numPointLightsInScene; i++)
    {
-      color += calculateContributionOfPointLight(pointLights[i], viewDir);
+      color += calculateContributionOfPointLight(pointLights[i], material, viewDir);
    }
 
    fragColor = vec4(color, 1.0);
 }
 
-vec3 calculateContributionOfPointLight(PointLight light, vec3 viewDir)
+vec3 calculateContributionOfPointLight(PointLight light, Material material, vec3 viewDir)
 {
    // Attenuation
    float distance    = length(light.worldPos - i.worldPos);
@@ -73,24 +87,24 @@ vec3 calculateContributionOfPointLight(PointLight light, vec3 viewDir)
 
    // Ambient
    // TODO: Do you really want the ambient light to be attenuated?
-   vec3 ambient      =   (vec3(texture(ambientTex, i.texCoords)) * attenuation) *  materialTextureAvailabilities.ambientTexIsAvailable
-                       - (materialConstants.ambient              * attenuation) * (materialTextureAvailabilities.ambientTexIsAvailable - 1);
+   vec3 ambient      =   (vec3(texture(ambientTex, i.texCoords)) * attenuation) *  material.ambientTexIsAvailable
+                       - (material.ambient                       * attenuation) * (material.ambientTexIsAvailable - 1);
 
    // Emissive
-   vec3 emissive     =   vec3(texture(emissiveTex, i.texCoords)) *  materialTextureAvailabilities.emissiveTexIsAvailable
-                       - materialConstants.emissive              * (materialTextureAvailabilities.emissiveTexIsAvailable - 1);
+   vec3 emissive     =   vec3(texture(emissiveTex, i.texCoords)) *  material.emissiveTexIsAvailable
+                       - material.emissive                       * (material.emissiveTexIsAvailable - 1);
 
    // Diffuse
    vec3  lightDir    = normalize(light.worldPos - i.worldPos);
    vec3  diff        = max(dot(lightDir, i.worldNormal), 0.0) * light.color * attenuation;
-   vec3  diffuse     =   (diff * vec3(texture(diffuseTex, i.texCoords))) *  materialTextureAvailabilities.diffuseTexIsAvailable
-                       - (diff * materialConstants.diffuse)              * (materialTextureAvailabilities.diffuseTexIsAvailable - 1);
+   vec3  diffuse     =   (diff * vec3(texture(diffuseTex, i.texCoords))) *  material.diffuseTexIsAvailable
+                       - (diff * material.diffuse)                       * (material.diffuseTexIsAvailable - 1);
 
    // Specular
    vec3 reflectedDir = reflect(-lightDir, i.worldNormal);
-   vec3 spec         = pow(max(dot(reflectedDir, viewDir), 0.0), materialConstants.shininess) * light.color * attenuation;
-   vec3 specular     =   (spec * vec3(texture(specularTex, i.texCoords))) *  materialTextureAvailabilities.specularTexIsAvailable
-                       - (spec * materialConstants.specular)              * (materialTextureAvailabilities.specularTexIsAvailable - 1);
+   vec3 spec         = pow(max(dot(reflectedDir, viewDir), 0.0), material.shininess) * light.color * attenuation;
+   vec3 specular     =   (spec * vec3(texture(specularTex, i.texCoords))) *  material.specularTexIsAvailable
+                       - (spec * material.specular)                       * (material.specularTexIsAvailable - 1);
 
    return (ambient + diffuse + specular + emissive);
 }
@@ -1,11 +1,16 @@
 #version 330 core
 
-layout (location = 0) in vec3 inPos;
-layout (location = 1) in vec3 inNormal;
+layout (location = 0) in vec3 inPos;              // Can be quantized to the bounding cube of the model, in which case the instance transform dequantizes it
+layout (location = 1) in vec4 inTangentFrame;     // QTangent, unit quaternion whose w is negative if the bitangent is reflected
 layout (location = 2) in vec2 inTexCoords;
+layout (location = 3) in vec4 inPositionAndScale; // Per instance, xyz = Position, w = Uniform scaling factor
+layout (location = 4) in vec4 inRotation;         // Per instance, unit quaternion, xyz = Vector part, w = Scalar part
 
-uniform mat4 model;
-uniform mat4 projectionView;
+layout (std140) uniform Camera
+{
+   mat4 projectionView;
+   vec3 cameraPos;
+};
 
 out VertexData
 {
@@ -14,10 +19,39 @@ out VertexData
    vec2 texCoords;
 } o;
 
+// Rotates v by the unit quaternion q (q * v * q^-1)
+vec3 rotateByQuat(vec4 q, vec3 v)
+{
+   return (2.0 * dot(q.xyz, v)) * q.xyz + (q.w * q.w - dot(q.xyz, q.xyz)) * v + (2.0 * q.w) * cross(q.xyz, v);
+}
+
+// The tangent frame of a QTangent is made out of the columns of the rotation matrix of its quaternion, which are the rotated X, Y and Z axes
+// Each column only needs a few multiply-adds, so a shader that only needs the normal doesn't pay for the whole frame
+// The quaternion must be normalized first, since its components were quantized
+vec3 qTangentToTangent(vec4 q)
+{
+   return vec3(1.0 - 2.0 * (q.y * q.y + q.z * q.z), 2.0 * (q.x * q.y + q.z * q.w), 2.0 * (q.x * q.z - q.y * q.w));
+}
+
+vec3 qTangentToBitangent(vec4 q)
+{
+   vec3 bitangent = vec3(2.0 * (q.x * q.y - q.z * q.w), 1.0 - 2.0 * (q.x * q.x + q.z * q.z), 2.0 * (q.y * q.z + q.x * q.w));
+   return (q.w < 0.0) ? -bitangent : bitangent;
+}
+
+vec3 qTangentToNormal(vec4 q)
+{
+   return vec3(2.0 * (q.x * q.z + q.y * q.w), 2.0 * (q.y * q.z - q.x * q.w), 1.0 - 2.0 * (q.x * q.x + q.y * q.y));
+}
+
 void main()
 {
-   o.worldPos    = vec3(model * vec4(inPos, 1.0));
-   o.worldNormal = normalize(mat3(model) * inNormal);
+   // 1) Scale, 2) rotate and 3) translate the model
+   o.worldPos    = inPositionAndScale.xyz + rotateByQuat(inRotation, inPos * inPositionAndScale.w);
+
+   // Since the scaling factor is uniform, the normals only need to be rotated
+   // The tangents and bitangents that normal mapping needs can be decoded in the same way with qTangentToTangent and qTangentToBitangent
+   o.worldNormal = normalize(rotateByQuat(inRotation, qTangentToNormal(normalize(inTangentFrame))));
    o.texCoords   = inTexCoords;
 
    gl_Position = projectionView * vec4(o.worldPos, 1.0);
@@ -1,11 +1,19 @@
 #version 330 core
 
-layout (location = 0) in vec3 inPos;
+layout (location = 0) in vec3 inPos;   // World space position
+layout (location = 1) in vec3 inColor;
 
-uniform mat4 model;
-uniform mat4 projectionView;
+layout (std140) uniform Camera
+{
+   mat4 projectionView;
+   vec3 cameraPos;
+};
+
+out vec3 color;
 
 void main()
 {
-   gl_Position = projectionView * model * vec4(inPos, 1.0);
+   color = inColor;
+
+   gl_Position = projectionView * vec4(inPos, 1.0);
 }
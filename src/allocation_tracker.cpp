@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#include "allocation_tracker.h"
+
+#ifdef TRACK_HEAP_ALLOCATIONS
+
+namespace
+{
+   std::atomic<unsigned long long> gNumOfHeapAllocations(0);
+   std::atomic<unsigned long long> gNumOfBytesAllocatedOnHeap(0);
+
+   void* allocate(std::size_t size)
+   {
+      gNumOfHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+      gNumOfBytesAllocatedOnHeap.fetch_add(size, std::memory_order_relaxed);
+
+      // malloc(0) is allowed to return a nullptr, but operator new must return a unique pointer
+      return std::malloc(size != 0 ? size : 1);
+   }
+
+   // Used by the overloads that take an alignment, which are called for types that are aligned to more than alignof(std::max_align_t)
+   void* allocateAligned(std::size_t size, std::align_val_t alignment)
+   {
+      gNumOfHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+      gNumOfBytesAllocatedOnHeap.fetch_add(size, std::memory_order_relaxed);
+
+      std::size_t alignmentInBytes = static_cast<std::size_t>(alignment);
+      std::size_t sizeInBytes      = (size != 0) ? size : 1;
+
+#ifdef _WIN32
+      return _aligned_malloc(sizeInBytes, alignmentInBytes);
+#else
+      // aligned_alloc requires the size to be a multiple of the alignment
+      return std::aligned_alloc(alignmentInBytes, (sizeInBytes + alignmentInBytes - 1) & ~(alignmentInBytes - 1));
+#endif
+   }
+
+   // Memory that comes from _aligned_malloc can't be freed with free
+   void freeAligned(void* ptr)
+   {
+#ifdef _WIN32
+      _aligned_free(ptr);
+#else
+      std::free(ptr);
+#endif
+   }
+}
+
+void* operator new(std::size_t size)
+{
+   void* ptr = allocate(size);
+   if (!ptr)
+   {
+      throw std::bad_alloc();
+   }
+
+   return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+   void* ptr = allocate(size);
+   if (!ptr)
+   {
+      throw std::bad_alloc();
+   }
+
+   return ptr;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+   return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+   return allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+   void* ptr = allocateAligned(size, alignment);
+   if (!ptr)
+   {
+      throw std::bad_alloc();
+   }
+
+   return ptr;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+   void* ptr = allocateAligned(size, alignment);
+   if (!ptr)
+   {
+      throw std::bad_alloc();
+   }
+
+   return ptr;
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+   return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+   return allocateAligned(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept
+{
+   std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+   std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+   std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+   std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+   std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+   std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+   freeAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+   freeAligned(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+   freeAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+   freeAligned(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+   freeAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+   freeAligned(ptr);
+}
+
+unsigned long long getTotalNumOfHeapAllocations()
+{
+   return gNumOfHeapAllocations.load(std::memory_order_relaxed);
+}
+
+unsigned long long getTotalNumOfBytesAllocatedOnHeap()
+{
+   return gNumOfBytesAllocatedOnHeap.load(std::memory_order_relaxed);
+}
+
+bool isHeapAllocationTrackingEnabled()
+{
+   return true;
+}
+
+#else
+
+unsigned long long getTotalNumOfHeapAllocations()
+{
+   return 0;
+}
+
+unsigned long long getTotalNumOfBytesAllocatedOnHeap()
+{
+   return 0;
+}
+
+bool isHeapAllocationTrackingEnabled()
+{
+   return false;
+}
+
+#endif
+
+AllocationTracker::AllocationTracker(unsigned int numOfWarmUpFrames)
+   : mNumOfWarmUpFrames(numOfWarmUpFrames)
+   , mNumOfFrames(0)
+   , mNumOfAllocationsAtBeginningOfFrame(0)
+   , mNumOfBytesAllocatedAtBeginningOfFrame(0)
+   , mNumOfAllocationsInLastFrame(0)
+   , mNumOfBytesAllocatedInLastFrame(0)
+   , mNumOfSteadyStateFrames(0)
+   , mNumOfSteadyStateAllocations(0)
+   , mMaxNumOfAllocationsInSteadyStateFrame(0)
+   , mAssertOnSteadyStateAllocations(true)
+{
+
+}
+
+void AllocationTracker::beginFrame()
+{
+   mNumOfAllocationsAtBeginningOfFrame    = getTotalNumOfHeapAllocations();
+   mNumOfBytesAllocatedAtBeginningOfFrame = getTotalNumOfBytesAllocatedOnHeap();
+}
+
+void AllocationTracker::endFrame()
+{
+   mNumOfAllocationsInLastFrame    = getTotalNumOfHeapAllocations() - mNumOfAllocationsAtBeginningOfFrame;
+   mNumOfBytesAllocatedInLastFrame = getTotalNumOfBytesAllocatedOnHeap() - mNumOfBytesAllocatedAtBeginningOfFrame;
+
+   if (isInSteadyState())
+   {
+      ++mNumOfSteadyStateFrames;
+      mNumOfSteadyStateAllocations          += mNumOfAllocationsInLastFrame;
+      mMaxNumOfAllocationsInSteadyStateFrame = std::max(mMaxNumOfAllocationsInSteadyStateFrame, mNumOfAllocationsInLastFrame);
+
+      if (mNumOfAllocationsInLastFrame != 0 && mAssertOnSteadyStateAllocations)
+      {
+         std::cout << "Error - AllocationTracker::endFrame - A steady state frame made " << mNumOfAllocationsInLastFrame << " heap allocations (" << mNumOfBytesAllocatedInLastFrame << " bytes)" << "\n";
+         assert(!"A steady state frame allocated memory on the heap");
+      }
+   }
+
+   ++mNumOfFrames;
+}
+
+bool AllocationTracker::isInSteadyState() const
+{
+   return mNumOfFrames >= mNumOfWarmUpFrames;
+}
+
+void AllocationTracker::restartWarmUp()
+{
+   mNumOfFrames = 0;
+}
+
+unsigned long long AllocationTracker::getNumOfAllocationsInLastFrame() const
+{
+   return mNumOfAllocationsInLastFrame;
+}
+
+unsigned long long AllocationTracker::getNumOfBytesAllocatedInLastFrame() const
+{
+   return mNumOfBytesAllocatedInLastFrame;
+}
+
+unsigned long long AllocationTracker::getNumOfSteadyStateFrames() const
+{
+   return mNumOfSteadyStateFrames;
+}
+
+unsigned long long AllocationTracker::getNumOfSteadyStateAllocations() const
+{
+   return mNumOfSteadyStateAllocations;
+}
+
+unsigned long long AllocationTracker::getMaxNumOfAllocationsInSteadyStateFrame() const
+{
+   return mMaxNumOfAllocationsInSteadyStateFrame;
+}
+
+void AllocationTracker::setAssertOnSteadyStateAllocations(bool assertOnSteadyStateAllocations)
+{
+   mAssertOnSteadyStateAllocations = assertOnSteadyStateAllocations;
+}
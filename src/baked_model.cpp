@@ -0,0 +1,350 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "baked_model.h"
+
+namespace
+{
+   const std::uint32_t bakedModelMagic = 0x4C444D42; // "BMDL"
+
+   // Must be incremented whenever the layout of the file or the processing of the meshes changes (e.g. the mesh optimizer, the QTangents or the vertex formats),
+   // so that the models that were baked with the old version are baked again
+   const std::uint32_t bakedModelVersion = 2;
+
+   // The blobs are aligned so that they can be read with SIMD loads and uploaded without the driver having to realign them
+   const std::uint64_t blobAlignmentInBytes = 16;
+
+   struct BakedModelHeader
+   {
+      std::uint32_t magic;
+      std::uint32_t version;
+      std::uint64_t sourceHash;
+      std::uint32_t importFlags;
+      std::uint32_t vertexFormat;
+      float         positionQuantizationCenter[3];
+      float         positionQuantizationHalfExtent;
+      std::uint32_t numOfMeshes;
+      std::uint32_t numOfMaterials;
+      std::uint64_t meshTableOffset;
+      std::uint64_t materialTableOffset;
+      std::uint64_t stringsOffset;
+      std::uint64_t stringsSizeInBytes;
+      std::uint64_t fileSizeInBytes;
+   };
+
+   struct BakedMesh
+   {
+      std::uint64_t vertexDataOffset;
+      std::uint64_t indexDataOffset;
+      std::uint32_t numOfVertices;
+      std::uint32_t numOfIndices;
+      std::uint32_t indexSizeInBytes;
+      std::uint32_t materialIndex;
+   };
+
+   // The texture filenames are ranges of the strings of the file, which are not null-terminated
+   struct BakedMaterial
+   {
+      float         ambientColor[3];
+      float         emissiveColor[3];
+      float         diffuseColor[3];
+      float         specularColor[3];
+      float         shininess;
+      std::uint32_t textureFilenameOffsets[static_cast<unsigned int>(MaterialTextureTypes::count)];
+      std::uint32_t textureFilenameLengths[static_cast<unsigned int>(MaterialTextureTypes::count)];
+   };
+
+   std::uint64_t alignOffset(std::uint64_t offset, std::uint64_t alignment)
+   {
+      return (offset + alignment - 1) & ~(alignment - 1);
+   }
+
+   unsigned int getVertexSizeInBytes(VertexFormat vertexFormat)
+   {
+      return (vertexFormat == VertexFormat::compact) ? sizeof(CompactVertex) : sizeof(Vertex);
+   }
+
+   // Checks that the given range lies within a file of the given size, without overflowing
+   bool isRangeInFile(std::uint64_t offset, std::uint64_t sizeInBytes, std::uint64_t fileSizeInBytes)
+   {
+      return (offset <= fileSizeInBytes) && (sizeInBytes <= fileSizeInBytes - offset);
+   }
+
+   void storeVec3(const glm::vec3& v, float* dst)
+   {
+      dst[0] = v.x;
+      dst[1] = v.y;
+      dst[2] = v.z;
+   }
+
+   glm::vec3 loadVec3(const float* src)
+   {
+      return glm::vec3(src[0], src[1], src[2]);
+   }
+}
+
+std::vector<MeshDataView> ImportedModel::getMeshViews() const
+{
+   std::vector<MeshDataView> meshViews;
+   meshViews.reserve(meshes.size());
+
+   for (const ImportedMesh& mesh : meshes)
+   {
+      meshViews.push_back(MeshDataView{mesh.vertexData.data(),
+                                       mesh.indexData.data(),
+                                       mesh.numOfVertices,
+                                       mesh.numOfIndices,
+                                       mesh.indexSizeInBytes,
+                                       mesh.materialIndex});
+   }
+
+   return meshViews;
+}
+
+bool BakedModel::open(const std::string& bakedModelFilePath, const BakedModelKey& key)
+{
+   if (!mFile.open(bakedModelFilePath))
+   {
+      return false;
+   }
+
+   const unsigned char* data     = mFile.getData();
+   std::uint64_t        fileSize = mFile.getSize();
+
+   // The header is at the beginning of the mapping, which is page-aligned
+   const BakedModelHeader* header = reinterpret_cast<const BakedModelHeader*>(data);
+   if (fileSize < sizeof(BakedModelHeader)      ||
+       header->magic        != bakedModelMagic   ||
+       header->version      != bakedModelVersion ||
+       header->sourceHash   != key.sourceHash    ||
+       header->importFlags  != key.importFlags   ||
+       header->vertexFormat != static_cast<std::uint32_t>(key.vertexFormat))
+   {
+      mFile.close();
+      return false;
+   }
+
+   // From this point on, the file claims to be up to date, so anything that doesn't add up means that it's corrupt (e.g. because writing it was interrupted)
+   bool isValid = (header->fileSizeInBytes == fileSize)                                                      &&
+                  (header->meshTableOffset     % alignof(BakedMesh)     == 0)                                 &&
+                  (header->materialTableOffset % alignof(BakedMaterial) == 0)                                 &&
+                  isRangeInFile(header->meshTableOffset,     header->numOfMeshes    * sizeof(BakedMesh),     fileSize) &&
+                  isRangeInFile(header->materialTableOffset, header->numOfMaterials * sizeof(BakedMaterial), fileSize) &&
+                  isRangeInFile(header->stringsOffset,       header->stringsSizeInBytes,                     fileSize);
+
+   const BakedMesh* meshes = reinterpret_cast<const BakedMesh*>(data + header->meshTableOffset);
+   unsigned int     vertexSizeInBytes = getVertexSizeInBytes(key.vertexFormat);
+   for (std::uint32_t i = 0; isValid && i < header->numOfMeshes; ++i)
+   {
+      const BakedMesh& mesh = meshes[i];
+      isValid = (mesh.indexSizeInBytes == sizeof(std::uint16_t) || mesh.indexSizeInBytes == sizeof(std::uint32_t)) &&
+                (mesh.materialIndex < header->numOfMaterials)                                                     &&
+                isRangeInFile(mesh.vertexDataOffset, static_cast<std::uint64_t>(mesh.numOfVertices) * vertexSizeInBytes,     fileSize) &&
+                isRangeInFile(mesh.indexDataOffset,  static_cast<std::uint64_t>(mesh.numOfIndices)  * mesh.indexSizeInBytes, fileSize);
+   }
+
+   const BakedMaterial* materials = reinterpret_cast<const BakedMaterial*>(data + header->materialTableOffset);
+   for (std::uint32_t i = 0; isValid && i < header->numOfMaterials; ++i)
+   {
+      for (unsigned int j = 0; isValid && j < static_cast<unsigned int>(MaterialTextureTypes::count); ++j)
+      {
+         isValid = isRangeInFile(materials[i].textureFilenameOffsets[j], materials[i].textureFilenameLengths[j], header->stringsSizeInBytes);
+      }
+   }
+
+   if (!isValid)
+   {
+      std::cout << "Error - BakedModel::open - The following baked model is corrupt and will be baked again: " << bakedModelFilePath << "\n";
+      mFile.close();
+      return false;
+   }
+
+   return true;
+}
+
+PositionQuantization BakedModel::getPositionQuantization() const
+{
+   const BakedModelHeader* header = reinterpret_cast<const BakedModelHeader*>(mFile.getData());
+   return PositionQuantization(loadVec3(header->positionQuantizationCenter), header->positionQuantizationHalfExtent);
+}
+
+std::vector<MeshDataView> BakedModel::getMeshViews() const
+{
+   const unsigned char*    data   = mFile.getData();
+   const BakedModelHeader* header = reinterpret_cast<const BakedModelHeader*>(data);
+   const BakedMesh*        meshes = reinterpret_cast<const BakedMesh*>(data + header->meshTableOffset);
+
+   std::vector<MeshDataView> meshViews;
+   meshViews.reserve(header->numOfMeshes);
+
+   for (std::uint32_t i = 0; i < header->numOfMeshes; ++i)
+   {
+      meshViews.push_back(MeshDataView{data + meshes[i].vertexDataOffset,
+                                       data + meshes[i].indexDataOffset,
+                                       meshes[i].numOfVertices,
+                                       meshes[i].numOfIndices,
+                                       meshes[i].indexSizeInBytes,
+                                       meshes[i].materialIndex});
+   }
+
+   return meshViews;
+}
+
+std::vector<MaterialDescription> BakedModel::getMaterials() const
+{
+   const unsigned char*    data      = mFile.getData();
+   const BakedModelHeader* header    = reinterpret_cast<const BakedModelHeader*>(data);
+   const BakedMaterial*    materials = reinterpret_cast<const BakedMaterial*>(data + header->materialTableOffset);
+   const char*             strings   = reinterpret_cast<const char*>(data + header->stringsOffset);
+
+   std::vector<MaterialDescription> materialDescriptions;
+   materialDescriptions.reserve(header->numOfMaterials);
+
+   for (std::uint32_t i = 0; i < header->numOfMaterials; ++i)
+   {
+      const BakedMaterial& material = materials[i];
+
+      std::array<std::string, static_cast<unsigned int>(MaterialTextureTypes::count)> textureFilenames;
+      for (unsigned int j = 0; j < static_cast<unsigned int>(MaterialTextureTypes::count); ++j)
+      {
+         textureFilenames[j].assign(strings + material.textureFilenameOffsets[j], material.textureFilenameLengths[j]);
+      }
+
+      materialDescriptions.emplace_back(textureFilenames,
+                                        MaterialConstants(loadVec3(material.ambientColor),
+                                                          loadVec3(material.emissiveColor),
+                                                          loadVec3(material.diffuseColor),
+                                                          loadVec3(material.specularColor),
+                                                          material.shininess));
+   }
+
+   return materialDescriptions;
+}
+
+bool writeBakedModel(const std::string& bakedModelFilePath, const BakedModelKey& key, const ImportedModel& importedModel)
+{
+   BakedModelHeader header = {};
+   header.magic                          = bakedModelMagic;
+   header.version                        = bakedModelVersion;
+   header.sourceHash                     = key.sourceHash;
+   header.importFlags                    = key.importFlags;
+   header.vertexFormat                   = static_cast<std::uint32_t>(key.vertexFormat);
+   header.positionQuantizationHalfExtent = importedModel.positionQuantization.halfExtent;
+   header.numOfMeshes                    = static_cast<std::uint32_t>(importedModel.meshes.size());
+   header.numOfMaterials                 = static_cast<std::uint32_t>(importedModel.materials.size());
+   storeVec3(importedModel.positionQuantization.center, header.positionQuantizationCenter);
+
+   // Build the material table and the strings
+   std::vector<BakedMaterial> materials(importedModel.materials.size());
+   std::string                strings;
+   for (std::size_t i = 0; i < importedModel.materials.size(); ++i)
+   {
+      const MaterialDescription& materialDescription = importedModel.materials[i];
+      BakedMaterial&             material            = materials[i];
+
+      storeVec3(materialDescription.constants.ambientColor,  material.ambientColor);
+      storeVec3(materialDescription.constants.emissiveColor, material.emissiveColor);
+      storeVec3(materialDescription.constants.diffuseColor,  material.diffuseColor);
+      storeVec3(materialDescription.constants.specularColor, material.specularColor);
+      material.shininess = materialDescription.constants.shininess;
+
+      for (unsigned int j = 0; j < static_cast<unsigned int>(MaterialTextureTypes::count); ++j)
+      {
+         material.textureFilenameOffsets[j] = static_cast<std::uint32_t>(strings.size());
+         material.textureFilenameLengths[j] = static_cast<std::uint32_t>(materialDescription.textureFilenames[j].size());
+         strings += materialDescription.textureFilenames[j];
+      }
+   }
+
+   // Lay out the file
+   header.meshTableOffset     = sizeof(BakedModelHeader);
+   header.materialTableOffset = alignOffset(header.meshTableOffset + header.numOfMeshes * sizeof(BakedMesh), alignof(BakedMaterial));
+   header.stringsOffset       = header.materialTableOffset + header.numOfMaterials * sizeof(BakedMaterial);
+   header.stringsSizeInBytes  = strings.size();
+
+   std::uint64_t          offset = header.stringsOffset + header.stringsSizeInBytes;
+   std::vector<BakedMesh> meshes(importedModel.meshes.size());
+   for (std::size_t i = 0; i < importedModel.meshes.size(); ++i)
+   {
+      const ImportedMesh& importedMesh = importedModel.meshes[i];
+      BakedMesh&          mesh         = meshes[i];
+
+      mesh.numOfVertices    = importedMesh.numOfVertices;
+      mesh.numOfIndices     = importedMesh.numOfIndices;
+      mesh.indexSizeInBytes = importedMesh.indexSizeInBytes;
+      mesh.materialIndex    = importedMesh.materialIndex;
+
+      mesh.vertexDataOffset = alignOffset(offset, blobAlignmentInBytes);
+      mesh.indexDataOffset  = alignOffset(mesh.vertexDataOffset + importedMesh.vertexData.size(), blobAlignmentInBytes);
+      offset                = mesh.indexDataOffset + importedMesh.indexData.size();
+   }
+   header.fileSizeInBytes = offset;
+
+   // Fill the file in memory so that it can be written with a single call
+   std::vector<unsigned char> fileData(static_cast<std::size_t>(header.fileSizeInBytes), 0);
+   std::memcpy(&fileData[0], &header, sizeof(BakedModelHeader));
+   if (!meshes.empty())
+   {
+      std::memcpy(&fileData[header.meshTableOffset], meshes.data(), meshes.size() * sizeof(BakedMesh));
+   }
+   if (!materials.empty())
+   {
+      std::memcpy(&fileData[header.materialTableOffset], materials.data(), materials.size() * sizeof(BakedMaterial));
+   }
+   std::copy(strings.begin(), strings.end(), fileData.begin() + header.stringsOffset);
+   for (std::size_t i = 0; i < meshes.size(); ++i)
+   {
+      const ImportedMesh& importedMesh = importedModel.meshes[i];
+      std::copy(importedMesh.vertexData.begin(), importedMesh.vertexData.end(), fileData.begin() + meshes[i].vertexDataOffset);
+      std::copy(importedMesh.indexData.begin(),  importedMesh.indexData.end(),  fileData.begin() + meshes[i].indexDataOffset);
+   }
+
+   // The file is written under a temporary name and then renamed, so that an interrupted write never leaves a partial file behind
+   // std::rename doesn't replace existing files on every platform, which is why the old file is removed first
+   std::string tempFilePath = bakedModelFilePath + ".tmp";
+   {
+      std::ofstream file(tempFilePath, std::ios::binary | std::ios::trunc);
+      file.write(reinterpret_cast<const char*>(fileData.data()), static_cast<std::streamsize>(fileData.size()));
+
+      if (!file)
+      {
+         std::cout << "Error - writeBakedModel - Could not write the following baked model: " << bakedModelFilePath << "\n";
+         file.close();
+         std::remove(tempFilePath.c_str());
+         return false;
+      }
+   }
+
+   std::remove(bakedModelFilePath.c_str());
+   if (std::rename(tempFilePath.c_str(), bakedModelFilePath.c_str()) != 0)
+   {
+      std::cout << "Error - writeBakedModel - Could not rename the following baked model: " << tempFilePath << "\n";
+      std::remove(tempFilePath.c_str());
+      return false;
+   }
+
+   return true;
+}
+
+bool calculateFileHash(const std::string& filePath, std::uint64_t& hash)
+{
+   MappedFile file;
+   if (!file.open(filePath))
+   {
+      return false;
+   }
+
+   // 64-bit FNV-1a
+   hash = 14695981039346656037ull;
+   const unsigned char* data = file.getData();
+   for (std::size_t i = 0; i < file.getSize(); ++i)
+   {
+      hash ^= data[i];
+      hash *= 1099511628211ull;
+   }
+
+   return true;
+}
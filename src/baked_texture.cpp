@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+#include "baked_texture.h"
+
+namespace
+{
+   const std::uint32_t bakedTextureMagic = 0x58455442; // "BTEX"
+
+   // Must be incremented whenever the layout of the file or the processing of the textures changes (e.g. the mip filter, the choice of the format or the block encoders),
+   // so that the textures that were baked with the old version are baked again
+   const std::uint32_t bakedTextureVersion = 2;
+
+   // The levels are aligned so that the driver doesn't have to realign them before it copies them
+   const std::uint64_t blobAlignmentInBytes = 16;
+
+   // A mip chain can't be longer than the one of the largest texture that OpenGL supports
+   const std::uint32_t maxNumOfMipLevels = 32;
+
+   struct BakedTextureHeader
+   {
+      std::uint32_t magic;
+      std::uint32_t version;
+      std::uint64_t sourceHash;
+      std::uint32_t format;
+      std::uint32_t numOfSourceComponents;
+      std::uint32_t width;
+      std::uint32_t height;
+      std::uint32_t numOfMipLevels;
+      std::uint32_t colorSpace;
+      std::uint64_t mipLevelTableOffset;
+      std::uint64_t fileSizeInBytes;
+   };
+
+   struct BakedMipLevel
+   {
+      std::uint64_t blocksOffset;
+      std::uint64_t sizeInBytes;
+      std::uint32_t width;
+      std::uint32_t height;
+   };
+
+   std::uint64_t alignOffset(std::uint64_t offset, std::uint64_t alignment)
+   {
+      return (offset + alignment - 1) & ~(alignment - 1);
+   }
+
+   // Checks that the given range lies within a file of the given size, without overflowing
+   bool isRangeInFile(std::uint64_t offset, std::uint64_t sizeInBytes, std::uint64_t fileSizeInBytes)
+   {
+      return (offset <= fileSizeInBytes) && (sizeInBytes <= fileSizeInBytes - offset);
+   }
+}
+
+bool BakedTexture::open(const std::string& bakedTextureFilePath, const BakedTextureKey& key)
+{
+   if (!mFile.open(bakedTextureFilePath))
+   {
+      return false;
+   }
+
+   const unsigned char* data     = mFile.getData();
+   std::uint64_t        fileSize = mFile.getSize();
+
+   // The header is at the beginning of the mapping, which is page-aligned
+   const BakedTextureHeader* header = reinterpret_cast<const BakedTextureHeader*>(data);
+   if (fileSize < sizeof(BakedTextureHeader)                          ||
+       header->magic      != bakedTextureMagic                         ||
+       header->version    != bakedTextureVersion                       ||
+       header->sourceHash != key.sourceHash                            ||
+       header->colorSpace != static_cast<std::uint32_t>(key.colorSpace))
+   {
+      mFile.close();
+      return false;
+   }
+
+   // From this point on, the file claims to be up to date, so anything that doesn't add up means that it's corrupt (e.g. because writing it was interrupted)
+   // The format is only used to check the sizes of the levels once it's known to be valid
+   CompressedTextureFormat format = static_cast<CompressedTextureFormat>(header->format);
+
+   bool isValid = (header->fileSizeInBytes == fileSize)                                                 &&
+                  (header->format < static_cast<std::uint32_t>(CompressedTextureFormat::count))          &&
+                  (header->width > 0) && (header->height > 0)                                           &&
+                  (header->numOfMipLevels > 0) && (header->numOfMipLevels <= maxNumOfMipLevels)         &&
+                  (header->mipLevelTableOffset % alignof(BakedMipLevel) == 0)                           &&
+                  isRangeInFile(header->mipLevelTableOffset, header->numOfMipLevels * sizeof(BakedMipLevel), fileSize);
+
+   // Each level must be half the size of the previous one, and its blocks must cover it
+   const BakedMipLevel* mipLevels = reinterpret_cast<const BakedMipLevel*>(data + header->mipLevelTableOffset);
+   std::uint32_t        width     = header->width;
+   std::uint32_t        height    = header->height;
+   for (std::uint32_t i = 0; isValid && i < header->numOfMipLevels; ++i)
+   {
+      const BakedMipLevel& mipLevel = mipLevels[i];
+      isValid = (mipLevel.width == width) && (mipLevel.height == height)                                                              &&
+                (mipLevel.sizeInBytes == calculateCompressedSizeInBytes(format, static_cast<int>(width), static_cast<int>(height)))     &&
+                isRangeInFile(mipLevel.blocksOffset, mipLevel.sizeInBytes, fileSize);
+
+      width  = std::max(width  / 2, 1u);
+      height = std::max(height / 2, 1u);
+   }
+
+   if (!isValid)
+   {
+      std::cout << "Error - BakedTexture::open - The following baked texture is corrupt and will be baked again: " << bakedTextureFilePath << "\n";
+      mFile.close();
+      return false;
+   }
+
+   return true;
+}
+
+bool BakedTexture::isOpen() const
+{
+   return mFile.isOpen();
+}
+
+CompressedTextureFormat BakedTexture::getFormat() const
+{
+   return static_cast<CompressedTextureFormat>(reinterpret_cast<const BakedTextureHeader*>(mFile.getData())->format);
+}
+
+int BakedTexture::getWidth() const
+{
+   return static_cast<int>(reinterpret_cast<const BakedTextureHeader*>(mFile.getData())->width);
+}
+
+int BakedTexture::getHeight() const
+{
+   return static_cast<int>(reinterpret_cast<const BakedTextureHeader*>(mFile.getData())->height);
+}
+
+int BakedTexture::getNumOfSourceComponents() const
+{
+   return static_cast<int>(reinterpret_cast<const BakedTextureHeader*>(mFile.getData())->numOfSourceComponents);
+}
+
+std::vector<CompressedMipLevelView> BakedTexture::getMipLevels() const
+{
+   const unsigned char*      data      = mFile.getData();
+   const BakedTextureHeader* header    = reinterpret_cast<const BakedTextureHeader*>(data);
+   const BakedMipLevel*      mipLevels = reinterpret_cast<const BakedMipLevel*>(data + header->mipLevelTableOffset);
+
+   std::vector<CompressedMipLevelView> mipLevelViews;
+   mipLevelViews.reserve(header->numOfMipLevels);
+
+   for (std::uint32_t i = 0; i < header->numOfMipLevels; ++i)
+   {
+      mipLevelViews.push_back(CompressedMipLevelView{data + mipLevels[i].blocksOffset,
+                                                     static_cast<std::size_t>(mipLevels[i].sizeInBytes),
+                                                     static_cast<int>(mipLevels[i].width),
+                                                     static_cast<int>(mipLevels[i].height)});
+   }
+
+   return mipLevelViews;
+}
+
+bool writeBakedTexture(const std::string&                     bakedTextureFilePath,
+                       const BakedTextureKey&                 key,
+                       CompressedTextureFormat                format,
+                       int                                    numOfSourceComponents,
+                       const std::vector<CompressedMipLevel>& mipLevels)
+{
+   if (mipLevels.empty() || mipLevels.size() > maxNumOfMipLevels)
+   {
+      std::cout << "Error - writeBakedTexture - The mip chain has an invalid number of levels: " << mipLevels.size() << "\n";
+      return false;
+   }
+
+   BakedTextureHeader header = {};
+   header.magic                 = bakedTextureMagic;
+   header.version               = bakedTextureVersion;
+   header.sourceHash            = key.sourceHash;
+   header.format                = static_cast<std::uint32_t>(format);
+   header.numOfSourceComponents = static_cast<std::uint32_t>(numOfSourceComponents);
+   header.width                 = static_cast<std::uint32_t>(mipLevels[0].width);
+   header.height                = static_cast<std::uint32_t>(mipLevels[0].height);
+   header.numOfMipLevels        = static_cast<std::uint32_t>(mipLevels.size());
+   header.colorSpace            = static_cast<std::uint32_t>(key.colorSpace);
+
+   // Lay out the file
+   header.mipLevelTableOffset = sizeof(BakedTextureHeader);
+
+   std::uint64_t              offset = header.mipLevelTableOffset + header.numOfMipLevels * sizeof(BakedMipLevel);
+   std::vector<BakedMipLevel> bakedMipLevels(mipLevels.size());
+   for (std::size_t i = 0; i < mipLevels.size(); ++i)
+   {
+      bakedMipLevels[i].blocksOffset = alignOffset(offset, blobAlignmentInBytes);
+      bakedMipLevels[i].sizeInBytes  = mipLevels[i].blocks.size();
+      bakedMipLevels[i].width        = static_cast<std::uint32_t>(mipLevels[i].width);
+      bakedMipLevels[i].height       = static_cast<std::uint32_t>(mipLevels[i].height);
+      offset                         = bakedMipLevels[i].blocksOffset + bakedMipLevels[i].sizeInBytes;
+   }
+   header.fileSizeInBytes = offset;
+
+   // Fill the file in memory so that it can be written with a single call
+   std::vector<unsigned char> fileData(static_cast<std::size_t>(header.fileSizeInBytes), 0);
+   std::memcpy(&fileData[0], &header, sizeof(BakedTextureHeader));
+   std::memcpy(&fileData[header.mipLevelTableOffset], bakedMipLevels.data(), bakedMipLevels.size() * sizeof(BakedMipLevel));
+   for (std::size_t i = 0; i < mipLevels.size(); ++i)
+   {
+      std::copy(mipLevels[i].blocks.begin(), mipLevels[i].blocks.end(), fileData.begin() + bakedMipLevels[i].blocksOffset);
+   }
+
+   // The file is written under a temporary name and then renamed, so that an interrupted write never leaves a partial file behind
+   // Models that share a texture can bake it at the same time on different threads, so each thread writes its own temporary file
+   // std::rename doesn't replace existing files on every platform, which is why the old file is removed first
+   std::string tempFilePath = bakedTextureFilePath + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+   {
+      std::ofstream file(tempFilePath, std::ios::binary | std::ios::trunc);
+      file.write(reinterpret_cast<const char*>(fileData.data()), static_cast<std::streamsize>(fileData.size()));
+
+      if (!file)
+      {
+         std::cout << "Error - writeBakedTexture - Could not write the following baked texture: " << bakedTextureFilePath << "\n";
+         file.close();
+         std::remove(tempFilePath.c_str());
+         return false;
+      }
+   }
+
+   std::remove(bakedTextureFilePath.c_str());
+   if (std::rename(tempFilePath.c_str(), bakedTextureFilePath.c_str()) != 0)
+   {
+      std::cout << "Error - writeBakedTexture - Could not rename the following baked texture: " << tempFilePath << "\n";
+      std::remove(tempFilePath.c_str());
+      return false;
+   }
+
+   return true;
+}
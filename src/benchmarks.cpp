@@ -0,0 +1,1189 @@
+#include <glm/gtc/matrix_transform.hpp>
+#include <stb_image/stb_image.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "allocation_tracker.h"
+#include "baked_model.h"
+#include "baked_texture.h"
+#include "game_object_3D.h"
+#include "mesh_optimizer.h"
+#include "model_loader.h"
+#include "obj_parser.h"
+#include "object_pool.h"
+#include "parallel_for.h"
+#include "qtangent.h"
+#include "resource_manager.h"
+#include "string_id.h"
+#include "texture_compression.h"
+#include "texture_loader.h"
+#include "benchmarks.h"
+
+namespace
+{
+   double getElapsedTimeInSec(std::chrono::steady_clock::time_point start)
+   {
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   }
+
+   // The OBJ parser is meant to be a drop-in replacement for Assimp, so the processed meshes and materials of both importers should match byte for byte
+   // When they don't, the index of the first mesh or material that differs is returned through the given index, which is the size of the shorter list if only the sizes differ
+   bool areMeshesEqual(const ImportedModel& lhs, const ImportedModel& rhs, std::size_t& firstDifferentMeshIndex)
+   {
+      std::size_t numOfMeshes = std::min(lhs.meshes.size(), rhs.meshes.size());
+      for (firstDifferentMeshIndex = 0; firstDifferentMeshIndex < numOfMeshes; ++firstDifferentMeshIndex)
+      {
+         const ImportedMesh& lhsMesh = lhs.meshes[firstDifferentMeshIndex];
+         const ImportedMesh& rhsMesh = rhs.meshes[firstDifferentMeshIndex];
+         if ((lhsMesh.vertexData != rhsMesh.vertexData) || (lhsMesh.indexData != rhsMesh.indexData) || (lhsMesh.materialIndex != rhsMesh.materialIndex))
+         {
+            return false;
+         }
+      }
+
+      return lhs.meshes.size() == rhs.meshes.size();
+   }
+
+   bool areMaterialsEqual(const ImportedModel& lhs, const ImportedModel& rhs, std::size_t& firstDifferentMaterialIndex)
+   {
+      std::size_t numOfMaterials = std::min(lhs.materials.size(), rhs.materials.size());
+      for (firstDifferentMaterialIndex = 0; firstDifferentMaterialIndex < numOfMaterials; ++firstDifferentMaterialIndex)
+      {
+         const MaterialDescription& lhsMaterial = lhs.materials[firstDifferentMaterialIndex];
+         const MaterialDescription& rhsMaterial = rhs.materials[firstDifferentMaterialIndex];
+         if ((lhsMaterial.textureFilenames        != rhsMaterial.textureFilenames)        ||
+             (lhsMaterial.constants.ambientColor  != rhsMaterial.constants.ambientColor)  ||
+             (lhsMaterial.constants.emissiveColor != rhsMaterial.constants.emissiveColor) ||
+             (lhsMaterial.constants.diffuseColor  != rhsMaterial.constants.diffuseColor)  ||
+             (lhsMaterial.constants.specularColor != rhsMaterial.constants.specularColor) ||
+             (lhsMaterial.constants.shininess     != rhsMaterial.constants.shininess))
+         {
+            return false;
+         }
+      }
+
+      return lhs.materials.size() == rhs.materials.size();
+   }
+
+   // CPU equivalent of the transform that game_object_3D.vs applies to each vertex
+   glm::vec3 transformByInstance(const InstanceTransform& instanceTransform, const glm::vec3& point)
+   {
+      return glm::vec3(instanceTransform.positionAndScale) + (instanceTransform.rotation * (point * instanceTransform.positionAndScale.w));
+   }
+
+   struct StressTestResource
+   {
+      ResourceFootprint getFootprint() const
+      {
+         return ResourceFootprint{sizeof(StressTestResource), 64 * 1024};
+      }
+
+      unsigned int id;
+   };
+
+   // Simulates a slow load (e.g. reading a file) and counts how many times each resource is loaded
+   class StressTestResourceLoader
+   {
+   public:
+
+      std::shared_ptr<StressTestResource> loadResource(unsigned int id, std::vector<std::atomic<unsigned int>>& numOfLoadsPerID) const
+      {
+         std::this_thread::sleep_for(std::chrono::milliseconds(2));
+         numOfLoadsPerID[id].fetch_add(1, std::memory_order_relaxed);
+         return std::make_shared<StressTestResource>(StressTestResource{id});
+      }
+   };
+}
+
+void runObjectPoolBenchmark()
+{
+   // We keep a fixed number of objects alive and repeatedly destroy a random one and spawn a new one in its place
+   const unsigned int numOfLiveObjects = 10000;
+   const unsigned int numOfChurnOps    = 1000000;
+   const double       targetOpsPerSec  = 100000.0;
+
+   std::vector<unsigned int> indices(numOfChurnOps);
+   std::mt19937              randomNumberGenerator(0);
+   for (unsigned int& index : indices)
+   {
+      index = randomNumberGenerator() % numOfLiveObjects;
+   }
+
+   // The objects are never rendered, so they don't need a model
+   // The handle is declared once, since converting a std::shared_ptr into a handle allocates its shared state, which would be counted as part of every operation
+   ResourceHandle<Model> model;
+
+   // std::make_shared
+   double             sharedPtrTimeInSec = 0.0;
+   unsigned long long sharedPtrNumOfAllocations = 0;
+   {
+      std::vector<std::shared_ptr<GameObject3D>> objects;
+      objects.reserve(numOfLiveObjects);
+      for (unsigned int i = 0; i < numOfLiveObjects; ++i)
+      {
+         objects.push_back(std::make_shared<GameObject3D>(model, glm::vec3(0.0f), 0.0f, glm::vec3(0.0f, 1.0f, 0.0f), 1.0f));
+      }
+
+      unsigned long long numOfAllocationsBefore = getTotalNumOfHeapAllocations();
+      auto               start                  = std::chrono::steady_clock::now();
+
+      for (unsigned int index : indices)
+      {
+         objects[index] = std::make_shared<GameObject3D>(model, glm::vec3(static_cast<float>(index)), 0.0f, glm::vec3(0.0f, 1.0f, 0.0f), 1.0f);
+      }
+
+      sharedPtrTimeInSec        = getElapsedTimeInSec(start);
+      sharedPtrNumOfAllocations = getTotalNumOfHeapAllocations() - numOfAllocationsBefore;
+   }
+
+   // ObjectPool
+   double             poolTimeInSec = 0.0;
+   unsigned long long poolNumOfAllocations = 0;
+   bool               staleHandlesDetected = true;
+   {
+      ObjectPool<GameObject3D>          pool;
+      std::vector<Handle<GameObject3D>> handles;
+      handles.reserve(numOfLiveObjects);
+      for (unsigned int i = 0; i < numOfLiveObjects; ++i)
+      {
+         handles.push_back(pool.create(model, glm::vec3(0.0f), 0.0f, glm::vec3(0.0f, 1.0f, 0.0f), 1.0f));
+      }
+
+      unsigned long long numOfAllocationsBefore = getTotalNumOfHeapAllocations();
+      auto               start                  = std::chrono::steady_clock::now();
+
+      for (unsigned int index : indices)
+      {
+         pool.destroy(handles[index]);
+         handles[index] = pool.create(model, glm::vec3(static_cast<float>(index)), 0.0f, glm::vec3(0.0f, 1.0f, 0.0f), 1.0f);
+      }
+
+      poolTimeInSec        = getElapsedTimeInSec(start);
+      poolNumOfAllocations = getTotalNumOfHeapAllocations() - numOfAllocationsBefore;
+
+      // A handle to a destroyed object must not resolve, even after its slot has been reused
+      Handle<GameObject3D> staleHandle = handles[0];
+      pool.destroy(handles[0]);
+      handles[0] = pool.create(model, glm::vec3(0.0f), 0.0f, glm::vec3(0.0f, 1.0f, 0.0f), 1.0f);
+      staleHandlesDetected = (pool.get(staleHandle) == nullptr) && (pool.get(handles[0]) != nullptr);
+   }
+
+   double sharedPtrOpsPerSec = numOfChurnOps / sharedPtrTimeInSec;
+   double poolOpsPerSec      = numOfChurnOps / poolTimeInSec;
+
+   std::cout << "Info - runObjectPoolBenchmark - Spawn/despawn churn of GameObject3D with " << numOfLiveObjects << " live objects and " << numOfChurnOps << " operations" << "\n";
+   std::cout << "std::make_shared: " << sharedPtrOpsPerSec << " ops/s - " << sharedPtrNumOfAllocations << " heap allocations" << "\n";
+   std::cout << "ObjectPool:       " << poolOpsPerSec << " ops/s - " << poolNumOfAllocations << " heap allocations" << "\n";
+   if (!isHeapAllocationTrackingEnabled())
+   {
+      std::cout << "The heap allocations are not tracked in this build (define TRACK_HEAP_ALLOCATIONS to track them)" << "\n";
+   }
+   std::cout << "Target of " << targetOpsPerSec << " ops/s " << ((poolOpsPerSec >= targetOpsPerSec) ? "met" : "NOT met") << "\n";
+   std::cout << "Stale handles " << (staleHandlesDetected ? "are" : "are NOT") << " detected" << "\n";
+}
+
+void runInstanceTransformBenchmark()
+{
+   // We prepare the per instance data of a large number of instances for several frames,
+   // once as model matrices (the old format) and once as instance transforms (the new format)
+   const unsigned int numOfInstances = 100000;
+   const unsigned int numOfFrames    = 100;
+
+   std::vector<glm::vec3>    positions(numOfInstances);
+   std::vector<quat>         rotations(numOfInstances);
+   std::vector<float>        scalingFactors(numOfInstances);
+   std::mt19937              randomNumberGenerator(0);
+   std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+   for (unsigned int i = 0; i < numOfInstances; ++i)
+   {
+      positions[i]      = glm::vec3(distribution(randomNumberGenerator), distribution(randomNumberGenerator), distribution(randomNumberGenerator)) * 100.0f;
+      rotations[i]      = angleAxis(distribution(randomNumberGenerator) * 3.14159265f,
+                                    glm::normalize(glm::vec3(distribution(randomNumberGenerator), distribution(randomNumberGenerator), 1.0f)));
+      scalingFactors[i] = 0.5f + (distribution(randomNumberGenerator) + 1.0f);
+   }
+
+   // Model matrices
+   std::vector<glm::mat4> modelMatrices(numOfInstances);
+   auto                   start = std::chrono::steady_clock::now();
+   for (unsigned int frame = 0; frame < numOfFrames; ++frame)
+   {
+      for (unsigned int i = 0; i < numOfInstances; ++i)
+      {
+         glm::mat4 modelMatrix = glm::translate(glm::mat4(1.0f), positions[i]);
+         modelMatrix          *= quatToMat4(rotations[i]);
+         modelMatrices[i]      = glm::scale(modelMatrix, glm::vec3(scalingFactors[i]));
+      }
+   }
+   double modelMatricesTimeInSec = getElapsedTimeInSec(start);
+
+   // Instance transforms
+   std::vector<InstanceTransform> instanceTransforms(numOfInstances, InstanceTransform(glm::vec3(0.0f), 1.0f, quat()));
+   start = std::chrono::steady_clock::now();
+   for (unsigned int frame = 0; frame < numOfFrames; ++frame)
+   {
+      for (unsigned int i = 0; i < numOfInstances; ++i)
+      {
+         instanceTransforms[i] = InstanceTransform(positions[i], scalingFactors[i], rotations[i]);
+      }
+   }
+   double instanceTransformsTimeInSec = getElapsedTimeInSec(start);
+
+   // Both formats must place the vertices in the same spot
+   float maxError = 0.0f;
+   for (unsigned int i = 0; i < numOfInstances; ++i)
+   {
+      glm::vec3 point(1.0f, 2.0f, 3.0f);
+      glm::vec3 difference = glm::vec3(modelMatrices[i] * glm::vec4(point, 1.0f)) - transformByInstance(instanceTransforms[i], point);
+      maxError = std::max(maxError, glm::length(difference));
+   }
+
+   double modelMatricesNsPerInstance      = (modelMatricesTimeInSec * 1e9) / (static_cast<double>(numOfInstances) * numOfFrames);
+   double instanceTransformsNsPerInstance = (instanceTransformsTimeInSec * 1e9) / (static_cast<double>(numOfInstances) * numOfFrames);
+   double modelMatricesMBPerFrame         = (static_cast<double>(numOfInstances) * sizeof(glm::mat4)) / (1024.0 * 1024.0);
+   double instanceTransformsMBPerFrame    = (static_cast<double>(numOfInstances) * sizeof(InstanceTransform)) / (1024.0 * 1024.0);
+
+   std::cout << "Info - runInstanceTransformBenchmark - Per instance data of " << numOfInstances << " instances prepared over " << numOfFrames << " frames" << "\n";
+   std::cout << "Model matrices:      " << modelMatricesNsPerInstance << " ns/instance - " << modelMatricesMBPerFrame << " MB uploaded per frame" << "\n";
+   std::cout << "Instance transforms: " << instanceTransformsNsPerInstance << " ns/instance - " << instanceTransformsMBPerFrame << " MB uploaded per frame" << "\n";
+   std::cout << "Max distance between the vertices transformed by both formats: " << maxError << "\n";
+}
+
+void runQTangentBenchmark()
+{
+   // We encode a large number of random tangent frames, half of which are reflected, and then read them back for several passes,
+   // once as separate tangents, bitangents and normals (what normal mapping would need without QTangents) and once as QTangents quantized to 16-bit snorms
+   const unsigned int numOfVertices = 1000000;
+   const unsigned int numOfPasses   = 20;
+
+   struct TangentFrame
+   {
+      glm::vec3 tangent;
+      glm::vec3 bitangent;
+      glm::vec3 normal;
+   };
+
+   std::vector<TangentFrame>             tangentFrames;
+   std::mt19937                          randomNumberGenerator(0);
+   std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+   tangentFrames.reserve(numOfVertices);
+   for (unsigned int i = 0; i < numOfVertices; ++i)
+   {
+      quat rotation = angleAxis(distribution(randomNumberGenerator) * 3.14159265f,
+                                glm::normalize(glm::vec3(distribution(randomNumberGenerator), distribution(randomNumberGenerator), distribution(randomNumberGenerator) + 2.0f)));
+      float bitangentSign = (i % 2 == 0) ? 1.0f : -1.0f;
+      tangentFrames.push_back(TangentFrame{rotation * glm::vec3(1.0f, 0.0f, 0.0f), bitangentSign * (rotation * glm::vec3(0.0f, 1.0f, 0.0f)), rotation * glm::vec3(0.0f, 0.0f, 1.0f)});
+   }
+
+   // Encoding, which is what ModelLoader does for each vertex
+   std::vector<glm::i16vec4> qTangents(numOfVertices);
+   auto                      start = std::chrono::steady_clock::now();
+   for (unsigned int i = 0; i < numOfVertices; ++i)
+   {
+      quat qTangent = encodeQTangent(tangentFrames[i].tangent, tangentFrames[i].bitangent, tangentFrames[i].normal);
+      qTangents[i]  = glm::i16vec4(glm::round(glm::vec4(qTangent.x, qTangent.y, qTangent.z, qTangent.w) * 32767.0f));
+   }
+   double encodingTimeInSec = getElapsedTimeInSec(start);
+
+   // Fetching, which is what the vertex shader does for each vertex
+   // The sums keep the compiler from optimizing the loops away
+   glm::vec3 tangentFramesSum(0.0f);
+   start = std::chrono::steady_clock::now();
+   for (unsigned int pass = 0; pass < numOfPasses; ++pass)
+   {
+      for (const TangentFrame& tangentFrame : tangentFrames)
+      {
+         tangentFramesSum += tangentFrame.tangent + tangentFrame.bitangent + tangentFrame.normal;
+      }
+   }
+   double tangentFramesTimeInSec = getElapsedTimeInSec(start);
+
+   glm::vec3 qTangentsSum(0.0f);
+   start = std::chrono::steady_clock::now();
+   for (unsigned int pass = 0; pass < numOfPasses; ++pass)
+   {
+      for (const glm::i16vec4& qTangent : qTangents)
+      {
+         glm::vec3 tangent, bitangent, normal;
+         decodeQTangent(quat(qTangent.x / 32767.0f, qTangent.y / 32767.0f, qTangent.z / 32767.0f, qTangent.w / 32767.0f), tangent, bitangent, normal);
+         qTangentsSum += tangent + bitangent + normal;
+      }
+   }
+   double qTangentsTimeInSec = getElapsedTimeInSec(start);
+
+   // The decoded frames must match the original ones, including the reflections
+   float        maxAngleInDeg        = 0.0f;
+   unsigned int numOfLostReflections = 0;
+   for (unsigned int i = 0; i < numOfVertices; ++i)
+   {
+      glm::vec3 tangent, bitangent, normal;
+      decodeQTangent(quat(qTangents[i].x / 32767.0f, qTangents[i].y / 32767.0f, qTangents[i].z / 32767.0f, qTangents[i].w / 32767.0f), tangent, bitangent, normal);
+
+      // The angles are calculated from the chords between the unit vectors, since the acos of their dot products is too imprecise for such small angles
+      const TangentFrame& original = tangentFrames[i];
+      float maxChord = std::max(glm::length(tangent - original.tangent), std::max(glm::length(bitangent - original.bitangent), glm::length(normal - original.normal)));
+      maxAngleInDeg = std::max(maxAngleInDeg, glm::degrees(2.0f * std::asin(std::min(0.5f * maxChord, 1.0f))));
+
+      if (glm::dot(bitangent, original.bitangent) < 0.0f)
+      {
+         ++numOfLostReflections;
+      }
+   }
+
+   double tangentFramesNsPerVertex = (tangentFramesTimeInSec * 1e9) / (static_cast<double>(numOfVertices) * numOfPasses);
+   double qTangentsNsPerVertex     = (qTangentsTimeInSec * 1e9) / (static_cast<double>(numOfVertices) * numOfPasses);
+
+   std::cout << "Info - runQTangentBenchmark - Tangent frames of " << numOfVertices << " vertices encoded once and fetched over " << numOfPasses << " passes" << "\n";
+   std::cout << "Encoding:        " << (encodingTimeInSec * 1e9) / numOfVertices << " ns/vertex" << "\n";
+   std::cout << "Tangent frames:  " << tangentFramesNsPerVertex << " ns/vertex - " << sizeof(TangentFrame) << " bytes/vertex (sum " << tangentFramesSum.x << ")" << "\n";
+   std::cout << "QTangents:       " << qTangentsNsPerVertex << " ns/vertex - " << sizeof(glm::i16vec4) << " bytes/vertex (sum " << qTangentsSum.x << ")" << "\n";
+   std::cout << "Vertex sizes:    " << sizeof(Vertex) << " bytes (standard), " << sizeof(CompactVertex) << " bytes (compact), "
+             << sizeof(glm::vec3) + sizeof(TangentFrame) + sizeof(glm::vec2) << " bytes with separate tangents, bitangents and normals" << "\n";
+   std::cout << "Max angle between the original and the decoded vectors: " << maxAngleInDeg << " degrees" << "\n";
+   std::cout << "Lost reflections: " << numOfLostReflections << "\n";
+}
+
+void runMeshOptimizerBenchmark(const char* modelFilePath)
+{
+   // The meshes are imported by ModelLoader::importModel, with the importer that the game uses, and the optimization that it runs on them is reported
+   // They are never uploaded, so no OpenGL context is needed
+   ModelLoader                         modelLoader;
+   ImportedModel                       importedModel;
+   std::vector<MeshOptimizationReport> reports;
+   if (!modelLoader.importModel(modelFilePath, VertexFormat::compact, importedModel, 0, &reports))
+   {
+      std::cout << "Error - runMeshOptimizerBenchmark - The following model could not be imported: " << modelFilePath << "\n";
+      return;
+   }
+
+   const char* stageNames[] = {"Welding:      ", "Vertex cache: ", "Overdraw:     ", "Vertex fetch: "}; // Indexed with MeshOptimizationStage
+
+   std::cout << "Info - runMeshOptimizerBenchmark - Optimization of the meshes of " << modelFilePath << " (ACMR and ATVR of a FIFO cache of " << vertexCacheSizeForStatistics << " vertices)" << "\n";
+   for (std::size_t i = 0; i < importedModel.meshes.size(); ++i)
+   {
+      std::cout << "Mesh " << i << " - " << importedModel.meshes[i].numOfIndices / 3 << " triangles" << "\n";
+      for (unsigned int stage = 0; stage < static_cast<unsigned int>(MeshOptimizationStage::count); ++stage)
+      {
+         const MeshOptimizationStageReport& stageReport = reports[i].stages[stage];
+         std::cout << stageNames[stage]
+                   << "vertices " << stageReport.numOfVerticesBefore << " -> " << stageReport.numOfVerticesAfter
+                   << " - ACMR " << stageReport.before.acmr << " -> " << stageReport.after.acmr
+                   << " - ATVR " << stageReport.before.atvr << " -> " << stageReport.after.atvr
+                   << " - " << stageReport.timeInMs << " ms" << "\n";
+      }
+   }
+}
+
+void runModelCacheBenchmark(const char* modelFilePath)
+{
+   // Both paths stop where ModelLoader::loadResource starts uploading, since the upload needs an OpenGL context
+   // The warm path reads every byte of the blobs instead, which is what the upload does to the mapped pages
+   // The files are in the file cache of the OS after the first run, so the times don't include reading them from the disk
+   const unsigned int numOfRuns    = 10;
+   const VertexFormat vertexFormat = VertexFormat::compact;
+
+   ModelLoader modelLoader;
+   std::string bakedModelFilePath = std::string(modelFilePath) + ".benchmark.bakedmodel";
+
+   BakedModelKey key;
+   if (!modelLoader.calculateBakedModelKey(modelFilePath, vertexFormat, key))
+   {
+      std::cout << "Error - runModelCacheBenchmark - The following model could not be read: " << modelFilePath << "\n";
+      return;
+   }
+
+   // Assimp path without baking, which is what every load did before the models were baked
+   double importTimeInSec = 0.0;
+   for (unsigned int i = 0; i < numOfRuns; ++i)
+   {
+      auto          start = std::chrono::steady_clock::now();
+      ImportedModel importedModel;
+      if (!modelLoader.importModelWithAssimp(modelFilePath, vertexFormat, importedModel))
+      {
+         return;
+      }
+      importTimeInSec += getElapsedTimeInSec(start);
+   }
+
+   // Cold load, which hashes the model file, misses the cache, imports the model and bakes it
+   double coldTimeInSec = 0.0;
+   for (unsigned int i = 0; i < numOfRuns; ++i)
+   {
+      std::remove(bakedModelFilePath.c_str());
+
+      auto          start = std::chrono::steady_clock::now();
+      BakedModelKey coldKey;
+      BakedModel    bakedModel;
+      ImportedModel importedModel;
+      if (!modelLoader.calculateBakedModelKey(modelFilePath, vertexFormat, coldKey) ||
+          bakedModel.open(bakedModelFilePath, coldKey)                              ||
+          !modelLoader.importModel(modelFilePath, vertexFormat, importedModel)      ||
+          !writeBakedModel(bakedModelFilePath, coldKey, importedModel))
+      {
+         std::cout << "Error - runModelCacheBenchmark - The cold load did not go through the import path" << "\n";
+         return;
+      }
+      coldTimeInSec += getElapsedTimeInSec(start);
+   }
+
+   // Warm load, which hashes the model file and maps the baked model
+   double        warmTimeInSec = 0.0;
+   double        hashTimeInSec = 0.0;
+   unsigned int  checksum      = 0;
+   std::size_t   numOfBytes    = 0;
+   std::uint64_t bakedSize     = 0;
+   for (unsigned int i = 0; i < numOfRuns; ++i)
+   {
+      auto          start = std::chrono::steady_clock::now();
+      BakedModelKey warmKey;
+      BakedModel    bakedModel;
+      if (!modelLoader.calculateBakedModelKey(modelFilePath, vertexFormat, warmKey))
+      {
+         return;
+      }
+      hashTimeInSec += getElapsedTimeInSec(start);
+
+      if (!bakedModel.open(bakedModelFilePath, warmKey))
+      {
+         std::cout << "Error - runModelCacheBenchmark - The warm load missed the cache" << "\n";
+         return;
+      }
+
+      std::vector<MaterialDescription> materials = bakedModel.getMaterials();
+      numOfBytes = 0;
+      for (const MeshDataView& meshView : bakedModel.getMeshViews())
+      {
+         const unsigned char* vertexData = static_cast<const unsigned char*>(meshView.vertexData);
+         const unsigned char* indexData  = static_cast<const unsigned char*>(meshView.indexData);
+         std::size_t          vertexSize = meshView.numOfVertices * ((vertexFormat == VertexFormat::compact) ? sizeof(CompactVertex) : sizeof(Vertex));
+         std::size_t          indexSize  = meshView.numOfIndices * meshView.indexSizeInBytes;
+
+         checksum   += std::accumulate(vertexData, vertexData + vertexSize, 0u);
+         checksum   += std::accumulate(indexData, indexData + indexSize, 0u);
+         numOfBytes += vertexSize + indexSize;
+      }
+      warmTimeInSec += getElapsedTimeInSec(start);
+   }
+
+   MappedFile modelFile;
+   MappedFile bakedModelFile;
+   if (modelFile.open(modelFilePath) && bakedModelFile.open(bakedModelFilePath))
+   {
+      bakedSize = bakedModelFile.getSize();
+      std::cout << "Info - runModelCacheBenchmark - Loads of " << modelFilePath << " (" << modelFile.getSize() << " bytes) averaged over " << numOfRuns << " runs" << "\n";
+   }
+   bakedModelFile.close();
+   std::remove(bakedModelFilePath.c_str());
+
+   std::cout << "Assimp import:              " << (importTimeInSec * 1e3) / numOfRuns << " ms" << "\n";
+   std::cout << "Cold load (import + bake):  " << (coldTimeInSec * 1e3) / numOfRuns << " ms" << "\n";
+   std::cout << "Warm load (hash + map):     " << (warmTimeInSec * 1e3) / numOfRuns << " ms, of which " << (hashTimeInSec * 1e3) / numOfRuns << " ms hashing the model file (checksum " << checksum << ")" << "\n";
+   std::cout << "Speedup over Assimp:        " << importTimeInSec / warmTimeInSec << "x" << "\n";
+   std::cout << "Baked model:                " << bakedSize << " bytes, of which " << numOfBytes << " bytes of vertices and indices" << "\n";
+}
+
+void runObjParserBenchmark(const char* modelFilePath)
+{
+   // Both importers are timed up to the ImportedModel that ModelLoader::loadResource uploads, so the times include welding and optimizing the meshes
+   // The parse alone is timed separately for each number of threads, since it's the only stage that runs in parallel
+   // The files are in the file cache of the OS after the first run, so the times don't include reading them from the disk
+   const unsigned int numOfRuns    = 10;
+   const VertexFormat vertexFormat = VertexFormat::compact;
+
+   ModelLoader modelLoader;
+
+   double        assimpTimeInSec = 0.0;
+   ImportedModel assimpModel;
+   bool          hasAssimpModel  = true;
+   for (unsigned int i = 0; i < numOfRuns && hasAssimpModel; ++i)
+   {
+      auto start       = std::chrono::steady_clock::now();
+      hasAssimpModel   = modelLoader.importModelWithAssimp(modelFilePath, vertexFormat, assimpModel);
+      assimpTimeInSec += getElapsedTimeInSec(start);
+   }
+
+   double        objTimeInSec = 0.0;
+   ImportedModel objModel;
+   for (unsigned int i = 0; i < numOfRuns; ++i)
+   {
+      auto start = std::chrono::steady_clock::now();
+      if (!modelLoader.importObjModel(modelFilePath, vertexFormat, objModel))
+      {
+         std::cout << "Error - runObjParserBenchmark - The following model could not be imported with the OBJ parser: " << modelFilePath << "\n";
+         return;
+      }
+      objTimeInSec += getElapsedTimeInSec(start);
+   }
+
+   MappedFile modelFile;
+   if (modelFile.open(modelFilePath))
+   {
+      std::cout << "Info - runObjParserBenchmark - Imports of " << modelFilePath << " (" << modelFile.getSize() << " bytes) averaged over " << numOfRuns << " runs" << "\n";
+   }
+
+   if (hasAssimpModel)
+   {
+      std::cout << "Assimp import:              " << (assimpTimeInSec * 1e3) / numOfRuns << " ms" << "\n";
+   }
+   std::cout << "OBJ parser import:          " << (objTimeInSec * 1e3) / numOfRuns << " ms" << "\n";
+   if (hasAssimpModel)
+   {
+      std::cout << "Speedup over Assimp:        " << assimpTimeInSec / objTimeInSec << "x" << "\n";
+   }
+
+   std::vector<unsigned int> threadCounts = {1, 2, 4, 8};
+   if (std::find(threadCounts.begin(), threadCounts.end(), getDefaultNumOfThreads()) == threadCounts.end())
+   {
+      threadCounts.push_back(getDefaultNumOfThreads());
+   }
+
+   for (unsigned int numOfThreads : threadCounts)
+   {
+      double parseTimeInSec = 0.0;
+      for (unsigned int i = 0; i < numOfRuns; ++i)
+      {
+         auto     start = std::chrono::steady_clock::now();
+         ObjModel parsedModel;
+         parseObjModel(modelFilePath, parsedModel, numOfThreads);
+         parseTimeInSec += getElapsedTimeInSec(start);
+      }
+
+      std::cout << "OBJ parse with " << numOfThreads << " thread(s): " << (parseTimeInSec * 1e3) / numOfRuns << " ms" << "\n";
+   }
+
+   if (!hasAssimpModel)
+   {
+      return;
+   }
+
+   std::size_t firstDifferentMeshIndex     = 0;
+   std::size_t firstDifferentMaterialIndex = 0;
+   std::cout << "Meshes match Assimp's:      " << (areMeshesEqual(assimpModel, objModel, firstDifferentMeshIndex) ? "yes" : "no") << "\n";
+   std::cout << "Materials match Assimp's:   " << (areMaterialsEqual(assimpModel, objModel, firstDifferentMaterialIndex) ? "yes" : "no") << "\n";
+}
+
+bool verifyObjParser(const std::vector<std::string>& modelFilePaths)
+{
+   const VertexFormat vertexFormats[] = {VertexFormat::standard, VertexFormat::compact};
+
+   ModelLoader modelLoader;
+   bool        doAllModelsMatch = true;
+
+   for (const std::string& modelFilePath : modelFilePaths)
+   {
+      for (VertexFormat vertexFormat : vertexFormats)
+      {
+         const char* vertexFormatName = (vertexFormat == VertexFormat::standard) ? "standard" : "compact";
+
+         ImportedModel assimpModel;
+         ImportedModel objModel;
+         if (!modelLoader.importModelWithAssimp(modelFilePath, vertexFormat, assimpModel) || !modelLoader.importObjModel(modelFilePath, vertexFormat, objModel))
+         {
+            std::cout << "Error - verifyObjParser - The following model could not be imported with both importers: " << modelFilePath << "\n";
+            doAllModelsMatch = false;
+            continue;
+         }
+
+         std::size_t firstDifferentMeshIndex     = 0;
+         std::size_t firstDifferentMaterialIndex = 0;
+         bool        doMeshesMatch               = areMeshesEqual(assimpModel, objModel, firstDifferentMeshIndex);
+         bool        doMaterialsMatch            = areMaterialsEqual(assimpModel, objModel, firstDifferentMaterialIndex);
+
+         std::cout << modelFilePath << " (" << vertexFormatName << " vertex format): " << objModel.meshes.size() << " meshes, " << objModel.materials.size() << " materials" << "\n";
+         if (!doMeshesMatch)
+         {
+            std::cout << "Error - verifyObjParser - Mesh " << firstDifferentMeshIndex << " differs from Assimp's (" << objModel.meshes.size() << " meshes vs " << assimpModel.meshes.size() << ")" << "\n";
+         }
+
+         if (!doMaterialsMatch)
+         {
+            std::cout << "Error - verifyObjParser - Material " << firstDifferentMaterialIndex << " differs from Assimp's (" << objModel.materials.size() << " materials vs " << assimpModel.materials.size() << ")" << "\n";
+         }
+
+         doAllModelsMatch = doAllModelsMatch && doMeshesMatch && doMaterialsMatch;
+      }
+   }
+
+   std::cout << "Info - verifyObjParser - " << (doAllModelsMatch ? "The OBJ parser matches Assimp on every model" : "The OBJ parser does not match Assimp") << "\n";
+   return doAllModelsMatch;
+}
+
+void runLoadScalingBenchmark(const char* modelFilePath)
+{
+   // Times the two stages of a cold model load that run in parallel, for each number of threads:
+   // the import of the model (see ModelLoader::importModel) and the bake of its textures, which decodes each image and generates, compresses and writes its mip chain (see TextureLoader::bakeTexture)
+   // The upload is left out, since it needs an OpenGL context and it runs on the context thread anyway
+   // The files are in the file cache of the OS after the first run, so the times don't include reading them from the disk
+   const unsigned int numOfRuns    = 3;
+   const VertexFormat vertexFormat = VertexFormat::compact;
+
+   ModelLoader   modelLoader;
+   TextureLoader textureLoader;
+
+   ImportedModel importedModel;
+   if (!modelLoader.importModel(modelFilePath, vertexFormat, importedModel))
+   {
+      std::cout << "Error - runLoadScalingBenchmark - The following model could not be imported: " << modelFilePath << "\n";
+      return;
+   }
+
+   // Collect the textures of the materials once per color space, like ModelLoader::prepareResource does
+   std::string                                            modelDir = std::string(modelFilePath).substr(0, std::string(modelFilePath).find_last_of('/'));
+   std::vector<std::pair<std::string, TextureColorSpace>> textures;
+   for (const MaterialDescription& material : importedModel.materials)
+   {
+      for (unsigned int i = 0; i < static_cast<unsigned int>(MaterialTextureTypes::count); ++i)
+      {
+         TextureColorSpace colorSpace = (static_cast<MaterialTextureTypes>(i) == MaterialTextureTypes::specular) ? TextureColorSpace::linear : TextureColorSpace::srgb;
+         auto              texture    = std::make_pair(modelDir + '/' + material.textureFilenames[i], colorSpace);
+         if (!material.textureFilenames[i].empty() && std::find(textures.begin(), textures.end(), texture) == textures.end())
+         {
+            textures.push_back(texture);
+         }
+      }
+   }
+
+   std::cout << "Info - runLoadScalingBenchmark - Cold loads of " << modelFilePath << " (" << importedModel.meshes.size() << " meshes, " << textures.size() << " textures) averaged over " << numOfRuns << " runs, "
+             << getDefaultNumOfThreads() << " hardware threads" << "\n";
+
+   std::vector<unsigned int> threadCounts = {1, 2, 4, 8};
+   if (std::find(threadCounts.begin(), threadCounts.end(), getDefaultNumOfThreads()) == threadCounts.end())
+   {
+      threadCounts.push_back(getDefaultNumOfThreads());
+   }
+
+   double singleThreadedTimeInSec = 0.0;
+   for (unsigned int numOfThreads : threadCounts)
+   {
+      double importTimeInSec = 0.0;
+      double bakeTimeInSec   = 0.0;
+      for (unsigned int run = 0; run < numOfRuns; ++run)
+      {
+         auto          start = std::chrono::steady_clock::now();
+         ImportedModel model;
+         modelLoader.importModel(modelFilePath, vertexFormat, model, numOfThreads);
+         importTimeInSec += getElapsedTimeInSec(start);
+
+         for (const auto& texture : textures)
+         {
+            std::string     bakedTextureFilePath = texture.first + ".benchmark.bakedtexture";
+            BakedTextureKey key{0, texture.second};
+            DecodedTexture  decodedTexture;
+
+            start = std::chrono::steady_clock::now();
+            decodedTexture.data.reset(stbi_load(texture.first.c_str(), &decodedTexture.width, &decodedTexture.height, &decodedTexture.numComponents, 0));
+            if (decodedTexture.data)
+            {
+               textureLoader.bakeTexture(bakedTextureFilePath, key, decodedTexture, numOfThreads);
+            }
+            bakeTimeInSec += getElapsedTimeInSec(start);
+
+            std::remove(bakedTextureFilePath.c_str());
+         }
+      }
+
+      double totalTimeInSec = (importTimeInSec + bakeTimeInSec) / numOfRuns;
+      if (numOfThreads == 1)
+      {
+         singleThreadedTimeInSec = totalTimeInSec;
+      }
+
+      std::cout << numOfThreads << " thread(s): import " << (importTimeInSec * 1e3) / numOfRuns << " ms, texture bake " << (bakeTimeInSec * 1e3) / numOfRuns << " ms, total " << totalTimeInSec * 1e3 << " ms ("
+                << singleThreadedTimeInSec / totalTimeInSec << "x)" << "\n";
+   }
+}
+
+void runMeshProcessingBenchmark(const char* modelFilePath)
+{
+   // Without a model, a model with hundreds of meshes is generated, since the meshes are what the import is parallelized over
+   // Each mesh is a UV sphere with its own group and material, which is written as an OBJ file so that both importers can read it
+   const unsigned int numOfRuns    = 5;
+   const VertexFormat vertexFormat = VertexFormat::compact;
+
+   std::string generatedModelFilePath = "mesh_processing_benchmark.obj";
+   bool        isModelGenerated       = (modelFilePath == nullptr);
+   if (isModelGenerated)
+   {
+      const unsigned int numOfMeshes   = 400;
+      const unsigned int numOfSegments = 24;
+      const float        pi            = 3.14159265f;
+
+      FILE* file = std::fopen(generatedModelFilePath.c_str(), "w");
+      if (!file)
+      {
+         std::cout << "Error - runMeshProcessingBenchmark - The following model could not be created: " << generatedModelFilePath << "\n";
+         return;
+      }
+
+      // The vertices of each sphere are written right before its faces, which refer to them with negative indices
+      for (unsigned int i = 0; i < numOfMeshes; ++i)
+      {
+         glm::vec3 center(static_cast<float>(i % 20) * 3.0f, 0.0f, static_cast<float>(i / 20) * 3.0f);
+         for (unsigned int ring = 0; ring <= numOfSegments; ++ring)
+         {
+            for (unsigned int segment = 0; segment <= numOfSegments; ++segment)
+            {
+               float     theta  = pi * static_cast<float>(ring) / numOfSegments;
+               float     phi    = 2.0f * pi * static_cast<float>(segment) / numOfSegments;
+               glm::vec3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+               glm::vec3 position = center + normal;
+
+               std::fprintf(file, "v %f %f %f\nvt %f %f\nvn %f %f %f\n", position.x, position.y, position.z,
+                            static_cast<float>(segment) / numOfSegments, static_cast<float>(ring) / numOfSegments,
+                            normal.x, normal.y, normal.z);
+            }
+         }
+
+         std::fprintf(file, "g sphere%u\nusemtl material%u\n", i, i);
+
+         int numOfVerticesPerSphere = static_cast<int>((numOfSegments + 1) * (numOfSegments + 1));
+         for (unsigned int ring = 0; ring < numOfSegments; ++ring)
+         {
+            for (unsigned int segment = 0; segment < numOfSegments; ++segment)
+            {
+               int a = static_cast<int>(ring * (numOfSegments + 1) + segment) - numOfVerticesPerSphere;
+               int b = a + static_cast<int>(numOfSegments + 1);
+               std::fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, b + 1, b + 1, b + 1, a + 1, a + 1, a + 1);
+            }
+         }
+      }
+
+      std::fclose(file);
+      modelFilePath = generatedModelFilePath.c_str();
+   }
+
+   ModelLoader               modelLoader;
+   std::vector<unsigned int> threadCounts = {1, 2, 4, 8};
+   if (std::find(threadCounts.begin(), threadCounts.end(), getDefaultNumOfThreads()) == threadCounts.end())
+   {
+      threadCounts.push_back(getDefaultNumOfThreads());
+   }
+
+   // Both importers are measured, since the OBJ parser also parses and calculates the tangents in parallel, while Assimp only does it serially
+   std::array<const char*, 2> importerNames = {"Assimp", "OBJ parser"};
+   for (unsigned int importer = 0; importer < importerNames.size(); ++importer)
+   {
+      double singleThreadTimeInSec = 0.0;
+      for (unsigned int numOfThreads : threadCounts)
+      {
+         double        importTimeInSec = 0.0;
+         ImportedModel importedModel;
+         bool          isImported      = true;
+         for (unsigned int i = 0; i < numOfRuns && isImported; ++i)
+         {
+            auto start       = std::chrono::steady_clock::now();
+            isImported       = (importer == 0) ? modelLoader.importModelWithAssimp(modelFilePath, vertexFormat, importedModel, numOfThreads)
+                                               : modelLoader.importObjModel(modelFilePath, vertexFormat, importedModel, numOfThreads);
+            importTimeInSec += getElapsedTimeInSec(start);
+         }
+
+         if (!isImported)
+         {
+            std::cout << "Warning - runMeshProcessingBenchmark - The model could not be imported with " << importerNames[importer] << "\n";
+            break;
+         }
+
+         if (numOfThreads == 1)
+         {
+            singleThreadTimeInSec = importTimeInSec;
+            std::cout << "Info - runMeshProcessingBenchmark - Imports of " << modelFilePath << " (" << importedModel.meshes.size() << " meshes) with " << importerNames[importer] << " averaged over " << numOfRuns << " runs" << "\n";
+         }
+
+         std::cout << numOfThreads << " thread(s): " << (importTimeInSec * 1e3) / numOfRuns << " ms, " << singleThreadTimeInSec / importTimeInSec << "x" << "\n";
+      }
+   }
+
+   if (isModelGenerated)
+   {
+      std::remove(generatedModelFilePath.c_str());
+   }
+}
+
+void runResourceCacheBenchmark()
+{
+   // Many threads request a small set of IDs in random orders, so most loads are requested by several threads at the same time
+   const unsigned int numOfIDs               = 256;
+   const unsigned int numOfRequestsPerThread = 20000;
+   const unsigned int numOfLookupsPerThread  = 1000000;
+   const unsigned int numOfThreads           = std::max(16u, getDefaultNumOfThreads());
+
+   std::vector<StringID> resourceIDs;
+   resourceIDs.reserve(numOfIDs);
+   for (unsigned int id = 0; id < numOfIDs; ++id)
+   {
+      resourceIDs.emplace_back("resources/stress_test/resource_" + std::to_string(id));
+   }
+
+   ResourceManager<StressTestResource>    resourceManager;
+   std::vector<std::atomic<unsigned int>> numOfLoadsPerID(numOfIDs);
+   std::atomic<unsigned int>              numOfWrongResources(0);
+
+   auto runThreads = [numOfThreads](const std::function<void(unsigned int)>& threadFunc)
+   {
+      std::vector<std::thread> threads;
+      threads.reserve(numOfThreads);
+      for (unsigned int threadIndex = 0; threadIndex < numOfThreads; ++threadIndex)
+      {
+         threads.emplace_back(threadFunc, threadIndex);
+      }
+
+      for (std::thread& thread : threads)
+      {
+         thread.join();
+      }
+   };
+
+   // Cold cache: every ID must be loaded exactly once, no matter how many threads request it at the same time
+   auto start = std::chrono::steady_clock::now();
+   runThreads([&](unsigned int threadIndex)
+   {
+      std::mt19937 randomNumberGenerator(threadIndex);
+      for (unsigned int i = 0; i < numOfRequestsPerThread; ++i)
+      {
+         unsigned int id = randomNumberGenerator() % numOfIDs;
+
+         std::shared_ptr<StressTestResource> resource = resourceManager.getOrLoadResource<StressTestResourceLoader>(resourceIDs[id], id, numOfLoadsPerID);
+         if (!resource || resource->id != id)
+         {
+            numOfWrongResources.fetch_add(1, std::memory_order_relaxed);
+         }
+      }
+   });
+   double coldTimeInSec = getElapsedTimeInSec(start);
+
+   unsigned int numOfDuplicateLoads = 0;
+   unsigned int numOfMissingLoads   = 0;
+   for (unsigned int id = 0; id < numOfIDs; ++id)
+   {
+      unsigned int numOfLoads = numOfLoadsPerID[id].load();
+      numOfDuplicateLoads    += (numOfLoads > 1) ? (numOfLoads - 1) : 0;
+      numOfMissingLoads      += (numOfLoads == 0) ? 1 : 0;
+   }
+
+   ResourceCacheStatistics coldStatistics = resourceManager.getStatistics();
+
+   // Warm cache: the lookups only contend on the locks of the shards
+   start = std::chrono::steady_clock::now();
+   runThreads([&](unsigned int threadIndex)
+   {
+      std::mt19937 randomNumberGenerator(threadIndex);
+      for (unsigned int i = 0; i < numOfLookupsPerThread; ++i)
+      {
+         unsigned int id = randomNumberGenerator() % numOfIDs;
+         if (resourceManager.getResource(resourceIDs[id])->id != id)
+         {
+            numOfWrongResources.fetch_add(1, std::memory_order_relaxed);
+         }
+      }
+   });
+   double warmTimeInSec = getElapsedTimeInSec(start);
+
+   ResourceCacheStatistics warmStatistics = resourceManager.getStatistics();
+
+   // Budgeted cache: the budget only fits a quarter of the resources, and the threads favor the resources with low IDs, which LRU eviction should keep resident
+   // Each thread pins the last resource it requested, and enforces the budget every few requests
+   const unsigned int                     numOfResidentIDs  = numOfIDs / 4;
+   const unsigned int                     enforcementPeriod = 64;
+   ResourceManager<StressTestResource>    budgetedResourceManager;
+   std::vector<std::atomic<unsigned int>> numOfBudgetedLoadsPerID(numOfIDs);
+   ResourceFootprint                      budget = StressTestResource().getFootprint();
+   budget.cpuMemoryInBytes *= numOfResidentIDs;
+   budget.gpuMemoryInBytes *= numOfResidentIDs;
+   budgetedResourceManager.setMemoryBudget(budget);
+
+   start = std::chrono::steady_clock::now();
+   runThreads([&](unsigned int threadIndex)
+   {
+      std::mt19937                        randomNumberGenerator(threadIndex);
+      std::shared_ptr<StressTestResource> pinnedResource;
+      for (unsigned int i = 0; i < numOfRequestsPerThread / 4; ++i)
+      {
+         unsigned int id = randomNumberGenerator() % (randomNumberGenerator() % numOfIDs + 1);
+         pinnedResource  = budgetedResourceManager.getOrLoadResource<StressTestResourceLoader>(resourceIDs[id], id, numOfBudgetedLoadsPerID);
+         if (!pinnedResource || pinnedResource->id != id)
+         {
+            numOfWrongResources.fetch_add(1, std::memory_order_relaxed);
+         }
+
+         if (i % enforcementPeriod == 0)
+         {
+            budgetedResourceManager.enforceMemoryBudget();
+         }
+      }
+   });
+   double budgetedTimeInSec = getElapsedTimeInSec(start);
+
+   // Nothing is pinned anymore, so the budget must be met after enforcing it once more
+   budgetedResourceManager.enforceMemoryBudget();
+   ResourceFootprint       residentFootprint  = budgetedResourceManager.getResidentFootprint();
+   ResourceCacheStatistics budgetedStatistics = budgetedResourceManager.getStatistics();
+   unsigned int            numOfBudgetedLoads = 0;
+   for (const std::atomic<unsigned int>& numOfLoads : numOfBudgetedLoadsPerID)
+   {
+      numOfBudgetedLoads += numOfLoads.load();
+   }
+
+   std::cout << "Info - runResourceCacheBenchmark - " << numOfThreads << " threads requesting " << numOfIDs << " resources" << "\n";
+   std::cout << "Cold: " << numOfRequestsPerThread * numOfThreads << " requests in " << coldTimeInSec * 1e3 << " ms, "
+             << coldStatistics.numOfMisses << " misses, " << coldStatistics.numOfHits << " hits, " << coldStatistics.numOfInFlightHits << " in-flight hits, "
+             << coldStatistics.numOfContendedLocks << " contended locks" << "\n";
+   std::cout << "Warm: " << static_cast<double>(numOfLookupsPerThread) * numOfThreads / warmTimeInSec / 1e6 << " million lookups/s, "
+             << warmStatistics.numOfContendedLocks - coldStatistics.numOfContendedLocks << " contended locks" << "\n";
+   std::cout << "Budgeted (" << numOfResidentIDs << " resident resources): " << (numOfRequestsPerThread / 4) * numOfThreads << " requests in " << budgetedTimeInSec * 1e3 << " ms, "
+             << budgetedStatistics.numOfHits * 100.0 / (budgetedStatistics.numOfHits + budgetedStatistics.numOfInFlightHits + budgetedStatistics.numOfMisses) << "% hits, "
+             << numOfBudgetedLoads << " loads, " << budgetedStatistics.numOfEvictions << " evictions, "
+             << residentFootprint.gpuMemoryInBytes / 1024 << " / " << budget.gpuMemoryInBytes / 1024 << " KB resident" << "\n";
+
+   if (numOfDuplicateLoads != 0 || numOfMissingLoads != 0 || numOfWrongResources.load() != 0)
+   {
+      std::cout << "Error - runResourceCacheBenchmark - " << numOfDuplicateLoads << " duplicate loads, " << numOfMissingLoads << " missing loads and " << numOfWrongResources.load() << " wrong resources" << "\n";
+   }
+   else
+   {
+      std::cout << "Every resource was loaded exactly once" << "\n";
+   }
+
+   if (residentFootprint.cpuMemoryInBytes > budget.cpuMemoryInBytes || residentFootprint.gpuMemoryInBytes > budget.gpuMemoryInBytes)
+   {
+      std::cout << "Error - runResourceCacheBenchmark - The budgeted cache exceeds its budget after all the resources were unpinned" << "\n";
+   }
+}
+
+void runStringIDBenchmark()
+{
+   const unsigned int numOfIDs     = 1024;
+   const unsigned int numOfLookups = 10000000;
+
+   // Paths are typical resource IDs, and their long common prefix is the worst case for comparing strings
+   std::vector<std::string> stringIDs;
+   std::vector<StringID>    hashedIDs;
+   stringIDs.reserve(numOfIDs);
+   hashedIDs.reserve(numOfIDs);
+   for (unsigned int id = 0; id < numOfIDs; ++id)
+   {
+      stringIDs.push_back("resources/models/model_" + std::to_string(id) + "/model_" + std::to_string(id) + ".obj");
+      hashedIDs.emplace_back(stringIDs.back());
+   }
+
+   std::vector<unsigned int> lookupOrder(numOfLookups);
+   std::mt19937              randomNumberGenerator(0);
+   for (unsigned int& id : lookupOrder)
+   {
+      id = randomNumberGenerator() % numOfIDs;
+   }
+
+   std::unordered_map<std::string, unsigned int> stringMap;
+   std::unordered_map<StringID, unsigned int>    hashedMap;
+   ResourceManager<StressTestResource>           resourceManager;
+   std::vector<std::atomic<unsigned int>>        numOfLoadsPerID(numOfIDs);
+   for (unsigned int id = 0; id < numOfIDs; ++id)
+   {
+      stringMap.emplace(stringIDs[id], id);
+      hashedMap.emplace(hashedIDs[id], id);
+      resourceManager.loadResource<StressTestResourceLoader>(hashedIDs[id], id, numOfLoadsPerID);
+   }
+
+   // The sums keep the compiler from optimizing the lookups away, and they must all match
+   std::array<unsigned long long, 4> checksums = {};
+   std::array<double, 4>             timesInSec = {};
+
+   auto start = std::chrono::steady_clock::now();
+   for (unsigned int id : lookupOrder)
+   {
+      checksums[0] += stringMap.find(stringIDs[id])->second;
+   }
+   timesInSec[0] = getElapsedTimeInSec(start);
+
+   start = std::chrono::steady_clock::now();
+   for (unsigned int id : lookupOrder)
+   {
+      checksums[1] += hashedMap.find(hashedIDs[id])->second;
+   }
+   timesInSec[1] = getElapsedTimeInSec(start);
+
+   // Through a resource manager, whose lookups also lock a shard and copy a shared_ptr
+   // Converting a std::string to a StringID on every lookup shows what it costs when the IDs are not kept around
+   start = std::chrono::steady_clock::now();
+   for (unsigned int id : lookupOrder)
+   {
+      checksums[2] += resourceManager.getResource(stringIDs[id])->id;
+   }
+   timesInSec[2] = getElapsedTimeInSec(start);
+
+   start = std::chrono::steady_clock::now();
+   for (unsigned int id : lookupOrder)
+   {
+      checksums[3] += resourceManager.getResource(hashedIDs[id])->id;
+   }
+   timesInSec[3] = getElapsedTimeInSec(start);
+
+   std::array<const char*, 4> names = {"std::unordered_map, std::string keys",
+                                       "std::unordered_map, StringID keys",
+                                       "ResourceManager, std::string converted on each lookup",
+                                       "ResourceManager, StringID"};
+
+   std::cout << "Info - runStringIDBenchmark - " << numOfLookups << " random lookups of " << numOfIDs << " IDs" << "\n";
+   for (unsigned int i = 0; i < names.size(); ++i)
+   {
+      std::cout << names[i] << ": " << (timesInSec[i] * 1e9) / numOfLookups << " ns/lookup" << "\n";
+   }
+
+   if (checksums[0] != checksums[1] || checksums[0] != checksums[2] || checksums[0] != checksums[3])
+   {
+      std::cout << "Error - runStringIDBenchmark - The lookups found different values" << "\n";
+   }
+}
+
+void runTextureCompressionBenchmark(const char* texFilePath)
+{
+   // Everything runs on the CPU, where the decoder stands in for the GPU to verify the encoders
+   // The quality of each format is the PSNR of the RGB channels of its decompressed base level against the decoded image
+   // The files are in the file cache of the OS after the first run, so the times don't include reading them from the disk
+   const unsigned int numOfRuns = 3;
+
+   DecodedTexture decodedTexture;
+
+   // Decoding the image is what every load did before the textures were baked, and glGenerateMipmap ran on top of it
+   double decodeTimeInSec = 0.0;
+   for (unsigned int i = 0; i < numOfRuns; ++i)
+   {
+      auto start = std::chrono::steady_clock::now();
+      decodedTexture.data.reset(stbi_load(texFilePath, &decodedTexture.width, &decodedTexture.height, &decodedTexture.numComponents, 0));
+      decodeTimeInSec += getElapsedTimeInSec(start);
+
+      if (!decodedTexture.data)
+      {
+         std::cout << "Error - runTextureCompressionBenchmark - The following texture could not be decoded: " << texFilePath << "\n";
+         return;
+      }
+   }
+
+   auto                  start           = std::chrono::steady_clock::now();
+   std::vector<MipLevel> mipChain        = generateMipChain(decodedTexture.data.get(), decodedTexture.width, decodedTexture.height, decodedTexture.numComponents, TextureColorSpace::srgb);
+   double                mipTimeInSec    = getElapsedTimeInSec(start);
+   std::size_t           rgbaSizeInBytes = 0;
+   for (const MipLevel& mipLevel : mipChain)
+   {
+      rgbaSizeInBytes += mipLevel.texels.size();
+   }
+
+   // Averaging the sRGB values directly would darken the mips of high-contrast images, so the average linear intensity of the last mip must match the one of the base level
+   const auto calculateAverageLinearIntensity = [](const MipLevel& mipLevel)
+   {
+      double intensity = 0.0;
+      for (std::size_t i = 0; i < mipLevel.texels.size(); i += 4)
+      {
+         for (std::size_t c = 0; c < 3; ++c)
+         {
+            double srgb = mipLevel.texels[i + c] / 255.0;
+            intensity  += (srgb <= 0.04045) ? (srgb / 12.92) : std::pow((srgb + 0.055) / 1.055, 2.4);
+         }
+      }
+
+      return intensity / (mipLevel.texels.size() / 4 * 3);
+   };
+
+   std::cout << "Info - runTextureCompressionBenchmark - " << texFilePath << " (" << decodedTexture.width << "x" << decodedTexture.height << ", " << decodedTexture.numComponents << " components)" << "\n";
+   std::cout << "Decode with stb_image:      " << (decodeTimeInSec * 1e3) / numOfRuns << " ms" << "\n";
+   std::cout << "Gamma-correct mip chain:    " << mipTimeInSec * 1e3 << " ms for " << mipChain.size() << " levels, average linear intensity " << calculateAverageLinearIntensity(mipChain.front()) << " (base) / " << calculateAverageLinearIntensity(mipChain.back()) << " (1x1)" << "\n";
+   std::cout << "Uncompressed RGBA:          " << rgbaSizeInBytes / 1024 << " KB" << "\n";
+
+   BakedTextureKey key{0, TextureColorSpace::srgb};
+   if (!calculateFileHash(texFilePath, key.sourceHash))
+   {
+      return;
+   }
+
+   std::string             bakedTextureFilePath = std::string(texFilePath) + ".benchmark.bakedtexture";
+   CompressedTextureFormat defaultFormat        = chooseCompressedTextureFormat(decodedTexture.numComponents);
+
+   std::array<const char*, static_cast<unsigned int>(CompressedTextureFormat::count)> names = {"BC1", "BC3", "BC7"};
+   for (unsigned int f = 0; f < static_cast<unsigned int>(CompressedTextureFormat::count); ++f)
+   {
+      CompressedTextureFormat format = static_cast<CompressedTextureFormat>(f);
+
+      start = std::chrono::steady_clock::now();
+      std::vector<CompressedMipLevel> compressedMipLevels;
+      for (const MipLevel& mipLevel : mipChain)
+      {
+         compressedMipLevels.push_back(compressMipLevel(format, mipLevel));
+      }
+      double compressTimeInSec = getElapsedTimeInSec(start);
+
+      std::size_t compressedSizeInBytes = 0;
+      for (const CompressedMipLevel& compressedMipLevel : compressedMipLevels)
+      {
+         compressedSizeInBytes += compressedMipLevel.blocks.size();
+      }
+
+      start = std::chrono::steady_clock::now();
+      MipLevel decompressedMipLevel;
+      bool     isDecompressed = decompressMipLevel(format, compressedMipLevels.front().getView(), decompressedMipLevel);
+      double   decompressTimeInSec = getElapsedTimeInSec(start);
+
+      double squaredError = 0.0;
+      for (std::size_t i = 0; isDecompressed && i < decompressedMipLevel.texels.size(); i += 4)
+      {
+         for (std::size_t c = 0; c < 3; ++c)
+         {
+            double difference = static_cast<double>(decompressedMipLevel.texels[i + c]) - mipChain.front().texels[i + c];
+            squaredError += difference * difference;
+         }
+      }
+      double meanSquaredError = squaredError / (mipChain.front().texels.size() / 4 * 3);
+      double psnr             = (meanSquaredError > 0.0) ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : std::numeric_limits<double>::infinity();
+
+      // The container must give back the exact blocks that were written, and mapping it is what a warm load does before the upload
+      bool   isRoundTripExact = writeBakedTexture(bakedTextureFilePath, key, format, decodedTexture.numComponents, compressedMipLevels);
+      double warmTimeInSec    = 0.0;
+      for (unsigned int i = 0; isRoundTripExact && i < numOfRuns; ++i)
+      {
+         start = std::chrono::steady_clock::now();
+         BakedTextureKey warmKey{0, TextureColorSpace::srgb};
+         BakedTexture    bakedTexture;
+         if (!calculateFileHash(texFilePath, warmKey.sourceHash))
+         {
+            return;
+         }
+
+         if (!bakedTexture.open(bakedTextureFilePath, warmKey) || bakedTexture.getFormat() != format)
+         {
+            isRoundTripExact = false;
+            break;
+         }
+
+         std::vector<CompressedMipLevelView> mipLevels = bakedTexture.getMipLevels();
+         isRoundTripExact = (mipLevels.size() == compressedMipLevels.size());
+         for (std::size_t j = 0; isRoundTripExact && j < mipLevels.size(); ++j)
+         {
+            isRoundTripExact = (mipLevels[j].sizeInBytes == compressedMipLevels[j].blocks.size()) &&
+                               (std::memcmp(mipLevels[j].blocks, compressedMipLevels[j].blocks.data(), mipLevels[j].sizeInBytes) == 0);
+         }
+         warmTimeInSec += getElapsedTimeInSec(start);
+      }
+      std::remove(bakedTextureFilePath.c_str());
+
+      std::cout << names[f] << ((format == defaultFormat) ? " (baked by default)" : "") << "\n";
+      std::cout << "   Compress mip chain:      " << compressTimeInSec * 1e3 << " ms" << "\n";
+      std::cout << "   Size:                    " << compressedSizeInBytes / 1024 << " KB (" << static_cast<double>(rgbaSizeInBytes) / compressedSizeInBytes << "x smaller than RGBA)" << "\n";
+      std::cout << "   Decompress base level:   " << decompressTimeInSec * 1e3 << " ms, PSNR " << psnr << " dB" << "\n";
+      std::cout << "   Warm load (hash + map):  " << (warmTimeInSec * 1e3) / numOfRuns << " ms (" << decodeTimeInSec / warmTimeInSec << "x faster than decoding)" << "\n";
+
+      if (!isDecompressed || !isRoundTripExact)
+      {
+         std::cout << "Error - runTextureCompressionBenchmark - The " << names[f] << " blocks did not survive " << (isDecompressed ? "the baked texture" : "decompression") << "\n";
+      }
+   }
+}
@@ -240,3 +240,10 @@ void Camera::updateCoordinateFrame()
    mRight = glm::normalize(glm::cross(mFront, mWorldUp));
    mUp    = glm::normalize(glm::cross(mRight, mFront));
 }
+
+bool Camera::isDirty() const
+{
+   // The projection view matrix is recalculated every time the camera moves, rotates or zooms
+   // It is only cleaned when it is requested for rendering, so this flag tells us if the camera changed since the last frame
+   return mNeedToUpdatePerspectiveProjectionViewMatrix;
+}
@@ -0,0 +1,230 @@
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+#include "gl_state_cache.h"
+#include "debug_renderer.h"
+
+namespace
+{
+   const float lineWidths[] = {1.0f, 5.0f}; // Indexed with DebugLineStyle
+}
+
+DebugRenderer::DebugRenderer()
+   : mVertices()
+   , mVAO(0)
+   , mVBO(0)
+   , mCapacityOfVBOInBytes(0)
+   , mNumOfLinesInLastFlush(0)
+   , mNumOfDrawCallsInLastFlush(0)
+{
+   configureVAO();
+}
+
+DebugRenderer::~DebugRenderer()
+{
+   GLStateCache::get().deleteVertexArray(mVAO);
+   GLStateCache::get().deleteBuffer(mVBO);
+}
+
+DebugRenderer::DebugRenderer(DebugRenderer&& rhs) noexcept
+   : mVertices(std::move(rhs.mVertices))
+   , mVAO(std::exchange(rhs.mVAO, 0))
+   , mVBO(std::exchange(rhs.mVBO, 0))
+   , mCapacityOfVBOInBytes(std::exchange(rhs.mCapacityOfVBOInBytes, 0))
+   , mNumOfLinesInLastFlush(std::exchange(rhs.mNumOfLinesInLastFlush, 0))
+   , mNumOfDrawCallsInLastFlush(std::exchange(rhs.mNumOfDrawCallsInLastFlush, 0))
+{
+
+}
+
+DebugRenderer& DebugRenderer::operator=(DebugRenderer&& rhs) noexcept
+{
+   mVertices                  = std::move(rhs.mVertices);
+   mVAO                       = std::exchange(rhs.mVAO, 0);
+   mVBO                       = std::exchange(rhs.mVBO, 0);
+   mCapacityOfVBOInBytes      = std::exchange(rhs.mCapacityOfVBOInBytes, 0);
+   mNumOfLinesInLastFlush     = std::exchange(rhs.mNumOfLinesInLastFlush, 0);
+   mNumOfDrawCallsInLastFlush = std::exchange(rhs.mNumOfDrawCallsInLastFlush, 0);
+   return *this;
+}
+
+void DebugRenderer::begin(LinearAllocator& frameAllocator)
+{
+   for (FrameVector<DebugVertex>& vertices : mVertices)
+   {
+      vertices.reset(frameAllocator);
+   }
+}
+
+void DebugRenderer::addLine(const glm::vec3& startPoint, const glm::vec3& endPoint, const glm::vec3& color, DebugLineStyle style)
+{
+   FrameVector<DebugVertex>& vertices = mVertices[static_cast<unsigned int>(style)];
+   const DebugVertex line[] = {DebugVertex{startPoint, color}, DebugVertex{endPoint, color}};
+   vertices.append(line, 2);
+}
+
+void DebugRenderer::addAxes(const glm::vec3& position,
+                            const quat&      rotation,
+                            float            length,
+                            DebugLineStyle   style,
+                            const glm::vec3& xColor,
+                            const glm::vec3& yColor,
+                            const glm::vec3& zColor)
+{
+   addLine(position, position + rotation * glm::vec3(length, 0.0f, 0.0f), xColor, style);
+   addLine(position, position + rotation * glm::vec3(0.0f, length, 0.0f), yColor, style);
+   addLine(position, position + rotation * glm::vec3(0.0f, 0.0f, length), zColor, style);
+}
+
+void DebugRenderer::addArc(const glm::vec3& center,
+                           const glm::vec3& normal,
+                           const glm::vec3& startVector,
+                           float            angleInRad,
+                           const glm::vec3& color,
+                           DebugLineStyle   style,
+                           unsigned int     numOfSegments)
+{
+   if (numOfSegments == 0 || glm::dot(normal, normal) == 0.0f)
+   {
+      return;
+   }
+
+   // The arc lies in the plane spanned by u and v, which are perpendicular and have the same length
+   glm::vec3 n = glm::normalize(normal);
+   glm::vec3 u = startVector - glm::dot(startVector, n) * n;
+   glm::vec3 v = glm::cross(n, u);
+
+   // Each point is calculated from the angle directly instead of by rotating the previous one, so that the errors don't accumulate
+   FrameVector<DebugVertex>& vertices = mVertices[static_cast<unsigned int>(style)];
+   glm::vec3 prevPoint = center + u;
+   for (unsigned int i = 1; i <= numOfSegments; ++i)
+   {
+      float     angle     = angleInRad * (static_cast<float>(i) / static_cast<float>(numOfSegments));
+      glm::vec3 currPoint = center + std::cos(angle) * u + std::sin(angle) * v;
+
+      const DebugVertex line[] = {DebugVertex{prevPoint, color}, DebugVertex{currPoint, color}};
+      vertices.append(line, 2);
+
+      prevPoint = currPoint;
+   }
+}
+
+void DebugRenderer::addOrientationFrame(const glm::vec3& position, const quat& rotation, float size, DebugLineStyle style)
+{
+   addAxes(position, rotation, size, style);
+
+   // The length of the vector part of a unit quaternion is the sine of half its angle of rotation
+   // When it's close to zero the axis of rotation is undefined, so we only show the axes
+   glm::vec3 vectorPart(rotation.x, rotation.y, rotation.z);
+   float     sinOfHalfAngle = glm::length(vectorPart);
+   if (sinOfHalfAngle < 1e-4f)
+   {
+      return;
+   }
+
+   glm::vec3 axis  = vectorPart / sinOfHalfAngle;
+   float     angle = 2.0f * std::atan2(sinOfHalfAngle, rotation.w);
+
+   addLine(position, position + axis * (size * 1.25f), glm::vec3(1.0f), style);
+
+   // The arc starts at a vector that is perpendicular to the axis and ends where the rotation takes that vector
+   glm::vec3 helper        = (std::abs(axis.x) < 0.9f) ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+   glm::vec3 perpendicular = glm::normalize(glm::cross(axis, helper)) * (size * 0.5f);
+   addArc(position, axis, perpendicular, angle, glm::vec3(1.0f, 1.0f, 0.0f), style, 16);
+}
+
+void DebugRenderer::flush(const Shader& shader)
+{
+   unsigned int numOfVertices = 0;
+   for (const FrameVector<DebugVertex>& vertices : mVertices)
+   {
+      numOfVertices += static_cast<unsigned int>(vertices.size());
+   }
+
+   mNumOfLinesInLastFlush     = numOfVertices / 2;
+   mNumOfDrawCallsInLastFlush = 0;
+
+   if (numOfVertices == 0)
+   {
+      return;
+   }
+
+   GLStateCache& stateCache = GLStateCache::get();
+   stateCache.bindBuffer(GL_ARRAY_BUFFER, mVBO);
+
+   // Grow the buffer geometrically, and orphan it when it's big enough so that the driver doesn't have to wait for the draws of the previous frame
+   unsigned int requiredSizeInBytes = numOfVertices * sizeof(DebugVertex);
+   if (requiredSizeInBytes > mCapacityOfVBOInBytes)
+   {
+      mCapacityOfVBOInBytes = std::max(requiredSizeInBytes, mCapacityOfVBOInBytes * 2);
+   }
+   glBufferData(GL_ARRAY_BUFFER, mCapacityOfVBOInBytes, nullptr, GL_STREAM_DRAW);
+
+   unsigned int offset = 0;
+   for (const FrameVector<DebugVertex>& vertices : mVertices)
+   {
+      if (!vertices.empty())
+      {
+         glBufferSubData(GL_ARRAY_BUFFER, offset * sizeof(DebugVertex), vertices.size() * sizeof(DebugVertex), vertices.data());
+         offset += static_cast<unsigned int>(vertices.size());
+      }
+   }
+
+   shader.use();
+   stateCache.bindVertexArray(mVAO);
+
+   // One draw call per style
+   unsigned int firstVertex = 0;
+   for (unsigned int style = 0; style < static_cast<unsigned int>(DebugLineStyle::count); ++style)
+   {
+      FrameVector<DebugVertex>& vertices = mVertices[style];
+      if (vertices.empty())
+      {
+         continue;
+      }
+
+      stateCache.lineWidth(lineWidths[style]);
+      glDrawArrays(GL_LINES, firstVertex, static_cast<int>(vertices.size()));
+      ++mNumOfDrawCallsInLastFlush;
+
+      firstVertex += static_cast<unsigned int>(vertices.size());
+
+      vertices.clear();
+   }
+}
+
+unsigned int DebugRenderer::getNumOfLinesInLastFlush() const
+{
+   return mNumOfLinesInLastFlush;
+}
+
+unsigned int DebugRenderer::getNumOfDrawCallsInLastFlush() const
+{
+   return mNumOfDrawCallsInLastFlush;
+}
+
+void DebugRenderer::configureVAO()
+{
+   glGenVertexArrays(1, &mVAO);
+   glGenBuffers(1, &mVBO);
+
+   GLStateCache::get().bindVertexArray(mVAO);
+   GLStateCache::get().bindBuffer(GL_ARRAY_BUFFER, mVBO);
+
+   // The buffer is allocated when the renderer is flushed for the first time
+
+   // Set the vertex attribute pointers
+
+   // Positions
+   glEnableVertexAttribArray(0);
+   glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(DebugVertex), (void*)offsetof(DebugVertex, position));
+   // Colors
+   glEnableVertexAttribArray(1);
+   glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(DebugVertex), (void*)offsetof(DebugVertex, color));
+
+   GLStateCache::get().bindVertexArray(0);
+}
@@ -3,8 +3,8 @@
 
 #include "finite_state_machine.h"
 
-void FiniteStateMachine::initialize(std::unordered_map<std::string, std::shared_ptr<State>>&& states,
-                                    const std::string&                                        initialStateID)
+void FiniteStateMachine::initialize(std::unordered_map<StringID, std::shared_ptr<State>>&& states,
+                                    StringID                                               initialStateID)
 {
    mStates = std::move(states);
 
@@ -18,7 +18,7 @@ void FiniteStateMachine::initialize(std::unordered_map<std::string, std::shared_
    }
    else
    {
-      std::cout << "Error - FiniteStateMachine::FiniteStateMachine - A state with the following ID does not exist: " << initialStateID << "\n";
+      std::cout << "Error - FiniteStateMachine::FiniteStateMachine - A state with the following ID does not exist: " << initialStateID.getString() << "\n";
    }
 }
 
@@ -37,7 +37,12 @@ void FiniteStateMachine::renderCurrentState() const
    mCurrentState->render();
 }
 
-void FiniteStateMachine::changeState(const std::string& newStateID)
+bool FiniteStateMachine::currentStateNeedsRedraw() const
+{
+   return mCurrentState->needsRedraw();
+}
+
+void FiniteStateMachine::changeState(StringID newStateID)
 {
    auto it = mStates.find(newStateID);
    if (it != mStates.end())
@@ -51,7 +56,7 @@ void FiniteStateMachine::changeState(const std::string& newStateID)
    }
    else
    {
-      std::cout << "Error - FiniteStateMachine::changeState - A state with the following ID does not exist: " << newStateID << "\n";
+      std::cout << "Error - FiniteStateMachine::changeState - A state with the following ID does not exist: " << newStateID.getString() << "\n";
    }
 }
 
@@ -60,12 +65,12 @@ std::shared_ptr<State> FiniteStateMachine::getPreviousState()
    return mStates[mPreviousStateID];
 }
 
-std::string FiniteStateMachine::getPreviousStateID() const
+StringID FiniteStateMachine::getPreviousStateID() const
 {
    return mPreviousStateID;
 }
 
-std::string FiniteStateMachine::getCurrentStateID() const
+StringID FiniteStateMachine::getCurrentStateID() const
 {
    return mCurrentStateID;
 }
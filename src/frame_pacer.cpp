@@ -0,0 +1,116 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "frame_pacer.h"
+
+FramePacer::FramePacer()
+   : mTargetFrameRate(0)
+   , mTargetFrameDurationInSec(0.0)
+   , mNextFrameDeadlineInSec(0.0)
+   , mSpinThresholdInSec(0.002)
+   , mLateLatch(false)
+   , mLastInputLatencyInSec(0.0)
+   , mAverageInputLatencyInSec(0.0)
+   , mMaxInputLatencyInSec(0.0)
+   , mHasInputLatencySamples(false)
+{
+
+}
+
+void FramePacer::waitForNextFrame()
+{
+   // A target frame rate of 0 means that the frame rate is unlimited
+   if (mTargetFrameRate <= 0)
+   {
+      return;
+   }
+
+   double timeUntilDeadline = mNextFrameDeadlineInSec - glfwGetTime();
+
+   // Sleep while we are far away from the deadline
+   if (timeUntilDeadline > mSpinThresholdInSec)
+   {
+      std::this_thread::sleep_for(std::chrono::duration<double>(timeUntilDeadline - mSpinThresholdInSec));
+   }
+
+   // Spin for the remaining time
+   while (glfwGetTime() < mNextFrameDeadlineInSec)
+   {
+      std::this_thread::yield();
+   }
+
+   // Schedule the next deadline relative to the current one so that small errors don't accumulate
+   // If we fell behind by more than a frame, we resynchronize instead of rendering a burst of frames to catch up
+   double currentTime = glfwGetTime();
+   mNextFrameDeadlineInSec += mTargetFrameDurationInSec;
+   if (mNextFrameDeadlineInSec < currentTime)
+   {
+      mNextFrameDeadlineInSec = currentTime + mTargetFrameDurationInSec;
+   }
+}
+
+int FramePacer::getTargetFrameRate() const
+{
+   return mTargetFrameRate;
+}
+
+void FramePacer::setTargetFrameRate(int targetFrameRate)
+{
+   mTargetFrameRate          = std::max(targetFrameRate, 0);
+   mTargetFrameDurationInSec = (mTargetFrameRate > 0) ? (1.0 / mTargetFrameRate) : 0.0;
+   mNextFrameDeadlineInSec   = glfwGetTime() + mTargetFrameDurationInSec;
+}
+
+bool FramePacer::isLateLatchEnabled() const
+{
+   return mLateLatch;
+}
+
+void FramePacer::setLateLatch(bool lateLatch)
+{
+   mLateLatch = lateLatch;
+}
+
+void FramePacer::recordInputLatency(double latencyInSec)
+{
+   mLastInputLatencyInSec = latencyInSec;
+   mMaxInputLatencyInSec  = std::max(mMaxInputLatencyInSec, latencyInSec);
+
+   // Exponential moving average, so that old samples gradually stop influencing the result
+   if (mHasInputLatencySamples)
+   {
+      mAverageInputLatencyInSec += (latencyInSec - mAverageInputLatencyInSec) * 0.05;
+   }
+   else
+   {
+      mAverageInputLatencyInSec = latencyInSec;
+      mHasInputLatencySamples   = true;
+   }
+}
+
+double FramePacer::getLastInputLatencyInMs() const
+{
+   return mLastInputLatencyInSec * 1000.0;
+}
+
+double FramePacer::getAverageInputLatencyInMs() const
+{
+   return mAverageInputLatencyInSec * 1000.0;
+}
+
+double FramePacer::getMaxInputLatencyInMs() const
+{
+   return mMaxInputLatencyInSec * 1000.0;
+}
+
+void FramePacer::resetInputLatencyStats()
+{
+   mLastInputLatencyInSec    = 0.0;
+   mAverageInputLatencyInSec = 0.0;
+   mMaxInputLatencyInSec     = 0.0;
+   mHasInputLatencySamples   = false;
+}
@@ -1,20 +1,42 @@
 #include <iostream>
 
+#include "gl_state_cache.h"
 #include "shader_loader.h"
 #include "texture_loader.h"
 #include "model_loader.h"
 #include "play_state.h"
 #include "game.h"
 
+namespace
+{
+   const double glUploadBudgetInSec = 0.002;
+}
+
 Game::Game()
    : mFSM()
+   , mPlayState()
    , mWindow()
    , mCamera()
+   , mFramePacer()
+   , mCameraUniformBuffer()
+   , mLightsUniformBuffer()
+   , mMaterialBuffer()
+   , mTextureCache()
+   , mGeometryArena()
+   , mGLUploadQueue()
+   , mThreadPool()
    , mModelManager()
-   , mTextureManager()
    , mShaderManager()
+   , mGameObject3DPool()
    , mTable()
    , mTeapot()
+   , mOnDemandRendering(false)
+   , mNumOfFramesToRenderAfterEvents(0)
+   , mNumOfRenderedFrames(0)
+   , mNumOfSkippedFrames(0)
+   , mAllocationTracker(60)       // Number of warm-up frames
+   , mFrameAllocator(std::make_shared<LinearAllocator>(32 * 1024 * 1024)) // Capacity of the per-frame allocator in bytes
+   , mNumOfBenchmarkFrames(0)
 {
 
 }
@@ -51,55 +73,91 @@ bool Game::initialize(const std::string& title)
                                       20.0f,       // Movement speed
                                       0.1f);       // Mouse sensitivity
 
+   // Initialize the frame pacer
+   mFramePacer = std::make_shared<FramePacer>();
+
    // Initialize the 3D shader
-   auto gameObj3DShader = mShaderManager.loadResource<ShaderLoader>("game_object_3D",
+   auto gameObj3DShader = mShaderManager.loadResource<ShaderLoader>("game_object_3D"_sid,
                                                                     "resources/shaders/game_object_3D.vs",
                                                                     "resources/shaders/game_object_3D.fs");
-   gameObj3DShader->use();
-   gameObj3DShader->setVec3("pointLights[0].worldPos", glm::vec3(0.0f, 0.0f, 100.0f));
-   gameObj3DShader->setVec3("pointLights[0].color", glm::vec3(1.0f, 1.0f, 1.0f));
-   gameObj3DShader->setFloat("pointLights[0].constantAtt", 1.0f);
-   gameObj3DShader->setFloat("pointLights[0].linearAtt", 0.01f);
-   gameObj3DShader->setFloat("pointLights[0].quadraticAtt", 0.0f);
-   gameObj3DShader->setInt("numPointLightsInScene", 1);
 
    // Initialize the line shader
-   auto lineShader = mShaderManager.loadResource<ShaderLoader>("line",
+   auto lineShader = mShaderManager.loadResource<ShaderLoader>("line"_sid,
                                                                "resources/shaders/line.vs",
                                                                "resources/shaders/line.fs");
 
-   // Load the models
-   mModelManager.loadResource<ModelLoader>("table", "resources/models/table/table.obj");
-   mModelManager.loadResource<ModelLoader>("teapot", "resources/models/teapot/teapot.obj");
+   // Initialize the uniform buffers, which are shared by all the shaders through their binding points
+   unsigned int cameraBindingPoint = static_cast<unsigned int>(UniformBlockBindingPoints::camera);
+   unsigned int lightsBindingPoint = static_cast<unsigned int>(UniformBlockBindingPoints::lights);
+
+   mCameraUniformBuffer = std::make_shared<UniformBuffer>(sizeof(CameraUniformBlock), cameraBindingPoint);
+   mLightsUniformBuffer = std::make_shared<UniformBuffer>(sizeof(LightsUniformBlock), lightsBindingPoint);
+   mMaterialBuffer      = std::make_shared<MaterialBuffer>();
+   mTextureCache        = std::make_shared<TextureCache>();
+
+   gameObj3DShader->bindUniformBlock("Camera", cameraBindingPoint);
+   gameObj3DShader->bindUniformBlock("Lights", lightsBindingPoint);
+   gameObj3DShader->bindUniformBlock("Materials", static_cast<unsigned int>(UniformBlockBindingPoints::materials));
+   lineShader->bindUniformBlock("Camera", cameraBindingPoint);
+
+   // The lights don't move, so we only need to upload them once
+   LightsUniformBlock lights = {};
+   lights.pointLights[0].worldPos     = glm::vec3(0.0f, 0.0f, 100.0f);
+   lights.pointLights[0].color        = glm::vec3(1.0f, 1.0f, 1.0f);
+   lights.pointLights[0].constantAtt  = 1.0f;
+   lights.pointLights[0].linearAtt    = 0.01f;
+   lights.pointLights[0].quadraticAtt = 0.0f;
+   lights.numPointLightsInScene       = 1;
+   mLightsUniformBuffer->update(&lights, sizeof(LightsUniformBlock));
+
+   // Load the models asynchronously, so that the first frames are rendered while they are loading
+   // They are imported and their textures are decoded on the thread pool, and they are uploaded at the start of the frames (see executeGameLoop)
+   // All their meshes share the buffers of the geometry arena, which grows if they don't fit in its initial capacity, and their textures are shared through the texture cache
+   // The compact vertex format halves the size of the vertices and the indices (see VertexFormat)
+   mGeometryArena = std::make_shared<GeometryArena>(VertexFormat::compact, 1 << 16, 1 << 18);
+   mGLUploadQueue = std::make_shared<GLUploadQueue>();
+   mThreadPool    = std::make_shared<ThreadPool>();
+   mModelManager.loadResourceAsync<ModelLoader>("table"_sid, *mThreadPool, *mGLUploadQueue, "resources/models/table/table.obj", mMaterialBuffer, std::ref(*mTextureCache), mGeometryArena);
+   mModelManager.loadResourceAsync<ModelLoader>("teapot"_sid, *mThreadPool, *mGLUploadQueue, "resources/models/teapot/teapot.obj", mMaterialBuffer, std::ref(*mTextureCache), mGeometryArena);
+
+   // Create the game objects, which are not rendered until their models are ready
+   mGameObject3DPool = std::make_shared<ObjectPool<GameObject3D>>();
 
-   mTable = std::make_shared<GameObject3D>(mModelManager.getResource("table"),
-                                           glm::vec3(0.0f, -1.96875f * (7.5f / 2.5f) * 2.5f, 0.0f),
-                                           0.0f,
-                                           glm::vec3(0.0f, 0.0f, 0.0f),
-                                           1.0f);
+   mTable = mGameObject3DPool->create(mModelManager.getResourceHandle("table"_sid),
+                                      glm::vec3(0.0f, -1.96875f * (7.5f / 2.5f) * 2.5f, 0.0f),
+                                      0.0f,
+                                      glm::vec3(0.0f, 0.0f, 0.0f),
+                                      1.0f);
 
-   mTeapot = std::make_shared<GameObject3D>(mModelManager.getResource("teapot"),
-                                            glm::vec3(0.0f),
-                                            0.0f,
-                                            glm::vec3(0.0f, 0.0f, 0.0f),
-                                            7.5f / 2.5f);
+   mTeapot = mGameObject3DPool->create(mModelManager.getResourceHandle("teapot"_sid),
+                                       glm::vec3(0.0f),
+                                       0.0f,
+                                       glm::vec3(0.0f, 0.0f, 0.0f),
+                                       7.5f / 2.5f);
 
    // Create the FSM
    mFSM = std::make_shared<FiniteStateMachine>();
 
    // Initialize the states
-   std::unordered_map<std::string, std::shared_ptr<State>> mStates;
+   std::unordered_map<StringID, std::shared_ptr<State>> mStates;
 
-   mStates["play"] = std::make_shared<PlayState>(mFSM,
-                                                 mWindow,
-                                                 mCamera,
-                                                 gameObj3DShader,
-                                                 lineShader,
-                                                 mTable,
-                                                 mTeapot);
+   mPlayState = std::make_shared<PlayState>(mFSM,
+                                            mWindow,
+                                            mCamera,
+                                            mFramePacer,
+                                            mFrameAllocator,
+                                            mCameraUniformBuffer,
+                                            gameObj3DShader,
+                                            lineShader,
+                                            mGeometryArena,
+                                            mGameObject3DPool,
+                                            mTable,
+                                            mTeapot);
+
+   mStates["play"_sid] = mPlayState;
 
    // Initialize the FSM
-   mFSM->initialize(std::move(mStates), "play");
+   mFSM->initialize(std::move(mStates), "play"_sid);
 
    return true;
 }
@@ -110,14 +168,210 @@ void Game::executeGameLoop()
    double lastFrame    = 0.0;
    float  deltaTime    = 0.0f;
 
+   double startTime = glfwGetTime();
+
    while (!mWindow->shouldClose())
    {
+      // With late latching we wait for the next frame before polling the input instead of after,
+      // so that the input used to build the camera matrix is as fresh as possible when the frame is presented
+      if (mFramePacer->isLateLatchEnabled())
+      {
+         mFramePacer->waitForNextFrame();
+         mWindow->pollEvents();
+      }
+
       currentFrame = glfwGetTime();
       deltaTime    = static_cast<float>(currentFrame - lastFrame);
       lastFrame    = currentFrame;
 
+      mAllocationTracker.beginFrame();
+      mFrameAllocator->reset();
+
+      // Create the OpenGL objects of the resources that finished loading on the thread pool
+      // The budget limits how much longer a frame can get because of them, but an upload that takes longer than the budget still runs in a single frame
+      unsigned int numOfUploads = mGLUploadQueue->processUploads(glUploadBudgetInSec);
+
+      // Evict the resources that exceed the budgets of their managers and that nothing uses anymore
+      // This must happen on the context thread, since evicting a resource destroys its OpenGL objects
+      mModelManager.enforceMemoryBudget();
+      mTextureCache->getTextureManager().enforceMemoryBudget();
+      mShaderManager.enforceMemoryBudget();
+
+      // Uploads that didn't fit in the budget stay in the queue until the next frame
+      bool isLoading = mGLUploadQueue->getNumOfPendingUploads()                      != 0 ||
+                       mModelManager.getNumOfLoadingResources()                      != 0 ||
+                       mTextureCache->getTextureManager().getNumOfLoadingResources() != 0;
+
+      // Loading allocates on the thread pool and during the uploads, so the frames aren't in a steady state until everything is loaded
+      if (numOfUploads != 0 || isLoading)
+      {
+         mAllocationTracker.restartWarmUp();
+      }
+
       mFSM->processInputInCurrentState(deltaTime);
       mFSM->updateCurrentState(deltaTime);
+
+      // A resource that became ready changes the image even if nothing else did
+      if (mOnDemandRendering && numOfUploads == 0 && !needsToRender())
+      {
+         if (isLoading)
+         {
+            // Nothing changed yet, but the resources that are loading must be uploaded as soon as they are ready,
+            // so we keep processing the upload queue at the frame rate instead of sleeping until an event arrives
+            // With late latching, the events were already polled and the frame was already paced at the top of the loop
+            if (!mFramePacer->isLateLatchEnabled())
+            {
+               mWindow->pollEvents();
+               mFramePacer->waitForNextFrame();
+            }
+         }
+         else
+         {
+            // Nothing changed, so we sleep until an event arrives instead of rendering the same image again
+            // The timeout guarantees that we wake up periodically even if no events arrive
+            mWindow->waitEvents(0.5);
+         }
+         ++mNumOfSkippedFrames;
+
+         // The time spent sleeping should not be treated as the duration of a frame
+         lastFrame = glfwGetTime();
+
+         // Every frame that was begun must be ended, even if it wasn't rendered
+         mAllocationTracker.endFrame();
+         continue;
+      }
+
+      // ImGui changes the GL state without going through the cache, so we start every frame with an empty cache
+      GLStateCache::get().beginFrame();
+
       mFSM->renderCurrentState();
+      ++mNumOfRenderedFrames;
+
+      mWindow->swapBuffers();
+
+      // Measure the time between the oldest input processed in this frame and the moment the frame was handed to the swap chain
+      if (mWindow->hasUnpresentedInput())
+      {
+         mFramePacer->recordInputLatency(glfwGetTime() - mWindow->getTimeOfOldestUnpresentedInput());
+         mWindow->resetUnpresentedInput();
+      }
+
+      if (!mFramePacer->isLateLatchEnabled())
+      {
+         mWindow->pollEvents();
+         mFramePacer->waitForNextFrame();
+      }
+
+      // Objects spawned from the UI (e.g. the stress test teapots) make the frame and the ones that follow allocate, just like loading does
+      if (mPlayState->haveObjectsBeenSpawned())
+      {
+         mAllocationTracker.restartWarmUp();
+      }
+
+      mAllocationTracker.endFrame();
+
+      if (mNumOfBenchmarkFrames != 0 && mNumOfRenderedFrames >= mNumOfBenchmarkFrames)
+      {
+         mWindow->setShouldClose(true);
+      }
+   }
+
+   ResourceFootprint modelFootprint   = mModelManager.getResidentFootprint();
+   ResourceFootprint textureFootprint = mTextureCache->getTextureManager().getResidentFootprint();
+   ResourceFootprint shaderFootprint  = mShaderManager.getResidentFootprint();
+   std::cout << "Info - Game::executeGameLoop - Resident resources (RAM / VRAM)" << "\n";
+   std::cout << "Models: " << modelFootprint.cpuMemoryInBytes / 1024 << " KB / " << modelFootprint.gpuMemoryInBytes / 1024 << " KB (" << mModelManager.getStatistics().numOfEvictions << " evicted)" << "\n";
+   std::cout << "Textures: " << textureFootprint.cpuMemoryInBytes / 1024 << " KB / " << textureFootprint.gpuMemoryInBytes / 1024 << " KB" << "\n";
+   std::cout << "Shaders: " << shaderFootprint.cpuMemoryInBytes / 1024 << " KB / " << shaderFootprint.gpuMemoryInBytes / 1024 << " KB" << "\n";
+
+   TextureCacheStatistics textureCacheStatistics = mTextureCache->getStatistics();
+   std::cout << "Info - Game::executeGameLoop - Texture cache" << "\n";
+   std::cout << "Uploaded textures: " << textureCacheStatistics.numOfUploadedTextures << " - Shared textures: " << textureCacheStatistics.numOfSharedTextures << "\n";
+   std::cout << "Saved: " << textureCacheStatistics.numOfDecodedBytesSaved / 1024 << " KB decoded / " << textureCacheStatistics.numOfVRAMBytesSaved / 1024 << " KB VRAM / " << textureCacheStatistics.timeSavedInSec * 1000.0 << " ms" << "\n";
+
+   if (mOnDemandRendering)
+   {
+      std::cout << "Info - Game::executeGameLoop - Rendered frames: " << mNumOfRenderedFrames << " - Skipped frames: " << mNumOfSkippedFrames << "\n";
    }
+
+   if (mNumOfBenchmarkFrames != 0)
+   {
+      unsigned long long numOfSteadyStateFrames      = mAllocationTracker.getNumOfSteadyStateFrames();
+      unsigned long long numOfSteadyStateAllocations = mAllocationTracker.getNumOfSteadyStateAllocations();
+      double             avgNumOfAllocationsPerFrame = (numOfSteadyStateFrames != 0) ? (static_cast<double>(numOfSteadyStateAllocations) / numOfSteadyStateFrames) : 0.0;
+
+      std::cout << "Info - Game::executeGameLoop - Benchmark results" << "\n";
+      std::cout << "Steady state frames: " << numOfSteadyStateFrames << "\n";
+      std::cout << "Average frame time: " << (((glfwGetTime() - startTime) * 1000.0) / mNumOfRenderedFrames) << " ms (use --swap-interval 0 to measure it without vsync)" << "\n";
+      if (isHeapAllocationTrackingEnabled())
+      {
+         std::cout << "Heap allocations per frame: " << avgNumOfAllocationsPerFrame << " (max " << mAllocationTracker.getMaxNumOfAllocationsInSteadyStateFrame() << ")" << "\n";
+      }
+      else
+      {
+         std::cout << "Heap allocations per frame: Not tracked (define TRACK_HEAP_ALLOCATIONS to track them)" << "\n";
+      }
+      std::cout << "Peak frame allocator usage: " << mFrameAllocator->getPeakUsedBytes() << " / " << mFrameAllocator->getCapacityInBytes() << " bytes" << "\n";
+   }
+}
+
+void Game::setOnDemandRendering(bool onDemandRendering)
+{
+   mOnDemandRendering = onDemandRendering;
+}
+
+void Game::setTargetFrameRate(int targetFrameRate)
+{
+   mFramePacer->setTargetFrameRate(targetFrameRate);
+}
+
+void Game::setSwapInterval(int swapInterval)
+{
+   mWindow->setSwapInterval(swapInterval);
+}
+
+void Game::setLateLatch(bool lateLatch)
+{
+   mFramePacer->setLateLatch(lateLatch);
+}
+
+void Game::setNumOfBenchmarkFrames(unsigned int numOfBenchmarkFrames)
+{
+   // The benchmark renders the given number of frames in a hidden window, reports the heap allocations made per frame and exits
+   // Instead of asserting, we let the benchmark finish so that it can report all the allocations
+   mNumOfBenchmarkFrames = numOfBenchmarkFrames;
+   mAllocationTracker.setAssertOnSteadyStateAllocations(numOfBenchmarkFrames == 0);
+   mWindow->setVisible(numOfBenchmarkFrames == 0);
+}
+
+void Game::setNumOfStressTestTeapots(unsigned int numOfStressTestTeapots)
+{
+   mPlayState->spawnStressTestTeapots(numOfStressTestTeapots);
+}
+
+void Game::setModelMemoryBudget(const ResourceFootprint& budget)
+{
+   // The textures are shared by the models through the texture cache, so they are not included in the footprints of the models
+   // The cache gets the same budget, and its textures can be evicted once the models that use them are evicted
+   mModelManager.setMemoryBudget(budget);
+   mTextureCache->getTextureManager().setMemoryBudget(budget);
+}
+
+bool Game::needsToRender()
+{
+   // ImGui needs a few frames to react to an event (e.g. a button needs one frame to be hovered and another one to be released),
+   // so we keep rendering for a few frames after the last event was received
+   if (mWindow->eventsReceived())
+   {
+      mWindow->resetEventsReceived();
+      mNumOfFramesToRenderAfterEvents = 3;
+   }
+
+   if (mNumOfFramesToRenderAfterEvents > 0)
+   {
+      --mNumOfFramesToRenderAfterEvents;
+      return true;
+   }
+
+   return mFSM->currentStateNeedsRedraw();
 }
@@ -2,19 +2,18 @@
 
 #include "game_object_3D.h"
 
-GameObject3D::GameObject3D(const std::shared_ptr<Model>& model,
-                           const glm::vec3&              position,
-                           float                         angleOfRotInDeg,
-                           const glm::vec3&              axisOfRot,
-                           float                         scalingFactor)
+GameObject3D::GameObject3D(const ResourceHandle<Model>& model,
+                           const glm::vec3&             position,
+                           float                        angleOfRotInDeg,
+                           const glm::vec3&             axisOfRot,
+                           float                        scalingFactor)
    : mModel(model)
    , mPosition(position)
    , mRotation(angleAxis(glm::radians(angleOfRotInDeg), axisOfRot))
    , mScalingFactor(scalingFactor != 0.0f ? scalingFactor : 1.0f)
-   , mModelMatrix(1.0f)
-   , mCalculateModelMatrix(true)
+   , mIsDirty(true)
 {
-   calculateModelMatrix();
+
 }
 
 GameObject3D::GameObject3D(GameObject3D&& rhs) noexcept
@@ -22,33 +21,53 @@ GameObject3D::GameObject3D(GameObject3D&& rhs) noexcept
    , mPosition(std::exchange(rhs.mPosition, glm::vec3(0.0f)))
    , mRotation(std::exchange(rhs.mRotation, quat()))
    , mScalingFactor(std::exchange(rhs.mScalingFactor, 1.0f))
-   , mModelMatrix(std::exchange(rhs.mModelMatrix, glm::mat4(1.0f)))
-   , mCalculateModelMatrix(std::exchange(rhs.mCalculateModelMatrix, true))
+   , mIsDirty(std::exchange(rhs.mIsDirty, true))
 {
 
 }
 
 GameObject3D& GameObject3D::operator=(GameObject3D&& rhs) noexcept
 {
-   mModel                = std::move(rhs.mModel);
-   mPosition             = std::exchange(rhs.mPosition, glm::vec3(0.0f));
-   mRotation             = std::exchange(rhs.mRotation, quat());
-   mScalingFactor        = std::exchange(rhs.mScalingFactor, 1.0f);
-   mModelMatrix          = std::exchange(rhs.mModelMatrix, glm::mat4(1.0f));
-   mCalculateModelMatrix = std::exchange(rhs.mCalculateModelMatrix, true);
+   mModel         = std::move(rhs.mModel);
+   mPosition      = std::exchange(rhs.mPosition, glm::vec3(0.0f));
+   mRotation      = std::exchange(rhs.mRotation, quat());
+   mScalingFactor = std::exchange(rhs.mScalingFactor, 1.0f);
+   mIsDirty       = std::exchange(rhs.mIsDirty, true);
    return *this;
 }
 
 void GameObject3D::render(const Shader& shader) const
 {
-   if (mCalculateModelMatrix)
+   if (!isModelReady())
    {
-      calculateModelMatrix();
+      return;
    }
 
-   shader.setMat4("model", mModelMatrix);
+   InstanceTransform instanceTransform = getInstanceTransform();
+   mModel.get()->render(shader, &instanceTransform, 1);
+}
+
+const std::shared_ptr<Model>& GameObject3D::getModel() const
+{
+   return mModel.get();
+}
+
+const ResourceHandle<Model>& GameObject3D::getModelHandle() const
+{
+   return mModel;
+}
+
+bool GameObject3D::isModelReady() const
+{
+   return mModel.isReady();
+}
 
-   mModel->render(shader);
+InstanceTransform GameObject3D::getInstanceTransform() const
+{
+   // The model matrix is no longer built on the CPU
+   // The vertex shader scales, rotates and translates the vertices using the transform directly
+   mIsDirty = false;
+   return InstanceTransform(mPosition, mScalingFactor, mRotation);
 }
 
 glm::vec3 GameObject3D::getPosition() const
@@ -59,7 +78,7 @@ glm::vec3 GameObject3D::getPosition() const
 void GameObject3D::setPosition(const glm::vec3& position)
 {
    mPosition = position;
-   mCalculateModelMatrix = true;
+   mIsDirty = true;
 }
 
 float GameObject3D::getScalingFactor() const
@@ -67,28 +86,33 @@ float GameObject3D::getScalingFactor() const
    return mScalingFactor;
 }
 
+quat GameObject3D::getRotation() const
+{
+   return mRotation;
+}
+
 void GameObject3D::setRotation(const quat& rotation)
 {
    mRotation = rotation;
-   mCalculateModelMatrix = true;
+   mIsDirty = true;
 }
 
 void GameObject3D::translate(const glm::vec3& translation)
 {
    mPosition += translation;
-   mCalculateModelMatrix = true;
+   mIsDirty = true;
 }
 
 void GameObject3D::rotateByMultiplyingCurrentRotationFromTheLeft(const quat& rotation)
 {
    mRotation = rotation * mRotation;
-   mCalculateModelMatrix = true;
+   mIsDirty = true;
 }
 
 void GameObject3D::rotateByMultiplyingCurrentRotationFromTheRight(const quat& rotation)
 {
    mRotation = mRotation * rotation;
-   mCalculateModelMatrix = true;
+   mIsDirty = true;
 }
 
 void GameObject3D::scale(float scalingFactor)
@@ -96,20 +120,11 @@ void GameObject3D::scale(float scalingFactor)
    if (scalingFactor != 0.0f)
    {
       mScalingFactor *= scalingFactor;
-      mCalculateModelMatrix = true;
+      mIsDirty = true;
    }
 }
 
-void GameObject3D::calculateModelMatrix() const
+bool GameObject3D::isDirty() const
 {
-   // 3) Translate the model
-   mModelMatrix = glm::translate(glm::mat4(1.0f), mPosition);
-
-   // 2) Rotate the model
-   mModelMatrix *= quatToMat4(mRotation);
-
-   // 1) Scale the model
-   mModelMatrix = glm::scale(mModelMatrix, glm::vec3(mScalingFactor));
-
-   mCalculateModelMatrix = false;
+   return mIsDirty;
 }
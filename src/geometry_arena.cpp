@@ -0,0 +1,462 @@
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+#include "gl_state_cache.h"
+#include "geometry_arena.h"
+
+namespace
+{
+   const unsigned int indexUnitSizeInBytes = sizeof(std::uint16_t);
+
+   // 16-bit indices are offset by the base vertex of their mesh, so they can address the 65536 vertices of the mesh regardless of where it's stored
+   const unsigned int maxNumOfVerticesForShortIndices = 65536;
+}
+
+GeometryArena::GeometryArena(VertexFormat vertexFormat, unsigned int initialNumOfVertices, unsigned int initialNumOfIndices)
+   : mVertexFormat(vertexFormat)
+   , mVertexSizeInBytes((vertexFormat == VertexFormat::compact) ? sizeof(CompactVertex) : sizeof(Vertex))
+   , mVertexAllocator(initialNumOfVertices)
+   , mIndexAllocator(initialNumOfIndices * (sizeof(unsigned int) / indexUnitSizeInBytes))
+   , mIndexAllocations()
+   , mVAO(0)
+   , mVBO(0)
+   , mEBO(0)
+   , mInstanceVBO(0)
+   , mInstanceCapacity(0)
+   , mCurrBaseInstance(0)
+   , mNumOfBytesInUse(0)
+   , mNumOfBytesSavedByVertexFormat(0)
+{
+   configureVAO();
+}
+
+GeometryArena::~GeometryArena()
+{
+   GLStateCache::get().deleteVertexArray(mVAO);
+   GLStateCache::get().deleteBuffer(mVBO);
+   GLStateCache::get().deleteBuffer(mEBO);
+   GLStateCache::get().deleteBuffer(mInstanceVBO);
+}
+
+unsigned int GeometryArena::allocateVertices(const std::vector<Vertex>& vertices, const PositionQuantization& positionQuantization)
+{
+   unsigned int numOfVertices = static_cast<unsigned int>(vertices.size());
+
+   // The standard vertex format doesn't need to be converted
+   if (mVertexFormat == VertexFormat::compact)
+   {
+      return allocateEncodedVertices(encodeVertices(mVertexFormat, vertices, positionQuantization).data(), numOfVertices);
+   }
+
+   return allocateEncodedVertices(vertices.data(), numOfVertices);
+}
+
+unsigned int GeometryArena::allocateIndices(const std::vector<unsigned int>& indices, unsigned int numOfVertices)
+{
+   unsigned int               indexSizeInBytes = 0;
+   std::vector<unsigned char> encodedIndices   = encodeIndices(mVertexFormat, indices, numOfVertices, indexSizeInBytes);
+
+   return allocateEncodedIndices(encodedIndices.data(), static_cast<unsigned int>(indices.size()), indexSizeInBytes);
+}
+
+unsigned int GeometryArena::allocateEncodedVertices(const void* vertexData, unsigned int numOfVertices)
+{
+   unsigned int allocationID = allocate(mVertexAllocator, mVBO, mVertexSizeInBytes, numOfVertices, vertexData, numOfVertices * mVertexSizeInBytes);
+
+   if (allocationID != OffsetAllocator::invalidAllocation)
+   {
+      mNumOfBytesInUse               += numOfVertices * mVertexSizeInBytes;
+      mNumOfBytesSavedByVertexFormat += numOfVertices * (sizeof(Vertex) - mVertexSizeInBytes);
+   }
+
+   return allocationID;
+}
+
+unsigned int GeometryArena::allocateEncodedIndices(const void* indexData, unsigned int numOfIndices, unsigned int indexSizeInBytes)
+{
+   if (indexSizeInBytes != sizeof(std::uint16_t) && indexSizeInBytes != sizeof(unsigned int))
+   {
+      std::cout << "Error - GeometryArena::allocateEncodedIndices - The following index size is not supported: " << indexSizeInBytes << "\n";
+      return OffsetAllocator::invalidAllocation;
+   }
+
+   // The sizes of the allocations are rounded up to a multiple of 4 bytes, so that all the offsets are aligned for 32-bit indices
+   // The padding is never drawn, so it's left uninitialized
+   unsigned int sizeInBytes  = (numOfIndices * indexSizeInBytes + 3) & ~3u;
+   unsigned int allocationID = allocate(mIndexAllocator, mEBO, indexUnitSizeInBytes, sizeInBytes / indexUnitSizeInBytes, indexData, numOfIndices * indexSizeInBytes);
+
+   if (allocationID != OffsetAllocator::invalidAllocation)
+   {
+      if (allocationID >= mIndexAllocations.size())
+      {
+         mIndexAllocations.resize(allocationID + 1);
+      }
+
+      mIndexAllocations[allocationID] = IndexAllocation{numOfIndices, indexSizeInBytes};
+
+      mNumOfBytesInUse               += sizeInBytes;
+      mNumOfBytesSavedByVertexFormat += numOfIndices * sizeof(unsigned int) - sizeInBytes;
+   }
+
+   return allocationID;
+}
+
+std::vector<unsigned char> GeometryArena::encodeVertices(VertexFormat vertexFormat, const std::vector<Vertex>& vertices, const PositionQuantization& positionQuantization)
+{
+   std::vector<unsigned char> encodedVertices;
+
+   if (vertexFormat == VertexFormat::compact)
+   {
+      encodedVertices.resize(vertices.size() * sizeof(CompactVertex));
+      for (std::size_t i = 0; i < vertices.size(); ++i)
+      {
+         CompactVertex compactVertex(vertices[i], positionQuantization);
+         std::memcpy(&encodedVertices[i * sizeof(CompactVertex)], &compactVertex, sizeof(CompactVertex));
+      }
+   }
+   else
+   {
+      encodedVertices.resize(vertices.size() * sizeof(Vertex));
+      std::memcpy(encodedVertices.data(), vertices.data(), encodedVertices.size());
+   }
+
+   return encodedVertices;
+}
+
+std::vector<unsigned char> GeometryArena::encodeIndices(VertexFormat                     vertexFormat,
+                                                        const std::vector<unsigned int>& indices,
+                                                        unsigned int                     numOfVertices,
+                                                        unsigned int&                    indexSizeInBytes)
+{
+   bool useShortIndices = (vertexFormat == VertexFormat::compact) && (numOfVertices <= maxNumOfVerticesForShortIndices);
+   indexSizeInBytes     = useShortIndices ? sizeof(std::uint16_t) : sizeof(unsigned int);
+
+   std::vector<unsigned char> encodedIndices(indices.size() * indexSizeInBytes);
+
+   if (useShortIndices)
+   {
+      for (std::size_t i = 0; i < indices.size(); ++i)
+      {
+         std::uint16_t shortIndex = static_cast<std::uint16_t>(indices[i]);
+         std::memcpy(&encodedIndices[i * sizeof(std::uint16_t)], &shortIndex, sizeof(std::uint16_t));
+      }
+   }
+   else
+   {
+      std::memcpy(encodedIndices.data(), indices.data(), encodedIndices.size());
+   }
+
+   return encodedIndices;
+}
+
+void GeometryArena::freeVertices(unsigned int vertexAllocationID)
+{
+   if (vertexAllocationID == OffsetAllocator::invalidAllocation)
+   {
+      return;
+   }
+
+   unsigned int numOfVertices = mVertexAllocator.getSize(vertexAllocationID);
+   mNumOfBytesInUse               -= numOfVertices * mVertexSizeInBytes;
+   mNumOfBytesSavedByVertexFormat -= numOfVertices * (sizeof(Vertex) - mVertexSizeInBytes);
+
+   mVertexAllocator.free(vertexAllocationID);
+}
+
+void GeometryArena::freeIndices(unsigned int indexAllocationID)
+{
+   if (indexAllocationID == OffsetAllocator::invalidAllocation)
+   {
+      return;
+   }
+
+   unsigned int sizeInBytes = mIndexAllocator.getSize(indexAllocationID) * indexUnitSizeInBytes;
+   mNumOfBytesInUse               -= sizeInBytes;
+   mNumOfBytesSavedByVertexFormat -= mIndexAllocations[indexAllocationID].numOfIndices * sizeof(unsigned int) - sizeInBytes;
+
+   mIndexAllocator.free(indexAllocationID);
+}
+
+void GeometryArena::compact()
+{
+   relocate(mVBO, mVertexSizeInBytes, mVertexAllocator.getCapacity(), mVertexAllocator.getCapacity(), mVertexAllocator.compact());
+   relocate(mEBO, indexUnitSizeInBytes, mIndexAllocator.getCapacity(), mIndexAllocator.getCapacity(), mIndexAllocator.compact());
+}
+
+DrawElementsIndirectCommand GeometryArena::getDrawCommand(unsigned int vertexAllocationID,
+                                                          unsigned int indexAllocationID,
+                                                          unsigned int numOfInstances,
+                                                          unsigned int baseInstance) const
+{
+   // The first index is expressed in indices of the type of the allocation, like the offsets of glMultiDrawElementsIndirect
+   const IndexAllocation& indexAllocation = mIndexAllocations[indexAllocationID];
+   return DrawElementsIndirectCommand{indexAllocation.numOfIndices,
+                                      numOfInstances,
+                                      mIndexAllocator.getOffset(indexAllocationID) * indexUnitSizeInBytes / indexAllocation.indexSizeInBytes,
+                                      static_cast<int>(mVertexAllocator.getOffset(vertexAllocationID)),
+                                      baseInstance};
+}
+
+unsigned int GeometryArena::getIndexType(unsigned int indexAllocationID) const
+{
+   return (mIndexAllocations[indexAllocationID].indexSizeInBytes == sizeof(std::uint16_t)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+unsigned int GeometryArena::getVertexAllocationSizeInBytes(unsigned int vertexAllocationID) const
+{
+   return mVertexAllocator.getSize(vertexAllocationID) * mVertexSizeInBytes;
+}
+
+unsigned int GeometryArena::getIndexAllocationSizeInBytes(unsigned int indexAllocationID) const
+{
+   return mIndexAllocator.getSize(indexAllocationID) * indexUnitSizeInBytes;
+}
+
+void GeometryArena::bindVertexArray() const
+{
+   GLStateCache::get().bindVertexArray(mVAO);
+}
+
+void GeometryArena::uploadInstanceTransforms(const InstanceTransform* instanceTransforms, unsigned int numOfInstances)
+{
+   if (numOfInstances == 0)
+   {
+      return;
+   }
+
+   // Grow the buffer geometrically, and orphan it when it's big enough so that the driver doesn't have to wait for the draws of the previous frame
+   // Orphaning keeps the name of the buffer, so the instance attributes of the VAO don't need to be specified again
+   if (numOfInstances > mInstanceCapacity)
+   {
+      mInstanceCapacity = std::max(numOfInstances, mInstanceCapacity * 2);
+   }
+
+   GLStateCache::get().bindBuffer(GL_ARRAY_BUFFER, mInstanceVBO);
+   glBufferData(GL_ARRAY_BUFFER, mInstanceCapacity * sizeof(InstanceTransform), nullptr, GL_STREAM_DRAW);
+   glBufferSubData(GL_ARRAY_BUFFER, 0, numOfInstances * sizeof(InstanceTransform), instanceTransforms);
+}
+
+unsigned int GeometryArena::multiDrawElementsIndirect(unsigned int indexType, const DrawElementsIndirectCommand* commands, unsigned int numOfCommands) const
+{
+   // OpenGL 3.3 has neither glMultiDrawElementsIndirect (4.3) nor base instances (4.2), so we walk the commands on the CPU
+   // The base vertex is supported by glDrawElementsInstancedBaseVertex, and the base instance is emulated by offsetting the instance attributes,
+   // which is a cheap change of the state of the VAO that is skipped when consecutive commands share their instances
+   bindVertexArray();
+
+   std::size_t indexSizeInBytes = (indexType == GL_UNSIGNED_SHORT) ? sizeof(std::uint16_t) : sizeof(unsigned int);
+   for (unsigned int i = 0; i < numOfCommands; ++i)
+   {
+      const DrawElementsIndirectCommand& command = commands[i];
+
+      setBaseInstance(command.baseInstance);
+      glDrawElementsInstancedBaseVertex(GL_TRIANGLES,
+                                        command.count,
+                                        indexType,
+                                        (void*)(static_cast<std::size_t>(command.firstIndex) * indexSizeInBytes),
+                                        command.instanceCount,
+                                        command.baseVertex);
+   }
+
+   return numOfCommands;
+}
+
+VertexFormat GeometryArena::getVertexFormat() const
+{
+   return mVertexFormat;
+}
+
+unsigned int GeometryArena::getVertexCapacity() const
+{
+   return mVertexAllocator.getCapacity();
+}
+
+unsigned int GeometryArena::getNumOfFreeVertices() const
+{
+   return mVertexAllocator.getNumOfFreeUnits();
+}
+
+unsigned int GeometryArena::getIndexCapacityInBytes() const
+{
+   return mIndexAllocator.getCapacity() * indexUnitSizeInBytes;
+}
+
+unsigned int GeometryArena::getNumOfFreeIndexBytes() const
+{
+   return mIndexAllocator.getNumOfFreeUnits() * indexUnitSizeInBytes;
+}
+
+unsigned int GeometryArena::getNumOfBytesInUse() const
+{
+   return mNumOfBytesInUse;
+}
+
+unsigned int GeometryArena::getNumOfBytesSavedByVertexFormat() const
+{
+   return mNumOfBytesSavedByVertexFormat;
+}
+
+unsigned int GeometryArena::allocate(OffsetAllocator& allocator,
+                                     unsigned int     bufferID,
+                                     unsigned int     elementSizeInBytes,
+                                     unsigned int     numOfElements,
+                                     const void*      data,
+                                     unsigned int     dataSizeInBytes)
+{
+   unsigned int allocationID = allocator.allocate(numOfElements);
+   if (allocationID == OffsetAllocator::invalidAllocation)
+   {
+      makeRoom(allocator, bufferID, elementSizeInBytes, numOfElements);
+
+      allocationID = allocator.allocate(numOfElements);
+      if (allocationID == OffsetAllocator::invalidAllocation)
+      {
+         std::cout << "Error - GeometryArena::allocate - Could not allocate the following number of elements: " << numOfElements << "\n";
+         return OffsetAllocator::invalidAllocation;
+      }
+   }
+
+   // The copy targets are used so that uploading data doesn't disturb the bindings of the VAO or the ones that are tracked by the state cache
+   glBindBuffer(GL_COPY_WRITE_BUFFER, bufferID);
+   glBufferSubData(GL_COPY_WRITE_BUFFER, allocator.getOffset(allocationID) * elementSizeInBytes, dataSizeInBytes, data);
+   glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+   return allocationID;
+}
+
+void GeometryArena::makeRoom(OffsetAllocator& allocator, unsigned int bufferID, unsigned int elementSizeInBytes, unsigned int numOfElements)
+{
+   unsigned int                       oldCapacity = allocator.getCapacity();
+   std::vector<OffsetAllocator::Move> moves       = allocator.compact();
+
+   // After compacting, the largest free block contains all the free elements
+   unsigned int newCapacity = oldCapacity;
+   if (allocator.getSizeOfLargestFreeBlock() < numOfElements)
+   {
+      unsigned int numOfUsedElements = oldCapacity - allocator.getNumOfFreeUnits();
+      newCapacity = std::max(oldCapacity * 2, numOfUsedElements + numOfElements);
+      allocator.grow(newCapacity);
+   }
+
+   relocate(bufferID, elementSizeInBytes, oldCapacity, newCapacity, moves);
+}
+
+void GeometryArena::relocate(unsigned int                              bufferID,
+                             unsigned int                              elementSizeInBytes,
+                             unsigned int                              oldCapacity,
+                             unsigned int                              newCapacity,
+                             const std::vector<OffsetAllocator::Move>& moves)
+{
+   if (moves.empty() && newCapacity == oldCapacity)
+   {
+      return;
+   }
+
+   // Copy the old contents into a temporary buffer, so that the moves can read the old layout while they write the new one
+   unsigned int tempBufferID = 0;
+   glGenBuffers(1, &tempBufferID);
+
+   glBindBuffer(GL_COPY_READ_BUFFER, bufferID);
+   glBindBuffer(GL_COPY_WRITE_BUFFER, tempBufferID);
+   glBufferData(GL_COPY_WRITE_BUFFER, oldCapacity * elementSizeInBytes, nullptr, GL_STREAM_COPY);
+   glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldCapacity * elementSizeInBytes);
+
+   glBindBuffer(GL_COPY_READ_BUFFER, tempBufferID);
+   glBindBuffer(GL_COPY_WRITE_BUFFER, bufferID);
+
+   if (newCapacity != oldCapacity)
+   {
+      // Reallocating the storage keeps the name of the buffer, so the VAO doesn't need to be configured again
+      // The allocations that didn't move are restored by copying the old contents back
+      glBufferData(GL_COPY_WRITE_BUFFER, newCapacity * elementSizeInBytes, nullptr, GL_STATIC_DRAW);
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldCapacity * elementSizeInBytes);
+   }
+
+   for (const OffsetAllocator::Move& move : moves)
+   {
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, move.srcOffset * elementSizeInBytes, move.dstOffset * elementSizeInBytes, move.size * elementSizeInBytes);
+   }
+
+   glBindBuffer(GL_COPY_READ_BUFFER, 0);
+   glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+   GLStateCache::get().deleteBuffer(tempBufferID);
+}
+
+void GeometryArena::setBaseInstance(unsigned int baseInstance) const
+{
+   if (baseInstance == mCurrBaseInstance)
+   {
+      return;
+   }
+
+   GLStateCache::get().bindBuffer(GL_ARRAY_BUFFER, mInstanceVBO);
+
+   std::size_t offset = static_cast<std::size_t>(baseInstance) * sizeof(InstanceTransform);
+   glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceTransform), (void*)(offset + offsetof(InstanceTransform, positionAndScale)));
+   glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceTransform), (void*)(offset + offsetof(InstanceTransform, rotation)));
+
+   mCurrBaseInstance = baseInstance;
+}
+
+void GeometryArena::configureVAO()
+{
+   glGenVertexArrays(1, &mVAO);
+   glGenBuffers(1, &mVBO);
+   glGenBuffers(1, &mEBO);
+   glGenBuffers(1, &mInstanceVBO);
+
+   GLStateCache::get().bindVertexArray(mVAO);
+
+   // Allocate the storage of the buffers, which is filled as meshes are added to the arena
+
+   // Positions, normals and texture coordinates
+   GLStateCache::get().bindBuffer(GL_ARRAY_BUFFER, mVBO);
+   glBufferData(GL_ARRAY_BUFFER, mVertexAllocator.getCapacity() * mVertexSizeInBytes, nullptr, GL_STATIC_DRAW);
+   // Indices
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEBO);
+   glBufferData(GL_ELEMENT_ARRAY_BUFFER, mIndexAllocator.getCapacity() * indexUnitSizeInBytes, nullptr, GL_STATIC_DRAW);
+
+   // Set the vertex attribute pointers
+   // Both formats are read as floats by the vertex shader, since the compact attributes are normalized or half floats
+   glEnableVertexAttribArray(0);
+   glEnableVertexAttribArray(1);
+   glEnableVertexAttribArray(2);
+
+   if (mVertexFormat == VertexFormat::compact)
+   {
+      // Positions
+      glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(CompactVertex), (void*)offsetof(CompactVertex, position));
+      // Tangent frames
+      glVertexAttribPointer(1, 4, GL_SHORT, GL_TRUE, sizeof(CompactVertex), (void*)offsetof(CompactVertex, tangentFrame));
+      // Texture coords
+      glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(CompactVertex), (void*)offsetof(CompactVertex, texCoords));
+   }
+   else
+   {
+      // Positions
+      glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+      // Tangent frames
+      glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, tangentFrame));
+      // Texture coords
+      glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+   }
+
+   // Set the instance attribute pointers
+   // The divisor of 1 makes the attributes advance once per instance instead of once per vertex
+   GLStateCache::get().bindBuffer(GL_ARRAY_BUFFER, mInstanceVBO);
+
+   // Positions and scaling factors
+   glEnableVertexAttribArray(3);
+   glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceTransform), (void*)offsetof(InstanceTransform, positionAndScale));
+   glVertexAttribDivisor(3, 1);
+   // Rotations
+   glEnableVertexAttribArray(4);
+   glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceTransform), (void*)offsetof(InstanceTransform, rotation));
+   glVertexAttribDivisor(4, 1);
+
+   GLStateCache::get().bindVertexArray(0);
+}
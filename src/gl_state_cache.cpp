@@ -0,0 +1,271 @@
+#include "gl_state_cache.h"
+
+namespace
+{
+   // Capabilities whose state is cached
+   // The order must match the indices of GLStateCache::mCapabilities
+   const GLenum cachedCapabilities[] = {GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND, GL_MULTISAMPLE};
+
+   int getCapabilityIndex(GLenum capability)
+   {
+      for (int i = 0; i < 4; ++i)
+      {
+         if (cachedCapabilities[i] == capability)
+         {
+            return i;
+         }
+      }
+
+      return -1;
+   }
+}
+
+GLStateCache& GLStateCache::get()
+{
+   static GLStateCache cache;
+   return cache;
+}
+
+GLStateCache::GLStateCache()
+   : mProgramID(unknown)
+   , mVAOID(unknown)
+   , mArrayBufferID(unknown)
+   , mUniformBufferID(unknown)
+   , mActiveTexUnit(unknown)
+   , mTexture2DIDs()
+   , mCapabilities()
+   , mLineWidth(-1.0f)
+   , mNumOfCallsIssued(0)
+   , mNumOfCallsSkipped(0)
+   , mNumOfCallsIssuedInLastFrame(0)
+   , mNumOfCallsSkippedInLastFrame(0)
+{
+   invalidate();
+}
+
+void GLStateCache::beginFrame()
+{
+   mNumOfCallsIssuedInLastFrame  = mNumOfCallsIssued;
+   mNumOfCallsSkippedInLastFrame = mNumOfCallsSkipped;
+   mNumOfCallsIssued             = 0;
+   mNumOfCallsSkipped            = 0;
+
+   invalidate();
+}
+
+void GLStateCache::invalidate()
+{
+   mProgramID       = unknown;
+   mVAOID           = unknown;
+   mArrayBufferID   = unknown;
+   mUniformBufferID = unknown;
+   mActiveTexUnit   = unknown;
+   mTexture2DIDs.fill(unknown);
+   mCapabilities.fill(-1);
+   mLineWidth       = -1.0f;
+}
+
+void GLStateCache::useProgram(unsigned int programID)
+{
+   if (programID == mProgramID)
+   {
+      ++mNumOfCallsSkipped;
+      return;
+   }
+
+   glUseProgram(programID);
+   mProgramID = programID;
+   ++mNumOfCallsIssued;
+}
+
+void GLStateCache::bindVertexArray(unsigned int vaoID)
+{
+   if (vaoID == mVAOID)
+   {
+      ++mNumOfCallsSkipped;
+      return;
+   }
+
+   glBindVertexArray(vaoID);
+   mVAOID = vaoID;
+   ++mNumOfCallsIssued;
+}
+
+void GLStateCache::bindBuffer(GLenum target, unsigned int bufferID)
+{
+   unsigned int* cachedBufferID = nullptr;
+   if (target == GL_ARRAY_BUFFER)
+   {
+      cachedBufferID = &mArrayBufferID;
+   }
+   else if (target == GL_UNIFORM_BUFFER)
+   {
+      cachedBufferID = &mUniformBufferID;
+   }
+
+   if (cachedBufferID && (*cachedBufferID == bufferID))
+   {
+      ++mNumOfCallsSkipped;
+      return;
+   }
+
+   glBindBuffer(target, bufferID);
+   if (cachedBufferID)
+   {
+      *cachedBufferID = bufferID;
+   }
+   ++mNumOfCallsIssued;
+}
+
+void GLStateCache::bindBufferBase(GLenum target, unsigned int index, unsigned int bufferID)
+{
+   // The indexed bindings are only set once when the buffers are created, so they are not cached
+   // glBindBufferBase also binds the buffer to the generic binding point of the target though, so we need to keep track of that
+   glBindBufferBase(target, index, bufferID);
+   if (target == GL_UNIFORM_BUFFER)
+   {
+      mUniformBufferID = bufferID;
+   }
+   ++mNumOfCallsIssued;
+}
+
+void GLStateCache::activeTexture(unsigned int texUnit)
+{
+   if (texUnit == mActiveTexUnit)
+   {
+      ++mNumOfCallsSkipped;
+      return;
+   }
+
+   glActiveTexture(GL_TEXTURE0 + texUnit);
+   mActiveTexUnit = texUnit;
+   ++mNumOfCallsIssued;
+}
+
+void GLStateCache::bindTexture2D(unsigned int texUnit, unsigned int texID)
+{
+   if ((texUnit < maxNumOfTexUnits) && (mTexture2DIDs[texUnit] == texID))
+   {
+      ++mNumOfCallsSkipped;
+      return;
+   }
+
+   activeTexture(texUnit);
+   glBindTexture(GL_TEXTURE_2D, texID);
+   if (texUnit < maxNumOfTexUnits)
+   {
+      mTexture2DIDs[texUnit] = texID;
+   }
+   ++mNumOfCallsIssued;
+}
+
+void GLStateCache::enable(GLenum capability)
+{
+   if (!setCapability(capability, true))
+   {
+      ++mNumOfCallsSkipped;
+      return;
+   }
+
+   glEnable(capability);
+   ++mNumOfCallsIssued;
+}
+
+void GLStateCache::disable(GLenum capability)
+{
+   if (!setCapability(capability, false))
+   {
+      ++mNumOfCallsSkipped;
+      return;
+   }
+
+   glDisable(capability);
+   ++mNumOfCallsIssued;
+}
+
+void GLStateCache::lineWidth(float width)
+{
+   if (width == mLineWidth)
+   {
+      ++mNumOfCallsSkipped;
+      return;
+   }
+
+   glLineWidth(width);
+   mLineWidth = width;
+   ++mNumOfCallsIssued;
+}
+
+void GLStateCache::deleteProgram(unsigned int programID)
+{
+   glDeleteProgram(programID);
+   if (programID == mProgramID)
+   {
+      mProgramID = unknown;
+   }
+}
+
+void GLStateCache::deleteVertexArray(unsigned int vaoID)
+{
+   glDeleteVertexArrays(1, &vaoID);
+   if (vaoID == mVAOID)
+   {
+      mVAOID = 0;
+   }
+}
+
+void GLStateCache::deleteBuffer(unsigned int bufferID)
+{
+   glDeleteBuffers(1, &bufferID);
+   if (bufferID == mArrayBufferID)
+   {
+      mArrayBufferID = 0;
+   }
+
+   if (bufferID == mUniformBufferID)
+   {
+      mUniformBufferID = 0;
+   }
+}
+
+void GLStateCache::deleteTexture(unsigned int texID)
+{
+   glDeleteTextures(1, &texID);
+   for (unsigned int& boundTexID : mTexture2DIDs)
+   {
+      if (boundTexID == texID)
+      {
+         boundTexID = 0;
+      }
+   }
+}
+
+unsigned int GLStateCache::getNumOfCallsIssuedInLastFrame() const
+{
+   return mNumOfCallsIssuedInLastFrame;
+}
+
+unsigned int GLStateCache::getNumOfCallsSkippedInLastFrame() const
+{
+   return mNumOfCallsSkippedInLastFrame;
+}
+
+bool GLStateCache::setCapability(GLenum capability, bool enabled)
+{
+   // Returns true if the call needs to be issued
+   // Capabilities that are not cached are always issued
+   int index = getCapabilityIndex(capability);
+   if (index == -1)
+   {
+      return true;
+   }
+
+   int state = enabled ? 1 : 0;
+   if (mCapabilities[index] == state)
+   {
+      return false;
+   }
+
+   mCapabilities[index] = state;
+   return true;
+}
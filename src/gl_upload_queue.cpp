@@ -0,0 +1,55 @@
+#include <chrono>
+
+#include "gl_upload_queue.h"
+
+GLUploadQueue::GLUploadQueue()
+   : mUploads()
+   , mMutex()
+{
+
+}
+
+void GLUploadQueue::push(std::function<void()> upload)
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+   mUploads.push_back(std::move(upload));
+}
+
+unsigned int GLUploadQueue::processUploads(double budgetInSec)
+{
+   auto         start          = std::chrono::steady_clock::now();
+   unsigned int numOfProcessed  = 0;
+
+   while (true)
+   {
+      std::function<void()> upload;
+
+      {
+         // The lock is not held while the upload runs, so other threads can keep pushing uploads
+         std::lock_guard<std::mutex> lock(mMutex);
+         if (mUploads.empty())
+         {
+            break;
+         }
+
+         upload = std::move(mUploads.front());
+         mUploads.pop_front();
+      }
+
+      upload();
+      ++numOfProcessed;
+
+      if (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= budgetInSec)
+      {
+         break;
+      }
+   }
+
+   return numOfProcessed;
+}
+
+unsigned int GLUploadQueue::getNumOfPendingUploads() const
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+   return static_cast<unsigned int>(mUploads.size());
+}
@@ -0,0 +1,65 @@
+#include "instanced_renderer.h"
+
+InstancedRenderer::InstancedRenderer()
+   : mGroups()
+{
+
+}
+
+void InstancedRenderer::begin()
+{
+   for (InstanceGroup& group : mGroups)
+   {
+      group.numOfInstances = 0;
+   }
+}
+
+void InstancedRenderer::submit(const GameObject3D& gameObject)
+{
+   const Model* model = gameObject.getModel().get();
+   if (!model)
+   {
+      // The model is still loading
+      return;
+   }
+
+   // Scenes only contain a handful of different models, so a linear search is faster than hashing
+   InstanceGroup* group = nullptr;
+   for (InstanceGroup& currGroup : mGroups)
+   {
+      if (currGroup.model == model)
+      {
+         group = &currGroup;
+         break;
+      }
+   }
+
+   if (!group)
+   {
+      mGroups.push_back(InstanceGroup{model, std::vector<InstanceTransform>(), 0});
+      group = &mGroups.back();
+   }
+
+   // We only grow the vector when the group is larger than it has ever been, and otherwise overwrite the matrices of the previous frame
+   if (group->numOfInstances < group->instanceTransforms.size())
+   {
+      group->instanceTransforms[group->numOfInstances] = gameObject.getInstanceTransform();
+   }
+   else
+   {
+      group->instanceTransforms.push_back(gameObject.getInstanceTransform());
+   }
+
+   ++group->numOfInstances;
+}
+
+void InstancedRenderer::flush(RenderQueue& renderQueue, RenderPass pass, const Shader& shader) const
+{
+   for (const InstanceGroup& group : mGroups)
+   {
+      if (group.numOfInstances != 0)
+      {
+         renderQueue.submit(pass, shader, *group.model, group.instanceTransforms.data(), group.numOfInstances);
+      }
+   }
+}
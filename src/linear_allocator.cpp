@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <iostream>
+
+#include "linear_allocator.h"
+
+LinearAllocator::LinearAllocator(std::size_t capacityInBytes)
+   : mBlock(new unsigned char[capacityInBytes])
+   , mCapacityInBytes(capacityInBytes)
+   , mOffset(0)
+   , mPeakOffset(0)
+   , mOutOfMemoryReported(false)
+{
+
+}
+
+void* LinearAllocator::allocate(std::size_t sizeInBytes, std::size_t alignment)
+{
+   // Round the current address up to the next multiple of the alignment, which must be a power of 2
+   std::size_t address       = reinterpret_cast<std::size_t>(mBlock.get()) + mOffset;
+   std::size_t padding       = (alignment - (address & (alignment - 1))) & (alignment - 1);
+   std::size_t alignedOffset = mOffset + padding;
+
+   if (alignedOffset + sizeInBytes > mCapacityInBytes)
+   {
+      // We only report this once so that we don't flood the console every frame
+      if (!mOutOfMemoryReported)
+      {
+         std::cout << "Error - LinearAllocator::allocate - The allocator ran out of memory. Capacity: " << mCapacityInBytes << " bytes - Requested: " << sizeInBytes << " bytes" << "\n";
+         mOutOfMemoryReported = true;
+      }
+
+      return nullptr;
+   }
+
+   mOffset     = alignedOffset + sizeInBytes;
+   mPeakOffset = std::max(mPeakOffset, mOffset);
+
+   return mBlock.get() + alignedOffset;
+}
+
+void LinearAllocator::reset()
+{
+   mOffset = 0;
+}
+
+std::size_t LinearAllocator::getCapacityInBytes() const
+{
+   return mCapacityInBytes;
+}
+
+std::size_t LinearAllocator::getUsedBytes() const
+{
+   return mOffset;
+}
+
+std::size_t LinearAllocator::getPeakUsedBytes() const
+{
+   return mPeakOffset;
+}
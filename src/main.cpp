@@ -1,9 +1,11 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <cstdlib>
 #include <iostream>
 
 #include "game.h"
+#include "benchmarks.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
@@ -54,6 +56,80 @@ int main(int argc, char* argv[])
    std::cout << "quat AB:      " << resGab.x << " " << resGab.y << " " << resGab.z << " " << resGab.w << '\n';
    std::cout << "quat BA:      " << resGab2.x << " " << resGab2.y << " " << resGab2.z << " " << resGab2.w << "\n\n";
 
+   // Benchmarks that don't need a window
+   for (int i = 1; i < argc; ++i)
+   {
+      if (std::string(argv[i]) == "--benchmark-object-pool")
+      {
+         runObjectPoolBenchmark();
+         return 0;
+      }
+      else if (std::string(argv[i]) == "--benchmark-instance-transforms")
+      {
+         runInstanceTransformBenchmark();
+         return 0;
+      }
+      else if (std::string(argv[i]) == "--benchmark-qtangents")
+      {
+         runQTangentBenchmark();
+         return 0;
+      }
+      else if (std::string(argv[i]) == "--benchmark-mesh-optimizer")
+      {
+         if ((i + 1) < argc)
+         {
+            runMeshOptimizerBenchmark(argv[i + 1]);
+         }
+         else
+         {
+            // The models of the game
+            runMeshOptimizerBenchmark("resources/models/table/table.obj");
+            runMeshOptimizerBenchmark("resources/models/teapot/teapot.obj");
+         }
+         return 0;
+      }
+      else if (std::string(argv[i]) == "--benchmark-model-cache")
+      {
+         runModelCacheBenchmark((i + 1) < argc ? argv[i + 1] : "resources/models/teapot/teapot.obj");
+         return 0;
+      }
+      else if (std::string(argv[i]) == "--benchmark-obj-parser")
+      {
+         runObjParserBenchmark((i + 1) < argc ? argv[i + 1] : "resources/models/teapot/teapot.obj");
+         return 0;
+      }
+      else if (std::string(argv[i]) == "--benchmark-load-threads")
+      {
+         runLoadScalingBenchmark((i + 1) < argc ? argv[i + 1] : "resources/models/teapot/teapot.obj");
+         return 0;
+      }
+      else if (std::string(argv[i]) == "--verify-obj-parser")
+      {
+         // The exit code tells scripts whether the OBJ parser still matches Assimp on the models of the game
+         return verifyObjParser({"resources/models/table/table.obj", "resources/models/teapot/teapot.obj"}) ? 0 : 1;
+      }
+      else if (std::string(argv[i]) == "--benchmark-mesh-processing")
+      {
+         runMeshProcessingBenchmark((i + 1) < argc ? argv[i + 1] : nullptr);
+         return 0;
+      }
+      else if (std::string(argv[i]) == "--benchmark-resource-cache")
+      {
+         runResourceCacheBenchmark();
+         return 0;
+      }
+      else if (std::string(argv[i]) == "--benchmark-string-ids")
+      {
+         runStringIDBenchmark();
+         return 0;
+      }
+      else if (std::string(argv[i]) == "--benchmark-texture-compression")
+      {
+         runTextureCompressionBenchmark((i + 1) < argc ? argv[i + 1] : "resources/models/teapot/teapot_specular.jpg");
+         return 0;
+      }
+   }
+
    Game game;
 
    if (!game.initialize("Quaternion-Experiments"))
@@ -62,6 +138,48 @@ int main(int argc, char* argv[])
       return -1;
    }
 
+   for (int i = 1; i < argc; ++i)
+   {
+      std::string arg(argv[i]);
+
+      // Only render when something changes (useful for kiosks, where the scene is static most of the time)
+      if (arg == "--on-demand")
+      {
+         game.setOnDemandRendering(true);
+      }
+      else if (arg == "--target-fps" && (i + 1) < argc)
+      {
+         game.setTargetFrameRate(std::atoi(argv[++i]));
+      }
+      else if (arg == "--swap-interval" && (i + 1) < argc)
+      {
+         game.setSwapInterval(std::atoi(argv[++i]));
+      }
+      else if (arg == "--late-latch")
+      {
+         game.setLateLatch(true);
+      }
+      else if (arg == "--benchmark" && (i + 1) < argc)
+      {
+         game.setNumOfBenchmarkFrames(static_cast<unsigned int>(std::atoi(argv[++i])));
+      }
+      // Spawn the given number of teapots on startup (e.g. to measure the GPU cost of instancing with --benchmark)
+      else if (arg == "--stress-test" && (i + 1) < argc)
+      {
+         game.setNumOfStressTestTeapots(static_cast<unsigned int>(std::atoi(argv[++i])));
+      }
+      // Limit the RAM and the VRAM taken by the models to the given number of megabytes each, evicting the ones that no game object uses
+      else if (arg == "--model-memory-budget" && (i + 1) < argc)
+      {
+         std::size_t budgetInBytes = static_cast<std::size_t>(std::atoi(argv[++i])) * 1024 * 1024;
+         game.setModelMemoryBudget(ResourceFootprint{budgetInBytes, budgetInBytes});
+      }
+      else
+      {
+         std::cout << "Warning - main - Unknown argument: " << arg << "\n";
+      }
+   }
+
    game.executeGameLoop();
 
    return 0;
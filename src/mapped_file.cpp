@@ -0,0 +1,142 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <iostream>
+#include <utility>
+
+#include "mapped_file.h"
+
+MappedFile::MappedFile()
+   : mData(nullptr)
+   , mSize(0)
+{
+
+}
+
+MappedFile::~MappedFile()
+{
+   close();
+}
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept
+   : mData(std::exchange(rhs.mData, nullptr))
+   , mSize(std::exchange(rhs.mSize, 0))
+{
+
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept
+{
+   close();
+   mData = std::exchange(rhs.mData, nullptr);
+   mSize = std::exchange(rhs.mSize, 0);
+   return *this;
+}
+
+bool MappedFile::open(const std::string& filePath)
+{
+   close();
+
+   // The handles of the file and of the mapping are closed right after the view is mapped, since the view keeps both of them alive until it's unmapped
+#ifdef _WIN32
+   HANDLE fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+   if (fileHandle == INVALID_HANDLE_VALUE)
+   {
+      return false;
+   }
+
+   LARGE_INTEGER fileSize;
+   if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+   {
+      // Empty files can't be mapped
+      CloseHandle(fileHandle);
+      return false;
+   }
+
+   HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   CloseHandle(fileHandle);
+   if (!mappingHandle)
+   {
+      std::cout << "Error - MappedFile::open - Could not create a mapping of the following file: " << filePath << "\n";
+      return false;
+   }
+
+   const void* data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+   CloseHandle(mappingHandle);
+   if (!data)
+   {
+      std::cout << "Error - MappedFile::open - Could not map the following file: " << filePath << "\n";
+      return false;
+   }
+
+   mData = static_cast<const unsigned char*>(data);
+   mSize = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+   int fileDescriptor = ::open(filePath.c_str(), O_RDONLY);
+   if (fileDescriptor == -1)
+   {
+      return false;
+   }
+
+   struct stat fileStatus;
+   if (fstat(fileDescriptor, &fileStatus) == -1 || fileStatus.st_size == 0)
+   {
+      // Empty files can't be mapped
+      ::close(fileDescriptor);
+      return false;
+   }
+
+   void* data = mmap(nullptr, static_cast<std::size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+   ::close(fileDescriptor);
+   if (data == MAP_FAILED)
+   {
+      std::cout << "Error - MappedFile::open - Could not map the following file: " << filePath << "\n";
+      return false;
+   }
+
+   mData = static_cast<const unsigned char*>(data);
+   mSize = static_cast<std::size_t>(fileStatus.st_size);
+#endif
+
+   return true;
+}
+
+void MappedFile::close()
+{
+   if (!mData)
+   {
+      return;
+   }
+
+#ifdef _WIN32
+   UnmapViewOfFile(mData);
+#else
+   munmap(const_cast<unsigned char*>(mData), mSize);
+#endif
+
+   mData = nullptr;
+   mSize = 0;
+}
+
+bool MappedFile::isOpen() const
+{
+   return mData != nullptr;
+}
+
+const unsigned char* MappedFile::getData() const
+{
+   return mData;
+}
+
+std::size_t MappedFile::getSize() const
+{
+   return mSize;
+}
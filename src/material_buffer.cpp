@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "material_buffer.h"
+
+MaterialBuffer::MaterialBuffer()
+   : mUniformBuffer(sizeof(MaterialsUniformBlock), static_cast<unsigned int>(UniformBlockBindingPoints::materials))
+   , mMaterials()
+   , mNumOfReferences()
+{
+   mMaterials.reserve(MAX_NUMBER_OF_MATERIALS);
+   mNumOfReferences.reserve(MAX_NUMBER_OF_MATERIALS);
+}
+
+bool MaterialBuffer::addMaterial(const MaterialConstants&                                            materialConstants,
+                                 std::bitset<static_cast<unsigned int>(MaterialTextureTypes::count)> materialTextureAvailabilities,
+                                 unsigned int&                                                       materialIndex)
+{
+   // Since the padding is zeroed, the materials can be compared byte by byte
+   MaterialUniform material;
+   std::memset(&material, 0, sizeof(MaterialUniform));
+   material.ambient                = materialConstants.ambientColor;
+   material.ambientTexIsAvailable  = materialTextureAvailabilities.test(static_cast<unsigned int>(MaterialTextureTypes::ambient));
+   material.emissive               = materialConstants.emissiveColor;
+   material.emissiveTexIsAvailable = materialTextureAvailabilities.test(static_cast<unsigned int>(MaterialTextureTypes::emissive));
+   material.diffuse                = materialConstants.diffuseColor;
+   material.diffuseTexIsAvailable  = materialTextureAvailabilities.test(static_cast<unsigned int>(MaterialTextureTypes::diffuse));
+   material.specular               = materialConstants.specularColor;
+   material.specularTexIsAvailable = materialTextureAvailabilities.test(static_cast<unsigned int>(MaterialTextureTypes::specular));
+   material.shininess              = materialConstants.shininess;
+
+   // Reuse an identical material if there is one, even if it's no longer referenced, since it's still in the buffer
+   unsigned int freeIndex = MAX_NUMBER_OF_MATERIALS;
+   for (unsigned int i = 0; i < mMaterials.size(); ++i)
+   {
+      if (std::memcmp(&mMaterials[i], &material, sizeof(MaterialUniform)) == 0)
+      {
+         ++mNumOfReferences[i];
+         materialIndex = i;
+         return true;
+      }
+
+      if (mNumOfReferences[i] == 0 && freeIndex == MAX_NUMBER_OF_MATERIALS)
+      {
+         freeIndex = i;
+      }
+   }
+
+   // Otherwise take the first slot that is no longer referenced, or a new one
+   if (freeIndex == MAX_NUMBER_OF_MATERIALS)
+   {
+      if (mMaterials.size() == MAX_NUMBER_OF_MATERIALS)
+      {
+         return false;
+      }
+
+      freeIndex = static_cast<unsigned int>(mMaterials.size());
+      mMaterials.push_back(material);
+      mNumOfReferences.push_back(0);
+   }
+   else
+   {
+      mMaterials[freeIndex] = material;
+   }
+
+   mNumOfReferences[freeIndex] = 1;
+   materialIndex               = freeIndex;
+
+   // Only the new material is uploaded
+   mUniformBuffer.update(&material, sizeof(MaterialUniform), freeIndex * sizeof(MaterialUniform));
+
+   return true;
+}
+
+void MaterialBuffer::retainMaterial(unsigned int materialIndex)
+{
+   if (materialIndex >= mNumOfReferences.size() || mNumOfReferences[materialIndex] == 0)
+   {
+      std::cout << "Error - MaterialBuffer::retainMaterial - The material with the following index is not referenced: " << materialIndex << "\n";
+      return;
+   }
+
+   ++mNumOfReferences[materialIndex];
+}
+
+void MaterialBuffer::releaseMaterial(unsigned int materialIndex)
+{
+   if (materialIndex >= mNumOfReferences.size() || mNumOfReferences[materialIndex] == 0)
+   {
+      std::cout << "Error - MaterialBuffer::releaseMaterial - The material with the following index is not referenced: " << materialIndex << "\n";
+      return;
+   }
+
+   --mNumOfReferences[materialIndex];
+}
+
+unsigned int MaterialBuffer::getNumOfMaterials() const
+{
+   return static_cast<unsigned int>(std::count_if(mNumOfReferences.begin(), mNumOfReferences.end(), [](unsigned int numOfReferences) { return numOfReferences != 0; }));
+}
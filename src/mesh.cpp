@@ -1,128 +1,165 @@
 #include <iostream>
 
+#include "geometry_arena.h"
+#include "material_buffer.h"
 #include "mesh.h"
 
-Mesh::Mesh(const std::vector<Vertex>&       vertices,
-           const std::vector<unsigned int>& indices,
-           const Material&                  material)
-   : mNumIndices(static_cast<unsigned int>(indices.size()))
+Mesh::Mesh(const std::shared_ptr<GeometryArena>&  geometryArena,
+           unsigned int                           vertexAllocationID,
+           unsigned int                           indexAllocationID,
+           const std::shared_ptr<MaterialBuffer>& materialBuffer,
+           const Material&                        material)
+   : mGeometryArena(geometryArena)
+   , mVertexAllocationID(vertexAllocationID)
+   , mIndexAllocationID(indexAllocationID)
+   , mMaterialBuffer(materialBuffer)
    , mMaterial(material)
+   , mMaterialUniformHandles()
 {
-   configureVAO(vertices, indices);
+   mMaterialBuffer->retainMaterial(mMaterial.index);
 }
 
 Mesh::~Mesh()
 {
-   glDeleteVertexArrays(1, &mVAO);
-   glDeleteBuffers(1, &mVBO);
-   glDeleteBuffers(1, &mEBO);
+   // Moved from meshes don't have an arena or a material buffer
+   if (mGeometryArena)
+   {
+      mGeometryArena->freeVertices(mVertexAllocationID);
+      mGeometryArena->freeIndices(mIndexAllocationID);
+   }
+
+   // This is what lets the material buffer reuse the slots of the materials of evicted models
+   if (mMaterialBuffer)
+   {
+      mMaterialBuffer->releaseMaterial(mMaterial.index);
+   }
 }
 
 Mesh::Mesh(Mesh&& rhs) noexcept
-   : mNumIndices(std::exchange(rhs.mNumIndices, 0))
+   : mGeometryArena(std::move(rhs.mGeometryArena))
+   , mVertexAllocationID(std::exchange(rhs.mVertexAllocationID, 0))
+   , mIndexAllocationID(std::exchange(rhs.mIndexAllocationID, 0))
+   , mMaterialBuffer(std::move(rhs.mMaterialBuffer))
    , mMaterial(std::move(rhs.mMaterial))
-   , mVAO(std::exchange(rhs.mVAO, 0))
-   , mVBO(std::exchange(rhs.mVBO, 0))
-   , mEBO(std::exchange(rhs.mEBO, 0))
+   , mMaterialUniformHandles(std::exchange(rhs.mMaterialUniformHandles, MaterialUniformHandles()))
 {
 
 }
 
 Mesh& Mesh::operator=(Mesh&& rhs) noexcept
 {
-   mNumIndices = std::exchange(rhs.mNumIndices, 0);
-   mMaterial   = std::move(rhs.mMaterial);
-   mVAO        = std::exchange(rhs.mVAO, 0);
-   mVBO        = std::exchange(rhs.mVBO, 0);
-   mEBO        = std::exchange(rhs.mEBO, 0);
+   mGeometryArena          = std::move(rhs.mGeometryArena);
+   mVertexAllocationID     = std::exchange(rhs.mVertexAllocationID, 0);
+   mIndexAllocationID      = std::exchange(rhs.mIndexAllocationID, 0);
+   mMaterialBuffer         = std::move(rhs.mMaterialBuffer);
+   mMaterial               = std::move(rhs.mMaterial);
+   mMaterialUniformHandles = std::exchange(rhs.mMaterialUniformHandles, MaterialUniformHandles());
    return *this;
 }
 
-void Mesh::render(const Shader& shader) const
+void Mesh::render(const Shader& shader, unsigned int numOfInstances, unsigned int baseInstance) const
+{
+   bindMaterial(shader);
+
+   DrawElementsIndirectCommand command = getDrawCommand(numOfInstances, baseInstance);
+   mGeometryArena->multiDrawElementsIndirect(getIndexType(), &command, 1);
+}
+
+void Mesh::bindMaterial(const Shader& shader) const
 {
+   if (mMaterialUniformHandles.shaderProgID != shader.getID())
+   {
+      resolveMaterialUniformHandles(shader);
+   }
+
+   // The constants of the material already live in the MaterialBuffer, so we only need to tell the shader which material to use
+   shader.setUniform(mMaterialUniformHandles.materialIndex, static_cast<int>(mMaterial.index));
    bindMaterialTextures(shader);
-   setMaterialTextureAvailabilities(shader);
-   setMaterialConstants(shader);
+}
+
+DrawElementsIndirectCommand Mesh::getDrawCommand(unsigned int numOfInstances, unsigned int baseInstance) const
+{
+   return mGeometryArena->getDrawCommand(mVertexAllocationID, mIndexAllocationID, numOfInstances, baseInstance);
+}
+
+bool Mesh::hasSameMaterialAs(const Mesh& other) const
+{
+   // Materials with the same constants share an index in the MaterialBuffer, but they can still use different textures
+   if (mMaterial.index != other.mMaterial.index || mMaterial.textures.size() != other.mMaterial.textures.size())
+   {
+      return false;
+   }
+
+   for (unsigned int i = 0; i < mMaterial.textures.size(); ++i)
+   {
+      if (mMaterial.textures[i].texture != other.mMaterial.textures[i].texture ||
+          mMaterial.textures[i].uniformName != other.mMaterial.textures[i].uniformName)
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+GeometryArena& Mesh::getGeometryArena() const
+{
+   return *mGeometryArena;
+}
+
+unsigned int Mesh::getGeometryID() const
+{
+   return mIndexAllocationID;
+}
 
-   glBindVertexArray(mVAO);
-   glDrawElements(GL_TRIANGLES, mNumIndices, GL_UNSIGNED_INT, 0);
-   glBindVertexArray(0);
+unsigned int Mesh::getIndexType() const
+{
+   return mGeometryArena->getIndexType(mIndexAllocationID);
 }
 
-void Mesh::configureVAO(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+unsigned int Mesh::getMaterialIndex() const
 {
-   glGenVertexArrays(1, &mVAO);
-   glGenBuffers(1, &mVBO);
-   glGenBuffers(1, &mEBO);
-
-   glBindVertexArray(mVAO);
-
-   // Load the mesh's data into the buffers
-
-   // Positions, normals and texture coordinates
-   glBindBuffer(GL_ARRAY_BUFFER, mVBO);
-   glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
-   // Indices
-   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEBO);
-   glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-
-   // Set the vertex attribute pointers
-
-   // Positions
-   glEnableVertexAttribArray(0);
-   glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-   // Normals
-   glEnableVertexAttribArray(1);
-   glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
-   // Texture coords
-   glEnableVertexAttribArray(2);
-   glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
-
-   glBindVertexArray(0);
+   return mMaterial.index;
+}
+
+ResourceFootprint Mesh::getFootprint() const
+{
+   std::size_t cpuMemoryInBytes = sizeof(Mesh) + mMaterial.textures.capacity() * sizeof(MaterialTexture) + mMaterialUniformHandles.textureSamplers.capacity() * sizeof(UniformHandle<int>);
+   std::size_t gpuMemoryInBytes = mGeometryArena->getVertexAllocationSizeInBytes(mVertexAllocationID) + mGeometryArena->getIndexAllocationSizeInBytes(mIndexAllocationID);
+   return ResourceFootprint{cpuMemoryInBytes, gpuMemoryInBytes};
 }
 
 void Mesh::bindMaterialTextures(const Shader& shader) const
 {
-   unsigned int texUnit = GL_TEXTURE0;
+   unsigned int texUnit = 0;
 
    for (unsigned int i = 0; i < mMaterial.textures.size(); ++i)
    {
-      // Get the location of the sampler2D uniform that should exist in the shader
-      int uniformLoc = glGetUniformLocation(shader.getID(), mMaterial.textures[i].uniformName.c_str());
+      // The sampler2D uniforms that don't exist in the shader were reported when their handles were resolved
+      UniformHandle<int> samplerHandle = mMaterialUniformHandles.textureSamplers[i];
 
-      if (uniformLoc != -1)
+      if (samplerHandle.isValid())
       {
-         // Activate the proper texture unit before binding the current texture
-         glActiveTexture(texUnit);
          // Tell the sampler2D uniform in what texture unit to look for the texture data
-         glUniform1i(uniformLoc, i);
-         // Bind the texture
-         mMaterial.textures[i].texture->bind();
+         shader.setUniform(samplerHandle, static_cast<int>(texUnit));
+         // Bind the texture to that unit
+         // Textures that are already bound to the right unit (e.g. by the previous mesh) are skipped by the state cache
+         mMaterial.textures[i].texture->bind(texUnit);
 
          ++texUnit;
       }
-      else
-      {
-         std::cout << "Error - Mesh::bindMaterialTextures - The following sampler2D uniform does not exist: " << mMaterial.textures[i].uniformName << "\n";
-      }
    }
-
-   glActiveTexture(GL_TEXTURE0);
 }
 
-void Mesh::setMaterialTextureAvailabilities(const Shader& shader) const
+void Mesh::resolveMaterialUniformHandles(const Shader& shader) const
 {
-   shader.setInt("materialTextureAvailabilities.ambientTexIsAvailable", mMaterial.textureAvailabilities.test(static_cast<unsigned int>(MaterialTextureTypes::ambient)));
-   shader.setInt("materialTextureAvailabilities.emissiveTexIsAvailable", mMaterial.textureAvailabilities.test(static_cast<unsigned int>(MaterialTextureTypes::emissive)));
-   shader.setInt("materialTextureAvailabilities.diffuseTexIsAvailable", mMaterial.textureAvailabilities.test(static_cast<unsigned int>(MaterialTextureTypes::diffuse)));
-   shader.setInt("materialTextureAvailabilities.specularTexIsAvailable", mMaterial.textureAvailabilities.test(static_cast<unsigned int>(MaterialTextureTypes::specular)));
-}
+   mMaterialUniformHandles.shaderProgID = shader.getID();
 
-void Mesh::setMaterialConstants(const Shader& shader) const
-{
-   shader.setVec3("materialConstants.ambient", mMaterial.constants.ambientColor);
-   shader.setVec3("materialConstants.emissive", mMaterial.constants.emissiveColor);
-   shader.setVec3("materialConstants.diffuse", mMaterial.constants.diffuseColor);
-   shader.setVec3("materialConstants.specular", mMaterial.constants.specularColor);
-   shader.setFloat("materialConstants.shininess", mMaterial.constants.shininess);
+   mMaterialUniformHandles.textureSamplers.clear();
+   for (const MaterialTexture& materialTexture : mMaterial.textures)
+   {
+      mMaterialUniformHandles.textureSamplers.push_back(shader.getUniformHandle<int>(materialTexture.uniformName.c_str()));
+   }
+
+   mMaterialUniformHandles.materialIndex = shader.getUniformHandle<int>("materialIndex");
 }
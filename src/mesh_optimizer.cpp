@@ -0,0 +1,474 @@
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+#include "mesh_optimizer.h"
+
+namespace
+{
+   const unsigned int invalidIndex = UINT_MAX;
+
+   // Constants of Forsyth's scoring function
+   const unsigned int maxSizeOfSimulatedCache = 32;
+   const float        cacheDecayPower         = 1.5f;
+   const float        lastTriangleScore       = 0.75f;
+   const float        valenceBoostScale       = 2.0f;
+   const float        valenceBoostPower       = 0.5f;
+
+   float calculateVertexScore(int cachePosition, unsigned int numOfLiveTriangles)
+   {
+      // Vertices that are not used by any of the remaining triangles should never be picked
+      if (numOfLiveTriangles == 0)
+      {
+         return -1.0f;
+      }
+
+      float score = 0.0f;
+      if (cachePosition >= 0)
+      {
+         if (cachePosition < 3)
+         {
+            // The vertices of the last triangle get a fixed score, so that the next triangle doesn't simply reuse the same edge every time, which creates long strips
+            score = lastTriangleScore;
+         }
+         else
+         {
+            float scaler = 1.0f / static_cast<float>(maxSizeOfSimulatedCache - 3);
+            score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scaler, cacheDecayPower);
+         }
+      }
+
+      // Boost the vertices with few remaining triangles, so that they are finished (and can leave the cache) as soon as possible
+      score += valenceBoostScale * std::pow(static_cast<float>(numOfLiveTriangles), -valenceBoostPower);
+      return score;
+   }
+
+   std::size_t hashVertex(const Vertex& vertex)
+   {
+      // FNV-1a over the bytes of the vertex, which is only correct because Vertex has no padding
+      static_assert(sizeof(Vertex) == sizeof(glm::vec3) + sizeof(quat) + sizeof(glm::vec2), "Vertex must not have any padding, since its bytes are hashed and compared");
+
+      const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&vertex);
+      std::size_t          hash  = 2166136261u;
+      for (std::size_t i = 0; i < sizeof(Vertex); ++i)
+      {
+         hash ^= bytes[i];
+         hash *= 16777619u;
+      }
+
+      return hash;
+   }
+
+   double getElapsedTimeInMs(std::chrono::steady_clock::time_point start)
+   {
+      return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+   }
+}
+
+VertexCacheStatistics analyzeVertexCache(const std::vector<unsigned int>& indices, unsigned int numOfVertices, unsigned int cacheSize)
+{
+   if (indices.empty() || numOfVertices == 0)
+   {
+      return VertexCacheStatistics{0.0f, 0.0f};
+   }
+
+   // A FIFO cache is simulated with timestamps: a vertex is in the cache if fewer than cacheSize vertices were added to it after it
+   // The timestamps start after cacheSize so that every vertex misses the first time it's used
+   std::vector<unsigned int> cacheTimestamps(numOfVertices, 0);
+   unsigned int              timestamp = cacheSize + 1;
+   unsigned int              numOfMisses = 0;
+
+   for (unsigned int index : indices)
+   {
+      if (timestamp - cacheTimestamps[index] > cacheSize)
+      {
+         cacheTimestamps[index] = timestamp++;
+         ++numOfMisses;
+      }
+   }
+
+   return VertexCacheStatistics{static_cast<float>(numOfMisses) / static_cast<float>(indices.size() / 3),
+                                static_cast<float>(numOfMisses) / static_cast<float>(numOfVertices)};
+}
+
+void weldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+   // Open addressing hash table whose slots store the indices of the unique vertices
+   // Its size is a power of two that is at least twice the number of vertices, which keeps the probe sequences short
+   std::size_t tableSize = 1;
+   while (tableSize < vertices.size() * 2)
+   {
+      tableSize *= 2;
+   }
+
+   std::vector<unsigned int> table(tableSize, invalidIndex);
+   std::vector<unsigned int> remap(vertices.size());
+   std::vector<Vertex>       uniqueVertices;
+   uniqueVertices.reserve(vertices.size());
+
+   for (unsigned int i = 0; i < vertices.size(); ++i)
+   {
+      std::size_t slot = hashVertex(vertices[i]) & (tableSize - 1);
+      while (table[slot] != invalidIndex && std::memcmp(&uniqueVertices[table[slot]], &vertices[i], sizeof(Vertex)) != 0)
+      {
+         slot = (slot + 1) & (tableSize - 1);
+      }
+
+      if (table[slot] == invalidIndex)
+      {
+         table[slot] = static_cast<unsigned int>(uniqueVertices.size());
+         uniqueVertices.push_back(vertices[i]);
+      }
+
+      remap[i] = table[slot];
+   }
+
+   for (unsigned int& index : indices)
+   {
+      index = remap[index];
+   }
+
+   vertices.swap(uniqueVertices);
+}
+
+void optimizeVertexCache(std::vector<unsigned int>& indices, unsigned int numOfVertices)
+{
+   unsigned int numOfTriangles = static_cast<unsigned int>(indices.size() / 3);
+   if (numOfTriangles == 0)
+   {
+      return;
+   }
+
+   // Build the lists of triangles that use each vertex, which are stored back to back in a single vector
+   // The live triangles of a vertex are always at the beginning of its list, so emitting a triangle only needs to swap it to the end
+   std::vector<unsigned int> numOfLiveTriangles(numOfVertices, 0);
+   for (unsigned int index : indices)
+   {
+      ++numOfLiveTriangles[index];
+   }
+
+   std::vector<unsigned int> firstTriangleOffsets(numOfVertices, 0);
+   for (unsigned int i = 1; i < numOfVertices; ++i)
+   {
+      firstTriangleOffsets[i] = firstTriangleOffsets[i - 1] + numOfLiveTriangles[i - 1];
+   }
+
+   std::vector<unsigned int> vertexTriangles(indices.size());
+   {
+      std::vector<unsigned int> numOfAddedTriangles(numOfVertices, 0);
+      for (unsigned int i = 0; i < indices.size(); ++i)
+      {
+         unsigned int vertex = indices[i];
+         vertexTriangles[firstTriangleOffsets[vertex] + numOfAddedTriangles[vertex]++] = i / 3;
+      }
+   }
+
+   std::vector<int>   cachePositions(numOfVertices, -1);
+   std::vector<float> vertexScores(numOfVertices);
+   for (unsigned int i = 0; i < numOfVertices; ++i)
+   {
+      vertexScores[i] = calculateVertexScore(-1, numOfLiveTriangles[i]);
+   }
+
+   // The score of a triangle is the sum of the scores of its vertices
+   auto calculateTriangleScore = [&indices, &vertexScores](unsigned int triangle)
+   {
+      return vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+   };
+
+   std::vector<bool> isTriangleEmitted(numOfTriangles, false);
+   unsigned int      bestTriangle = 0;
+   float             bestScore    = calculateTriangleScore(0);
+   for (unsigned int i = 1; i < numOfTriangles; ++i)
+   {
+      float score = calculateTriangleScore(i);
+      if (score > bestScore)
+      {
+         bestScore    = score;
+         bestTriangle = i;
+      }
+   }
+
+   std::vector<unsigned int> cache;
+   std::vector<unsigned int> newCache;
+   cache.reserve(maxSizeOfSimulatedCache + 3);
+   newCache.reserve(maxSizeOfSimulatedCache + 3);
+
+   std::vector<unsigned int> optimizedIndices;
+   optimizedIndices.reserve(indices.size());
+
+   // Triangles before this one have all been emitted, which keeps the searches for a new starting triangle linear overall
+   unsigned int firstTriangleThatMayBeLive = 0;
+
+   for (unsigned int numOfEmittedTriangles = 0; numOfEmittedTriangles < numOfTriangles; ++numOfEmittedTriangles)
+   {
+      // None of the triangles of the vertices in the cache are live, so we continue with the first live triangle
+      if (bestTriangle == invalidIndex)
+      {
+         while (isTriangleEmitted[firstTriangleThatMayBeLive])
+         {
+            ++firstTriangleThatMayBeLive;
+         }
+
+         bestTriangle = firstTriangleThatMayBeLive;
+      }
+
+      const unsigned int* triangle = &indices[bestTriangle * 3];
+      optimizedIndices.insert(optimizedIndices.end(), triangle, triangle + 3);
+      isTriangleEmitted[bestTriangle] = true;
+
+      // Remove the triangle from the lists of live triangles of its vertices
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+         unsigned int  vertex    = triangle[i];
+         unsigned int* triangles = &vertexTriangles[firstTriangleOffsets[vertex]];
+         unsigned int* last      = triangles + numOfLiveTriangles[vertex] - 1;
+         std::iter_swap(std::find(triangles, last + 1, bestTriangle), last);
+         --numOfLiveTriangles[vertex];
+      }
+
+      // Move the vertices of the triangle to the front of the LRU cache
+      newCache.assign(triangle, triangle + 3);
+      for (unsigned int vertex : cache)
+      {
+         if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+         {
+            newCache.push_back(vertex);
+         }
+      }
+
+      // The vertices that fall out of the cache lose their cache score
+      for (unsigned int i = maxSizeOfSimulatedCache; i < newCache.size(); ++i)
+      {
+         cachePositions[newCache[i]] = -1;
+         vertexScores[newCache[i]]   = calculateVertexScore(-1, numOfLiveTriangles[newCache[i]]);
+      }
+
+      newCache.resize(std::min(static_cast<unsigned int>(newCache.size()), maxSizeOfSimulatedCache));
+      cache.swap(newCache);
+
+      for (unsigned int i = 0; i < cache.size(); ++i)
+      {
+         cachePositions[cache[i]] = static_cast<int>(i);
+         vertexScores[cache[i]]   = calculateVertexScore(static_cast<int>(i), numOfLiveTriangles[cache[i]]);
+      }
+
+      // Only the scores of the live triangles of the vertices in the cache changed, so the next triangle is the best one among them
+      bestTriangle = invalidIndex;
+      bestScore    = -1.0f;
+      for (unsigned int vertex : cache)
+      {
+         const unsigned int* triangles = &vertexTriangles[firstTriangleOffsets[vertex]];
+         for (unsigned int i = 0; i < numOfLiveTriangles[vertex]; ++i)
+         {
+            unsigned int liveTriangle = triangles[i];
+            float        score        = calculateTriangleScore(liveTriangle);
+
+            if (score > bestScore)
+            {
+               bestScore    = score;
+               bestTriangle = liveTriangle;
+            }
+         }
+      }
+   }
+
+   indices.swap(optimizedIndices);
+}
+
+void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, float threshold)
+{
+   unsigned int numOfTriangles = static_cast<unsigned int>(indices.size() / 3);
+   if (numOfTriangles == 0)
+   {
+      return;
+   }
+
+   // Simulates a FIFO cache and returns the number of vertices of the given triangle that miss it
+   std::vector<unsigned int> cacheTimestamps(vertices.size(), 0);
+   unsigned int              timestamp = vertexCacheSizeForStatistics + 1;
+   auto updateCache = [&](unsigned int triangle)
+   {
+      unsigned int numOfMisses = 0;
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+         unsigned int vertex = indices[triangle * 3 + i];
+         if (timestamp - cacheTimestamps[vertex] > vertexCacheSizeForStatistics)
+         {
+            cacheTimestamps[vertex] = timestamp++;
+            ++numOfMisses;
+         }
+      }
+
+      return numOfMisses;
+   };
+
+   // Hard boundaries are the triangles that miss the cache with all their vertices, which means that the cache was flushed before them
+   // Triangles can be reordered at those boundaries without making the ACMR any worse
+   std::vector<unsigned int> hardBoundaries;
+   for (unsigned int i = 0; i < numOfTriangles; ++i)
+   {
+      if (updateCache(i) == 3)
+      {
+         hardBoundaries.push_back(i);
+      }
+   }
+   hardBoundaries.push_back(numOfTriangles);
+
+   // Soft boundaries split the clusters further, as long as the ACMR of the resulting clusters stays below the threshold
+   // The cache is flushed at each boundary, since that's what the reordering will do to it
+   std::vector<unsigned int> clusterBoundaries;
+   for (unsigned int i = 0; i + 1 < hardBoundaries.size(); ++i)
+   {
+      unsigned int start = hardBoundaries[i];
+      unsigned int end   = hardBoundaries[i + 1];
+
+      timestamp += vertexCacheSizeForStatistics + 1;
+      unsigned int numOfClusterMisses = 0;
+      for (unsigned int triangle = start; triangle < end; ++triangle)
+      {
+         numOfClusterMisses += updateCache(triangle);
+      }
+
+      float        clusterThreshold = threshold * (static_cast<float>(numOfClusterMisses) / static_cast<float>(end - start));
+      unsigned int clusterStart     = start;
+      unsigned int numOfMisses      = 0;
+
+      timestamp += vertexCacheSizeForStatistics + 1;
+      clusterBoundaries.push_back(start);
+      for (unsigned int triangle = start; triangle < end; ++triangle)
+      {
+         numOfMisses += updateCache(triangle);
+
+         if (triangle + 1 < end && static_cast<float>(numOfMisses) / static_cast<float>(triangle + 1 - clusterStart) <= clusterThreshold)
+         {
+            clusterStart = triangle + 1;
+            numOfMisses  = 0;
+            timestamp   += vertexCacheSizeForStatistics + 1;
+            clusterBoundaries.push_back(clusterStart);
+         }
+      }
+   }
+   clusterBoundaries.push_back(numOfTriangles);
+
+   // The clusters are sorted by how much they face away from the center of the mesh, since the triangles that face outwards are the ones that are more likely to occlude the others
+   glm::vec3 meshCenter(0.0f);
+   for (const Vertex& vertex : vertices)
+   {
+      meshCenter += vertex.position;
+   }
+   meshCenter /= static_cast<float>(vertices.size());
+
+   struct Cluster
+   {
+      unsigned int start;
+      unsigned int end;
+      float        sortKey;
+   };
+
+   std::vector<Cluster> clusters;
+   clusters.reserve(clusterBoundaries.size() - 1);
+   for (unsigned int i = 0; i + 1 < clusterBoundaries.size(); ++i)
+   {
+      // The lengths of the cross products are twice the areas of the triangles, so the normal and the center are weighted by area
+      glm::vec3 clusterNormal(0.0f);
+      glm::vec3 clusterCenter(0.0f);
+      float     clusterArea = 0.0f;
+      for (unsigned int triangle = clusterBoundaries[i]; triangle < clusterBoundaries[i + 1]; ++triangle)
+      {
+         const glm::vec3& a = vertices[indices[triangle * 3]].position;
+         const glm::vec3& b = vertices[indices[triangle * 3 + 1]].position;
+         const glm::vec3& c = vertices[indices[triangle * 3 + 2]].position;
+
+         glm::vec3 normal = glm::cross(b - a, c - a);
+         float     area   = glm::length(normal);
+
+         clusterNormal += normal;
+         clusterCenter += (a + b + c) * (area / 3.0f);
+         clusterArea   += area;
+      }
+
+      float sortKey = 0.0f;
+      if (clusterArea > 0.0f && glm::dot(clusterNormal, clusterNormal) > 0.0f)
+      {
+         sortKey = glm::dot(clusterCenter / clusterArea - meshCenter, glm::normalize(clusterNormal));
+      }
+
+      clusters.push_back(Cluster{clusterBoundaries[i], clusterBoundaries[i + 1], sortKey});
+   }
+
+   std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b)
+   {
+      return a.sortKey > b.sortKey;
+   });
+
+   std::vector<unsigned int> optimizedIndices;
+   optimizedIndices.reserve(indices.size());
+   for (const Cluster& cluster : clusters)
+   {
+      optimizedIndices.insert(optimizedIndices.end(), indices.begin() + cluster.start * 3, indices.begin() + cluster.end * 3);
+   }
+
+   indices.swap(optimizedIndices);
+}
+
+void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+   // Vertices are stored in the order in which the index buffer first references them, so the vertex fetches walk the vertex buffer mostly forwards
+   std::vector<unsigned int> remap(vertices.size(), invalidIndex);
+   std::vector<Vertex>       orderedVertices;
+   orderedVertices.reserve(vertices.size());
+
+   for (unsigned int& index : indices)
+   {
+      if (remap[index] == invalidIndex)
+      {
+         remap[index] = static_cast<unsigned int>(orderedVertices.size());
+         orderedVertices.push_back(vertices[index]);
+      }
+
+      index = remap[index];
+   }
+
+   vertices.swap(orderedVertices);
+}
+
+void optimizeMesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, MeshOptimizationReport* report)
+{
+   for (unsigned int stage = 0; stage < static_cast<unsigned int>(MeshOptimizationStage::count); ++stage)
+   {
+      unsigned int          numOfVerticesBefore = static_cast<unsigned int>(vertices.size());
+      VertexCacheStatistics before              = report ? analyzeVertexCache(indices, numOfVerticesBefore) : VertexCacheStatistics{0.0f, 0.0f};
+      auto                  start               = std::chrono::steady_clock::now();
+
+      switch (static_cast<MeshOptimizationStage>(stage))
+      {
+      case MeshOptimizationStage::welding:
+         weldVertices(vertices, indices);
+         break;
+      case MeshOptimizationStage::vertexCache:
+         optimizeVertexCache(indices, static_cast<unsigned int>(vertices.size()));
+         break;
+      case MeshOptimizationStage::overdraw:
+         optimizeOverdraw(indices, vertices);
+         break;
+      case MeshOptimizationStage::vertexFetch:
+         optimizeVertexFetch(vertices, indices);
+         break;
+      default:
+         break;
+      }
+
+      if (report)
+      {
+         double timeInMs = getElapsedTimeInMs(start);
+         report->stages[stage] = MeshOptimizationStageReport{numOfVerticesBefore,
+                                                             static_cast<unsigned int>(vertices.size()),
+                                                             before,
+                                                             analyzeVertexCache(indices, static_cast<unsigned int>(vertices.size())),
+                                                             timeInMs};
+      }
+   }
+}
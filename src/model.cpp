@@ -1,16 +1,79 @@
+#include "geometry_arena.h"
 #include "model.h"
 
-Model::Model(std::vector<Mesh>&& meshes, ResourceManager<Texture>&& texManager)
+Model::Model(std::vector<Mesh>&& meshes, const PositionQuantization& positionQuantization)
    : mMeshes(std::move(meshes))
-   , mTexManager(std::move(texManager))
+   , mPositionQuantization(positionQuantization)
+   , mQuantizedInstanceTransforms()
 {
 
 }
 
-void Model::render(const Shader& shader) const
+Model::Model(Model&& rhs) noexcept
+   : mMeshes(std::move(rhs.mMeshes))
+   , mPositionQuantization(std::exchange(rhs.mPositionQuantization, PositionQuantization()))
+   , mQuantizedInstanceTransforms(std::move(rhs.mQuantizedInstanceTransforms))
 {
+
+}
+
+Model& Model::operator=(Model&& rhs) noexcept
+{
+   mMeshes                      = std::move(rhs.mMeshes);
+   mPositionQuantization        = std::exchange(rhs.mPositionQuantization, PositionQuantization());
+   mQuantizedInstanceTransforms = std::move(rhs.mQuantizedInstanceTransforms);
+   return *this;
+}
+
+void Model::render(const Shader& shader, const InstanceTransform* instanceTransforms, unsigned int numOfInstances) const
+{
+   if (numOfInstances == 0 || mMeshes.empty())
+   {
+      return;
+   }
+
+   mQuantizedInstanceTransforms.assign(instanceTransforms, instanceTransforms + numOfInstances);
+   for (InstanceTransform& instanceTransform : mQuantizedInstanceTransforms)
+   {
+      applyPositionQuantization(instanceTransform);
+   }
+
+   // All the meshes of a model share the same geometry arena
+   mMeshes[0].getGeometryArena().uploadInstanceTransforms(mQuantizedInstanceTransforms.data(), numOfInstances);
+
    for (auto &mesh : mMeshes)
    {
-      mesh.render(shader);
+      mesh.render(shader, numOfInstances);
+   }
+}
+
+void Model::applyPositionQuantization(InstanceTransform& instanceTransform) const
+{
+   // The quantized positions (q) are in the [-1, 1] range of the bounding cube of the model, so the instance transform (translation t, scaling factor s and rotation r)
+   // needs to be applied to center + halfExtent * q, which is the same as a transform with a translation of t + s * r(center) and a scaling factor of s * halfExtent
+   float     scalingFactor = instanceTransform.positionAndScale.w;
+   glm::vec3 position      = glm::vec3(instanceTransform.positionAndScale) + scalingFactor * (instanceTransform.rotation * mPositionQuantization.center);
+
+   instanceTransform.positionAndScale = glm::vec4(position, scalingFactor * mPositionQuantization.halfExtent);
+}
+
+unsigned int Model::getNumOfMeshes() const
+{
+   return static_cast<unsigned int>(mMeshes.size());
+}
+
+const Mesh& Model::getMesh(unsigned int index) const
+{
+   return mMeshes[index];
+}
+
+ResourceFootprint Model::getFootprint() const
+{
+   ResourceFootprint footprint{sizeof(Model) + mQuantizedInstanceTransforms.capacity() * sizeof(InstanceTransform), 0};
+   for (const Mesh& mesh : mMeshes)
+   {
+      footprint += mesh.getFootprint();
    }
+
+   return footprint;
 }
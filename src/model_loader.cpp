@@ -1,61 +1,439 @@
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 
+#include <algorithm>
 #include <array>
+#include <cctype>
 #include <iostream>
+#include <limits>
 
+#include "mesh_optimizer.h"
 #include "model_loader.h"
+#include "obj_parser.h"
+#include "parallel_for.h"
+#include "qtangent.h"
 #include "texture_loader.h"
+#include "thread_pool.h"
 
-std::shared_ptr<Model> ModelLoader::loadResource(const std::string& modelFilePath) const
+namespace
+{
+   // Changing the flags changes the key of the baked models, so they are baked again
+   const unsigned int importFlags = aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace;
+
+   const char* const bakedModelFileExtension = ".bakedmodel";
+
+   bool hasFileExtension(const std::string& filePath, const std::string& extension)
+   {
+      if (filePath.size() < extension.size())
+      {
+         return false;
+      }
+
+      return std::equal(extension.begin(), extension.end(), filePath.end() - extension.size(), [](char lhs, char rhs)
+      {
+         return std::tolower(static_cast<unsigned char>(lhs)) == std::tolower(static_cast<unsigned char>(rhs));
+      });
+   }
+
+   // Specular maps hold intensities that the shader uses as is, while the other maps hold colors
+   TextureColorSpace getColorSpace(MaterialTextureTypes textureType)
+   {
+      return (textureType == MaterialTextureTypes::specular) ? TextureColorSpace::linear : TextureColorSpace::srgb;
+   }
+
+   // Everything that a model needs before it's uploaded, which is shared with the function that uploads it
+   // The mesh views point either to the baked model or to the imported model, depending on which one was loaded
+   struct PreparedModel
+   {
+      BakedModel                                       bakedModel;
+      ImportedModel                                    importedModel;
+      std::vector<MeshDataView>                        meshViews;
+      std::vector<MaterialDescription>                 materials;
+      PositionQuantization                             positionQuantization;
+      std::array<std::unordered_map<std::string, PreparedTexture>, static_cast<unsigned int>(TextureColorSpace::count)> textures;
+   };
+}
+
+std::shared_ptr<Model> ModelLoader::loadResource(const std::string&                     modelFilePath,
+                                                 const std::shared_ptr<MaterialBuffer>& materialBuffer,
+                                                 TextureCache&                          textureCache,
+                                                 const std::shared_ptr<GeometryArena>&  geometryArena) const
+{
+   std::function<std::shared_ptr<Model>()> createModel = prepareResource(modelFilePath, materialBuffer, textureCache, geometryArena);
+   return createModel ? createModel() : nullptr;
+}
+
+std::function<std::shared_ptr<Model>()> ModelLoader::prepareResource(const std::string&                     modelFilePath,
+                                                                     const std::shared_ptr<MaterialBuffer>& materialBuffer,
+                                                                     TextureCache&                          textureCache,
+                                                                     const std::shared_ptr<GeometryArena>&  geometryArena) const
+{
+   std::string  modelDir     = modelFilePath.substr(0, modelFilePath.find_last_of('/'));
+   VertexFormat vertexFormat = geometryArena->getVertexFormat();
+
+   // When the model is loaded asynchronously, the other workers of the thread pool are loading other resources,
+   // so the model is imported and its textures are baked on this worker alone instead of on threads of their own
+   unsigned int numOfThreads = ThreadPool::isWorkerThread() ? 1 : 0;
+
+   // std::function needs a copyable function, so the prepared model, which can only be moved, is shared
+   auto preparedModel = std::make_shared<PreparedModel>();
+
+   BakedModelKey bakedModelKey;
+   bool          canBeBaked = calculateBakedModelKey(modelFilePath, vertexFormat, bakedModelKey);
+
+   if (canBeBaked && preparedModel->bakedModel.open(getBakedModelFilePath(modelFilePath), bakedModelKey))
+   {
+      // The vertices and indices are uploaded straight from the mapped file, which is unmapped once they are in the geometry arena
+      preparedModel->meshViews            = preparedModel->bakedModel.getMeshViews();
+      preparedModel->materials            = preparedModel->bakedModel.getMaterials();
+      preparedModel->positionQuantization = preparedModel->bakedModel.getPositionQuantization();
+   }
+   else
+   {
+      if (!importModel(modelFilePath, vertexFormat, preparedModel->importedModel, numOfThreads))
+      {
+         return nullptr;
+      }
+
+      // A model that can't be baked is still loaded, it's just imported again the next time
+      if (canBeBaked)
+      {
+         writeBakedModel(getBakedModelFilePath(modelFilePath), bakedModelKey, preparedModel->importedModel);
+      }
+
+      preparedModel->meshViews            = preparedModel->importedModel.getMeshViews();
+      preparedModel->materials            = preparedModel->importedModel.materials;
+      preparedModel->positionQuantization = preparedModel->importedModel.positionQuantization;
+   }
+
+   // Decode the textures of the materials that the meshes use, so that only their upload is left for the context thread
+   // The textures that are already in the texture cache (e.g. because another model uses the same image) are taken from it instead, which also keeps them alive until the model is created
+   // Note that we assume that the textures are in the same directory as the model
+   TextureLoader textureLoader;
+   for (const MeshDataView& meshView : preparedModel->meshViews)
+   {
+      const MaterialDescription& material = preparedModel->materials[meshView.materialIndex];
+      for (unsigned int i = 0; i < static_cast<unsigned int>(MaterialTextureTypes::count); ++i)
+      {
+         const std::string&                                texFilename      = material.textureFilenames[i];
+         TextureColorSpace                                 colorSpace       = getColorSpace(static_cast<MaterialTextureTypes>(i));
+         std::unordered_map<std::string, PreparedTexture>& preparedTextures = preparedModel->textures[static_cast<unsigned int>(colorSpace)];
+         if (texFilename.empty() || preparedTextures.find(texFilename) != preparedTextures.end())
+         {
+            continue;
+         }
+
+         PreparedTexture& preparedTexture = preparedTextures[texFilename];
+         preparedTexture.decodeTimeInSec  = 0.0;
+
+         // The texture cache and the baked texture are both keyed by the contents of the file, so it's only hashed once
+         std::string   texFilePath = modelDir + '/' + texFilename;
+         std::uint64_t sourceHash  = 0;
+         if (!calculateFileHash(texFilePath, sourceHash))
+         {
+            std::cout << "Error - ModelLoader::prepareResource - The following texture could not be read: " << texFilePath << "\n";
+            continue;
+         }
+
+         preparedTexture.key           = textureCache.calculateKey(sourceHash, colorSpace);
+         preparedTexture.cachedTexture = textureCache.findTexture(preparedTexture.key);
+         if (!preparedTexture.cachedTexture)
+         {
+            // Models that are loaded at the same time often share textures, so only one of them decodes each one
+            preparedTexture.decodedTexture = textureCache.decodeTexture(preparedTexture.key, [&](DecodedTexture& decodedTexture)
+            {
+               return textureLoader.decodeTexture(texFilePath, sourceHash, colorSpace, decodedTexture, numOfThreads);
+            }, preparedTexture.decodeTimeInSec);
+         }
+      }
+   }
+
+   // The loader can be a temporary (see ResourceManager::loadResourceAsync), so the function holds a copy of it
+   // The material buffer and the geometry arena are shared with the function so that they stay alive, but the texture cache must be kept alive by the caller
+   TextureCache* textureCachePtr = &textureCache;
+   return [modelLoader = *this, preparedModel, materialBuffer, textureCachePtr, geometryArena]()
+   {
+      return modelLoader.createModel(preparedModel->meshViews, preparedModel->materials, preparedModel->positionQuantization, preparedModel->textures, materialBuffer, *textureCachePtr, geometryArena);
+   };
+}
+
+bool ModelLoader::importModel(const std::string&                   modelFilePath,
+                              VertexFormat                         vertexFormat,
+                              ImportedModel&                       importedModel,
+                              unsigned int                         numOfThreads,
+                              std::vector<MeshOptimizationReport>* meshOptimizationReports) const
+{
+#ifdef USE_NATIVE_OBJ_PARSER
+   if (hasFileExtension(modelFilePath, ".obj") && importObjModel(modelFilePath, vertexFormat, importedModel, numOfThreads, meshOptimizationReports))
+   {
+      return true;
+   }
+#endif
+
+   return importModelWithAssimp(modelFilePath, vertexFormat, importedModel, numOfThreads, meshOptimizationReports);
+}
+
+bool ModelLoader::importModelWithAssimp(const std::string&                   modelFilePath,
+                                        VertexFormat                         vertexFormat,
+                                        ImportedModel&                       importedModel,
+                                        unsigned int                         numOfThreads,
+                                        std::vector<MeshOptimizationReport>* meshOptimizationReports) const
 {
    Assimp::Importer importer;
-   const aiScene* scene = importer.ReadFile(modelFilePath, aiProcess_Triangulate | aiProcess_FlipUVs);
+   const aiScene* scene = importer.ReadFile(modelFilePath, importFlags);
 
    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
    {
-      std::cout << "Error - ModelLoader::loadResource - The error below occurred while importing this model: " << modelFilePath << "\n" << importer.GetErrorString() << "\n";
-      return nullptr;
+      std::cout << "Error - ModelLoader::importModelWithAssimp - The error below occurred while importing this model: " << modelFilePath << "\n" << importer.GetErrorString() << "\n";
+      return false;
+   }
+
+   // The positions of the standard vertex format are not quantized
+   importedModel.positionQuantization = (vertexFormat == VertexFormat::compact) ? calculatePositionQuantization(scene) : PositionQuantization();
+
+   std::vector<const aiMesh*> meshes;
+   flattenNodeHierarchyRecursively(scene->mRootNode, scene, meshes);
+
+   // The scene is only read while the meshes and the materials are processed, and each task writes to its own element, so they can all run in parallel
+   // The materials are stored in the same order as in the scene, since that's what the material indices of the meshes refer to
+   unsigned int numOfMeshes = static_cast<unsigned int>(meshes.size());
+   importedModel.meshes.assign(numOfMeshes, ImportedMesh());
+   importedModel.materials.assign(scene->mNumMaterials, MaterialDescription({}, MaterialConstants(glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f), 0.0f)));
+   if (meshOptimizationReports)
+   {
+      meshOptimizationReports->assign(numOfMeshes, MeshOptimizationReport());
+   }
+
+   parallelFor(numOfMeshes + scene->mNumMaterials, numOfThreads, [&](unsigned int i)
+   {
+      if (i < numOfMeshes)
+      {
+         std::vector<Vertex>       vertices = processVertices(meshes[i]);
+         std::vector<unsigned int> indices  = processIndices(meshes[i]);
+         importedModel.meshes[i] = processMesh(vertices, indices, meshes[i]->mMaterialIndex, vertexFormat, importedModel.positionQuantization, meshOptimizationReports ? &(*meshOptimizationReports)[i] : nullptr);
+      }
+      else
+      {
+         importedModel.materials[i - numOfMeshes] = processMaterial(scene->mMaterials[i - numOfMeshes]);
+      }
+   });
+
+   return true;
+}
+
+bool ModelLoader::importObjModel(const std::string&                   modelFilePath,
+                                 VertexFormat                         vertexFormat,
+                                 ImportedModel&                       importedModel,
+                                 unsigned int                         numOfThreads,
+                                 std::vector<MeshOptimizationReport>* meshOptimizationReports) const
+{
+   ObjModel objModel;
+   if (!parseObjModel(modelFilePath, objModel, numOfThreads))
+   {
+      return false;
+   }
+
+   // The positions of the standard vertex format are not quantized
+   importedModel.positionQuantization = PositionQuantization();
+   if (vertexFormat == VertexFormat::compact)
+   {
+      glm::vec3 minPos(std::numeric_limits<float>::max());
+      glm::vec3 maxPos(std::numeric_limits<float>::lowest());
+      for (const ObjMesh& mesh : objModel.meshes)
+      {
+         for (const Vertex& vertex : mesh.vertices)
+         {
+            minPos = glm::min(minPos, vertex.position);
+            maxPos = glm::max(maxPos, vertex.position);
+         }
+      }
+
+      importedModel.positionQuantization = calculatePositionQuantization(minPos, maxPos);
+   }
+
+   importedModel.meshes.assign(objModel.meshes.size(), ImportedMesh());
+   if (meshOptimizationReports)
+   {
+      meshOptimizationReports->assign(objModel.meshes.size(), MeshOptimizationReport());
+   }
+
+   parallelFor(static_cast<unsigned int>(objModel.meshes.size()), numOfThreads, [&](unsigned int i)
+   {
+      ObjMesh& mesh = objModel.meshes[i];
+      importedModel.meshes[i] = processMesh(mesh.vertices, mesh.indices, mesh.materialIndex, vertexFormat, importedModel.positionQuantization, meshOptimizationReports ? &(*meshOptimizationReports)[i] : nullptr);
+   });
+
+   importedModel.materials = std::move(objModel.materials);
+   return true;
+}
+
+bool ModelLoader::calculateBakedModelKey(const std::string& modelFilePath, VertexFormat vertexFormat, BakedModelKey& key) const
+{
+   if (!calculateFileHash(modelFilePath, key.sourceHash))
+   {
+      return false;
+   }
+
+   // The materials of an OBJ model are defined in the MTL files that it references, so their contents are hashed after the contents of the model
+   // A library that can't be read is hashed as 0, so that creating it later invalidates the baked model too
+   if (hasFileExtension(modelFilePath, ".obj"))
+   {
+      std::vector<std::string> mtlFilePaths;
+      findObjMaterialLibraries(modelFilePath, mtlFilePaths);
+      for (const std::string& mtlFilePath : mtlFilePaths)
+      {
+         std::uint64_t mtlHash = 0;
+         calculateFileHash(mtlFilePath, mtlHash);
+
+         for (unsigned int i = 0; i < sizeof(mtlHash); ++i)
+         {
+            key.sourceHash ^= (mtlHash >> (i * 8)) & 0xFF;
+            key.sourceHash *= 1099511628211ull;
+         }
+      }
+
+#ifdef USE_NATIVE_OBJ_PARSER
+      // The OBJ parser isn't known to match Assimp byte for byte yet, so the models that it bakes are kept apart from the ones that Assimp bakes
+      key.sourceHash ^= 0xFF;
+      key.sourceHash *= 1099511628211ull;
+#endif
+   }
+
+   key.importFlags  = importFlags;
+   key.vertexFormat = vertexFormat;
+   return true;
+}
+
+std::string ModelLoader::getBakedModelFilePath(const std::string& modelFilePath) const
+{
+   return modelFilePath + bakedModelFileExtension;
+}
+
+std::shared_ptr<Model> ModelLoader::createModel(const std::vector<MeshDataView>&        meshViews,
+                                                const std::vector<MaterialDescription>& materialDescriptions,
+                                                const PositionQuantization&             positionQuantization,
+                                                const PreparedTextures&                 preparedTextures,
+                                                const std::shared_ptr<MaterialBuffer>&  materialBuffer,
+                                                TextureCache&                           textureCache,
+                                                const std::shared_ptr<GeometryArena>&   geometryArena) const
+{
+   std::vector<Mesh> meshes;
+   meshes.reserve(meshViews.size());
+
+   // The materials are only created for the meshes that use them, and only once per model
+   // Each mesh holds its own reference to the slot of its material, so the references that are added here are released once the meshes are created
+   std::unordered_map<unsigned int, Material> materials;
+
+   for (const MeshDataView& meshView : meshViews)
+   {
+      auto it = materials.find(meshView.materialIndex);
+      if (it == materials.end())
+      {
+         Material material = createMaterial(materialDescriptions[meshView.materialIndex], preparedTextures, textureCache);
+
+         // The constants and the texture availabilities never change after this point, so we upload them to the material buffer right away
+         if (!materialBuffer->addMaterial(material.constants, material.textureAvailabilities, material.index))
+         {
+            std::cout << "Error - ModelLoader::createModel - The material buffer is full. Capacity: " << MAX_NUMBER_OF_MATERIALS << " materials" << "\n";
+
+            // The meshes that were already created free their vertices and indices and release their materials when they are destroyed
+            for (const auto& createdMaterial : materials)
+            {
+               materialBuffer->releaseMaterial(createdMaterial.second.index);
+            }
+
+            return nullptr;
+         }
+
+         it = materials.emplace(meshView.materialIndex, std::move(material)).first;
+      }
+
+      meshes.emplace_back(geometryArena,                                                                                                // Geometry arena
+                          geometryArena->allocateEncodedVertices(meshView.vertexData, meshView.numOfVertices),                          // Vertices
+                          geometryArena->allocateEncodedIndices(meshView.indexData, meshView.numOfIndices, meshView.indexSizeInBytes), // Indices
+                          materialBuffer,                                                                                               // Material buffer
+                          it->second);                                                                                                  // Material textures and constants
    }
 
-   ResourceManager<Texture> texManager;
-   std::vector<Mesh>        meshes;
-   processNodeHierarchyRecursively(scene->mRootNode,
-                                   scene,
-                                   modelFilePath.substr(0, modelFilePath.find_last_of('/')),
-                                   texManager,
-                                   meshes);
+   for (const auto& material : materials)
+   {
+      materialBuffer->releaseMaterial(material.second.index);
+   }
 
-   return std::make_shared<Model>(std::move(meshes), std::move(texManager));
+   return std::make_shared<Model>(std::move(meshes), positionQuantization);
 }
 
-void ModelLoader::processNodeHierarchyRecursively(const aiNode*             node,
-                                                  const aiScene*            scene,
-                                                  const std::string&        modelDir,
-                                                  ResourceManager<Texture>& texManager,
-                                                  std::vector<Mesh>&        meshes) const
+void ModelLoader::flattenNodeHierarchyRecursively(const aiNode*               node,
+                                                  const aiScene*              scene,
+                                                  std::vector<const aiMesh*>& meshes) const
 {
-   // Create a Mesh object for each mesh referenced by the current node
+   // Note that nodes do not store meshes directly
+   // All the meshes are stored in the scene struct
+   // Nodes only contain indices that can be used to access meshes from said struct
    for (unsigned int i = 0; i < node->mNumMeshes; i++)
    {
-      // Note that nodes do not store meshes directly
-      // All the meshes are stored in the scene struct
-      // Nodes only contain indices that can be used to access meshes from said struct
-      aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-      meshes.emplace_back(processVertices(mesh),                                                           // Vertices
-                          processIndices(mesh),                                                            // Indices
-                          processMaterial(scene->mMaterials[mesh->mMaterialIndex], modelDir, texManager)); // Material textures and constants
+      meshes.push_back(scene->mMeshes[node->mMeshes[i]]);
    }
 
-   // After we have processed all the meshes referenced by the current node, we recursively process its children
+   // After we have collected all the meshes referenced by the current node, we recursively collect the ones of its children
    for (unsigned int i = 0; i < node->mNumChildren; i++)
    {
-      processNodeHierarchyRecursively(node->mChildren[i],
-                                      scene,
-                                      modelDir,
-                                      texManager,
-                                      meshes);
+      flattenNodeHierarchyRecursively(node->mChildren[i], scene, meshes);
+   }
+}
+
+ImportedMesh ModelLoader::processMesh(std::vector<Vertex>&        vertices,
+                                      std::vector<unsigned int>&  indices,
+                                      unsigned int                materialIndex,
+                                      VertexFormat                vertexFormat,
+                                      const PositionQuantization& positionQuantization,
+                                      MeshOptimizationReport*     meshOptimizationReport) const
+{
+   // Both importers create a vertex for each corner of each face, and they don't optimize the order of the triangles,
+   // so we weld the vertices and reorder them and the triangles before the mesh is converted to the vertex format of the geometry arena
+   optimizeMesh(vertices, indices, meshOptimizationReport);
+
+   ImportedMesh importedMesh;
+   importedMesh.vertexData    = GeometryArena::encodeVertices(vertexFormat, vertices, positionQuantization);
+   importedMesh.indexData     = GeometryArena::encodeIndices(vertexFormat, indices, static_cast<unsigned int>(vertices.size()), importedMesh.indexSizeInBytes);
+   importedMesh.numOfVertices = static_cast<unsigned int>(vertices.size());
+   importedMesh.numOfIndices  = static_cast<unsigned int>(indices.size());
+   importedMesh.materialIndex = materialIndex;
+   return importedMesh;
+}
+
+PositionQuantization ModelLoader::calculatePositionQuantization(const aiScene* scene) const
+{
+   glm::vec3 minPos(std::numeric_limits<float>::max());
+   glm::vec3 maxPos(std::numeric_limits<float>::lowest());
+
+   for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+   {
+      const aiMesh* mesh = scene->mMeshes[i];
+      for (unsigned int j = 0; j < mesh->mNumVertices; j++)
+      {
+         glm::vec3 position(mesh->mVertices[j].x, mesh->mVertices[j].y, mesh->mVertices[j].z);
+         minPos = glm::min(minPos, position);
+         maxPos = glm::max(maxPos, position);
+      }
+   }
+
+   return calculatePositionQuantization(minPos, maxPos);
+}
+
+PositionQuantization ModelLoader::calculatePositionQuantization(const glm::vec3& minPos, const glm::vec3& maxPos) const
+{
+   // The bounds are inverted when there are no vertices
+   if (glm::any(glm::greaterThan(minPos, maxPos)))
+   {
+      return PositionQuantization();
    }
+
+   // A cube is used instead of a box so that the dequantization is a uniform scaling, which is the only kind of scaling that instance transforms support
+   glm::vec3 halfExtents = 0.5f * (maxPos - minPos);
+   float     halfExtent  = std::max(halfExtents.x, std::max(halfExtents.y, halfExtents.z));
+
+   return PositionQuantization(0.5f * (minPos + maxPos), (halfExtent > 0.0f) ? halfExtent : 1.0f);
 }
 
 std::vector<Vertex> ModelLoader::processVertices(const aiMesh* mesh) const
@@ -63,15 +441,24 @@ std::vector<Vertex> ModelLoader::processVertices(const aiMesh* mesh) const
    std::vector<Vertex> vertices;
    vertices.reserve(mesh->mNumVertices);
 
+   // The tangents and bitangents are calculated by Assimp (see aiProcess_CalcTangentSpace), but only for the meshes that have texture coordinates
+   // Without them, the tangent frames are built around the normals
+   bool hasTangents = mesh->HasTangentsAndBitangents();
+
    // Loop over the vertices of the mesh
    for (unsigned int i = 0; i < mesh->mNumVertices; i++)
    {
-      // Store the position, the normal and the texture coordinates of the current vertex
+      // Store the position, the tangent frame and the texture coordinates of the current vertex
+      // The tangent frame is encoded as a QTangent, which stores the tangent, the bitangent and the normal in a single quaternion
       // Note that a vertex can contain up to 8 different sets of texture coordinates
       // We make the assumption that we will only use models that have a single set of texture coordinates per vertex
       // For this reason, we only check for the existence of the first set
+      glm::vec3 tangent   = hasTangents ? glm::vec3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z) : glm::vec3(0.0f);
+      glm::vec3 bitangent = hasTangents ? glm::vec3(mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z) : glm::vec3(0.0f);
+      glm::vec3 normal(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+
       vertices.emplace_back(glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z),                                          // Position
-                            glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z),                                             // Normal
+                            encodeQTangent(tangent, bitangent, normal),                                                                           // Tangent frame
                             mesh->HasTextureCoords(0) ? glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y) : glm::vec2(0.0f)); // Texture coordinates
    }
 
@@ -100,14 +487,8 @@ std::vector<unsigned int> ModelLoader::processIndices(const aiMesh* mesh) const
    return indices;
 }
 
-Material ModelLoader::processMaterial(const aiMaterial*         material,
-                                      const std::string&        modelDir,
-                                      ResourceManager<Texture>& texManager) const
+MaterialDescription ModelLoader::processMaterial(const aiMaterial* material) const
 {
-   // Load the textures
-   std::vector<MaterialTexture>                                        materialTextures;
-   std::bitset<static_cast<unsigned int>(MaterialTextureTypes::count)> materialTextureAvailabilities;
-
    // The material can consist of many textures and constants of different types
    // We make the assumption that we will only use models that have ambient, emissive, diffuse and specular textures or constants
    // A constant is only used during rendering if its corresponding texture is not available
@@ -116,46 +497,23 @@ Material ModelLoader::processMaterial(const aiMaterial*         material,
                                             aiTextureType_DIFFUSE,
                                             aiTextureType_SPECULAR};
 
-   for (aiTextureType texType : texTypes)
+   // The texture types of Assimp are stored in the same order as the ones of MaterialTextureTypes
+   std::array<std::string, static_cast<unsigned int>(MaterialTextureTypes::count)> texFilenames;
+   for (unsigned int i = 0; i < texTypes.size(); i++)
    {
       // Get the number of textures of the current type
-      unsigned int texCount = material->GetTextureCount(texType);
+      unsigned int texCount = material->GetTextureCount(texTypes[i]);
 
       if (texCount > 0)
       {
          if (texCount > 1)
          {
-            std::cout << "Warning - ModelLoader::processMaterial - Mesh uses more than one texture of the following type: " << texType << ". Only the first texture will be loaded." << "\n";
-         }
-
-         // Compose the name of the sampler2D uniform that should exist in the shader,
-         // and set the availability of the current texture type to true so that a texture of said type is used during rendering instead of its corresponding constant
-         std::string uniformName;
-         switch (texType)
-         {
-         case aiTextureType_AMBIENT:
-            uniformName = "ambientTex";
-            materialTextureAvailabilities[static_cast<unsigned int>(MaterialTextureTypes::ambient)] = true;
-            break;
-         case aiTextureType_EMISSIVE:
-            uniformName = "emissiveTex";
-            materialTextureAvailabilities[static_cast<unsigned int>(MaterialTextureTypes::emissive)] = true;
-            break;
-         case aiTextureType_DIFFUSE:
-            uniformName = "diffuseTex";
-            materialTextureAvailabilities[static_cast<unsigned int>(MaterialTextureTypes::diffuse)] = true;
-            break;
-         case aiTextureType_SPECULAR:
-            uniformName = "specularTex";
-            materialTextureAvailabilities[static_cast<unsigned int>(MaterialTextureTypes::specular)] = true;
-            break;
+            std::cout << "Warning - ModelLoader::processMaterial - Mesh uses more than one texture of the following type: " << texTypes[i] << ". Only the first texture will be loaded." << "\n";
          }
 
          aiString texFilename;
-         material->GetTexture(texType, 0, &texFilename);
-
-         // Note that we assume that the textures are in the same directory as the model
-         materialTextures.emplace_back(texManager.loadResource<TextureLoader>(texFilename.C_Str(), modelDir + '/' + texFilename.C_Str()), uniformName);
+         material->GetTexture(texTypes[i], 0, &texFilename);
+         texFilenames[i] = texFilename.C_Str();
       }
    }
 
@@ -169,8 +527,55 @@ Material ModelLoader::processMaterial(const aiMaterial*         material,
                                        ((material->Get(AI_MATKEY_COLOR_SPECULAR, color) == AI_SUCCESS) ? glm::vec3(color.r, color.g, color.b) : glm::vec3(0.0f)),
                                        ((material->Get(AI_MATKEY_SHININESS, shininess)  == AI_SUCCESS) ? shininess : 0.0f));
 
+   return MaterialDescription(texFilenames, materialConstants);
+}
+
+Material ModelLoader::createMaterial(const MaterialDescription& materialDescription,
+                                     const PreparedTextures&    preparedTextures,
+                                     TextureCache&              textureCache) const
+{
+   // Names of the sampler2D uniforms that should exist in the shader, in the order of MaterialTextureTypes
+   std::array<const char*, static_cast<unsigned int>(MaterialTextureTypes::count)> uniformNames = {"ambientTex",
+                                                                                                   "emissiveTex",
+                                                                                                   "diffuseTex",
+                                                                                                   "specularTex"};
+
+   // Load the textures
+   std::vector<MaterialTexture>                                        materialTextures;
+   std::bitset<static_cast<unsigned int>(MaterialTextureTypes::count)> materialTextureAvailabilities;
+
+   for (unsigned int i = 0; i < static_cast<unsigned int>(MaterialTextureTypes::count); i++)
+   {
+      const std::string&                                      texFilename            = materialDescription.textureFilenames[i];
+      const std::unordered_map<std::string, PreparedTexture>& preparedTexturesOfType = preparedTextures[static_cast<unsigned int>(getColorSpace(static_cast<MaterialTextureTypes>(i)))];
+
+      auto preparedTextureIt = preparedTexturesOfType.find(texFilename);
+      if (texFilename.empty() || preparedTextureIt == preparedTexturesOfType.end())
+      {
+         continue;
+      }
+
+      // The textures that could neither be found in the cache nor decoded are replaced by their corresponding constants
+      const PreparedTexture&   preparedTexture = preparedTextureIt->second;
+      std::shared_ptr<Texture> texture         = preparedTexture.cachedTexture;
+      if (!texture && preparedTexture.decodedTexture)
+      {
+         texture = textureCache.loadTexture(preparedTexture.key, *preparedTexture.decodedTexture, preparedTexture.decodeTimeInSec);
+      }
+
+      if (texture)
+      {
+         // Set the availability of the current texture type to true so that a texture of said type is used during rendering instead of its corresponding constant
+         materialTextureAvailabilities[i] = true;
+
+         materialTextures.emplace_back(texture, uniformNames[i]);
+      }
+   }
+
+   // The index is set once the material is added to the material buffer (see createModel)
    // TODO: Could we take advantage of move semantics here?
    return Material(materialTextures,
                    materialTextureAvailabilities,
-                   materialConstants);
+                   materialDescription.constants,
+                   0);
 }
@@ -0,0 +1,1207 @@
+#include <assimp/vector3.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+
+#include "mapped_file.h"
+#include "obj_parser.h"
+#include "parallel_for.h"
+#include "qtangent.h"
+
+// The steps below reproduce the ones of Assimp 5.0 (ObjFileParser, ObjFileMtlImporter, ObjFileImporter, TriangulateProcess, FlipUVsProcess and CalcTangentsProcess)
+// Their vector math is done with aiVector3D so that it rounds like Assimp's does
+namespace
+{
+   // Smallest chunk of an OBJ file that is worth a thread of its own
+   const std::size_t minChunkSizeInBytes = 64 * 1024;
+
+   // Assimp's fast_atof only reads the first 15 fractional digits of a number, and scales them with these powers of 10
+   const unsigned int maxNumOfFractionalDigits = 15;
+   const double       fractionalDigitScales[maxNumOfFractionalDigits + 1] = {0.0,
+                                                                             0.1,
+                                                                             0.01,
+                                                                             0.001,
+                                                                             0.0001,
+                                                                             0.00001,
+                                                                             0.000001,
+                                                                             0.0000001,
+                                                                             0.00000001,
+                                                                             0.000000001,
+                                                                             0.0000000001,
+                                                                             0.00000000001,
+                                                                             0.000000000001,
+                                                                             0.0000000000001,
+                                                                             0.00000000000001,
+                                                                             0.000000000000001};
+
+   // Names that Assimp gives to the material and to the object that are used when the OBJ file doesn't specify them
+   const char* const defaultMaterialName = "DefaultMaterial";
+   const char* const defaultObjectName   = "defaultobject";
+
+   // Index of a corner that doesn't have a texture coordinate or a normal
+   const int noIndex = INT_MIN;
+
+   // Material index of a mesh whose faces were added before any material was selected, which ends up using the default material
+   const int noMaterial = -1;
+
+   // Settings of CalcTangentsProcess
+   const float maxTangentSmoothingAngleInRad   = 45.0f * 0.0174532925f;
+   const float minNormalDotForTangentSmoothing = 0.9999f;
+
+   // Indices are 0-based and refer to the whole file, except for the ones that are relative (negative in the file),
+   // which refer to the chunk because the chunk doesn't know how many elements came before it
+   struct ObjCorner
+   {
+      std::array<int, 3> indices; // Position, texture coordinate and normal
+      unsigned char      relativeIndices; // Bit i is set if indices[i] is relative to the chunk
+   };
+
+   struct ObjFace
+   {
+      unsigned int firstCorner;
+      unsigned int numOfCorners;
+      bool         hasTexCoords;
+      bool         hasNormals;
+   };
+
+   enum class ObjStatementType : unsigned int
+   {
+      object          = 0,
+      group           = 1,
+      useMaterial     = 2,
+      materialLibrary = 3,
+      count           = 4
+   };
+
+   // Statements that change which mesh the faces that follow them are added to
+   struct ObjStatement
+   {
+      ObjStatementType type;
+      std::string      name;
+      unsigned int     faceIndex; // Index of the first face that comes after the statement
+   };
+
+   struct ObjChunk
+   {
+      std::vector<aiVector3D>   positions;
+      std::vector<aiVector3D>   texCoords;
+      std::vector<aiVector3D>   normals;
+      std::vector<ObjCorner>    corners;
+      std::vector<ObjFace>      faces;
+      std::vector<ObjStatement> statements;
+      std::string               error; // Describes the first line that couldn't be parsed like Assimp parses it
+   };
+
+   struct ObjMaterial
+   {
+      ObjMaterial(const std::string& name)
+         : name(name)
+         , ambientColor(0.0f)
+         , emissiveColor(0.0f)
+         , diffuseColor(0.6f)
+         , specularColor(0.0f)
+         , shininess(0.0f)
+         , textureFilenames()
+      {
+
+      }
+
+      std::string                                                                     name;
+      glm::vec3                                                                       ambientColor;
+      glm::vec3                                                                       emissiveColor;
+      glm::vec3                                                                       diffuseColor;
+      glm::vec3                                                                       specularColor;
+      float                                                                           shininess;
+      std::array<std::string, static_cast<unsigned int>(MaterialTextureTypes::count)> textureFilenames;
+   };
+
+   struct ObjObjectMesh
+   {
+      int                       materialIndex;
+      std::vector<unsigned int> faces;
+      bool                      hasTexCoords;
+      bool                      hasNormals;
+   };
+
+   bool isSpace(char c)
+   {
+      return c == ' ' || c == '\t';
+   }
+
+   bool isDigit(char c)
+   {
+      return c >= '0' && c <= '9';
+   }
+
+   void skipSpaces(const char*& it, const char* end)
+   {
+      while (it != end && isSpace(*it))
+      {
+         ++it;
+      }
+   }
+
+   void skipWord(const char*& it, const char* end)
+   {
+      while (it != end && !isSpace(*it))
+      {
+         ++it;
+      }
+   }
+
+   // Returns the rest of the line without the spaces around it
+   std::string parseName(const char* it, const char* end)
+   {
+      skipSpaces(it, end);
+      while (end != it && isSpace(*(end - 1)))
+      {
+         --end;
+      }
+
+      return std::string(it, end);
+   }
+
+   bool startsWithWord(const char* it, const char* end, const char* word)
+   {
+      for (; *word != '\0'; ++word, ++it)
+      {
+         if (it == end || *it != *word)
+         {
+            return false;
+         }
+      }
+
+      return it == end || isSpace(*it);
+   }
+
+   bool startsWithCaseInsensitive(const char* it, const char* end, const char* prefix)
+   {
+      for (; *prefix != '\0'; ++prefix, ++it)
+      {
+         if (it == end || std::tolower(static_cast<unsigned char>(*it)) != std::tolower(static_cast<unsigned char>(*prefix)))
+         {
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+   // Parses a number like Assimp's fast_atof does, so that both produce the same floats
+   // The integer part, the first 15 fractional digits and the exponent are parsed as integers, the fractional digits are scaled in double precision,
+   // and the parts are combined in single precision, which doesn't always give the float that is closest to the number
+   bool parseFloat(const char*& it, const char* end, float& value)
+   {
+      skipSpaces(it, end);
+
+      bool isNegative = (it != end && *it == '-');
+      if (it != end && (*it == '-' || *it == '+'))
+      {
+         ++it;
+      }
+
+      // Assimp also accepts commas as decimal separators
+      auto isDecimalSeparator = [end](const char* c) { return c != end && (*c == '.' || *c == ',') && (c + 1) != end && isDigit(c[1]); };
+
+      if (it == end || !(isDigit(*it) || isDecimalSeparator(it)))
+      {
+         return false;
+      }
+
+      float result = 0.0f;
+
+      if (isDigit(*it))
+      {
+         std::uint64_t          integerPart = 0;
+         std::from_chars_result parseResult = std::from_chars(it, end, integerPart);
+         if (parseResult.ec != std::errc())
+         {
+            return false;
+         }
+
+         it     = parseResult.ptr;
+         result = static_cast<float>(integerPart);
+      }
+
+      if (isDecimalSeparator(it))
+      {
+         ++it;
+
+         const char* digitsEnd = it;
+         while (digitsEnd != end && isDigit(*digitsEnd))
+         {
+            ++digitsEnd;
+         }
+
+         std::size_t   numOfDigits      = std::min<std::size_t>(digitsEnd - it, maxNumOfFractionalDigits);
+         std::uint64_t fractionalDigits = 0;
+         std::from_chars(it, it + numOfDigits, fractionalDigits);
+
+         result += static_cast<float>(static_cast<double>(fractionalDigits) * fractionalDigitScales[numOfDigits]);
+         it = digitsEnd;
+      }
+      else if (it != end && *it == '.')
+      {
+         // Trailing dots are ignored
+         ++it;
+      }
+
+      if (it != end && (*it == 'e' || *it == 'E'))
+      {
+         ++it;
+
+         bool isExponentNegative = (it != end && *it == '-');
+         if (it != end && (*it == '-' || *it == '+'))
+         {
+            ++it;
+         }
+
+         std::uint64_t          exponent    = 0;
+         std::from_chars_result parseResult = std::from_chars(it, end, exponent);
+         if (parseResult.ec != std::errc())
+         {
+            return false;
+         }
+
+         it = parseResult.ptr;
+         result *= std::pow(10.0f, isExponentNegative ? -static_cast<float>(exponent) : static_cast<float>(exponent));
+      }
+
+      value = isNegative ? -result : result;
+
+      // Like Assimp, ignore anything that follows the number in the same word
+      skipWord(it, end);
+      return true;
+   }
+
+   // Parses the numbers of a line, and returns how many there were (or -1 if one of them couldn't be parsed)
+   int parseFloats(const char* it, const char* end, float* values, int maxNumOfValues)
+   {
+      int numOfValues = 0;
+
+      skipSpaces(it, end);
+      while (it != end)
+      {
+         float value = 0.0f;
+         if (!parseFloat(it, end, value))
+         {
+            return -1;
+         }
+
+         if (numOfValues < maxNumOfValues)
+         {
+            values[numOfValues] = value;
+         }
+
+         ++numOfValues;
+         skipSpaces(it, end);
+      }
+
+      return numOfValues;
+   }
+
+   // Parses a corner of a face (v, v/vt, v//vn or v/vt/vn)
+   bool parseCorner(const char*& it, const char* end, const std::array<std::size_t, 3>& numOfElements, ObjCorner& corner)
+   {
+      corner.indices         = {noIndex, noIndex, noIndex};
+      corner.relativeIndices = 0;
+
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+         if (i > 0)
+         {
+            if (it == end || *it != '/')
+            {
+               break;
+            }
+
+            ++it;
+
+            // A missing texture coordinate (v//vn)
+            if (it != end && *it == '/')
+            {
+               continue;
+            }
+         }
+
+         int                    index       = 0;
+         std::from_chars_result parseResult = std::from_chars(it, end, index);
+         if (parseResult.ec != std::errc() || index == 0)
+         {
+            return false;
+         }
+
+         it = parseResult.ptr;
+
+         if (index > 0)
+         {
+            corner.indices[i] = index - 1;
+         }
+         else
+         {
+            corner.indices[i]       = static_cast<int>(numOfElements[i]) + index;
+            corner.relativeIndices |= static_cast<unsigned char>(1u << i);
+         }
+      }
+
+      return it == end || isSpace(*it);
+   }
+
+   bool parseFace(const char* it, const char* end, ObjChunk& chunk)
+   {
+      ObjFace face{static_cast<unsigned int>(chunk.corners.size()), 0, true, true};
+
+      std::array<std::size_t, 3> numOfElements = {chunk.positions.size(), chunk.texCoords.size(), chunk.normals.size()};
+
+      skipSpaces(it, end);
+      while (it != end)
+      {
+         ObjCorner corner;
+         if (!parseCorner(it, end, numOfElements, corner))
+         {
+            return false;
+         }
+
+         bool hasTexCoord = (corner.indices[1] != noIndex);
+         bool hasNormal   = (corner.indices[2] != noIndex);
+
+         // Assimp matches the texture coordinates and the normals of a face to its corners by their positions in the face,
+         // so faces where only some corners have them are not supported
+         if (face.numOfCorners > 0 && (hasTexCoord != face.hasTexCoords || hasNormal != face.hasNormals))
+         {
+            return false;
+         }
+
+         face.hasTexCoords = hasTexCoord;
+         face.hasNormals   = hasNormal;
+         ++face.numOfCorners;
+         chunk.corners.push_back(corner);
+
+         skipSpaces(it, end);
+      }
+
+      // Assimp treats the faces with fewer than 3 corners as lines and points, and it triangulates the polygons with more than 4 corners by clipping ears
+      if (face.numOfCorners < 3 || face.numOfCorners > 4)
+      {
+         return false;
+      }
+
+      chunk.faces.push_back(face);
+      return true;
+   }
+
+   bool parseLine(const char* it, const char* end, ObjChunk& chunk)
+   {
+      skipSpaces(it, end);
+      if (it == end)
+      {
+         return true;
+      }
+
+      float values[6];
+
+      switch (*it)
+      {
+      case 'v':
+         if (startsWithWord(it, end, "v"))
+         {
+            // Positions can be followed by colors, which are ignored, but homogeneous positions are not supported
+            int numOfValues = parseFloats(it + 1, end, values, 6);
+            if (numOfValues != 3 && numOfValues != 6)
+            {
+               return false;
+            }
+
+            chunk.positions.emplace_back(values[0], values[1], values[2]);
+         }
+         else if (startsWithWord(it, end, "vt"))
+         {
+            // The third component of 3D texture coordinates is ignored
+            int numOfValues = parseFloats(it + 2, end, values, 3);
+            if (numOfValues != 2 && numOfValues != 3)
+            {
+               return false;
+            }
+
+            chunk.texCoords.emplace_back(values[0], values[1], 0.0f);
+         }
+         else if (startsWithWord(it, end, "vn"))
+         {
+            if (parseFloats(it + 2, end, values, 3) != 3)
+            {
+               return false;
+            }
+
+            chunk.normals.emplace_back(values[0], values[1], values[2]);
+         }
+         break;
+      case 'f':
+         return parseFace(it + 1, end, chunk);
+      case 'l':
+      case 'p':
+         // Lines and points
+         return false;
+      case 'o':
+         chunk.statements.push_back(ObjStatement{ObjStatementType::object, parseName(it + 1, end), static_cast<unsigned int>(chunk.faces.size())});
+         break;
+      case 'g':
+         chunk.statements.push_back(ObjStatement{ObjStatementType::group, parseName(it + 1, end), static_cast<unsigned int>(chunk.faces.size())});
+         break;
+      case 'u':
+         if (startsWithWord(it, end, "usemtl"))
+         {
+            chunk.statements.push_back(ObjStatement{ObjStatementType::useMaterial, parseName(it + 6, end), static_cast<unsigned int>(chunk.faces.size())});
+         }
+         break;
+      case 'm':
+         if (startsWithWord(it, end, "mtllib"))
+         {
+            chunk.statements.push_back(ObjStatement{ObjStatementType::materialLibrary, parseName(it + 6, end), static_cast<unsigned int>(chunk.faces.size())});
+         }
+         break;
+      default:
+         // Comments, smoothing groups and the statements that don't affect the meshes
+         break;
+      }
+
+      return true;
+   }
+
+   void parseChunk(const char* begin, const char* end, ObjChunk& chunk)
+   {
+      const char* lineStart = begin;
+      while (lineStart != end)
+      {
+         const char* lineEnd = std::find(lineStart, end, '\n');
+
+         // Lines can also end with "\r\n"
+         const char* contentEnd = lineEnd;
+         if (contentEnd != lineStart && *(contentEnd - 1) == '\r')
+         {
+            --contentEnd;
+         }
+
+         if (!parseLine(lineStart, contentEnd, chunk))
+         {
+            chunk.error = std::string(lineStart, contentEnd);
+            return;
+         }
+
+         lineStart = (lineEnd == end) ? end : lineEnd + 1;
+      }
+   }
+
+   // Like Assimp, fall back to the MTL file that has the name of the OBJ file if the referenced one can't be opened
+   std::string resolveMtlFilePath(const std::string& modelFilePath, const std::string& mtlFilename)
+   {
+      std::string modelDir    = modelFilePath.substr(0, modelFilePath.find_last_of("/\\") + 1);
+      std::string mtlFilePath = modelDir + mtlFilename;
+
+      MappedFile mtlFile;
+      if (!mtlFile.open(mtlFilePath))
+      {
+         mtlFilePath = modelFilePath.substr(0, modelFilePath.size() - 3) + "mtl";
+      }
+
+      return mtlFilePath;
+   }
+
+   // Parses an MTL file like ObjFileMtlImporter does, and makes the last material that it defines the current one
+   void parseMtlFile(const std::string&                            mtlFilePath,
+                     std::vector<ObjMaterial>&                     materials,
+                     std::unordered_map<std::string, unsigned int>& materialIndices,
+                     int&                                          currMaterialIndex)
+   {
+      MappedFile file;
+      if (!file.open(mtlFilePath))
+      {
+         std::cout << "Warning - parseObjModel - The following material library could not be opened: " << mtlFilePath << "\n";
+         return;
+      }
+
+      const char* lineStart = reinterpret_cast<const char*>(file.getData());
+      const char* fileEnd   = lineStart + file.getSize();
+      while (lineStart != fileEnd)
+      {
+         const char* lineEnd    = std::find(lineStart, fileEnd, '\n');
+         const char* contentEnd = (lineEnd != lineStart && *(lineEnd - 1) == '\r') ? lineEnd - 1 : lineEnd;
+         const char* it         = lineStart;
+         lineStart              = (lineEnd == fileEnd) ? fileEnd : lineEnd + 1;
+
+         skipSpaces(it, contentEnd);
+         if (contentEnd - it < 2)
+         {
+            continue;
+         }
+
+         if (startsWithWord(it, contentEnd, "newmtl"))
+         {
+            std::string name = parseName(it + 6, contentEnd);
+
+            auto materialIt = materialIndices.find(name);
+            if (materialIt == materialIndices.end())
+            {
+               materialIt = materialIndices.emplace(name, static_cast<unsigned int>(materials.size())).first;
+               materials.emplace_back(name);
+            }
+
+            currMaterialIndex = materialIt->second;
+            continue;
+         }
+
+         // The properties that come before the first material have nothing to be applied to
+         if (currMaterialIndex == noMaterial)
+         {
+            continue;
+         }
+
+         ObjMaterial& material = materials[currMaterialIndex];
+         if (*it == 'K' || *it == 'k')
+         {
+            glm::vec3* color = nullptr;
+            switch (it[1])
+            {
+            case 'a': color = &material.ambientColor;  break;
+            case 'e': color = &material.emissiveColor; break;
+            case 'd': color = &material.diffuseColor;  break;
+            case 's': color = &material.specularColor; break;
+            }
+
+            // A color with a single component has its other components set to 0
+            float values[3] = {0.0f, 0.0f, 0.0f};
+            if (color && parseFloats(it + 2, contentEnd, values, 3) >= 1)
+            {
+               *color = glm::vec3(values[0], values[1], values[2]);
+            }
+         }
+         else if (startsWithWord(it, contentEnd, "Ns"))
+         {
+            float shininess = 0.0f;
+            if (parseFloats(it + 2, contentEnd, &shininess, 1) >= 1)
+            {
+               material.shininess = shininess;
+            }
+         }
+         else if (*it == 'm')
+         {
+            // The texture types are stored in the order of MaterialTextureTypes
+            const char* texKeywords[static_cast<unsigned int>(MaterialTextureTypes::count)] = {"map_Ka", "map_Ke", "map_Kd", "map_Ks"};
+            for (unsigned int i = 0; i < static_cast<unsigned int>(MaterialTextureTypes::count); ++i)
+            {
+               if (!startsWithCaseInsensitive(it, contentEnd, texKeywords[i]) &&
+                   !(i == static_cast<unsigned int>(MaterialTextureTypes::emissive) && startsWithCaseInsensitive(it, contentEnd, "map_emissive")))
+               {
+                  continue;
+               }
+
+               // Skip the options of the texture (e.g. "-clamp on" or "-s 1 1 1"), since ModelLoader doesn't use them
+               skipWord(it, contentEnd);
+               skipSpaces(it, contentEnd);
+               while (it != contentEnd && *it == '-')
+               {
+                  std::string option(it, std::find_if(it, contentEnd, isSpace));
+                  int         numOfArgs = (option == "-o" || option == "-s" || option == "-t") ? 3 : ((option == "-mm") ? 2 : 1);
+
+                  skipWord(it, contentEnd);
+                  for (int j = 0; j < numOfArgs; ++j)
+                  {
+                     skipSpaces(it, contentEnd);
+                     skipWord(it, contentEnd);
+                  }
+                  skipSpaces(it, contentEnd);
+               }
+
+               material.textureFilenames[i] = parseName(it, contentEnd);
+               break;
+            }
+         }
+      }
+   }
+
+   // Triangulates a face with 3 or 4 corners like TriangulateProcess does
+   // Quads are split along the diagonal that starts at their concave corner, if they have one
+   void triangulateFace(const std::vector<aiVector3D>& positions, unsigned int firstCorner, unsigned int numOfCorners, std::vector<unsigned int>& indices)
+   {
+      if (numOfCorners == 3)
+      {
+         indices.push_back(firstCorner);
+         indices.push_back(firstCorner + 1);
+         indices.push_back(firstCorner + 2);
+         return;
+      }
+
+      unsigned int startCorner = 0;
+      for (unsigned int i = 0; i < 4; ++i)
+      {
+         const aiVector3D& v0 = positions[firstCorner + (i + 3) % 4];
+         const aiVector3D& v1 = positions[firstCorner + (i + 2) % 4];
+         const aiVector3D& v2 = positions[firstCorner + (i + 1) % 4];
+         const aiVector3D& v  = positions[firstCorner + i];
+
+         aiVector3D left  = (v0 - v);
+         aiVector3D diag  = (v1 - v);
+         aiVector3D right = (v2 - v);
+         left.Normalize();
+         diag.Normalize();
+         right.Normalize();
+
+         const float angle = std::acos(left * diag) + std::acos(right * diag);
+         if (angle > AI_MATH_PI_F)
+         {
+            startCorner = i;
+            break;
+         }
+      }
+
+      indices.push_back(firstCorner + startCorner);
+      indices.push_back(firstCorner + (startCorner + 1) % 4);
+      indices.push_back(firstCorner + (startCorner + 2) % 4);
+      indices.push_back(firstCorner + startCorner);
+      indices.push_back(firstCorner + (startCorner + 2) % 4);
+      indices.push_back(firstCorner + (startCorner + 3) % 4);
+   }
+
+   bool isSpecialFloat(float f)
+   {
+      return std::isnan(f) || std::isinf(f);
+   }
+
+   // Calculates the tangents and bitangents of a triangle mesh like CalcTangentsProcess does
+   // Each triangle calculates them from its texture coordinates, and the ones of the corners that share their position and have similar frames are averaged
+   void calculateTangents(const std::vector<aiVector3D>&   positions,
+                          const std::vector<aiVector3D>&   normals,
+                          const std::vector<aiVector3D>&   texCoords,
+                          const std::vector<unsigned int>& indices,
+                          std::vector<aiVector3D>&         tangents,
+                          std::vector<aiVector3D>&         bitangents)
+   {
+      std::size_t numOfVertices = positions.size();
+      tangents.assign(numOfVertices, aiVector3D());
+      bitangents.assign(numOfVertices, aiVector3D());
+
+      for (std::size_t i = 0; i < indices.size(); i += 3)
+      {
+         const unsigned int p0 = indices[i], p1 = indices[i + 1], p2 = indices[i + 2];
+
+         aiVector3D v = positions[p1] - positions[p0];
+         aiVector3D w = positions[p2] - positions[p0];
+
+         float sx = texCoords[p1].x - texCoords[p0].x, sy = texCoords[p1].y - texCoords[p0].y;
+         float tx = texCoords[p2].x - texCoords[p0].x, ty = texCoords[p2].y - texCoords[p0].y;
+         float dirCorrection = (tx * sy - ty * sx) < 0.0f ? -1.0f : 1.0f;
+
+         // When the texture coordinates of the corners are the same, the default directions are used
+         if (sx * ty == sy * tx)
+         {
+            sx = 0.0f;
+            sy = 1.0f;
+            tx = 1.0f;
+            ty = 0.0f;
+         }
+
+         aiVector3D tangent((w.x * sy - v.x * ty) * dirCorrection,
+                            (w.y * sy - v.y * ty) * dirCorrection,
+                            (w.z * sy - v.z * ty) * dirCorrection);
+         aiVector3D bitangent((w.x * sx - v.x * tx) * dirCorrection,
+                              (w.y * sx - v.y * tx) * dirCorrection,
+                              (w.z * sx - v.z * tx) * dirCorrection);
+
+         for (std::size_t j = i; j < i + 3; ++j)
+         {
+            unsigned int      p = indices[j];
+            const aiVector3D& n = normals[p];
+
+            // Project the tangent and the bitangent onto the plane of the normal
+            aiVector3D localTangent   = tangent - n * (tangent * n);
+            aiVector3D localBitangent = bitangent - n * (bitangent * n);
+            localTangent.NormalizeSafe();
+            localBitangent.NormalizeSafe();
+
+            // Rebuild the one that is invalid from the other one and the normal
+            bool isTangentInvalid   = isSpecialFloat(localTangent.x)   || isSpecialFloat(localTangent.y)   || isSpecialFloat(localTangent.z);
+            bool isBitangentInvalid = isSpecialFloat(localBitangent.x) || isSpecialFloat(localBitangent.y) || isSpecialFloat(localBitangent.z);
+            if (isTangentInvalid != isBitangentInvalid)
+            {
+               if (isTangentInvalid)
+               {
+                  localTangent = n ^ localBitangent;
+                  localTangent.NormalizeSafe();
+               }
+               else
+               {
+                  localBitangent = localTangent ^ n;
+                  localBitangent.NormalizeSafe();
+               }
+            }
+
+            tangents[p]   = localTangent;
+            bitangents[p] = localBitangent;
+         }
+      }
+
+      // Sort the vertices by their distance to a plane, like SpatialSort does, so that the vertices that are close to each other can be found with a binary search
+      // The sort is stable so that the tangents of vertices at the same distance are always averaged in the same order
+      aiVector3D planeNormal(0.8523f, 0.8765f, 0.8787f);
+      planeNormal.Normalize();
+
+      std::vector<std::pair<float, unsigned int>> sortedVertices(numOfVertices);
+      aiVector3D minPos = positions.empty() ? aiVector3D() : positions[0];
+      aiVector3D maxPos = minPos;
+      for (unsigned int i = 0; i < numOfVertices; ++i)
+      {
+         sortedVertices[i] = std::make_pair(positions[i] * planeNormal, i);
+         minPos = aiVector3D(std::min(minPos.x, positions[i].x), std::min(minPos.y, positions[i].y), std::min(minPos.z, positions[i].z));
+         maxPos = aiVector3D(std::max(maxPos.x, positions[i].x), std::max(maxPos.y, positions[i].y), std::max(maxPos.z, positions[i].z));
+      }
+      std::stable_sort(sortedVertices.begin(), sortedVertices.end(), [](const std::pair<float, unsigned int>& lhs, const std::pair<float, unsigned int>& rhs)
+      {
+         return lhs.first < rhs.first;
+      });
+
+      const float posEpsilon        = (maxPos - minPos).Length() * 1e-4f;
+      const float squaredPosEpsilon = posEpsilon * posEpsilon;
+      const float minTangentDot     = std::cos(maxTangentSmoothingAngleInRad);
+
+      std::vector<bool>         isVertexDone(numOfVertices, false);
+      std::vector<unsigned int> closeVertices;
+      for (unsigned int a = 0; a < numOfVertices; ++a)
+      {
+         if (isVertexDone[a])
+         {
+            continue;
+         }
+
+         const aiVector3D origPos       = positions[a];
+         const aiVector3D origNormal    = normals[a];
+         const aiVector3D origTangent   = tangents[a];
+         const aiVector3D origBitangent = bitangents[a];
+
+         // Like in CalcTangentsProcess, the current vertex is added to its group before it's found among the close vertices, so it counts twice
+         closeVertices.clear();
+         closeVertices.push_back(a);
+
+         float distance = origPos * planeNormal;
+         auto  it       = std::lower_bound(sortedVertices.begin(), sortedVertices.end(), distance - posEpsilon, [](const std::pair<float, unsigned int>& lhs, float rhs)
+         {
+            return lhs.first < rhs;
+         });
+
+         for (; it != sortedVertices.end() && it->first < distance + posEpsilon; ++it)
+         {
+            unsigned int b = it->second;
+            if ((positions[b] - origPos).SquareLength() >= squaredPosEpsilon ||
+                isVertexDone[b]                                              ||
+                normals[b] * origNormal < minNormalDotForTangentSmoothing    ||
+                tangents[b] * origTangent < minTangentDot                    ||
+                bitangents[b] * origBitangent < minTangentDot)
+            {
+               continue;
+            }
+
+            closeVertices.push_back(b);
+            isVertexDone[b] = true;
+         }
+
+         aiVector3D smoothTangent(0.0f, 0.0f, 0.0f);
+         aiVector3D smoothBitangent(0.0f, 0.0f, 0.0f);
+         for (unsigned int b : closeVertices)
+         {
+            smoothTangent   += tangents[b];
+            smoothBitangent += bitangents[b];
+         }
+         smoothTangent.Normalize();
+         smoothBitangent.Normalize();
+
+         for (unsigned int b : closeVertices)
+         {
+            tangents[b]   = smoothTangent;
+            bitangents[b] = smoothBitangent;
+         }
+      }
+   }
+
+   // Creates a vertex for each corner of the faces of the mesh, triangulates the faces, flips the texture coordinates and calculates the tangents
+   bool createMesh(const ObjObjectMesh&           objectMesh,
+                   const std::vector<ObjFace>&    faces,
+                   const std::vector<ObjCorner>&  corners,
+                   const std::vector<aiVector3D>& positions,
+                   const std::vector<aiVector3D>& texCoords,
+                   const std::vector<aiVector3D>& normals,
+                   ObjMesh&                       mesh)
+   {
+      // ModelLoader needs normals
+      bool hasNormals   = objectMesh.hasNormals && !normals.empty();
+      bool hasTexCoords = objectMesh.hasTexCoords && !texCoords.empty();
+      if (!hasNormals)
+      {
+         return false;
+      }
+
+      std::vector<aiVector3D> cornerPositions;
+      std::vector<aiVector3D> cornerNormals;
+      std::vector<aiVector3D> cornerTexCoords;
+
+      for (unsigned int faceIndex : objectMesh.faces)
+      {
+         const ObjFace& face = faces[faceIndex];
+         for (unsigned int i = face.firstCorner; i < face.firstCorner + face.numOfCorners; ++i)
+         {
+            const ObjCorner& corner = corners[i];
+            cornerPositions.push_back(positions[corner.indices[0]]);
+            cornerNormals.push_back(face.hasNormals ? normals[corner.indices[2]] : aiVector3D());
+
+            // The texture coordinates of the corners that don't have any are 0 before they are flipped
+            if (hasTexCoords)
+            {
+               aiVector3D texCoord = face.hasTexCoords ? texCoords[corner.indices[1]] : aiVector3D();
+               cornerTexCoords.emplace_back(texCoord.x, 1.0f - texCoord.y, 0.0f);
+            }
+         }
+      }
+
+      mesh.indices.clear();
+      mesh.indices.reserve(cornerPositions.size() * 3 / 2);
+      unsigned int firstCorner = 0;
+      for (unsigned int faceIndex : objectMesh.faces)
+      {
+         triangulateFace(cornerPositions, firstCorner, faces[faceIndex].numOfCorners, mesh.indices);
+         firstCorner += faces[faceIndex].numOfCorners;
+      }
+
+      // Without texture coordinates, the tangent frames are built around the normals (see ModelLoader::processVertices)
+      std::vector<aiVector3D> tangents(cornerPositions.size(), aiVector3D());
+      std::vector<aiVector3D> bitangents(cornerPositions.size(), aiVector3D());
+      if (hasTexCoords)
+      {
+         calculateTangents(cornerPositions, cornerNormals, cornerTexCoords, mesh.indices, tangents, bitangents);
+      }
+
+      mesh.vertices.clear();
+      mesh.vertices.reserve(cornerPositions.size());
+      for (std::size_t i = 0; i < cornerPositions.size(); ++i)
+      {
+         mesh.vertices.emplace_back(glm::vec3(cornerPositions[i].x, cornerPositions[i].y, cornerPositions[i].z),
+                                    encodeQTangent(glm::vec3(tangents[i].x, tangents[i].y, tangents[i].z),
+                                                   glm::vec3(bitangents[i].x, bitangents[i].y, bitangents[i].z),
+                                                   glm::vec3(cornerNormals[i].x, cornerNormals[i].y, cornerNormals[i].z)),
+                                    hasTexCoords ? glm::vec2(cornerTexCoords[i].x, cornerTexCoords[i].y) : glm::vec2(0.0f));
+      }
+
+      mesh.materialIndex = (objectMesh.materialIndex == noMaterial) ? 0 : static_cast<unsigned int>(objectMesh.materialIndex);
+      return true;
+   }
+}
+
+bool parseObjModel(const std::string& modelFilePath, ObjModel& objModel, unsigned int numOfThreads)
+{
+   MappedFile file;
+   if (!file.open(modelFilePath))
+   {
+      std::cout << "Error - parseObjModel - The following model could not be opened: " << modelFilePath << "\n";
+      return false;
+   }
+
+   const char* fileBegin = reinterpret_cast<const char*>(file.getData());
+   const char* fileEnd   = fileBegin + file.getSize();
+
+   // Split the file into chunks of whole lines
+   if (numOfThreads == 0)
+   {
+      numOfThreads = getDefaultNumOfThreads();
+   }
+   std::size_t numOfChunks = std::max<std::size_t>(std::min<std::size_t>(numOfThreads, file.getSize() / minChunkSizeInBytes), 1);
+
+   std::vector<const char*> chunkBegins(numOfChunks + 1, fileEnd);
+   chunkBegins[0] = fileBegin;
+   for (std::size_t i = 1; i < numOfChunks; ++i)
+   {
+      const char* lineEnd = std::find(std::max(fileBegin + i * (file.getSize() / numOfChunks), chunkBegins[i - 1]), fileEnd, '\n');
+      chunkBegins[i]      = (lineEnd == fileEnd) ? fileEnd : lineEnd + 1;
+   }
+
+   // Parse the chunks in parallel
+   std::vector<ObjChunk> chunks(numOfChunks);
+   parallelFor(static_cast<unsigned int>(numOfChunks), static_cast<unsigned int>(numOfChunks), [&chunkBegins, &chunks](unsigned int i)
+   {
+      parseChunk(chunkBegins[i], chunkBegins[i + 1], chunks[i]);
+   });
+
+   for (const ObjChunk& chunk : chunks)
+   {
+      if (!chunk.error.empty())
+      {
+         std::cout << "Warning - parseObjModel - The following line is not supported by the OBJ parser, so " << modelFilePath << " will be imported with Assimp: " << chunk.error << "\n";
+         return false;
+      }
+   }
+
+   // Merge the elements of the chunks, and make their relative indices absolute
+   std::vector<aiVector3D> positions;
+   std::vector<aiVector3D> texCoords;
+   std::vector<aiVector3D> normals;
+   std::vector<ObjCorner>  corners;
+   std::vector<ObjFace>    faces;
+   for (ObjChunk& chunk : chunks)
+   {
+      std::array<int, 3> elementOffsets = {static_cast<int>(positions.size()), static_cast<int>(texCoords.size()), static_cast<int>(normals.size())};
+      std::array<int, 3> numOfElements  = {static_cast<int>(positions.size() + chunk.positions.size()),
+                                           static_cast<int>(texCoords.size() + chunk.texCoords.size()),
+                                           static_cast<int>(normals.size() + chunk.normals.size())};
+
+      unsigned int cornerOffset = static_cast<unsigned int>(corners.size());
+      for (ObjCorner& corner : chunk.corners)
+      {
+         for (unsigned int i = 0; i < 3; ++i)
+         {
+            if (corner.indices[i] == noIndex)
+            {
+               continue;
+            }
+
+            if (corner.relativeIndices & (1u << i))
+            {
+               corner.indices[i] += elementOffsets[i];
+            }
+
+            // Assimp discards all the normals or texture coordinates of a mesh when one of their indices is out of range, which is not supported
+            if (corner.indices[i] < 0 || corner.indices[i] >= numOfElements[i])
+            {
+               std::cout << "Warning - parseObjModel - An index is out of range, so " << modelFilePath << " will be imported with Assimp" << "\n";
+               return false;
+            }
+         }
+      }
+
+      for (ObjFace& face : chunk.faces)
+      {
+         face.firstCorner += cornerOffset;
+      }
+
+      for (ObjStatement& statement : chunk.statements)
+      {
+         statement.faceIndex += static_cast<unsigned int>(faces.size());
+      }
+
+      positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+      texCoords.insert(texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+      normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+      corners.insert(corners.end(), chunk.corners.begin(), chunk.corners.end());
+      faces.insert(faces.end(), chunk.faces.begin(), chunk.faces.end());
+   }
+
+   // Replay the statements and the faces in the order of the file to group the faces into meshes like ObjFileParser does
+   // Objects and groups both start a new object, which starts a new mesh, and selecting a different material starts a new mesh unless the current one is empty
+   std::vector<ObjMaterial>                      materials(1, ObjMaterial(defaultMaterialName));
+   std::unordered_map<std::string, unsigned int> materialIndices = {{defaultMaterialName, 0}};
+   std::vector<std::vector<unsigned int>>        objects; // Indices of the meshes of each object
+   std::vector<std::string>                      objectNames;
+   std::vector<ObjObjectMesh>                    objectMeshes;
+   std::string                                   activeGroupName;
+   int                                           currObjectIndex   = -1;
+   int                                           currMeshIndex     = -1;
+   int                                           currMaterialIndex = noMaterial;
+
+   auto createObjectMesh = [&]()
+   {
+      objectMeshes.push_back(ObjObjectMesh{noMaterial, {}, false, false});
+      currMeshIndex = static_cast<int>(objectMeshes.size()) - 1;
+
+      // Meshes that are created before any object are never part of the scene
+      if (currObjectIndex != -1)
+      {
+         objects[currObjectIndex].push_back(currMeshIndex);
+      }
+   };
+
+   auto createObject = [&](const std::string& name)
+   {
+      objects.emplace_back();
+      objectNames.push_back(name);
+      currObjectIndex = static_cast<int>(objects.size()) - 1;
+
+      createObjectMesh();
+      objectMeshes[currMeshIndex].materialIndex = currMaterialIndex;
+   };
+
+   std::vector<ObjChunk>::size_type statementChunk = 0;
+   std::size_t                      statementIndex = 0;
+   for (unsigned int faceIndex = 0; faceIndex <= faces.size(); ++faceIndex)
+   {
+      // Process the statements that come before the current face
+      while (statementChunk < chunks.size())
+      {
+         if (statementIndex == chunks[statementChunk].statements.size())
+         {
+            ++statementChunk;
+            statementIndex = 0;
+            continue;
+         }
+
+         const ObjStatement& statement = chunks[statementChunk].statements[statementIndex];
+         if (statement.faceIndex > faceIndex)
+         {
+            break;
+         }
+         ++statementIndex;
+
+         switch (statement.type)
+         {
+         case ObjStatementType::object:
+            if (!statement.name.empty())
+            {
+               // Selecting an existing object doesn't change the current mesh
+               auto objectIt = std::find(objectNames.begin(), objectNames.end(), statement.name);
+               if (objectIt != objectNames.end())
+               {
+                  currObjectIndex = static_cast<int>(objectIt - objectNames.begin());
+               }
+               else
+               {
+                  createObject(statement.name);
+               }
+            }
+            break;
+         case ObjStatementType::group:
+            if (statement.name != activeGroupName)
+            {
+               createObject(statement.name);
+               activeGroupName = statement.name;
+            }
+            break;
+         case ObjStatementType::useMaterial:
+            if (!statement.name.empty() && (currMaterialIndex == noMaterial || materials[currMaterialIndex].name != statement.name))
+            {
+               // Unknown materials are created with the default values
+               auto materialIt = materialIndices.find(statement.name);
+               if (materialIt == materialIndices.end())
+               {
+                  materialIt = materialIndices.emplace(statement.name, static_cast<unsigned int>(materials.size())).first;
+                  materials.emplace_back(statement.name);
+               }
+               currMaterialIndex = materialIt->second;
+
+               if (currMeshIndex == -1 ||
+                   (objectMeshes[currMeshIndex].materialIndex != noMaterial    &&
+                    objectMeshes[currMeshIndex].materialIndex != currMaterialIndex &&
+                    !objectMeshes[currMeshIndex].faces.empty()))
+               {
+                  createObjectMesh();
+               }
+               objectMeshes[currMeshIndex].materialIndex = currMaterialIndex;
+            }
+            break;
+         case ObjStatementType::materialLibrary:
+            if (!statement.name.empty())
+            {
+               parseMtlFile(resolveMtlFilePath(modelFilePath, statement.name), materials, materialIndices, currMaterialIndex);
+            }
+            break;
+         default:
+            break;
+         }
+      }
+
+      if (faceIndex == faces.size())
+      {
+         break;
+      }
+
+      // Add the current face to the current mesh
+      if (currMaterialIndex == noMaterial)
+      {
+         currMaterialIndex = 0;
+      }
+      if (currObjectIndex == -1)
+      {
+         createObject(defaultObjectName);
+      }
+      if (currMeshIndex == -1)
+      {
+         createObjectMesh();
+      }
+
+      ObjObjectMesh& objectMesh = objectMeshes[currMeshIndex];
+      objectMesh.faces.push_back(faceIndex);
+      objectMesh.hasTexCoords |= faces[faceIndex].hasTexCoords;
+      objectMesh.hasNormals   |= faces[faceIndex].hasNormals;
+   }
+
+   // The meshes are stored in the order of their objects, and the empty ones are dropped
+   std::vector<unsigned int> meshIndices;
+   for (const std::vector<unsigned int>& objectMeshIndices : objects)
+   {
+      for (unsigned int meshIndex : objectMeshIndices)
+      {
+         if (!objectMeshes[meshIndex].faces.empty())
+         {
+            meshIndices.push_back(meshIndex);
+         }
+      }
+   }
+
+   // The meshes don't share any data that they write to, so they are created in parallel
+   std::vector<unsigned char> areMeshesValid(meshIndices.size(), 0);
+   objModel.meshes.assign(meshIndices.size(), ObjMesh());
+   parallelFor(static_cast<unsigned int>(meshIndices.size()), numOfThreads, [&](unsigned int i)
+   {
+      areMeshesValid[i] = createMesh(objectMeshes[meshIndices[i]], faces, corners, positions, texCoords, normals, objModel.meshes[i]);
+   });
+
+   if (std::find(areMeshesValid.begin(), areMeshesValid.end(), 0) != areMeshesValid.end())
+   {
+      std::cout << "Warning - parseObjModel - A mesh doesn't have normals, so " << modelFilePath << " will be imported with Assimp" << "\n";
+      return false;
+   }
+
+   objModel.materials.clear();
+   objModel.materials.reserve(materials.size());
+   for (const ObjMaterial& material : materials)
+   {
+      objModel.materials.emplace_back(material.textureFilenames,
+                                      MaterialConstants(material.ambientColor,
+                                                        material.emissiveColor,
+                                                        material.diffuseColor,
+                                                        material.specularColor,
+                                                        material.shininess));
+   }
+
+   return true;
+}
+
+bool findObjMaterialLibraries(const std::string& modelFilePath, std::vector<std::string>& mtlFilePaths)
+{
+   MappedFile file;
+   if (!file.open(modelFilePath))
+   {
+      return false;
+   }
+
+   const char* lineStart = reinterpret_cast<const char*>(file.getData());
+   const char* fileEnd   = lineStart + file.getSize();
+   while (lineStart != fileEnd)
+   {
+      const char* lineEnd    = std::find(lineStart, fileEnd, '\n');
+      const char* contentEnd = (lineEnd != lineStart && *(lineEnd - 1) == '\r') ? lineEnd - 1 : lineEnd;
+      const char* it         = lineStart;
+      lineStart              = (lineEnd == fileEnd) ? fileEnd : lineEnd + 1;
+
+      skipSpaces(it, contentEnd);
+      if (startsWithWord(it, contentEnd, "mtllib"))
+      {
+         std::string mtlFilename = parseName(it + 6, contentEnd);
+         if (!mtlFilename.empty())
+         {
+            mtlFilePaths.push_back(resolveMtlFilePath(modelFilePath, mtlFilename));
+         }
+      }
+   }
+
+   return true;
+}
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <iostream>
+
+#include "offset_allocator.h"
+
+OffsetAllocator::OffsetAllocator(unsigned int capacity)
+   : mAllocations()
+   , mFreeAllocationIDs()
+   , mFreeBlocks()
+   , mCapacity(capacity)
+   , mNumOfFreeUnits(capacity)
+{
+   if (capacity != 0)
+   {
+      mFreeBlocks.push_back(FreeBlock{0, capacity});
+   }
+}
+
+unsigned int OffsetAllocator::allocate(unsigned int size)
+{
+   if (size == 0)
+   {
+      std::cout << "Error - OffsetAllocator::allocate - Allocations must have at least one unit" << "\n";
+      return invalidAllocation;
+   }
+
+   // Best fit, which keeps the big blocks intact for as long as possible
+   unsigned int bestBlockIndex = invalidAllocation;
+   for (unsigned int i = 0; i < mFreeBlocks.size(); ++i)
+   {
+      if (mFreeBlocks[i].size >= size && (bestBlockIndex == invalidAllocation || mFreeBlocks[i].size < mFreeBlocks[bestBlockIndex].size))
+      {
+         bestBlockIndex = i;
+
+         if (mFreeBlocks[i].size == size)
+         {
+            break;
+         }
+      }
+   }
+
+   if (bestBlockIndex == invalidAllocation)
+   {
+      return invalidAllocation;
+   }
+
+   FreeBlock&   block  = mFreeBlocks[bestBlockIndex];
+   unsigned int offset = block.offset;
+   if (block.size == size)
+   {
+      mFreeBlocks.erase(mFreeBlocks.begin() + bestBlockIndex);
+   }
+   else
+   {
+      block.offset += size;
+      block.size   -= size;
+   }
+
+   mNumOfFreeUnits -= size;
+
+   // Reuse the IDs of freed allocations so that the vector of allocations doesn't grow forever
+   unsigned int allocationID;
+   if (!mFreeAllocationIDs.empty())
+   {
+      allocationID = mFreeAllocationIDs.back();
+      mFreeAllocationIDs.pop_back();
+      mAllocations[allocationID] = Allocation{offset, size, true};
+   }
+   else
+   {
+      allocationID = static_cast<unsigned int>(mAllocations.size());
+      mAllocations.push_back(Allocation{offset, size, true});
+   }
+
+   return allocationID;
+}
+
+void OffsetAllocator::free(unsigned int allocationID)
+{
+   if (allocationID >= mAllocations.size() || !mAllocations[allocationID].isAlive)
+   {
+      std::cout << "Error - OffsetAllocator::free - The following allocation is not alive: " << allocationID << "\n";
+      return;
+   }
+
+   Allocation& allocation = mAllocations[allocationID];
+   allocation.isAlive = false;
+
+   addFreeBlock(allocation.offset, allocation.size);
+   mNumOfFreeUnits += allocation.size;
+
+   mFreeAllocationIDs.push_back(allocationID);
+}
+
+std::vector<OffsetAllocator::Move> OffsetAllocator::compact()
+{
+   std::vector<unsigned int> liveAllocationIDs;
+   liveAllocationIDs.reserve(mAllocations.size() - mFreeAllocationIDs.size());
+   for (unsigned int i = 0; i < mAllocations.size(); ++i)
+   {
+      if (mAllocations[i].isAlive)
+      {
+         liveAllocationIDs.push_back(i);
+      }
+   }
+
+   std::sort(liveAllocationIDs.begin(), liveAllocationIDs.end(), [this](unsigned int a, unsigned int b)
+   {
+      return mAllocations[a].offset < mAllocations[b].offset;
+   });
+
+   std::vector<Move> moves;
+   unsigned int      dstOffset = 0;
+   for (unsigned int allocationID : liveAllocationIDs)
+   {
+      Allocation& allocation = mAllocations[allocationID];
+      if (allocation.offset != dstOffset)
+      {
+         moves.push_back(Move{allocation.offset, dstOffset, allocation.size});
+         allocation.offset = dstOffset;
+      }
+
+      dstOffset += allocation.size;
+   }
+
+   mFreeBlocks.clear();
+   if (dstOffset < mCapacity)
+   {
+      mFreeBlocks.push_back(FreeBlock{dstOffset, mCapacity - dstOffset});
+   }
+
+   return moves;
+}
+
+void OffsetAllocator::grow(unsigned int newCapacity)
+{
+   if (newCapacity <= mCapacity)
+   {
+      return;
+   }
+
+   unsigned int oldCapacity = mCapacity;
+   mCapacity        = newCapacity;
+   mNumOfFreeUnits += newCapacity - oldCapacity;
+
+   addFreeBlock(oldCapacity, newCapacity - oldCapacity);
+}
+
+unsigned int OffsetAllocator::getOffset(unsigned int allocationID) const
+{
+   return mAllocations[allocationID].offset;
+}
+
+unsigned int OffsetAllocator::getSize(unsigned int allocationID) const
+{
+   return mAllocations[allocationID].size;
+}
+
+unsigned int OffsetAllocator::getCapacity() const
+{
+   return mCapacity;
+}
+
+unsigned int OffsetAllocator::getNumOfFreeUnits() const
+{
+   return mNumOfFreeUnits;
+}
+
+unsigned int OffsetAllocator::getSizeOfLargestFreeBlock() const
+{
+   unsigned int largestSize = 0;
+   for (const FreeBlock& block : mFreeBlocks)
+   {
+      largestSize = std::max(largestSize, block.size);
+   }
+
+   return largestSize;
+}
+
+void OffsetAllocator::addFreeBlock(unsigned int offset, unsigned int size)
+{
+   // Find the first block that comes after the new one
+   auto next = std::lower_bound(mFreeBlocks.begin(), mFreeBlocks.end(), offset, [](const FreeBlock& block, unsigned int value)
+   {
+      return block.offset < value;
+   });
+
+   // Merge the new block with the previous one and/or the next one if they are adjacent
+   bool mergesWithPrev = (next != mFreeBlocks.begin()) && ((next - 1)->offset + (next - 1)->size == offset);
+   bool mergesWithNext = (next != mFreeBlocks.end()) && (offset + size == next->offset);
+
+   if (mergesWithPrev && mergesWithNext)
+   {
+      (next - 1)->size += size + next->size;
+      mFreeBlocks.erase(next);
+   }
+   else if (mergesWithPrev)
+   {
+      (next - 1)->size += size;
+   }
+   else if (mergesWithNext)
+   {
+      next->offset  = offset;
+      next->size   += size;
+   }
+   else
+   {
+      mFreeBlocks.insert(next, FreeBlock{offset, size});
+   }
+}
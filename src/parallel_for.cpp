@@ -0,0 +1,45 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "parallel_for.h"
+
+unsigned int getDefaultNumOfThreads()
+{
+   // hardware_concurrency returns 0 when the number of hardware threads can't be determined
+   return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void parallelFor(unsigned int numOfTasks, unsigned int numOfThreads, const std::function<void(unsigned int)>& task)
+{
+   if (numOfThreads == 0)
+   {
+      numOfThreads = getDefaultNumOfThreads();
+   }
+   numOfThreads = std::min(numOfThreads, numOfTasks);
+
+   std::atomic<unsigned int> nextTaskIndex(0);
+   auto runTasks = [&nextTaskIndex, numOfTasks, &task]()
+   {
+      for (unsigned int i = nextTaskIndex++; i < numOfTasks; i = nextTaskIndex++)
+      {
+         task(i);
+      }
+   };
+
+   // The calling thread works on the tasks too instead of waiting idly
+   std::vector<std::thread> threads;
+   threads.reserve(numOfThreads);
+   for (unsigned int i = 1; i < numOfThreads; ++i)
+   {
+      threads.emplace_back(runTasks);
+   }
+
+   runTasks();
+
+   for (std::thread& thread : threads)
+   {
+      thread.join();
+   }
+}
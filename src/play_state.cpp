@@ -3,31 +3,43 @@
 #include "imgui/imgui_impl_opengl3.h"
 
 #include <array>
+#include <cmath>
 #include <random>
 
+#include "gl_state_cache.h"
 #include "play_state.h"
 
-PlayState::PlayState(const std::shared_ptr<FiniteStateMachine>&     finiteStateMachine,
-                     const std::shared_ptr<Window>&                 window,
-                     const std::shared_ptr<Camera>&                 camera,
-                     const std::shared_ptr<Shader>&                 gameObject3DShader,
-                     const std::shared_ptr<Shader>&                 lineShader,
-                     const std::shared_ptr<GameObject3D>&           table,
-                     const std::shared_ptr<GameObject3D>&           teapot)
+PlayState::PlayState(const std::shared_ptr<FiniteStateMachine>&       finiteStateMachine,
+                     const std::shared_ptr<Window>&                   window,
+                     const std::shared_ptr<Camera>&                   camera,
+                     const std::shared_ptr<FramePacer>&               framePacer,
+                     const std::shared_ptr<LinearAllocator>&          frameAllocator,
+                     const std::shared_ptr<UniformBuffer>&            cameraUniformBuffer,
+                     const std::shared_ptr<Shader>&                   gameObject3DShader,
+                     const std::shared_ptr<Shader>&                   lineShader,
+                     const std::shared_ptr<GeometryArena>&            geometryArena,
+                     const std::shared_ptr<ObjectPool<GameObject3D>>& gameObject3DPool,
+                     Handle<GameObject3D>                             table,
+                     Handle<GameObject3D>                             teapot)
    : mFSM(finiteStateMachine)
    , mWindow(window)
    , mCamera(camera)
+   , mFramePacer(framePacer)
+   , mFrameAllocator(frameAllocator)
+   , mCameraUniformBuffer(cameraUniformBuffer)
    , mGameObject3DShader(gameObject3DShader)
    , mLineShader(lineShader)
+   , mGeometryArena(geometryArena)
+   , mGameObject3DPool(gameObject3DPool)
    , mTable(table)
    , mTeapot(teapot)
-   , mWorldXAxis(glm::vec3(0.0f), glm::vec3(20.0f, 0.0f, 0.0f), glm::vec3(0.0f), 0.0f, glm::vec3(0.0f), 0.0f, glm::vec3(1.0f, 0.0f, 0.0f)) // Red
-   , mWorldYAxis(glm::vec3(0.0f), glm::vec3(0.0f, 20.0f, 0.0f), glm::vec3(0.0f), 0.0f, glm::vec3(0.0f), 0.0f, glm::vec3(0.0f, 1.0f, 0.0f)) // Green
-   , mWorldZAxis(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 20.0f), glm::vec3(0.0f), 0.0f, glm::vec3(0.0f), 0.0f, glm::vec3(0.0f, 0.0f, 1.0f)) // Blue
-
-   , mLocalXAxis(glm::vec3(0.0f), glm::vec3(16.0f, 0.0f, 0.0f), glm::vec3(0.0f), 0.0f, glm::vec3(0.0f), 0.0f, glm::vec3(1.0f, 1.0f, 0.0f)) //
-   , mLocalYAxis(glm::vec3(0.0f), glm::vec3(0.0f, 16.0f, 0.0f), glm::vec3(0.0f), 0.0f, glm::vec3(0.0f), 0.0f, glm::vec3(0.0f, 1.0f, 1.0f)) //
-   , mLocalZAxis(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 16.0f), glm::vec3(0.0f), 0.0f, glm::vec3(0.0f), 0.0f, glm::vec3(1.0f, 0.0f, 1.0f)) //
+   , mRenderQueue()
+   , mDebugRenderer()
+   , mInstancedRenderer()
+   , mStressTestTeapots()
+   , mUseInstancing(true)
+   , mShowOrientationFrames(false)
+   , mHaveObjectsBeenSpawned(false)
 {
 
 }
@@ -164,18 +176,12 @@ void PlayState::update(float deltaTime)
 
 void PlayState::rotateSceneByMultiplyingCurrentRotationFromTheLeft(const quat& rot)
 {
-   mTeapot->rotateByMultiplyingCurrentRotationFromTheLeft(rot);
-   mLocalXAxis.rotateByMultiplyingCurrentRotationFromTheLeft(rot);
-   mLocalYAxis.rotateByMultiplyingCurrentRotationFromTheLeft(rot);
-   mLocalZAxis.rotateByMultiplyingCurrentRotationFromTheLeft(rot);
+   mGameObject3DPool->get(mTeapot)->rotateByMultiplyingCurrentRotationFromTheLeft(rot);
 }
 
 void PlayState::rotateSceneByMultiplyingCurrentRotationFromTheRight(const quat& rot)
 {
-   mTeapot->rotateByMultiplyingCurrentRotationFromTheRight(rot);
-   mLocalXAxis.rotateByMultiplyingCurrentRotationFromTheRight(rot);
-   mLocalYAxis.rotateByMultiplyingCurrentRotationFromTheRight(rot);
-   mLocalZAxis.rotateByMultiplyingCurrentRotationFromTheRight(rot);
+   mGameObject3DPool->get(mTeapot)->rotateByMultiplyingCurrentRotationFromTheRight(rot);
 }
 
 void PlayState::render()
@@ -211,12 +217,54 @@ void PlayState::render()
       ImGui::Spacing();
       ImGui::Spacing();
 
+      int targetFrameRate = mFramePacer->getTargetFrameRate();
+      if (ImGui::SliderInt("Target FPS (0 = Unlimited)", &targetFrameRate, 0, 240))
+      {
+         mFramePacer->setTargetFrameRate(targetFrameRate);
+      }
+
+      static const char* swapIntervals[] = {"0 (VSync Off)", "1", "2"};
+      int swapInterval = mWindow->getSwapInterval();
+      if (ImGui::Combo("Swap Interval", &swapInterval, swapIntervals, 3))
+      {
+         mWindow->setSwapInterval(swapInterval);
+      }
+
+      bool lateLatch = mFramePacer->isLateLatchEnabled();
+      if (ImGui::Checkbox("Late Latch Input", &lateLatch))
+      {
+         mFramePacer->setLateLatch(lateLatch);
+         mFramePacer->resetInputLatencyStats();
+      }
+
+      ImGui::Text("Input to present latency: %.2f ms (avg %.2f ms, max %.2f ms)", mFramePacer->getLastInputLatencyInMs(), mFramePacer->getAverageInputLatencyInMs(), mFramePacer->getMaxInputLatencyInMs());
+
+      ImGui::Spacing();
+      ImGui::Spacing();
+      ImGui::Spacing();
+
+      static int numOfStressTestTeapots = 10000;
+      ImGui::SliderInt("Stress Test Teapots", &numOfStressTestTeapots, 0, 10000);
+      if (ImGui::Button("Spawn Stress Test Teapots"))
+      {
+         spawnStressTestTeapots(static_cast<unsigned int>(numOfStressTestTeapots));
+      }
+
+      ImGui::Checkbox("Use Instancing", &mUseInstancing);
+      ImGui::Checkbox("Show Orientation Frames", &mShowOrientationFrames);
+      ImGui::Text("Draw calls: %u (%u batches)", mRenderQueue.getNumOfDrawCallsInLastRender(), mRenderQueue.getNumOfBatchesInLastRender());
+      ImGui::Text("Debug lines: %u (%u draw calls)", mDebugRenderer.getNumOfLinesInLastFlush(), mDebugRenderer.getNumOfDrawCallsInLastFlush());
+      ImGui::Text("State changes: %u (%u avoided by sorting)", mRenderQueue.getNumOfStateChangesInLastRender(), mRenderQueue.getNumOfStateChangesAvoidedInLastRender());
+      ImGui::Text("GL calls: %u issued, %u skipped", GLStateCache::get().getNumOfCallsIssuedInLastFrame(), GLStateCache::get().getNumOfCallsSkippedInLastFrame());
+      ImGui::Text("Geometry: %.1f KB (%.1f KB saved by the vertex format)", mGeometryArena->getNumOfBytesInUse() / 1024.0f, mGeometryArena->getNumOfBytesSavedByVertexFormat() / 1024.0f);
+
+      ImGui::Spacing();
+      ImGui::Spacing();
+      ImGui::Spacing();
+
       if (ImGui::Button("Reset rotation"))
       {
-         mTeapot->setRotation(quat());
-         mLocalXAxis.setRotation(quat());
-         mLocalYAxis.setRotation(quat());
-         mLocalZAxis.setRotation(quat());
+         mGameObject3DPool->get(mTeapot)->setRotation(quat());
       }
 
       ImGui::Spacing();
@@ -293,7 +341,7 @@ void PlayState::render()
       {
          quat lookRot = lookRotation(glm::vec3(fwd[0], fwd[1], fwd[2]), glm::vec3(up[0], up[1], up[2]));
 
-         //mTeapot->setRotation(lookRot);
+         //mGameObject3DPool->get(mTeapot)->setRotation(lookRot);
          //mLocalXAxis.setRotation(lookRot);
          //mLocalYAxis.setRotation(lookRot);
          //mLocalZAxis.setRotation(lookRot);
@@ -312,7 +360,7 @@ void PlayState::render()
       {
          quat fromToRot = fromTo(glm::vec3(from[0], from[1], from[2]), glm::vec3(to[0], to[1], to[2]));
 
-         //mTeapot->setRotation(fromToRot);
+         //mGameObject3DPool->get(mTeapot)->setRotation(fromToRot);
          //mLocalXAxis.setRotation(fromToRot);
          //mLocalYAxis.setRotation(fromToRot);
          //mLocalZAxis.setRotation(fromToRot);
@@ -350,10 +398,7 @@ void PlayState::render()
             std::cout << "Unknown combo box value!" << '\n';
          }
 
-         mTeapot->setRotation(rot);
-         mLocalXAxis.setRotation(rot);
-         mLocalYAxis.setRotation(rot);
-         mLocalZAxis.setRotation(rot);
+         mGameObject3DPool->get(mTeapot)->setRotation(rot);
       }
 
       ImGui::End();
@@ -372,37 +417,66 @@ void PlayState::render()
    mWindow->clearAndBindMultisampleFramebuffer();
 
    // Enable depth testing for 3D objects
-   glEnable(GL_DEPTH_TEST);
+   GLStateCache::get().enable(GL_DEPTH_TEST);
 
-   mLineShader->use();
-   mLineShader->setMat4("projectionView", mCamera->getPerspectiveProjectionViewMatrix());
+   // Upload the camera data once for all the shaders
+   CameraUniformBlock cameraUniformBlock;
+   cameraUniformBlock.projectionView = mCamera->getPerspectiveProjectionViewMatrix();
+   cameraUniformBlock.cameraPos      = mCamera->getPosition();
+   cameraUniformBlock.padding        = 0.0f;
+   mCameraUniformBuffer->update(&cameraUniformBlock, sizeof(CameraUniformBlock));
 
-   mWorldXAxis.render(*mLineShader);
-   mWorldYAxis.render(*mLineShader);
-   mWorldZAxis.render(*mLineShader);
+   // Submit everything to the render queue, which sorts the packets to minimize the state changes before rendering them
+   mRenderQueue.begin(mCamera->getPosition(), 130.0f, *mFrameAllocator); // The max depth is the far plane of the camera
+   mDebugRenderer.begin(*mFrameAllocator);
 
-   mLocalXAxis.render(*mLineShader);
-   mLocalYAxis.render(*mLineShader);
-   mLocalZAxis.render(*mLineShader);
+   const GameObject3D* table  = mGameObject3DPool->get(mTable);
+   const GameObject3D* teapot = mGameObject3DPool->get(mTeapot);
 
-   mGameObject3DShader->use();
-   mGameObject3DShader->setMat4("projectionView", mCamera->getPerspectiveProjectionViewMatrix());
-   mGameObject3DShader->setVec3("cameraPos", mCamera->getPosition());
-
-   mTable->render(*mGameObject3DShader);
+   if (mUseInstancing)
+   {
+      // Render all the objects that share a model with a single draw call per mesh
+      mInstancedRenderer.begin();
+      mInstancedRenderer.submit(*table);
+      for (Handle<GameObject3D> stressTestTeapot : mStressTestTeapots)
+      {
+         mInstancedRenderer.submit(*mGameObject3DPool->get(stressTestTeapot));
+      }
+      mInstancedRenderer.flush(mRenderQueue, RenderPass::opaque, *mGameObject3DShader);
+   }
+   else
+   {
+      mRenderQueue.submit(RenderPass::opaque, *mGameObject3DShader, *table);
+      for (Handle<GameObject3D> stressTestTeapot : mStressTestTeapots)
+      {
+         mRenderQueue.submit(RenderPass::opaque, *mGameObject3DShader, *mGameObject3DPool->get(stressTestTeapot));
+      }
+   }
 
    // Disable face culling so that we render the inside of the teapot
-   glDisable(GL_CULL_FACE);
-   mTeapot->render(*mGameObject3DShader);
-   glEnable(GL_CULL_FACE);
+   mRenderQueue.submit(RenderPass::opaqueDoubleSided, *mGameObject3DShader, *teapot);
+
+   mRenderQueue.render();
+
+   // The world axes and the local axes of the teapot are rendered with a single draw call
+   mDebugRenderer.addAxes(glm::vec3(0.0f), quat(), 20.0f, DebugLineStyle::thick);
+   mDebugRenderer.addAxes(glm::vec3(0.0f), teapot->getRotation(), 16.0f, DebugLineStyle::thick, glm::vec3(1.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 1.0f), glm::vec3(1.0f, 0.0f, 1.0f));
+
+   if (mShowOrientationFrames)
+   {
+      for (Handle<GameObject3D> stressTestTeapot : mStressTestTeapots)
+      {
+         const GameObject3D* gameObject = mGameObject3DPool->get(stressTestTeapot);
+         mDebugRenderer.addOrientationFrame(gameObject->getPosition(), gameObject->getRotation(), 4.0f);
+      }
+   }
+
+   mDebugRenderer.flush(*mLineShader);
 
    ImGui::Render();
    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
    mWindow->generateAntiAliasedImage();
-
-   mWindow->swapBuffers();
-   mWindow->pollEvents();
 }
 
 void PlayState::exit()
@@ -410,11 +484,62 @@ void PlayState::exit()
 
 }
 
+bool PlayState::needsRedraw() const
+{
+   // The axes are derived from the rotation of the teapot every frame, so they don't need to be checked
+   return mCamera->isDirty()                          ||
+          mGameObject3DPool->get(mTable)->isDirty()  ||
+          mGameObject3DPool->get(mTeapot)->isDirty();
+}
+
 void PlayState::resetScene()
 {
 
 }
 
+void PlayState::spawnStressTestTeapots(unsigned int numOfTeapots)
+{
+   destroyStressTestTeapots();
+   mHaveObjectsBeenSpawned = true;
+
+   // Lay out the teapots in a square grid under the table
+   ResourceHandle<Model>         teapotModel   = mGameObject3DPool->get(mTeapot)->getModelHandle();
+   unsigned int                  numOfColumns  = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<float>(numOfTeapots))));
+   float                         spacing       = 6.0f;
+   float                         halfGridWidth = (numOfColumns - 1) * spacing * 0.5f;
+
+   mStressTestTeapots.reserve(numOfTeapots);
+   for (unsigned int i = 0; i < numOfTeapots; ++i)
+   {
+      glm::vec3 position(((i % numOfColumns) * spacing) - halfGridWidth,
+                         -30.0f,
+                         ((i / numOfColumns) * spacing) - halfGridWidth);
+
+      mStressTestTeapots.push_back(mGameObject3DPool->create(teapotModel,
+                                                             position,
+                                                             static_cast<float>((i * 37) % 360), // Give each teapot a different orientation
+                                                             glm::vec3(0.0f, 1.0f, 0.0f),
+                                                             0.5f));
+   }
+}
+
+void PlayState::destroyStressTestTeapots()
+{
+   for (Handle<GameObject3D> stressTestTeapot : mStressTestTeapots)
+   {
+      mGameObject3DPool->destroy(stressTestTeapot);
+   }
+
+   mStressTestTeapots.clear();
+}
+
+bool PlayState::haveObjectsBeenSpawned()
+{
+   bool haveObjectsBeenSpawned = mHaveObjectsBeenSpawned;
+   mHaveObjectsBeenSpawned     = false;
+   return haveObjectsBeenSpawned;
+}
+
 void PlayState::resetCamera()
 {
    mCamera->reposition(glm::vec3(30.0f, 30.0f, 30.0f),
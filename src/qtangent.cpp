@@ -0,0 +1,87 @@
+#include <cmath>
+
+#include "qtangent.h"
+
+namespace
+{
+   // Smallest positive value of a 16-bit snorm
+   const float minAbsW = 1.0f / 32767.0f;
+
+   // Converts a rotation matrix (whose columns are the rotated X, Y and Z axes) into a unit quaternion
+   // The square root is taken of the largest of the four possible terms, which keeps the division by it accurate
+   quat rotationMatrixToQuat(const glm::mat3& m)
+   {
+      float trace = m[0][0] + m[1][1] + m[2][2];
+
+      if (trace > 0.0f)
+      {
+         float s = 2.0f * std::sqrt(1.0f + trace); // 4w
+         return quat((m[1][2] - m[2][1]) / s, (m[2][0] - m[0][2]) / s, (m[0][1] - m[1][0]) / s, 0.25f * s);
+      }
+      else if (m[0][0] > m[1][1] && m[0][0] > m[2][2])
+      {
+         float s = 2.0f * std::sqrt(1.0f + m[0][0] - m[1][1] - m[2][2]); // 4x
+         return quat(0.25f * s, (m[1][0] + m[0][1]) / s, (m[2][0] + m[0][2]) / s, (m[1][2] - m[2][1]) / s);
+      }
+      else if (m[1][1] > m[2][2])
+      {
+         float s = 2.0f * std::sqrt(1.0f + m[1][1] - m[0][0] - m[2][2]); // 4y
+         return quat((m[1][0] + m[0][1]) / s, 0.25f * s, (m[2][1] + m[1][2]) / s, (m[2][0] - m[0][2]) / s);
+      }
+      else
+      {
+         float s = 2.0f * std::sqrt(1.0f + m[2][2] - m[0][0] - m[1][1]); // 4z
+         return quat((m[2][0] + m[0][2]) / s, (m[2][1] + m[1][2]) / s, 0.25f * s, (m[0][1] - m[1][0]) / s);
+      }
+   }
+}
+
+quat encodeQTangent(const glm::vec3& tangent, const glm::vec3& bitangent, const glm::vec3& normal)
+{
+   // Orthonormalize the frame with Gram-Schmidt, keeping the normal as is since it's what the lighting depends on the most
+   glm::vec3 n = glm::normalize(normal);
+   glm::vec3 t = tangent - glm::dot(tangent, n) * n;
+   if (glm::dot(t, t) < 1e-12f)
+   {
+      // The tangent is undefined (e.g. the mesh has no texture coordinates), so any vector that is perpendicular to the normal will do
+      t = (std::abs(n.x) < 0.9f) ? glm::cross(n, glm::vec3(1.0f, 0.0f, 0.0f)) : glm::cross(n, glm::vec3(0.0f, 1.0f, 0.0f));
+   }
+   t = glm::normalize(t);
+   glm::vec3 b = glm::cross(n, t);
+
+   // The frame is reflected if the given bitangent points away from the one that makes it right-handed
+   bool isReflected = glm::dot(b, bitangent) < 0.0f;
+
+   quat q = rotationMatrixToQuat(glm::mat3(t, b, n));
+   normalize(q);
+
+   // q and -q represent the same rotation, so we pick the one with a positive w and use the sign of w to store the reflection
+   if (q.w < 0.0f)
+   {
+      q = -q;
+   }
+
+   // Push w away from 0 so that its sign survives the quantization, and shrink the vector part so that q stays a unit quaternion
+   if (q.w < minAbsW)
+   {
+      float vectorScale = std::sqrt(1.0f - minAbsW * minAbsW) / glm::length(glm::vec3(q.x, q.y, q.z));
+      q = quat(q.x * vectorScale, q.y * vectorScale, q.z * vectorScale, minAbsW);
+   }
+
+   return isReflected ? -q : q;
+}
+
+void decodeQTangent(const quat& qTangent, glm::vec3& tangent, glm::vec3& bitangent, glm::vec3& normal)
+{
+   // The frame is made out of the columns of the rotation matrix of the quaternion, which are the same for q and -q
+   quat q = normalized(qTangent);
+
+   tangent   = glm::vec3(1.0f - 2.0f * (q.y * q.y + q.z * q.z), 2.0f * (q.x * q.y + q.z * q.w),        2.0f * (q.x * q.z - q.y * q.w));
+   bitangent = glm::vec3(2.0f * (q.x * q.y - q.z * q.w),        1.0f - 2.0f * (q.x * q.x + q.z * q.z), 2.0f * (q.y * q.z + q.x * q.w));
+   normal    = glm::vec3(2.0f * (q.x * q.z + q.y * q.w),        2.0f * (q.y * q.z - q.x * q.w),        1.0f - 2.0f * (q.x * q.x + q.y * q.y));
+
+   if (qTangent.w < 0.0f)
+   {
+      bitangent = -bitangent;
+   }
+}
@@ -0,0 +1,330 @@
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <array>
+
+#include "gl_state_cache.h"
+#include "geometry_arena.h"
+#include "render_queue.h"
+
+namespace
+{
+   const unsigned int numOfPassBits     = 4;
+   const unsigned int numOfShaderBits   = 8;
+   const unsigned int numOfMaterialBits = 12;
+   const unsigned int numOfMeshBits     = 16;
+   const unsigned int numOfDepthBits    = 24;
+
+   unsigned long long makeSortKey(unsigned int pass, unsigned int shaderID, unsigned int materialID, unsigned int meshID, unsigned int depth)
+   {
+      // IDs that don't fit in their fields wrap around, which only makes the sorting less effective since packets are compared by their actual states when they are executed
+      unsigned long long key = pass & ((1u << numOfPassBits) - 1);
+      key = (key << numOfShaderBits)   | (shaderID   & ((1u << numOfShaderBits) - 1));
+      key = (key << numOfMaterialBits) | (materialID & ((1u << numOfMaterialBits) - 1));
+      key = (key << numOfMeshBits)     | (meshID     & ((1u << numOfMeshBits) - 1));
+      key = (key << numOfDepthBits)    | (depth      & ((1u << numOfDepthBits) - 1));
+      return key;
+   }
+}
+
+RenderQueue::RenderQueue()
+   : mPackets()
+   , mSortEntries()
+   , mSortScratch()
+   , mInstanceTransforms()
+   , mDrawCommands()
+   , mNumOfSubmittedDrawCommands(0)
+   , mCameraPos(0.0f)
+   , mMaxDepth(1.0f)
+   , mNumOfBatchesInLastRender(0)
+   , mNumOfDrawCallsInLastRender(0)
+   , mNumOfStateChangesInLastRender(0)
+   , mNumOfStateChangesAvoidedInLastRender(0)
+{
+
+}
+
+void RenderQueue::begin(const glm::vec3& cameraPos, float maxDepth, LinearAllocator& frameAllocator)
+{
+   // The arrays of the previous frame were freed when the allocator was reset, so submitting packets never touches the heap
+   mPackets.reset(frameAllocator);
+   mSortEntries.reset(frameAllocator);
+   mSortScratch.reset(frameAllocator);
+   mInstanceTransforms.reset(frameAllocator);
+   mDrawCommands.reset(frameAllocator);
+
+   mCameraPos = cameraPos;
+   mMaxDepth  = (maxDepth > 0.0f) ? maxDepth : 1.0f;
+}
+
+void RenderQueue::submit(RenderPass pass, const Shader& shader, const GameObject3D& gameObject)
+{
+   // The model is still loading
+   if (!gameObject.isModelReady())
+   {
+      return;
+   }
+
+   InstanceTransform instanceTransform = gameObject.getInstanceTransform();
+   submit(pass, shader, *gameObject.getModel(), &instanceTransform, 1);
+}
+
+void RenderQueue::submit(RenderPass pass, const Shader& shader, const Model& model, const InstanceTransform* instanceTransforms, unsigned int numOfInstances)
+{
+   if (numOfInstances == 0)
+   {
+      return;
+   }
+
+   // The instance transforms are copied so that the caller doesn't need to keep them alive until the queue is rendered
+   // If the frame allocator is out of memory, the model isn't rendered
+   unsigned int firstInstance = static_cast<unsigned int>(mInstanceTransforms.size());
+   if (!mInstanceTransforms.append(instanceTransforms, numOfInstances))
+   {
+      return;
+   }
+
+   for (unsigned int i = firstInstance; i < mInstanceTransforms.size(); ++i)
+   {
+      model.applyPositionQuantization(mInstanceTransforms[i]);
+   }
+
+   // Packets of instanced models are sorted by the depth of their first instance
+   float depth = glm::length(glm::vec3(instanceTransforms[0].positionAndScale) - mCameraPos);
+
+   for (unsigned int i = 0; i < model.getNumOfMeshes(); ++i)
+   {
+      const Mesh& mesh = model.getMesh(i);
+      addPacket(DrawPacket{pass, &shader, &model, i, firstInstance, numOfInstances}, mesh.getMaterialIndex(), mesh.getGeometryID(), depth);
+   }
+}
+
+void RenderQueue::render()
+{
+   radixSort();
+
+   // The packets were submitted in the order in which they used to be rendered, so executing them in that order tells us how many state changes the sorting avoided
+   unsigned int numOfUnsortedStateChanges = 0;
+   {
+      // mSortScratch is free after sorting, so we reuse it to store the submission order
+      mSortScratch.clear();
+      for (unsigned int i = 0; i < mPackets.size(); ++i)
+      {
+         mSortScratch.push_back(SortEntry{0, i});
+      }
+
+      numOfUnsortedStateChanges = executePackets(mSortScratch, false);
+   }
+
+   mNumOfBatchesInLastRender             = 0;
+   mNumOfDrawCallsInLastRender           = 0;
+   mNumOfStateChangesInLastRender        = executePackets(mSortEntries, true);
+   mNumOfStateChangesAvoidedInLastRender = (numOfUnsortedStateChanges > mNumOfStateChangesInLastRender) ? (numOfUnsortedStateChanges - mNumOfStateChangesInLastRender) : 0;
+}
+
+unsigned int RenderQueue::getNumOfBatchesInLastRender() const
+{
+   return mNumOfBatchesInLastRender;
+}
+
+unsigned int RenderQueue::getNumOfDrawCallsInLastRender() const
+{
+   return mNumOfDrawCallsInLastRender;
+}
+
+unsigned int RenderQueue::getNumOfStateChangesInLastRender() const
+{
+   return mNumOfStateChangesInLastRender;
+}
+
+unsigned int RenderQueue::getNumOfStateChangesAvoidedInLastRender() const
+{
+   return mNumOfStateChangesAvoidedInLastRender;
+}
+
+void RenderQueue::addPacket(const DrawPacket& packet, unsigned int materialID, unsigned int meshID, float depth)
+{
+   // Opaque packets are sorted from front to back so that the depth test rejects as many fragments as possible
+   float        normalizedDepth = std::min(std::max(depth / mMaxDepth, 0.0f), 1.0f);
+   unsigned int quantizedDepth  = static_cast<unsigned int>(normalizedDepth * static_cast<float>((1u << numOfDepthBits) - 1));
+
+   // The sort entry is only added if the packet fits, so that it never refers to a packet that doesn't exist
+   if (mPackets.push_back(packet))
+   {
+      mSortEntries.push_back(SortEntry{makeSortKey(static_cast<unsigned int>(packet.pass), packet.shader->getID(), materialID, meshID, quantizedDepth),
+                                       static_cast<unsigned int>(mPackets.size() - 1)});
+   }
+}
+
+void RenderQueue::radixSort()
+{
+   // Least significant digit radix sort with 8-bit digits
+   // It's stable, so packets with the same key are executed in the order in which they were submitted
+   const unsigned int numOfDigits = sizeof(unsigned long long);
+   const unsigned int numOfValues = 256;
+
+   std::size_t numOfEntries = mSortEntries.size();
+   if (numOfEntries < 2)
+   {
+      return;
+   }
+
+   if (!mSortScratch.resize(numOfEntries))
+   {
+      return;
+   }
+
+   // Build the histograms of all the digits in a single pass over the keys
+   std::array<std::array<unsigned int, numOfValues>, numOfDigits> histograms = {};
+   for (const SortEntry& entry : mSortEntries)
+   {
+      for (unsigned int digit = 0; digit < numOfDigits; ++digit)
+      {
+         ++histograms[digit][(entry.key >> (digit * 8)) & 0xFF];
+      }
+   }
+
+   for (unsigned int digit = 0; digit < numOfDigits; ++digit)
+   {
+      std::array<unsigned int, numOfValues>& histogram = histograms[digit];
+
+      // Skip the digits that are the same for all the keys (e.g. the pass when every packet is opaque)
+      if (histogram[(mSortEntries[0].key >> (digit * 8)) & 0xFF] == numOfEntries)
+      {
+         continue;
+      }
+
+      // Turn the histogram into the offsets at which each digit value starts
+      unsigned int offset = 0;
+      for (unsigned int& count : histogram)
+      {
+         unsigned int currCount = count;
+         count   = offset;
+         offset += currCount;
+      }
+
+      for (const SortEntry& entry : mSortEntries)
+      {
+         mSortScratch[histogram[(entry.key >> (digit * 8)) & 0xFF]++] = entry;
+      }
+
+      mSortEntries.swap(mSortScratch);
+   }
+}
+
+unsigned int RenderQueue::executePackets(const FrameVector<SortEntry>& order, bool issueCalls)
+{
+   unsigned int numOfStateChanges = 0;
+
+   // Face culling is enabled by default (see Window::initialize)
+   bool           faceCullingIsEnabled = true;
+   const Shader*  currShader           = nullptr;
+   GeometryArena* currGeometryArena    = nullptr;
+   const Mesh*    currMaterialMesh     = nullptr;
+   unsigned int   currIndexType        = 0;
+
+   mDrawCommands.clear();
+   mNumOfSubmittedDrawCommands = 0;
+
+   for (const SortEntry& entry : order)
+   {
+      const DrawPacket& packet = mPackets[entry.packetIndex];
+      const Mesh&       mesh   = packet.model->getMesh(packet.meshIndex);
+
+      bool enableFaceCulling      = (packet.pass != RenderPass::opaqueDoubleSided);
+      bool faceCullingChanges     = (enableFaceCulling != faceCullingIsEnabled);
+      bool shaderChanges          = (packet.shader != currShader);
+      bool geometryArenaChanges   = (&mesh.getGeometryArena() != currGeometryArena);
+      bool materialChanges        = shaderChanges || !currMaterialMesh || !mesh.hasSameMaterialAs(*currMaterialMesh); // The material uniforms belong to the shader
+      bool indexTypeChanges       = (mesh.getIndexType() != currIndexType);
+
+      // The pending commands were recorded with the current state, so they must be submitted before it changes
+      // A change of the index type isn't a state change, but the commands of a multi-draw call must share their index type
+      if (issueCalls && (faceCullingChanges || shaderChanges || geometryArenaChanges || materialChanges || indexTypeChanges))
+      {
+         submitDrawCommands(currGeometryArena, currIndexType);
+      }
+
+      currIndexType = mesh.getIndexType();
+
+      // Raster state
+      if (faceCullingChanges)
+      {
+         if (issueCalls)
+         {
+            enableFaceCulling ? GLStateCache::get().enable(GL_CULL_FACE) : GLStateCache::get().disable(GL_CULL_FACE);
+         }
+
+         faceCullingIsEnabled = enableFaceCulling;
+         ++numOfStateChanges;
+      }
+
+      // Shader
+      if (shaderChanges)
+      {
+         if (issueCalls)
+         {
+            packet.shader->use();
+         }
+
+         currShader = packet.shader;
+         ++numOfStateChanges;
+      }
+
+      // Geometry arena
+      // The instance transforms of the whole queue are uploaded at once, and each command selects its own with its base instance
+      if (geometryArenaChanges)
+      {
+         if (issueCalls)
+         {
+            mesh.getGeometryArena().uploadInstanceTransforms(mInstanceTransforms.data(), static_cast<unsigned int>(mInstanceTransforms.size()));
+            mesh.getGeometryArena().bindVertexArray();
+         }
+
+         currGeometryArena = &mesh.getGeometryArena();
+         ++numOfStateChanges;
+      }
+
+      // Material
+      if (materialChanges)
+      {
+         if (issueCalls)
+         {
+            mesh.bindMaterial(*packet.shader);
+         }
+
+         currMaterialMesh = &mesh;
+         ++numOfStateChanges;
+      }
+
+      if (issueCalls)
+      {
+         mDrawCommands.push_back(mesh.getDrawCommand(packet.numOfInstances, packet.firstInstance));
+      }
+   }
+
+   if (issueCalls)
+   {
+      submitDrawCommands(currGeometryArena, currIndexType);
+
+      if (!faceCullingIsEnabled)
+      {
+         GLStateCache::get().enable(GL_CULL_FACE);
+      }
+   }
+
+   return numOfStateChanges;
+}
+
+void RenderQueue::submitDrawCommands(GeometryArena* geometryArena, unsigned int indexType)
+{
+   unsigned int numOfPendingDrawCommands = static_cast<unsigned int>(mDrawCommands.size()) - mNumOfSubmittedDrawCommands;
+   if (!geometryArena || numOfPendingDrawCommands == 0)
+   {
+      return;
+   }
+
+   mNumOfDrawCallsInLastRender += geometryArena->multiDrawElementsIndirect(indexType, &mDrawCommands[mNumOfSubmittedDrawCommands], numOfPendingDrawCommands);
+   mNumOfSubmittedDrawCommands  = static_cast<unsigned int>(mDrawCommands.size());
+   ++mNumOfBatchesInLastRender;
+}
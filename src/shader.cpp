@@ -1,33 +1,90 @@
+#include <cstring>
 #include <iostream>
 
+#include "gl_state_cache.h"
 #include "shader.h"
 
+namespace
+{
+   // 32-bit FNV-1a
+   unsigned int hashUniformName(const char* name)
+   {
+      unsigned int hash = 2166136261u;
+      for (; *name != '\0'; ++name)
+      {
+         hash ^= static_cast<unsigned char>(*name);
+         hash *= 16777619u;
+      }
+
+      return hash;
+   }
+
+   bool isSampler(GLenum type)
+   {
+      switch (type)
+      {
+      case GL_SAMPLER_1D:
+      case GL_SAMPLER_2D:
+      case GL_SAMPLER_3D:
+      case GL_SAMPLER_CUBE:
+      case GL_SAMPLER_2D_SHADOW:
+      case GL_SAMPLER_2D_ARRAY:
+      case GL_SAMPLER_2D_MULTISAMPLE:
+         return true;
+      default:
+         return false;
+      }
+   }
+
+   // Booleans and samplers are set with glUniform1i, so they are compatible with ints
+   bool typesAreCompatible(GLenum uniformType, GLenum requestedType)
+   {
+      if (uniformType == requestedType)
+      {
+         return true;
+      }
+
+      if (requestedType == GL_INT || requestedType == GL_BOOL)
+      {
+         return (uniformType == GL_INT) || (uniformType == GL_BOOL) || isSampler(uniformType);
+      }
+
+      return false;
+   }
+}
+
 Shader::Shader(unsigned int shaderProgID)
    : mShaderProgID(shaderProgID)
+   , mUniforms()
+   , mMissingUniforms()
 {
-
+   reflectActiveUniforms();
 }
 
 Shader::~Shader()
 {
-   glDeleteProgram(mShaderProgID);
+   GLStateCache::get().deleteProgram(mShaderProgID);
 }
 
 Shader::Shader(Shader&& rhs) noexcept
    : mShaderProgID(std::exchange(rhs.mShaderProgID, 0))
+   , mUniforms(std::move(rhs.mUniforms))
+   , mMissingUniforms(std::move(rhs.mMissingUniforms))
 {
 
 }
 
 Shader& Shader::operator=(Shader&& rhs) noexcept
 {
-   mShaderProgID = std::exchange(rhs.mShaderProgID, 0);
+   mShaderProgID    = std::exchange(rhs.mShaderProgID, 0);
+   mUniforms        = std::move(rhs.mUniforms);
+   mMissingUniforms = std::move(rhs.mMissingUniforms);
    return *this;
 }
 
 void Shader::use() const
 {
-   glUseProgram(mShaderProgID);
+   GLStateCache::get().useProgram(mShaderProgID);
 }
 
 unsigned int Shader::getID() const
@@ -35,74 +92,291 @@ unsigned int Shader::getID() const
    return mShaderProgID;
 }
 
-void Shader::setBool(const std::string& name, bool value) const
+ResourceFootprint Shader::getFootprint() const
+{
+   // OpenGL 3.3 doesn't report the size of a linked program, so we only count the uniform table
+   std::size_t cpuMemoryInBytes = sizeof(Shader) + mUniforms.capacity() * sizeof(UniformInfo);
+   for (const UniformInfo& uniform : mUniforms)
+   {
+      cpuMemoryInBytes += uniform.name.capacity();
+   }
+
+   return ResourceFootprint{cpuMemoryInBytes, 0};
+}
+
+void Shader::bindUniformBlock(const char* blockName, unsigned int bindingPoint) const
+{
+   unsigned int blockIndex = glGetUniformBlockIndex(mShaderProgID, blockName);
+
+   if (blockIndex == GL_INVALID_INDEX)
+   {
+      std::cout << "Error - Shader::bindUniformBlock - The following uniform block does not exist: " << blockName << "\n";
+      return;
+   }
+
+   glUniformBlockBinding(mShaderProgID, blockIndex, bindingPoint);
+}
+
+void Shader::setBool(const char* name, bool value) const
+{
+   glUniform1i(getUniformLocation(name), (int)value);
+}
+
+void Shader::setInt(const char* name, int value) const
+{
+   glUniform1i(getUniformLocation(name), value);
+}
+
+void Shader::setFloat(const char* name, float value) const
+{
+   glUniform1f(getUniformLocation(name), value);
+}
+
+void Shader::setVec2(const char* name, const glm::vec2 &value) const
+{
+   glUniform2fv(getUniformLocation(name), 1, &value[0]);
+}
+
+void Shader::setVec2(const char* name, float x, float y) const
+{
+   glUniform2f(getUniformLocation(name), x, y);
+}
+
+void Shader::setVec3(const char* name, const glm::vec3 &value) const
+{
+   glUniform3fv(getUniformLocation(name), 1, &value[0]);
+}
+
+void Shader::setVec3(const char* name, float x, float y, float z) const
+{
+   glUniform3f(getUniformLocation(name), x, y, z);
+}
+
+void Shader::setVec4(const char* name, const glm::vec4 &value) const
+{
+   glUniform4fv(getUniformLocation(name), 1, &value[0]);
+}
+
+void Shader::setVec4(const char* name, float x, float y, float z, float w) const
+{
+   glUniform4f(getUniformLocation(name), x, y, z, w);
+}
+
+void Shader::setMat2(const char* name, const glm::mat2& value) const
+{
+   glUniformMatrix2fv(getUniformLocation(name), 1, GL_FALSE, &value[0][0]);
+}
+
+void Shader::setMat3(const char* name, const glm::mat3& value) const
+{
+   glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, &value[0][0]);
+}
+
+void Shader::setMat4(const char* name, const glm::mat4& value) const
 {
-   glUniform1i(getUniformLocation(name.c_str()), (int)value);
+   glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &value[0][0]);
 }
 
-void Shader::setInt(const std::string& name, int value) const
+void Shader::setUniform(UniformHandle<bool> handle, bool value) const
 {
-   glUniform1i(getUniformLocation(name.c_str()), value);
+   glUniform1i(handle.location, (int)value);
 }
 
-void Shader::setFloat(const std::string& name, float value) const
+void Shader::setUniform(UniformHandle<int> handle, int value) const
 {
-   glUniform1f(getUniformLocation(name.c_str()), value);
+   glUniform1i(handle.location, value);
 }
 
-void Shader::setVec2(const std::string& name, const glm::vec2 &value) const
+void Shader::setUniform(UniformHandle<float> handle, float value) const
 {
-   glUniform2fv(getUniformLocation(name.c_str()), 1, &value[0]);
+   glUniform1f(handle.location, value);
 }
 
-void Shader::setVec2(const std::string& name, float x, float y) const
+void Shader::setUniform(UniformHandle<glm::vec2> handle, const glm::vec2& value) const
 {
-   glUniform2f(getUniformLocation(name.c_str()), x, y);
+   glUniform2fv(handle.location, 1, &value[0]);
 }
 
-void Shader::setVec3(const std::string& name, const glm::vec3 &value) const
+void Shader::setUniform(UniformHandle<glm::vec3> handle, const glm::vec3& value) const
 {
-   glUniform3fv(getUniformLocation(name.c_str()), 1, &value[0]);
+   glUniform3fv(handle.location, 1, &value[0]);
 }
 
-void Shader::setVec3(const std::string& name, float x, float y, float z) const
+void Shader::setUniform(UniformHandle<glm::vec4> handle, const glm::vec4& value) const
 {
-   glUniform3f(getUniformLocation(name.c_str()), x, y, z);
+   glUniform4fv(handle.location, 1, &value[0]);
 }
 
-void Shader::setVec4(const std::string& name, const glm::vec4 &value) const
+void Shader::setUniform(UniformHandle<glm::mat2> handle, const glm::mat2& value) const
 {
-   glUniform4fv(getUniformLocation(name.c_str()), 1, &value[0]);
+   glUniformMatrix2fv(handle.location, 1, GL_FALSE, &value[0][0]);
 }
 
-void Shader::setVec4(const std::string& name, float x, float y, float z, float w) const
+void Shader::setUniform(UniformHandle<glm::mat3> handle, const glm::mat3& value) const
 {
-   glUniform4f(getUniformLocation(name.c_str()), x, y, z, w);
+   glUniformMatrix3fv(handle.location, 1, GL_FALSE, &value[0][0]);
+}
+
+void Shader::setUniform(UniformHandle<glm::mat4> handle, const glm::mat4& value) const
+{
+   glUniformMatrix4fv(handle.location, 1, GL_FALSE, &value[0][0]);
+}
+
+void Shader::reflectActiveUniforms()
+{
+   if (mShaderProgID == 0)
+   {
+      return;
+   }
+
+   int numOfActiveUniforms = 0;
+   int maxNameLength       = 0;
+   glGetProgramiv(mShaderProgID, GL_ACTIVE_UNIFORMS, &numOfActiveUniforms);
+   glGetProgramiv(mShaderProgID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+   // Arrays of basic types are reported once, so we count their elements before sizing the table
+   std::vector<char> nameBuffer(maxNameLength + 1);
+   unsigned int      numOfEntries = 0;
+   for (int i = 0; i < numOfActiveUniforms; ++i)
+   {
+      int    size   = 0;
+      GLenum type   = 0;
+      glGetActiveUniform(mShaderProgID, i, maxNameLength, nullptr, &size, &type, nameBuffer.data());
+      numOfEntries += (size > 1) ? (size + 1) : 2;
+   }
+
+   // Keep the load factor at or below 50% so that the probe sequences stay short
+   unsigned int tableSize = 16;
+   while (tableSize < numOfEntries * 2)
+   {
+      tableSize *= 2;
+   }
+
+   mUniforms.assign(tableSize, UniformInfo{std::string(), 0, -1, 0});
+
+   for (int i = 0; i < numOfActiveUniforms; ++i)
+   {
+      int    nameLength = 0;
+      int    size       = 0;
+      GLenum type       = 0;
+      glGetActiveUniform(mShaderProgID, i, maxNameLength, &nameLength, &size, &type, nameBuffer.data());
+
+      std::string name(nameBuffer.data(), nameLength);
+      int         location = glGetUniformLocation(mShaderProgID, name.c_str());
+
+      // Uniforms that live in uniform blocks don't have a location
+      if (location == -1)
+      {
+         continue;
+      }
+
+      insertUniform(name, location, type);
+
+      // Arrays of basic types are reported as "name[0]", but they can also be referred to as "name" or "name[i]"
+      std::size_t bracketPos = name.rfind("[0]");
+      if (bracketPos != std::string::npos && bracketPos + 3 == name.size())
+      {
+         std::string baseName = name.substr(0, bracketPos);
+         insertUniform(baseName, location, type);
+
+         for (int element = 1; element < size; ++element)
+         {
+            std::string elementName = baseName + "[" + std::to_string(element) + "]";
+            insertUniform(elementName, glGetUniformLocation(mShaderProgID, elementName.c_str()), type);
+         }
+      }
+   }
 }
 
-void Shader::setMat2(const std::string& name, const glm::mat2& value) const
+void Shader::insertUniform(const std::string& name, int location, GLenum type)
 {
-   glUniformMatrix2fv(getUniformLocation(name.c_str()), 1, GL_FALSE, &value[0][0]);
+   unsigned int hash = hashUniformName(name.c_str());
+   unsigned int mask = static_cast<unsigned int>(mUniforms.size()) - 1;
+
+   for (unsigned int slot = hash & mask; ; slot = (slot + 1) & mask)
+   {
+      UniformInfo& uniform = mUniforms[slot];
+      if (uniform.location == -1)
+      {
+         uniform = UniformInfo{name, hash, location, type};
+         return;
+      }
+      else if (uniform.hash == hash && uniform.name == name)
+      {
+         return;
+      }
+   }
 }
 
-void Shader::setMat3(const std::string& name, const glm::mat3& value) const
+const Shader::UniformInfo* Shader::findUniform(const char* name) const
 {
-   glUniformMatrix3fv(getUniformLocation(name.c_str()), 1, GL_FALSE, &value[0][0]);
+   if (mUniforms.empty())
+   {
+      return nullptr;
+   }
+
+   // This lookup doesn't allocate, since it compares the name against the stored strings directly
+   unsigned int hash = hashUniformName(name);
+   unsigned int mask = static_cast<unsigned int>(mUniforms.size()) - 1;
+
+   for (unsigned int slot = hash & mask; ; slot = (slot + 1) & mask)
+   {
+      const UniformInfo& uniform = mUniforms[slot];
+      if (uniform.location == -1)
+      {
+         return nullptr;
+      }
+      else if (uniform.hash == hash && std::strcmp(uniform.name.c_str(), name) == 0)
+      {
+         return &uniform;
+      }
+   }
 }
 
-void Shader::setMat4(const std::string& name, const glm::mat4& value) const
+int Shader::getUniformLocation(const char* name) const
 {
-   glUniformMatrix4fv(getUniformLocation(name.c_str()), 1, GL_FALSE, &value[0][0]);
+   const UniformInfo* uniform = findUniform(name);
+
+   if (!uniform)
+   {
+      reportMissingUniform(name);
+      return -1;
+   }
+
+   return uniform->location;
 }
 
-int Shader::getUniformLocation(const std::string& name) const
+int Shader::getUniformLocation(const char* name, GLenum type) const
 {
-   int uniformLoc = glGetUniformLocation(mShaderProgID, name.c_str());
+   const UniformInfo* uniform = findUniform(name);
 
-   if (uniformLoc == -1)
+   if (!uniform)
    {
-      std::cout << "Error - Shader::getUniformLocation - The following uniform does not exist: " << name << "\n";
+      reportMissingUniform(name);
+      return -1;
    }
 
-   return uniformLoc;
+   if (!typesAreCompatible(uniform->type, type))
+   {
+      std::cout << "Error - Shader::getUniformLocation - The following uniform was requested with the wrong type: " << name << "\n";
+      return -1;
+   }
+
+   return uniform->location;
+}
+
+void Shader::reportMissingUniform(const char* name) const
+{
+   // Uniforms that are set every frame would flood the console, so we only report each missing uniform once
+   for (const std::string& missingUniform : mMissingUniforms)
+   {
+      if (missingUniform == name)
+      {
+         return;
+      }
+   }
+
+   mMissingUniforms.emplace_back(name);
+
+   std::cout << "Error - Shader::getUniformLocation - The following uniform does not exist: " << name << "\n";
 }
@@ -0,0 +1,70 @@
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+#include "string_id.h"
+
+namespace
+{
+#ifndef NDEBUG
+   // Reverse table from the hashes to the strings that were converted at runtime
+   // Its entries are never erased, so the pointers to their strings stay valid until the program exits
+   struct InternTable
+   {
+      std::mutex                                     mutex;
+      std::unordered_map<std::uint64_t, std::string> strings;
+   };
+
+   InternTable& getInternTable()
+   {
+      static InternTable internTable;
+      return internTable;
+   }
+
+   const char* internString(std::uint64_t hash, const char* str, std::size_t length)
+   {
+      InternTable&                internTable = getInternTable();
+      std::lock_guard<std::mutex> lock(internTable.mutex);
+
+      auto result = internTable.strings.emplace(hash, std::string(str, length));
+      if (!result.second && result.first->second.compare(0, std::string::npos, str, length) != 0)
+      {
+         std::cout << "Error - StringID::StringID - The following strings have the same hash: " << result.first->second << " and " << std::string(str, length) << "\n";
+      }
+
+      return result.first->second.c_str();
+   }
+#endif
+}
+
+StringID::StringID(const char* str)
+   : StringID(str, std::strlen(str))
+{
+#ifndef NDEBUG
+   mDebugString = internString(mHash, str, std::strlen(str));
+#endif
+}
+
+StringID::StringID(const std::string& str)
+   : StringID(str.c_str(), str.size())
+{
+#ifndef NDEBUG
+   mDebugString = internString(mHash, str.c_str(), str.size());
+#endif
+}
+
+std::string StringID::getString() const
+{
+#ifndef NDEBUG
+   if (mDebugString)
+   {
+      return mDebugString;
+   }
+#endif
+
+   char hexHash[17];
+   std::snprintf(hexHash, sizeof(hexHash), "%016llx", static_cast<unsigned long long>(mHash));
+   return hexHash;
+}
@@ -1,31 +1,41 @@
 #include <utility>
 
+#include "gl_state_cache.h"
 #include "texture.h"
 
-Texture::Texture(unsigned int texID)
+Texture::Texture(unsigned int texID, std::size_t gpuMemoryInBytes)
    : mTexID(texID)
+   , mGPUMemoryInBytes(gpuMemoryInBytes)
 {
 
 }
 
 Texture::~Texture()
 {
-   glDeleteTextures(1, &mTexID);
+   GLStateCache::get().deleteTexture(mTexID);
 }
 
 Texture::Texture(Texture&& rhs) noexcept
    : mTexID(std::exchange(rhs.mTexID, 0))
+   , mGPUMemoryInBytes(std::exchange(rhs.mGPUMemoryInBytes, 0))
 {
 
 }
 
 Texture& Texture::operator=(Texture&& rhs) noexcept
 {
-   mTexID = std::exchange(rhs.mTexID, 0);
+   mTexID            = std::exchange(rhs.mTexID, 0);
+   mGPUMemoryInBytes = std::exchange(rhs.mGPUMemoryInBytes, 0);
    return *this;
 }
 
-void Texture::bind() const
+void Texture::bind(unsigned int texUnit) const
 {
-   glBindTexture(GL_TEXTURE_2D, mTexID);
+   GLStateCache::get().bindTexture2D(texUnit, mTexID);
+}
+
+ResourceFootprint Texture::getFootprint() const
+{
+   // The pixels only live in VRAM once the texture has been created
+   return ResourceFootprint{sizeof(Texture), mGPUMemoryInBytes};
 }
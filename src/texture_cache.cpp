@@ -0,0 +1,168 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+#include "texture_cache.h"
+
+TextureCache::TextureCache()
+   : mTextures()
+   , mMutex()
+   , mLoadCosts()
+   , mDecodes()
+   , mStatistics()
+{
+
+}
+
+StringID TextureCache::calculateKey(std::uint64_t     sourceHash,
+                                    TextureColorSpace colorSpace,
+                                    unsigned int      wrapS,
+                                    unsigned int      wrapT,
+                                    unsigned int      minFilter,
+                                    unsigned int      magFilter,
+                                    bool              genMipmap) const
+{
+   // The color space and the sampler parameters are hashed after the contents of the file, since the same image sampled differently is a different texture
+   const unsigned int parameters[] = {static_cast<unsigned int>(colorSpace), wrapS, wrapT, minFilter, magFilter, genMipmap ? 1u : 0u};
+   std::uint64_t      hash         = sourceHash;
+   for (unsigned int parameter : parameters)
+   {
+      hash ^= parameter;
+      hash *= 1099511628211ull;
+   }
+
+   return StringID::fromHash(hash);
+}
+
+std::shared_ptr<Texture> TextureCache::findTexture(StringID key)
+{
+   std::shared_ptr<Texture> texture = mTextures.findResource(key);
+   if (texture)
+   {
+      recordSharedTexture(key, true);
+   }
+
+   return texture;
+}
+
+std::shared_ptr<const DecodedTexture> TextureCache::decodeTexture(StringID                                    key,
+                                                                  const std::function<bool(DecodedTexture&)>& decode,
+                                                                  double&                                     decodeTimeInSec)
+{
+   // The first thread that misses on a key registers its decode, and the threads that miss on the same key after it wait for that decode instead of decoding the image again
+   // The entry stays after the decode so that the threads that miss before the texture is uploaded share it too, until the decoded texture is freed
+   std::promise<DecodeResult>       promise;
+   std::shared_future<DecodeResult> inFlightDecode;
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      auto it = mDecodes.find(key);
+      if (it != mDecodes.end() && (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready || !it->second.get().decodedTexture.expired()))
+      {
+         inFlightDecode = it->second;
+      }
+      else
+      {
+         mDecodes[key] = promise.get_future().share();
+      }
+   }
+
+   if (inFlightDecode.valid())
+   {
+      const DecodeResult&                   decodeResult   = inFlightDecode.get();
+      std::shared_ptr<const DecodedTexture> decodedTexture = decodeResult.decodedTexture.lock();
+      if (decodedTexture)
+      {
+         decodeTimeInSec = decodeResult.decodeTimeInSec;
+
+         std::lock_guard<std::mutex> lock(mMutex);
+         mStatistics.numOfDecodedBytesSaved += static_cast<unsigned long long>(decodedTexture->width) * decodedTexture->height * decodedTexture->numComponents;
+         mStatistics.timeSavedInSec         += decodeResult.decodeTimeInSec;
+         return decodedTexture;
+      }
+
+      // The decode failed, or its texture was freed while we were waiting for it, so we try on our own without registering another decode
+   }
+
+   auto                            start          = std::chrono::steady_clock::now();
+   std::shared_ptr<DecodedTexture> decodedTexture = std::make_shared<DecodedTexture>();
+   if (!decode(*decodedTexture) || !decodedTexture->isValid())
+   {
+      decodedTexture.reset();
+   }
+   decodeTimeInSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   if (!inFlightDecode.valid())
+   {
+      promise.set_value(DecodeResult{decodedTexture, decodeTimeInSec});
+   }
+
+   return decodedTexture;
+}
+
+std::shared_ptr<Texture> TextureCache::loadTexture(StringID              key,
+                                                   const DecodedTexture& decodedTexture,
+                                                   double                decodeTimeInSec,
+                                                   unsigned int          wrapS,
+                                                   unsigned int          wrapT,
+                                                   unsigned int          minFilter,
+                                                   unsigned int          magFilter,
+                                                   bool                  genMipmap)
+{
+   // Another model could have uploaded the same texture since this one was decoded, in which case only the upload is saved
+   std::shared_ptr<Texture> texture = mTextures.findResource(key);
+   if (texture)
+   {
+      recordSharedTexture(key, false);
+      return texture;
+   }
+
+   auto start = std::chrono::steady_clock::now();
+   texture    = mTextures.getOrLoadResource<TextureLoader>(key, decodedTexture, wrapS, wrapT, minFilter, magFilter, genMipmap);
+   double uploadTimeInSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   if (!texture)
+   {
+      return nullptr;
+   }
+
+   // From now on the texture is found before it's decoded, so its decode doesn't need to be shared anymore
+   std::lock_guard<std::mutex> lock(mMutex);
+   mDecodes.erase(key);
+   mLoadCosts[key] = LoadCost{static_cast<unsigned long long>(decodedTexture.width) * decodedTexture.height * decodedTexture.numComponents,
+                              texture->getFootprint().gpuMemoryInBytes,
+                              decodeTimeInSec,
+                              uploadTimeInSec};
+   ++mStatistics.numOfUploadedTextures;
+
+   return texture;
+}
+
+ResourceManager<Texture>& TextureCache::getTextureManager()
+{
+   return mTextures;
+}
+
+TextureCacheStatistics TextureCache::getStatistics() const
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+   return mStatistics;
+}
+
+void TextureCache::recordSharedTexture(StringID key, bool isDecodeSaved)
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+   ++mStatistics.numOfSharedTextures;
+
+   auto it = mLoadCosts.find(key);
+   if (it != mLoadCosts.end())
+   {
+      mStatistics.numOfVRAMBytesSaved += it->second.vramSizeInBytes;
+      mStatistics.timeSavedInSec      += it->second.uploadTimeInSec;
+
+      if (isDecodeSaved)
+      {
+         mStatistics.numOfDecodedBytesSaved += it->second.decodedSizeInBytes;
+         mStatistics.timeSavedInSec         += it->second.decodeTimeInSec;
+      }
+   }
+}
@@ -0,0 +1,851 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "parallel_for.h"
+#include "texture_compression.h"
+
+namespace
+{
+   const int blockDimension      = 4;
+   const int numOfTexelsPerBlock = blockDimension * blockDimension;
+
+   // Positions between the endpoints of a BC1 block that its indices stand for, where 0 is the first endpoint and 1 is the second one
+   const float bc1IndexWeights[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+
+   // Weights out of 64 that BC7 mode 6 interpolates its endpoints with, one for each of its 4-bit indices
+   const int   bc7Weights[16]       = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+   const float bc7IndexWeights[16]  = {0.0f / 64.0f,  4.0f / 64.0f,  9.0f / 64.0f,  13.0f / 64.0f, 17.0f / 64.0f, 21.0f / 64.0f, 26.0f / 64.0f, 30.0f / 64.0f,
+                                       34.0f / 64.0f, 38.0f / 64.0f, 43.0f / 64.0f, 47.0f / 64.0f, 51.0f / 64.0f, 55.0f / 64.0f, 60.0f / 64.0f, 64.0f / 64.0f};
+
+   // The mode of a BC7 block is given by the position of the first set bit, so mode 6 starts with six zeros and a one
+   const unsigned int bc7Mode6Bits = 1 << 6;
+
+   const std::array<float, 256>& getSRGBToLinearTable()
+   {
+      static const std::array<float, 256> srgbToLinearTable = []()
+      {
+         std::array<float, 256> table;
+         for (int i = 0; i < 256; ++i)
+         {
+            float srgb = i / 255.0f;
+            table[i]   = (srgb <= 0.04045f) ? (srgb / 12.92f) : std::pow((srgb + 0.055f) / 1.055f, 2.4f);
+         }
+
+         return table;
+      }();
+
+      return srgbToLinearTable;
+   }
+
+   unsigned char linearToSRGB(float linear)
+   {
+      linear     = std::min(std::max(linear, 0.0f), 1.0f);
+      float srgb = (linear <= 0.0031308f) ? (linear * 12.92f) : (1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f);
+      return static_cast<unsigned char>(srgb * 255.0f + 0.5f);
+   }
+
+   // Copies a block of texels out of a level, and clamps the coordinates of the texels that lie past its edges
+   void loadBlock(const MipLevel& mipLevel, int blockX, int blockY, unsigned char* blockTexels)
+   {
+      for (int y = 0; y < blockDimension; ++y)
+      {
+         int srcY = std::min(blockY * blockDimension + y, mipLevel.height - 1);
+         for (int x = 0; x < blockDimension; ++x)
+         {
+            int srcX = std::min(blockX * blockDimension + x, mipLevel.width - 1);
+            std::memcpy(&blockTexels[(y * blockDimension + x) * 4], &mipLevel.texels[(static_cast<std::size_t>(srcY) * mipLevel.width + srcX) * 4], 4);
+         }
+      }
+   }
+
+   // Copies the texels of a block that lie within the level
+   void storeBlock(const unsigned char* blockTexels, int blockX, int blockY, MipLevel& mipLevel)
+   {
+      for (int y = 0; y < blockDimension && blockY * blockDimension + y < mipLevel.height; ++y)
+      {
+         int dstY = blockY * blockDimension + y;
+         for (int x = 0; x < blockDimension && blockX * blockDimension + x < mipLevel.width; ++x)
+         {
+            int dstX = blockX * blockDimension + x;
+            std::memcpy(&mipLevel.texels[(static_cast<std::size_t>(dstY) * mipLevel.width + dstX) * 4], &blockTexels[(y * blockDimension + x) * 4], 4);
+         }
+      }
+   }
+
+   int calculateSquaredError(const unsigned char* lhs, const unsigned char* rhs, int numOfChannels)
+   {
+      int error = 0;
+      for (int c = 0; c < numOfChannels; ++c)
+      {
+         int difference = static_cast<int>(lhs[c]) - static_cast<int>(rhs[c]);
+         error += difference * difference;
+      }
+
+      return error;
+   }
+
+   // Fits a line to the texels of a block along the principal axis of their distribution, which is found with power iterations on their covariance matrix,
+   // and returns the points of the line where the projections of the texels start and end
+   void fitEndpoints(const unsigned char* texels, int numOfChannels, float endpoints[2][4])
+   {
+      float mean[4] = {};
+      for (int i = 0; i < numOfTexelsPerBlock; ++i)
+      {
+         for (int c = 0; c < numOfChannels; ++c)
+         {
+            mean[c] += texels[i * 4 + c];
+         }
+      }
+
+      for (int c = 0; c < numOfChannels; ++c)
+      {
+         mean[c] /= numOfTexelsPerBlock;
+      }
+
+      float covariance[4][4] = {};
+      for (int i = 0; i < numOfTexelsPerBlock; ++i)
+      {
+         for (int r = 0; r < numOfChannels; ++r)
+         {
+            for (int c = 0; c < numOfChannels; ++c)
+            {
+               covariance[r][c] += (texels[i * 4 + r] - mean[r]) * (texels[i * 4 + c] - mean[c]);
+            }
+         }
+      }
+
+      // The iterations start from the channel that varies the most, which is never orthogonal to the principal axis
+      int maxVarianceChannel = 0;
+      for (int c = 1; c < numOfChannels; ++c)
+      {
+         if (covariance[c][c] > covariance[maxVarianceChannel][maxVarianceChannel])
+         {
+            maxVarianceChannel = c;
+         }
+      }
+
+      float axis[4] = {};
+      for (int c = 0; c < numOfChannels; ++c)
+      {
+         axis[c] = covariance[maxVarianceChannel][c];
+      }
+
+      for (int iteration = 0; iteration < 8; ++iteration)
+      {
+         float nextAxis[4] = {};
+         float maxComponent = 0.0f;
+         for (int r = 0; r < numOfChannels; ++r)
+         {
+            for (int c = 0; c < numOfChannels; ++c)
+            {
+               nextAxis[r] += covariance[r][c] * axis[c];
+            }
+            maxComponent = std::max(maxComponent, std::abs(nextAxis[r]));
+         }
+
+         if (maxComponent == 0.0f)
+         {
+            break;
+         }
+
+         for (int c = 0; c < numOfChannels; ++c)
+         {
+            axis[c] = nextAxis[c] / maxComponent;
+         }
+      }
+
+      float lengthSquared = 0.0f;
+      for (int c = 0; c < numOfChannels; ++c)
+      {
+         lengthSquared += axis[c] * axis[c];
+      }
+
+      // A block of a single color has no axis, so both endpoints are that color
+      float minProjection = 0.0f;
+      float maxProjection = 0.0f;
+      if (lengthSquared > 1e-12f)
+      {
+         float invLength = 1.0f / std::sqrt(lengthSquared);
+         for (int c = 0; c < numOfChannels; ++c)
+         {
+            axis[c] *= invLength;
+         }
+
+         minProjection = maxProjection = 0.0f;
+         for (int i = 0; i < numOfTexelsPerBlock; ++i)
+         {
+            float projection = 0.0f;
+            for (int c = 0; c < numOfChannels; ++c)
+            {
+               projection += (texels[i * 4 + c] - mean[c]) * axis[c];
+            }
+
+            minProjection = std::min(minProjection, projection);
+            maxProjection = std::max(maxProjection, projection);
+         }
+      }
+
+      for (int c = 0; c < numOfChannels; ++c)
+      {
+         endpoints[0][c] = std::min(std::max(mean[c] + minProjection * axis[c], 0.0f), 255.0f);
+         endpoints[1][c] = std::min(std::max(mean[c] + maxProjection * axis[c], 0.0f), 255.0f);
+      }
+   }
+
+   // Solves for the endpoints that minimize the squared error of the texels for the given indices, where each index stands for a position between the endpoints
+   // Returns false if all the texels have the same index, in which case the endpoints can't be solved for
+   bool refineEndpoints(const unsigned char* texels, int numOfChannels, const unsigned int* indices, const float* indexWeights, float endpoints[2][4])
+   {
+      float a00 = 0.0f;
+      float a01 = 0.0f;
+      float a11 = 0.0f;
+      float b0[4] = {};
+      float b1[4] = {};
+      for (int i = 0; i < numOfTexelsPerBlock; ++i)
+      {
+         float t = indexWeights[indices[i]];
+         float s = 1.0f - t;
+         a00 += s * s;
+         a01 += s * t;
+         a11 += t * t;
+
+         for (int c = 0; c < numOfChannels; ++c)
+         {
+            b0[c] += s * texels[i * 4 + c];
+            b1[c] += t * texels[i * 4 + c];
+         }
+      }
+
+      float determinant = a00 * a11 - a01 * a01;
+      if (std::abs(determinant) < 1e-6f)
+      {
+         return false;
+      }
+
+      for (int c = 0; c < numOfChannels; ++c)
+      {
+         endpoints[0][c] = std::min(std::max((a11 * b0[c] - a01 * b1[c]) / determinant, 0.0f), 255.0f);
+         endpoints[1][c] = std::min(std::max((a00 * b1[c] - a01 * b0[c]) / determinant, 0.0f), 255.0f);
+      }
+
+      return true;
+   }
+
+   std::uint16_t packRGB565(const float* color)
+   {
+      unsigned int r = static_cast<unsigned int>(color[0] * (31.0f / 255.0f) + 0.5f);
+      unsigned int g = static_cast<unsigned int>(color[1] * (63.0f / 255.0f) + 0.5f);
+      unsigned int b = static_cast<unsigned int>(color[2] * (31.0f / 255.0f) + 0.5f);
+      return static_cast<std::uint16_t>((r << 11) | (g << 5) | b);
+   }
+
+   void unpackRGB565(std::uint16_t packedColor, unsigned char* color)
+   {
+      unsigned int r = (packedColor >> 11) & 0x1F;
+      unsigned int g = (packedColor >> 5) & 0x3F;
+      unsigned int b = packedColor & 0x1F;
+      color[0] = static_cast<unsigned char>((r << 3) | (r >> 2));
+      color[1] = static_cast<unsigned char>((g << 2) | (g >> 4));
+      color[2] = static_cast<unsigned char>((b << 3) | (b >> 2));
+      color[3] = 255;
+   }
+
+   // In four-color mode, the third and fourth colors lie at a third and two thirds of the way from the first color to the second one
+   // In three-color mode, which BC1 uses when the first color isn't greater than the second one, the third color lies halfway and the fourth one is transparent black
+   void calculateColorPalette(std::uint16_t color0, std::uint16_t color1, bool isFourColorMode, unsigned char palette[4][4])
+   {
+      unpackRGB565(color0, palette[0]);
+      unpackRGB565(color1, palette[1]);
+
+      for (int c = 0; c < 3; ++c)
+      {
+         if (isFourColorMode)
+         {
+            palette[2][c] = static_cast<unsigned char>((2 * palette[0][c] + palette[1][c]) / 3);
+            palette[3][c] = static_cast<unsigned char>((palette[0][c] + 2 * palette[1][c]) / 3);
+         }
+         else
+         {
+            palette[2][c] = static_cast<unsigned char>((palette[0][c] + palette[1][c]) / 2);
+            palette[3][c] = 0;
+         }
+      }
+
+      palette[2][3] = 255;
+      palette[3][3] = isFourColorMode ? 255 : 0;
+   }
+
+   int findColorIndices(const unsigned char* texels, std::uint16_t color0, std::uint16_t color1, unsigned int* indices)
+   {
+      unsigned char palette[4][4];
+      calculateColorPalette(color0, color1, true, palette);
+
+      int error = 0;
+      for (int i = 0; i < numOfTexelsPerBlock; ++i)
+      {
+         int minError = calculateSquaredError(&texels[i * 4], palette[0], 3);
+         indices[i]   = 0;
+         for (unsigned int j = 1; j < 4; ++j)
+         {
+            int paletteError = calculateSquaredError(&texels[i * 4], palette[j], 3);
+            if (paletteError < minError)
+            {
+               minError   = paletteError;
+               indices[i] = j;
+            }
+         }
+
+         error += minError;
+      }
+
+      return error;
+   }
+
+   // Encodes the colors of a block in four-color mode, which is the only mode of the color blocks of BC3, and which BC1 also uses for opaque textures
+   void encodeColorBlock(const unsigned char* texels, unsigned char* block)
+   {
+      float endpoints[2][4];
+      fitEndpoints(texels, 3, endpoints);
+
+      std::uint16_t color0 = packRGB565(endpoints[0]);
+      std::uint16_t color1 = packRGB565(endpoints[1]);
+      unsigned int  indices[numOfTexelsPerBlock];
+      int           error = findColorIndices(texels, color0, color1, indices);
+
+      // The endpoints of the principal axis are only a guess, so they are refined for the indices that were picked for as long as that reduces the error
+      for (int iteration = 0; iteration < 2; ++iteration)
+      {
+         unsigned int refinedIndices[numOfTexelsPerBlock];
+         if (!refineEndpoints(texels, 3, indices, bc1IndexWeights, endpoints))
+         {
+            break;
+         }
+
+         std::uint16_t refinedColor0 = packRGB565(endpoints[0]);
+         std::uint16_t refinedColor1 = packRGB565(endpoints[1]);
+         int           refinedError  = findColorIndices(texels, refinedColor0, refinedColor1, refinedIndices);
+         if (refinedError >= error)
+         {
+            break;
+         }
+
+         color0 = refinedColor0;
+         color1 = refinedColor1;
+         error  = refinedError;
+         std::copy(refinedIndices, refinedIndices + numOfTexelsPerBlock, indices);
+      }
+
+      // Four-color mode requires the first color to be greater than the second one, so they are swapped if needed, which swaps the first two and the last two indices
+      // If both colors are the same, the block is in three-color mode, where the first index still stands for the first color
+      if (color0 < color1)
+      {
+         std::swap(color0, color1);
+         for (unsigned int& index : indices)
+         {
+            index ^= 1;
+         }
+      }
+      else if (color0 == color1)
+      {
+         std::fill(indices, indices + numOfTexelsPerBlock, 0);
+      }
+
+      std::uint32_t packedIndices = 0;
+      for (int i = 0; i < numOfTexelsPerBlock; ++i)
+      {
+         packedIndices |= indices[i] << (2 * i);
+      }
+
+      block[0] = static_cast<unsigned char>(color0 & 0xFF);
+      block[1] = static_cast<unsigned char>(color0 >> 8);
+      block[2] = static_cast<unsigned char>(color1 & 0xFF);
+      block[3] = static_cast<unsigned char>(color1 >> 8);
+      for (int i = 0; i < 4; ++i)
+      {
+         block[4 + i] = static_cast<unsigned char>(packedIndices >> (8 * i));
+      }
+   }
+
+   void decodeColorBlock(const unsigned char* block, bool isBC1, unsigned char* texels)
+   {
+      std::uint16_t color0 = static_cast<std::uint16_t>(block[0] | (block[1] << 8));
+      std::uint16_t color1 = static_cast<std::uint16_t>(block[2] | (block[3] << 8));
+
+      unsigned char palette[4][4];
+      calculateColorPalette(color0, color1, !isBC1 || color0 > color1, palette);
+
+      std::uint32_t packedIndices = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<std::uint32_t>(block[7]) << 24);
+      for (int i = 0; i < numOfTexelsPerBlock; ++i)
+      {
+         std::memcpy(&texels[i * 4], palette[(packedIndices >> (2 * i)) & 3], 4);
+      }
+   }
+
+   // If the first alpha is greater than the second one, the other six alphas are interpolated between them
+   // Otherwise, only four alphas are interpolated, and the last two are 0 and 255
+   void calculateAlphaPalette(unsigned char alpha0, unsigned char alpha1, unsigned char palette[8])
+   {
+      palette[0] = alpha0;
+      palette[1] = alpha1;
+
+      if (alpha0 > alpha1)
+      {
+         for (int i = 2; i < 8; ++i)
+         {
+            palette[i] = static_cast<unsigned char>(((8 - i) * alpha0 + (i - 1) * alpha1) / 7);
+         }
+      }
+      else
+      {
+         for (int i = 2; i < 6; ++i)
+         {
+            palette[i] = static_cast<unsigned char>(((6 - i) * alpha0 + (i - 1) * alpha1) / 5);
+         }
+         palette[6] = 0;
+         palette[7] = 255;
+      }
+   }
+
+   void encodeAlphaBlock(const unsigned char* texels, unsigned char* block)
+   {
+      unsigned char minAlpha = 255;
+      unsigned char maxAlpha = 0;
+      for (int i = 0; i < numOfTexelsPerBlock; ++i)
+      {
+         minAlpha = std::min(minAlpha, texels[i * 4 + 3]);
+         maxAlpha = std::max(maxAlpha, texels[i * 4 + 3]);
+      }
+
+      unsigned char palette[8];
+      calculateAlphaPalette(maxAlpha, minAlpha, palette);
+
+      std::uint64_t packedIndices = 0;
+      for (int i = 0; i < numOfTexelsPerBlock && minAlpha != maxAlpha; ++i)
+      {
+         std::uint64_t index    = 0;
+         int           minError = std::abs(texels[i * 4 + 3] - palette[0]);
+         for (std::uint64_t j = 1; j < 8; ++j)
+         {
+            int paletteError = std::abs(texels[i * 4 + 3] - palette[j]);
+            if (paletteError < minError)
+            {
+               minError = paletteError;
+               index    = j;
+            }
+         }
+
+         packedIndices |= index << (3 * i);
+      }
+
+      block[0] = maxAlpha;
+      block[1] = minAlpha;
+      for (int i = 0; i < 6; ++i)
+      {
+         block[2 + i] = static_cast<unsigned char>(packedIndices >> (8 * i));
+      }
+   }
+
+   void decodeAlphaBlock(const unsigned char* block, unsigned char* texels)
+   {
+      unsigned char palette[8];
+      calculateAlphaPalette(block[0], block[1], palette);
+
+      std::uint64_t packedIndices = 0;
+      for (int i = 0; i < 6; ++i)
+      {
+         packedIndices |= static_cast<std::uint64_t>(block[2 + i]) << (8 * i);
+      }
+
+      for (int i = 0; i < numOfTexelsPerBlock; ++i)
+      {
+         texels[i * 4 + 3] = palette[(packedIndices >> (3 * i)) & 7];
+      }
+   }
+
+   // BC7 blocks are read and written as a stream of bits that starts at the least significant bit of their first byte
+   void writeBits(unsigned char* block, unsigned int& bitOffset, unsigned int value, unsigned int numOfBits)
+   {
+      for (unsigned int i = 0; i < numOfBits; ++i, ++bitOffset)
+      {
+         if ((value >> i) & 1)
+         {
+            block[bitOffset >> 3] |= static_cast<unsigned char>(1 << (bitOffset & 7));
+         }
+      }
+   }
+
+   unsigned int readBits(const unsigned char* block, unsigned int& bitOffset, unsigned int numOfBits)
+   {
+      unsigned int value = 0;
+      for (unsigned int i = 0; i < numOfBits; ++i, ++bitOffset)
+      {
+         value |= ((block[bitOffset >> 3] >> (bitOffset & 7)) & 1) << i;
+      }
+
+      return value;
+   }
+
+   // The endpoints of mode 6 have 7 bits per channel and a shared lowest bit (the P-bit), which is picked to minimize the quantization error
+   void quantizeBC7Endpoint(const float* endpoint, unsigned int* quantizedEndpoint, unsigned int& pBit)
+   {
+      float minError = 0.0f;
+      for (unsigned int p = 0; p < 2; ++p)
+      {
+         unsigned int candidate[4];
+         float        error = 0.0f;
+         for (int c = 0; c < 4; ++c)
+         {
+            float value  = std::floor((endpoint[c] - p) * 0.5f + 0.5f);
+            candidate[c] = static_cast<unsigned int>(std::min(std::max(value, 0.0f), 127.0f));
+
+            float difference = static_cast<float>((candidate[c] << 1) | p) - endpoint[c];
+            error += difference * difference;
+         }
+
+         if (p == 0 || error < minError)
+         {
+            minError = error;
+            pBit     = p;
+            std::copy(candidate, candidate + 4, quantizedEndpoint);
+         }
+      }
+   }
+
+   void calculateBC7Palette(const unsigned int quantizedEndpoints[2][4], const unsigned int pBits[2], unsigned char palette[16][4])
+   {
+      unsigned int endpoints[2][4];
+      for (int e = 0; e < 2; ++e)
+      {
+         for (int c = 0; c < 4; ++c)
+         {
+            endpoints[e][c] = (quantizedEndpoints[e][c] << 1) | pBits[e];
+         }
+      }
+
+      for (int i = 0; i < 16; ++i)
+      {
+         for (int c = 0; c < 4; ++c)
+         {
+            palette[i][c] = static_cast<unsigned char>(((64 - bc7Weights[i]) * endpoints[0][c] + bc7Weights[i] * endpoints[1][c] + 32) >> 6);
+         }
+      }
+   }
+
+   int findBC7Indices(const unsigned char* texels, const unsigned int quantizedEndpoints[2][4], const unsigned int pBits[2], unsigned int* indices)
+   {
+      unsigned char palette[16][4];
+      calculateBC7Palette(quantizedEndpoints, pBits, palette);
+
+      int error = 0;
+      for (int i = 0; i < numOfTexelsPerBlock; ++i)
+      {
+         int minError = calculateSquaredError(&texels[i * 4], palette[0], 4);
+         indices[i]   = 0;
+         for (unsigned int j = 1; j < 16; ++j)
+         {
+            int paletteError = calculateSquaredError(&texels[i * 4], palette[j], 4);
+            if (paletteError < minError)
+            {
+               minError   = paletteError;
+               indices[i] = j;
+            }
+         }
+
+         error += minError;
+      }
+
+      return error;
+   }
+
+   // Mode 6 has a single pair of RGBA endpoints and 4-bit indices, which is what most BC7 encoders use for blocks that are not split into subsets
+   void encodeBC7Block(const unsigned char* texels, unsigned char* block)
+   {
+      float endpoints[2][4];
+      fitEndpoints(texels, 4, endpoints);
+
+      unsigned int quantizedEndpoints[2][4];
+      unsigned int pBits[2];
+      quantizeBC7Endpoint(endpoints[0], quantizedEndpoints[0], pBits[0]);
+      quantizeBC7Endpoint(endpoints[1], quantizedEndpoints[1], pBits[1]);
+
+      unsigned int indices[numOfTexelsPerBlock];
+      int          error = findBC7Indices(texels, quantizedEndpoints, pBits, indices);
+
+      for (int iteration = 0; iteration < 2; ++iteration)
+      {
+         if (!refineEndpoints(texels, 4, indices, bc7IndexWeights, endpoints))
+         {
+            break;
+         }
+
+         unsigned int refinedEndpoints[2][4];
+         unsigned int refinedPBits[2];
+         unsigned int refinedIndices[numOfTexelsPerBlock];
+         quantizeBC7Endpoint(endpoints[0], refinedEndpoints[0], refinedPBits[0]);
+         quantizeBC7Endpoint(endpoints[1], refinedEndpoints[1], refinedPBits[1]);
+
+         int refinedError = findBC7Indices(texels, refinedEndpoints, refinedPBits, refinedIndices);
+         if (refinedError >= error)
+         {
+            break;
+         }
+
+         std::memcpy(quantizedEndpoints, refinedEndpoints, sizeof(quantizedEndpoints));
+         std::memcpy(pBits, refinedPBits, sizeof(pBits));
+         std::copy(refinedIndices, refinedIndices + numOfTexelsPerBlock, indices);
+         error = refinedError;
+      }
+
+      // The highest bit of the index of the first texel is implied to be 0, so the endpoints are swapped if it's set, which mirrors the indices
+      if (indices[0] >= 8)
+      {
+         for (int c = 0; c < 4; ++c)
+         {
+            std::swap(quantizedEndpoints[0][c], quantizedEndpoints[1][c]);
+         }
+         std::swap(pBits[0], pBits[1]);
+
+         for (unsigned int& index : indices)
+         {
+            index = 15 - index;
+         }
+      }
+
+      std::memset(block, 0, 16);
+      unsigned int bitOffset = 0;
+      writeBits(block, bitOffset, bc7Mode6Bits, 7);
+      for (int c = 0; c < 4; ++c)
+      {
+         writeBits(block, bitOffset, quantizedEndpoints[0][c], 7);
+         writeBits(block, bitOffset, quantizedEndpoints[1][c], 7);
+      }
+      writeBits(block, bitOffset, pBits[0], 1);
+      writeBits(block, bitOffset, pBits[1], 1);
+
+      writeBits(block, bitOffset, indices[0], 3);
+      for (int i = 1; i < numOfTexelsPerBlock; ++i)
+      {
+         writeBits(block, bitOffset, indices[i], 4);
+      }
+   }
+
+   bool decodeBC7Block(const unsigned char* block, unsigned char* texels)
+   {
+      unsigned int bitOffset = 0;
+      if (readBits(block, bitOffset, 7) != bc7Mode6Bits)
+      {
+         return false;
+      }
+
+      unsigned int quantizedEndpoints[2][4];
+      unsigned int pBits[2];
+      for (int c = 0; c < 4; ++c)
+      {
+         quantizedEndpoints[0][c] = readBits(block, bitOffset, 7);
+         quantizedEndpoints[1][c] = readBits(block, bitOffset, 7);
+      }
+      pBits[0] = readBits(block, bitOffset, 1);
+      pBits[1] = readBits(block, bitOffset, 1);
+
+      unsigned char palette[16][4];
+      calculateBC7Palette(quantizedEndpoints, pBits, palette);
+
+      for (int i = 0; i < numOfTexelsPerBlock; ++i)
+      {
+         unsigned int index = readBits(block, bitOffset, (i == 0) ? 3 : 4);
+         std::memcpy(&texels[i * 4], palette[index], 4);
+      }
+
+      return true;
+   }
+
+   void compressBlock(CompressedTextureFormat format, const unsigned char* texels, unsigned char* block)
+   {
+      switch (format)
+      {
+      case CompressedTextureFormat::bc1:
+         encodeColorBlock(texels, block);
+         break;
+      case CompressedTextureFormat::bc3:
+         encodeAlphaBlock(texels, block);
+         encodeColorBlock(texels, block + 8);
+         break;
+      case CompressedTextureFormat::bc7:
+         encodeBC7Block(texels, block);
+         break;
+      default:
+         break;
+      }
+   }
+
+   bool decompressBlock(CompressedTextureFormat format, const unsigned char* block, unsigned char* texels)
+   {
+      switch (format)
+      {
+      case CompressedTextureFormat::bc1:
+         decodeColorBlock(block, true, texels);
+         return true;
+      case CompressedTextureFormat::bc3:
+         decodeColorBlock(block + 8, false, texels);
+         decodeAlphaBlock(block, texels);
+         return true;
+      case CompressedTextureFormat::bc7:
+         return decodeBC7Block(block, texels);
+      default:
+         return false;
+      }
+   }
+}
+
+CompressedMipLevelView CompressedMipLevel::getView() const
+{
+   return CompressedMipLevelView{blocks.data(), blocks.size(), width, height};
+}
+
+unsigned int getBlockSizeInBytes(CompressedTextureFormat format)
+{
+   return (format == CompressedTextureFormat::bc1) ? 8 : 16;
+}
+
+std::size_t calculateCompressedSizeInBytes(CompressedTextureFormat format, int width, int height)
+{
+   std::size_t numOfBlocksX = static_cast<std::size_t>(width + blockDimension - 1) / blockDimension;
+   std::size_t numOfBlocksY = static_cast<std::size_t>(height + blockDimension - 1) / blockDimension;
+   return numOfBlocksX * numOfBlocksY * getBlockSizeInBytes(format);
+}
+
+CompressedTextureFormat chooseCompressedTextureFormat(int numComponents)
+{
+   // Images with 2 components are grey with alpha
+   return (numComponents == 2 || numComponents == 4) ? CompressedTextureFormat::bc3 : CompressedTextureFormat::bc1;
+}
+
+std::vector<MipLevel> generateMipChain(const unsigned char* texels, int width, int height, int numComponents, TextureColorSpace colorSpace, unsigned int numOfThreads)
+{
+   std::vector<MipLevel> mipChain;
+
+   // Expand the texels to RGBA, where the grey images are copied to all the color channels
+   MipLevel baseLevel{width, height, std::vector<unsigned char>(static_cast<std::size_t>(width) * height * 4)};
+   for (std::size_t i = 0; i < static_cast<std::size_t>(width) * height; ++i)
+   {
+      const unsigned char* srcTexel = &texels[i * numComponents];
+      unsigned char*       dstTexel = &baseLevel.texels[i * 4];
+      bool                 isGrey   = (numComponents < 3);
+
+      dstTexel[0] = srcTexel[0];
+      dstTexel[1] = isGrey ? srcTexel[0] : srcTexel[1];
+      dstTexel[2] = isGrey ? srcTexel[0] : srcTexel[2];
+      dstTexel[3] = (numComponents == 2 || numComponents == 4) ? srcTexel[numComponents - 1] : 255;
+   }
+   mipChain.push_back(std::move(baseLevel));
+
+   // Each level is a 2x2 box filter of the previous one, and the last column and row of an odd level are reused by the texels that would fall past its edges
+   const std::array<float, 256>& srgbToLinear = getSRGBToLinearTable();
+   bool                          isSRGB       = (colorSpace == TextureColorSpace::srgb);
+   while (mipChain.back().width > 1 || mipChain.back().height > 1)
+   {
+      const MipLevel& srcLevel = mipChain.back();
+      MipLevel        dstLevel{std::max(srcLevel.width / 2, 1), std::max(srcLevel.height / 2, 1), std::vector<unsigned char>()};
+      dstLevel.texels.resize(static_cast<std::size_t>(dstLevel.width) * dstLevel.height * 4);
+
+      parallelFor(static_cast<unsigned int>(dstLevel.height), numOfThreads, [&srcLevel, &dstLevel, &srgbToLinear, isSRGB](unsigned int y)
+      {
+         int srcY0 = std::min(static_cast<int>(y) * 2,     srcLevel.height - 1);
+         int srcY1 = std::min(static_cast<int>(y) * 2 + 1, srcLevel.height - 1);
+
+         for (int x = 0; x < dstLevel.width; ++x)
+         {
+            int srcX0 = std::min(x * 2,     srcLevel.width - 1);
+            int srcX1 = std::min(x * 2 + 1, srcLevel.width - 1);
+
+            const unsigned char* srcTexels[4] = {&srcLevel.texels[(static_cast<std::size_t>(srcY0) * srcLevel.width + srcX0) * 4],
+                                                 &srcLevel.texels[(static_cast<std::size_t>(srcY0) * srcLevel.width + srcX1) * 4],
+                                                 &srcLevel.texels[(static_cast<std::size_t>(srcY1) * srcLevel.width + srcX0) * 4],
+                                                 &srcLevel.texels[(static_cast<std::size_t>(srcY1) * srcLevel.width + srcX1) * 4]};
+            unsigned char* dstTexel = &dstLevel.texels[(static_cast<std::size_t>(y) * dstLevel.width + x) * 4];
+
+            for (int c = 0; c < 3; ++c)
+            {
+               if (isSRGB)
+               {
+                  float linear = 0.0f;
+                  for (const unsigned char* srcTexel : srcTexels)
+                  {
+                     linear += srgbToLinear[srcTexel[c]];
+                  }
+                  dstTexel[c] = linearToSRGB(linear * 0.25f);
+               }
+               else
+               {
+                  int sum = srcTexels[0][c] + srcTexels[1][c] + srcTexels[2][c] + srcTexels[3][c];
+                  dstTexel[c] = static_cast<unsigned char>((sum + 2) / 4);
+               }
+            }
+
+            int alpha = srcTexels[0][3] + srcTexels[1][3] + srcTexels[2][3] + srcTexels[3][3];
+            dstTexel[3] = static_cast<unsigned char>((alpha + 2) / 4);
+         }
+      });
+
+      mipChain.push_back(std::move(dstLevel));
+   }
+
+   return mipChain;
+}
+
+CompressedMipLevel compressMipLevel(CompressedTextureFormat format, const MipLevel& mipLevel, unsigned int numOfThreads)
+{
+   int          numOfBlocksX     = (mipLevel.width  + blockDimension - 1) / blockDimension;
+   int          numOfBlocksY     = (mipLevel.height + blockDimension - 1) / blockDimension;
+   unsigned int blockSizeInBytes = getBlockSizeInBytes(format);
+
+   CompressedMipLevel compressedMipLevel{mipLevel.width, mipLevel.height, std::vector<unsigned char>(calculateCompressedSizeInBytes(format, mipLevel.width, mipLevel.height))};
+
+   parallelFor(static_cast<unsigned int>(numOfBlocksY), numOfThreads, [&](unsigned int blockY)
+   {
+      unsigned char blockTexels[numOfTexelsPerBlock * 4];
+      for (int blockX = 0; blockX < numOfBlocksX; ++blockX)
+      {
+         loadBlock(mipLevel, blockX, static_cast<int>(blockY), blockTexels);
+         compressBlock(format, blockTexels, &compressedMipLevel.blocks[(static_cast<std::size_t>(blockY) * numOfBlocksX + blockX) * blockSizeInBytes]);
+      }
+   });
+
+   return compressedMipLevel;
+}
+
+bool decompressMipLevel(CompressedTextureFormat format, const CompressedMipLevelView& compressedMipLevel, MipLevel& mipLevel)
+{
+   if (compressedMipLevel.sizeInBytes < calculateCompressedSizeInBytes(format, compressedMipLevel.width, compressedMipLevel.height))
+   {
+      return false;
+   }
+
+   int          numOfBlocksX     = (compressedMipLevel.width  + blockDimension - 1) / blockDimension;
+   int          numOfBlocksY     = (compressedMipLevel.height + blockDimension - 1) / blockDimension;
+   unsigned int blockSizeInBytes = getBlockSizeInBytes(format);
+
+   mipLevel.width  = compressedMipLevel.width;
+   mipLevel.height = compressedMipLevel.height;
+   mipLevel.texels.assign(static_cast<std::size_t>(mipLevel.width) * mipLevel.height * 4, 0);
+
+   unsigned char blockTexels[numOfTexelsPerBlock * 4];
+   for (int blockY = 0; blockY < numOfBlocksY; ++blockY)
+   {
+      for (int blockX = 0; blockX < numOfBlocksX; ++blockX)
+      {
+         const unsigned char* block = &compressedMipLevel.blocks[(static_cast<std::size_t>(blockY) * numOfBlocksX + blockX) * blockSizeInBytes];
+         if (!decompressBlock(format, block, blockTexels))
+         {
+            return false;
+         }
+
+         storeBlock(blockTexels, blockX, blockY, mipLevel);
+      }
+   }
+
+   return true;
+}
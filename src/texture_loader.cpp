@@ -1,8 +1,78 @@
 #include <stb_image/stb_image.h>
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <iostream>
 
+#include "baked_model.h"
+#include "gl_state_cache.h"
 #include "texture_loader.h"
+#include "thread_pool.h"
+
+namespace
+{
+   const char* const bakedTextureFileExtension       = ".bakedtexture";
+   const char* const linearBakedTextureFileExtension = ".linear.bakedtexture";
+
+   // The compressed formats are extensions in OpenGL 3.3, so glad doesn't define their enums
+   // The textures are sampled as UNORM like the uncompressed ones, since the shaders expect the colors to be sRGB-encoded
+   const GLenum compressedRGBS3TCDXT1  = 0x83F0; // GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+   const GLenum compressedRGBAS3TCDXT5 = 0x83F3; // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+   const GLenum compressedRGBABPTC     = 0x8E8C; // GL_COMPRESSED_RGBA_BPTC_UNORM_ARB
+
+   GLenum getInternalFormat(CompressedTextureFormat format)
+   {
+      switch (format)
+      {
+      case CompressedTextureFormat::bc1:
+         return compressedRGBS3TCDXT1;
+      case CompressedTextureFormat::bc3:
+         return compressedRGBAS3TCDXT5;
+      default:
+         return compressedRGBABPTC;
+      }
+   }
+
+   // The extensions are queried the first time a compressed texture is uploaded, which happens on the context thread
+   bool isCompressedFormatSupported(CompressedTextureFormat format)
+   {
+      static const std::array<bool, static_cast<unsigned int>(CompressedTextureFormat::count)> supportedFormats = []()
+      {
+         std::array<bool, static_cast<unsigned int>(CompressedTextureFormat::count)> isSupported = {};
+
+         GLint numOfExtensions = 0;
+         glGetIntegerv(GL_NUM_EXTENSIONS, &numOfExtensions);
+         for (GLint i = 0; i < numOfExtensions; ++i)
+         {
+            const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (std::strcmp(extension, "GL_EXT_texture_compression_s3tc") == 0)
+            {
+               isSupported[static_cast<unsigned int>(CompressedTextureFormat::bc1)] = true;
+               isSupported[static_cast<unsigned int>(CompressedTextureFormat::bc3)] = true;
+            }
+            else if (std::strcmp(extension, "GL_ARB_texture_compression_bptc") == 0)
+            {
+               isSupported[static_cast<unsigned int>(CompressedTextureFormat::bc7)] = true;
+            }
+         }
+
+         return isSupported;
+      }();
+
+      return supportedFormats[static_cast<unsigned int>(format)];
+   }
+}
+
+void DecodedTexture::stbiImageFree(void* data)
+{
+   stbi_image_free(data);
+}
+
+bool DecodedTexture::isValid() const
+{
+   return data || bakedTexture.isOpen();
+}
 
 std::shared_ptr<Texture> TextureLoader::loadResource(const std::string& texFilePath,
                                                      unsigned int       wrapS,
@@ -11,32 +81,145 @@ std::shared_ptr<Texture> TextureLoader::loadResource(const std::string& texFileP
                                                      unsigned int       magFilter,
                                                      bool               genMipmap) const
 {
-   int width, height, numComponents;
-   std::unique_ptr<unsigned char, void(*)(void*)> texData(stbi_load(texFilePath.c_str(), &width, &height, &numComponents, 0), stbi_image_free);
+   // Textures that are loaded by path are assumed to hold colors
+   DecodedTexture decodedTexture;
+   if (!decodeTexture(texFilePath, TextureColorSpace::srgb, decodedTexture))
+   {
+      return nullptr;
+   }
 
-   if (!texData)
+   return loadResource(decodedTexture, wrapS, wrapT, minFilter, magFilter, genMipmap);
+}
+
+std::shared_ptr<Texture> TextureLoader::loadResource(const DecodedTexture& decodedTexture,
+                                                     unsigned int          wrapS,
+                                                     unsigned int          wrapT,
+                                                     unsigned int          minFilter,
+                                                     unsigned int          magFilter,
+                                                     bool                  genMipmap) const
+{
+   if (decodedTexture.bakedTexture.isOpen())
+   {
+      std::size_t  gpuMemoryInBytes = 0;
+      unsigned int texID            = generateCompressedTexture(decodedTexture.bakedTexture, wrapS, wrapT, minFilter, magFilter, genMipmap, gpuMemoryInBytes);
+      return std::make_shared<Texture>(texID, gpuMemoryInBytes);
+   }
+
+   unsigned int texID = generateTexture(decodedTexture, wrapS, wrapT, minFilter, magFilter, genMipmap);
+
+   // Drivers usually pad RGB textures to RGBA, so we assume 4 bytes per texel, and the mipmaps add a third of the size of the base level
+   std::size_t gpuMemoryInBytes = static_cast<std::size_t>(decodedTexture.width) * decodedTexture.height * 4;
+   if (genMipmap)
+   {
+      gpuMemoryInBytes += gpuMemoryInBytes / 3;
+   }
+
+   return std::make_shared<Texture>(texID, gpuMemoryInBytes);
+}
+
+std::function<std::shared_ptr<Texture>()> TextureLoader::prepareResource(const std::string& texFilePath,
+                                                                         unsigned int       wrapS,
+                                                                         unsigned int       wrapT,
+                                                                         unsigned int       minFilter,
+                                                                         unsigned int       magFilter,
+                                                                         bool               genMipmap) const
+{
+   // When the texture is loaded asynchronously, the other workers of the thread pool are loading other resources, so it's baked on this worker alone
+   unsigned int numOfThreads = ThreadPool::isWorkerThread() ? 1 : 0;
+
+   // std::function needs a copyable function, so the decoded texture, which can only be moved, is shared
+   // Textures that are loaded by path are assumed to hold colors
+   auto decodedTexture = std::make_shared<DecodedTexture>();
+   if (!decodeTexture(texFilePath, TextureColorSpace::srgb, *decodedTexture, numOfThreads))
    {
-      std::cout << "Error - TextureLoader::loadResource - The following texture could not be loaded: " << texFilePath << "\n";
       return nullptr;
    }
 
-   unsigned int texID = generateTexture(texData, width, height, numComponents, wrapS, wrapT, minFilter, magFilter, genMipmap);
+   return [decodedTexture, wrapS, wrapT, minFilter, magFilter, genMipmap]()
+   {
+      return TextureLoader().loadResource(*decodedTexture, wrapS, wrapT, minFilter, magFilter, genMipmap);
+   };
+}
+
+bool TextureLoader::decodeTexture(const std::string& texFilePath,
+                                  std::uint64_t      sourceHash,
+                                  TextureColorSpace  colorSpace,
+                                  DecodedTexture&    decodedTexture,
+                                  unsigned int       numOfThreads) const
+{
+   BakedTextureKey bakedTextureKey{sourceHash, colorSpace};
+   std::string     bakedTextureFilePath = getBakedTextureFilePath(texFilePath, colorSpace);
 
-   return std::make_shared<Texture>(texID);
+   if (decodedTexture.bakedTexture.open(bakedTextureFilePath, bakedTextureKey))
+   {
+      decodedTexture.width         = decodedTexture.bakedTexture.getWidth();
+      decodedTexture.height        = decodedTexture.bakedTexture.getHeight();
+      decodedTexture.numComponents = decodedTexture.bakedTexture.getNumOfSourceComponents();
+      return true;
+   }
+
+   decodedTexture.data.reset(stbi_load(texFilePath.c_str(), &decodedTexture.width, &decodedTexture.height, &decodedTexture.numComponents, 0));
+
+   if (!decodedTexture.data)
+   {
+      std::cout << "Error - TextureLoader::decodeTexture - The following texture could not be loaded: " << texFilePath << "\n";
+      return false;
+   }
+
+   // A texture that can't be baked is still loaded, it's just decoded again the next time
+   // Once it's baked, the pixels are released, since the baked texture is uploaded instead
+   if (bakeTexture(bakedTextureFilePath, bakedTextureKey, decodedTexture, numOfThreads) && decodedTexture.bakedTexture.open(bakedTextureFilePath, bakedTextureKey))
+   {
+      decodedTexture.data.reset();
+   }
+
+   return true;
+}
+
+bool TextureLoader::decodeTexture(const std::string& texFilePath, TextureColorSpace colorSpace, DecodedTexture& decodedTexture, unsigned int numOfThreads) const
+{
+   std::uint64_t sourceHash = 0;
+   if (!calculateFileHash(texFilePath, sourceHash))
+   {
+      std::cout << "Error - TextureLoader::decodeTexture - The following texture could not be read: " << texFilePath << "\n";
+      return false;
+   }
+
+   return decodeTexture(texFilePath, sourceHash, colorSpace, decodedTexture, numOfThreads);
+}
+
+std::string TextureLoader::getBakedTextureFilePath(const std::string& texFilePath, TextureColorSpace colorSpace) const
+{
+   return texFilePath + ((colorSpace == TextureColorSpace::linear) ? linearBakedTextureFileExtension : bakedTextureFileExtension);
+}
+
+bool TextureLoader::bakeTexture(const std::string&     bakedTextureFilePath,
+                                const BakedTextureKey& key,
+                                const DecodedTexture&  decodedTexture,
+                                unsigned int           numOfThreads) const
+{
+   CompressedTextureFormat format   = chooseCompressedTextureFormat(decodedTexture.numComponents);
+   std::vector<MipLevel>   mipChain = generateMipChain(decodedTexture.data.get(), decodedTexture.width, decodedTexture.height, decodedTexture.numComponents, key.colorSpace, numOfThreads);
+
+   std::vector<CompressedMipLevel> compressedMipLevels;
+   compressedMipLevels.reserve(mipChain.size());
+   for (const MipLevel& mipLevel : mipChain)
+   {
+      compressedMipLevels.push_back(compressMipLevel(format, mipLevel, numOfThreads));
+   }
+
+   return writeBakedTexture(bakedTextureFilePath, key, format, decodedTexture.numComponents, compressedMipLevels);
 }
 
-unsigned int TextureLoader::generateTexture(const std::unique_ptr<unsigned char, void(*)(void*)>& texData,
-                                            int          width,
-                                            int          height,
-                                            int          numComponents,
-                                            unsigned int wrapS,
-                                            unsigned int wrapT,
-                                            unsigned int minFilter,
-                                            unsigned int magFilter,
-                                            bool         genMipmap) const
+unsigned int TextureLoader::generateTexture(const DecodedTexture& decodedTexture,
+                                            unsigned int          wrapS,
+                                            unsigned int          wrapT,
+                                            unsigned int          minFilter,
+                                            unsigned int          magFilter,
+                                            bool                  genMipmap) const
 {
    GLenum format;
-   switch (numComponents)
+   switch (decodedTexture.numComponents)
    {
    case 3:
       format = GL_RGB;
@@ -45,13 +228,13 @@ unsigned int TextureLoader::generateTexture(const std::unique_ptr<unsigned char,
       format = GL_RGBA;
       break;
    default:
-      std::cout << "Error - TextureLoader::generateTexture - The texture has an invalid number of components: " << numComponents << "\n";
+      std::cout << "Error - TextureLoader::generateTexture - The texture has an invalid number of components: " << decodedTexture.numComponents << "\n";
    }
 
    unsigned int texID;
    glGenTextures(1, &texID);
-   glBindTexture(GL_TEXTURE_2D, texID);
-   glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, texData.get());
+   GLStateCache::get().bindTexture2D(0, texID);
+   glTexImage2D(GL_TEXTURE_2D, 0, format, decodedTexture.width, decodedTexture.height, 0, format, GL_UNSIGNED_BYTE, decodedTexture.data.get());
 
    if (genMipmap)
    {
@@ -63,7 +246,62 @@ unsigned int TextureLoader::generateTexture(const std::unique_ptr<unsigned char,
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
 
-   glBindTexture(GL_TEXTURE_2D, 0);
+   GLStateCache::get().bindTexture2D(0, 0);
+
+   return texID;
+}
+
+unsigned int TextureLoader::generateCompressedTexture(const BakedTexture& bakedTexture,
+                                                      unsigned int        wrapS,
+                                                      unsigned int        wrapT,
+                                                      unsigned int        minFilter,
+                                                      unsigned int        magFilter,
+                                                      bool                genMipmap,
+                                                      std::size_t&        gpuMemoryInBytes) const
+{
+   CompressedTextureFormat             format            = bakedTexture.getFormat();
+   std::vector<CompressedMipLevelView> mipLevels         = bakedTexture.getMipLevels();
+   std::size_t                         numOfMipLevels    = genMipmap ? mipLevels.size() : 1;
+   bool                                isFormatSupported = isCompressedFormatSupported(format);
+
+   unsigned int texID;
+   glGenTextures(1, &texID);
+   GLStateCache::get().bindTexture2D(0, texID);
+
+   // The mips were generated when the texture was baked, so they are uploaded instead of being generated with glGenerateMipmap
+   gpuMemoryInBytes = 0;
+   MipLevel decompressedMipLevel;
+   for (std::size_t i = 0; i < numOfMipLevels; ++i)
+   {
+      const CompressedMipLevelView& mipLevel = mipLevels[i];
+      if (isFormatSupported)
+      {
+         glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), getInternalFormat(format), mipLevel.width, mipLevel.height, 0, static_cast<GLsizei>(mipLevel.sizeInBytes), mipLevel.blocks);
+         gpuMemoryInBytes += mipLevel.sizeInBytes;
+      }
+      else if (decompressMipLevel(format, mipLevel, decompressedMipLevel))
+      {
+         glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), GL_RGBA, mipLevel.width, mipLevel.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, decompressedMipLevel.texels.data());
+         gpuMemoryInBytes += decompressedMipLevel.texels.size();
+      }
+      else
+      {
+         std::cout << "Error - TextureLoader::generateCompressedTexture - The following mip level could not be decompressed: " << i << "\n";
+         numOfMipLevels = i;
+         break;
+      }
+   }
+
+   // The levels that were not uploaded must not be sampled, or the texture would be incomplete
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(std::max<std::size_t>(numOfMipLevels, 1)) - 1);
+
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapS);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapT);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
+
+   GLStateCache::get().bindTexture2D(0, 0);
 
    return texID;
 }
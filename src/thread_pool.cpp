@@ -0,0 +1,87 @@
+#include "parallel_for.h"
+#include "thread_pool.h"
+
+namespace
+{
+   thread_local bool gIsWorkerThread = false;
+}
+
+ThreadPool::ThreadPool(unsigned int numOfThreads)
+   : mWorkers()
+   , mTasks()
+   , mMutex()
+   , mTaskAvailable()
+   , mIsStopping(false)
+{
+   if (numOfThreads == 0)
+   {
+      numOfThreads = getDefaultNumOfThreads();
+   }
+
+   mWorkers.reserve(numOfThreads);
+   for (unsigned int i = 0; i < numOfThreads; ++i)
+   {
+      mWorkers.emplace_back(&ThreadPool::runWorker, this);
+   }
+}
+
+ThreadPool::~ThreadPool()
+{
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mIsStopping = true;
+      mTasks.clear();
+   }
+
+   mTaskAvailable.notify_all();
+
+   for (std::thread& worker : mWorkers)
+   {
+      worker.join();
+   }
+}
+
+void ThreadPool::enqueue(std::function<void()> task)
+{
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mTasks.push_back(std::move(task));
+   }
+
+   mTaskAvailable.notify_one();
+}
+
+unsigned int ThreadPool::getNumOfThreads() const
+{
+   return static_cast<unsigned int>(mWorkers.size());
+}
+
+bool ThreadPool::isWorkerThread()
+{
+   return gIsWorkerThread;
+}
+
+void ThreadPool::runWorker()
+{
+   gIsWorkerThread = true;
+
+   while (true)
+   {
+      std::function<void()> task;
+
+      {
+         std::unique_lock<std::mutex> lock(mMutex);
+         mTaskAvailable.wait(lock, [this]() { return mIsStopping || !mTasks.empty(); });
+
+         if (mIsStopping)
+         {
+            return;
+         }
+
+         task = std::move(mTasks.front());
+         mTasks.pop_front();
+      }
+
+      task();
+   }
+}
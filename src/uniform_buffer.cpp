@@ -0,0 +1,56 @@
+#include <iostream>
+#include <utility>
+
+#include "gl_state_cache.h"
+#include "uniform_buffer.h"
+
+UniformBuffer::UniformBuffer(unsigned int sizeInBytes, unsigned int bindingPoint)
+   : mUBO(0)
+   , mSizeInBytes(sizeInBytes)
+   , mBindingPoint(bindingPoint)
+{
+   glGenBuffers(1, &mUBO);
+
+   GLStateCache::get().bindBuffer(GL_UNIFORM_BUFFER, mUBO);
+   glBufferData(GL_UNIFORM_BUFFER, mSizeInBytes, nullptr, GL_DYNAMIC_DRAW);
+
+   GLStateCache::get().bindBufferBase(GL_UNIFORM_BUFFER, mBindingPoint, mUBO);
+}
+
+UniformBuffer::~UniformBuffer()
+{
+   GLStateCache::get().deleteBuffer(mUBO);
+}
+
+UniformBuffer::UniformBuffer(UniformBuffer&& rhs) noexcept
+   : mUBO(std::exchange(rhs.mUBO, 0))
+   , mSizeInBytes(std::exchange(rhs.mSizeInBytes, 0))
+   , mBindingPoint(std::exchange(rhs.mBindingPoint, 0))
+{
+
+}
+
+UniformBuffer& UniformBuffer::operator=(UniformBuffer&& rhs) noexcept
+{
+   mUBO          = std::exchange(rhs.mUBO, 0);
+   mSizeInBytes  = std::exchange(rhs.mSizeInBytes, 0);
+   mBindingPoint = std::exchange(rhs.mBindingPoint, 0);
+   return *this;
+}
+
+void UniformBuffer::update(const void* data, unsigned int sizeInBytes, unsigned int offsetInBytes) const
+{
+   if (offsetInBytes + sizeInBytes > mSizeInBytes)
+   {
+      std::cout << "Error - UniformBuffer::update - The update does not fit in the buffer. Size: " << mSizeInBytes << " bytes - Offset: " << offsetInBytes << " bytes - Requested: " << sizeInBytes << " bytes" << "\n";
+      return;
+   }
+
+   GLStateCache::get().bindBuffer(GL_UNIFORM_BUFFER, mUBO);
+   glBufferSubData(GL_UNIFORM_BUFFER, offsetInBytes, sizeInBytes, data);
+}
+
+unsigned int UniformBuffer::getBindingPoint() const
+{
+   return mBindingPoint;
+}
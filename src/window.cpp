@@ -4,6 +4,7 @@
 
 #include <iostream>
 
+#include "gl_state_cache.h"
 #include "window.h"
 
 Window::Window(const std::string& title)
@@ -14,6 +15,9 @@ Window::Window(const std::string& title)
    , mHeightOfFramebufferInPix(0)
    , mTitle(title)
    , mIsFullScreen(false)
+   , mSwapInterval(1)
+   , mEventsReceived(true)
+   , mTimeOfOldestUnpresentedInput(-1.0)
    , mKeys()
    , mProcessedKeys()
    , mMouseMoved(false)
@@ -79,6 +83,8 @@ bool Window::initialize()
 
    glfwMakeContextCurrent(mWindow);
 
+   glfwSwapInterval(mSwapInterval);
+
    setInputCallbacks();
 
    enableCursor(true);
@@ -92,7 +98,7 @@ bool Window::initialize()
    }
 
    glViewport(0, 0, mWidthOfFramebufferInPix, mHeightOfFramebufferInPix);
-   glEnable(GL_CULL_FACE);
+   GLStateCache::get().enable(GL_CULL_FACE);
 
    if (!configureAntiAliasingSupport())
    {
@@ -149,6 +155,49 @@ void Window::pollEvents()
    glfwPollEvents();
 }
 
+void Window::waitEvents(double timeoutInSec)
+{
+   // Put the thread to sleep until an event arrives or the timeout expires
+   glfwWaitEventsTimeout(timeoutInSec);
+}
+
+int Window::getSwapInterval() const
+{
+   return mSwapInterval;
+}
+
+void Window::setSwapInterval(int swapInterval)
+{
+   // 0 disables vsync, 1 syncs with every vertical blank, 2 with every other vertical blank, etc.
+   mSwapInterval = swapInterval;
+   glfwSwapInterval(mSwapInterval);
+}
+
+bool Window::eventsReceived() const
+{
+   return mEventsReceived;
+}
+
+void Window::resetEventsReceived()
+{
+   mEventsReceived = false;
+}
+
+bool Window::hasUnpresentedInput() const
+{
+   return mTimeOfOldestUnpresentedInput >= 0.0;
+}
+
+double Window::getTimeOfOldestUnpresentedInput() const
+{
+   return mTimeOfOldestUnpresentedInput;
+}
+
+void Window::resetUnpresentedInput()
+{
+   mTimeOfOldestUnpresentedInput = -1.0;
+}
+
 unsigned int Window::getWidthOfWindowInPix() const
 {
    return mWidthOfWindowInPix;
@@ -193,6 +242,18 @@ void Window::setFullScreen(bool fullScreen)
    mIsFullScreen = fullScreen;
 }
 
+void Window::setVisible(bool visible)
+{
+   if (visible)
+   {
+      glfwShowWindow(mWindow);
+   }
+   else
+   {
+      glfwHideWindow(mWindow);
+   }
+}
+
 bool Window::keyIsPressed(int key) const
 {
    return mKeys.test(key);
@@ -277,10 +338,24 @@ void Window::setInputCallbacks()
       static_cast<Window*>(glfwGetWindowUserPointer(window))->scrollCallback(window, xOffset, yOffset);
    };
 
+   // The mouse button and char callbacks are only used to detect events
+   // ImGui chains them when it installs its own callbacks, so they must be set before ImGui is initialized
+   auto mouseButtonCallback = [](GLFWwindow* window, int button, int action, int mods)
+   {
+      static_cast<Window*>(glfwGetWindowUserPointer(window))->mouseButtonCallback(window, button, action, mods);
+   };
+
+   auto charCallback = [](GLFWwindow* window, unsigned int codepoint)
+   {
+      static_cast<Window*>(glfwGetWindowUserPointer(window))->charCallback(window, codepoint);
+   };
+
    glfwSetFramebufferSizeCallback(mWindow, framebufferSizeCallback);
    glfwSetKeyCallback(mWindow, keyCallback);
    glfwSetCursorPosCallback(mWindow, cursorPosCallback);
    glfwSetScrollCallback(mWindow, scrollCallback);
+   glfwSetMouseButtonCallback(mWindow, mouseButtonCallback);
+   glfwSetCharCallback(mWindow, charCallback);
 }
 
 void Window::framebufferSizeCallback(GLFWwindow* window, int width, int height)
@@ -293,6 +368,8 @@ void Window::framebufferSizeCallback(GLFWwindow* window, int width, int height)
    resizeFramebuffers();
 
    glViewport(0, 0, width, height);
+
+   mEventsReceived = true;
 }
 
 void Window::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
@@ -310,6 +387,9 @@ void Window::keyCallback(GLFWwindow* window, int key, int scancode, int action,
 
       mProcessedKeys.reset(key);
    }
+
+   mEventsReceived = true;
+   recordInputTime();
 }
 
 void Window::cursorPosCallback(GLFWwindow* window, double xPos, double yPos)
@@ -330,6 +410,9 @@ void Window::cursorPosCallback(GLFWwindow* window, double xPos, double yPos)
    mLastCursorYPos = yPos;
 
    mMouseMoved = true;
+
+   mEventsReceived = true;
+   recordInputTime();
 }
 
 void Window::scrollCallback(GLFWwindow* window, double xOffset, double yOffset)
@@ -339,6 +422,29 @@ void Window::scrollCallback(GLFWwindow* window, double xOffset, double yOffset)
    mScrollYOffset = static_cast<float>(yOffset);
 
    mScrollWheelMoved = true;
+
+   mEventsReceived = true;
+   recordInputTime();
+}
+
+void Window::mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
+{
+   mEventsReceived = true;
+   recordInputTime();
+}
+
+void Window::charCallback(GLFWwindow* window, unsigned int codepoint)
+{
+   mEventsReceived = true;
+}
+
+void Window::recordInputTime()
+{
+   // We only keep the time of the oldest input that hasn't been presented, since that's the one that has waited the longest
+   if (mTimeOfOldestUnpresentedInput < 0.0)
+   {
+      mTimeOfOldestUnpresentedInput = glfwGetTime();
+   }
 }
 
 bool Window::configureAntiAliasingSupport()